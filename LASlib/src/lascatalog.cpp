@@ -0,0 +1,620 @@
+/*
+===============================================================================
+
+  FILE:  lascatalog.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the LICENSE.txt file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "lascatalog.hpp"
+
+#include "lasreader.hpp"
+#include "lasreader_las.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+#include <map>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+using namespace std;
+
+typedef map<string, U32> my_name_map;
+typedef vector<LAScatalogNode> my_node_vector;
+
+// the catalog file starts with this 64 byte header followed by the entries, the nodes and the file names
+
+class LAScatalogHeader
+{
+public:
+  CHAR file_signature[4];
+  U32 version;
+  U32 number_entries;
+  U32 number_nodes;
+  U32 root;
+  U32 string_bytes;
+  U32 header_size;
+  U8 reserved[36];
+};
+
+static BOOL las_catalog_file_info(const CHAR* file_name, I64* modification_time, I64* file_size)
+{
+#ifdef _WIN32
+  struct _stat64 info;
+  if (_stat64(file_name, &info) != 0) return FALSE;
+#else
+  struct stat info;
+  if (stat(file_name, &info) != 0) return FALSE;
+  if (!S_ISREG(info.st_mode)) return FALSE;
+#endif
+  *modification_time = (I64)info.st_mtime;
+  *file_size = (I64)info.st_size;
+  return TRUE;
+}
+
+static BOOL las_catalog_is_lidar(const CHAR* file_name)
+{
+  I32 len = (I32)strlen(file_name);
+  if (len < 4) return FALSE;
+  const CHAR* ext = file_name + len - 4;
+  return (strcmp(ext, ".las") == 0 || strcmp(ext, ".laz") == 0 || strcmp(ext, ".LAS") == 0 || strcmp(ext, ".LAZ") == 0);
+}
+
+static void las_catalog_list_directory(const CHAR* directory, vector<string>& file_names)
+{
+  string path(directory);
+  if (path.size() && path[path.size()-1] != '/' && path[path.size()-1] != '\\')
+  {
+#ifdef _WIN32
+    path += '\\';
+#else
+    path += '/';
+#endif
+  }
+#ifdef _WIN32
+  WIN32_FIND_DATA info;
+  HANDLE h = FindFirstFile((path + "*").c_str(), &info);
+  if (h == INVALID_HANDLE_VALUE) return;
+  do
+  {
+    if ((info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0 && las_catalog_is_lidar(info.cFileName))
+    {
+      file_names.push_back(path + info.cFileName);
+    }
+  } while (FindNextFile(h, &info));
+  FindClose(h);
+#else
+  DIR* dir = opendir(directory);
+  if (dir == 0) return;
+  struct dirent* info;
+  while ((info = readdir(dir)) != 0)
+  {
+    if (las_catalog_is_lidar(info->d_name))
+    {
+      file_names.push_back(path + info->d_name);
+    }
+  }
+  closedir(dir);
+#endif
+  sort(file_names.begin(), file_names.end());
+}
+
+static BOOL las_catalog_read_header(const CHAR* file_name, LAScatalogEntry* entry)
+{
+  LASreaderLAS lasreaderlas;
+  if (!lasreaderlas.open(file_name))
+  {
+    return FALSE;
+  }
+  const LASheader* header = &lasreaderlas.header;
+  entry->min_x = header->min_x;
+  entry->min_y = header->min_y;
+  entry->min_z = header->min_z;
+  entry->max_x = header->max_x;
+  entry->max_y = header->max_y;
+  entry->max_z = header->max_z;
+  entry->number_of_point_records = lasreaderlas.npoints;
+  entry->point_data_format = header->point_data_format;
+  entry->version_minor = header->version_minor;
+  entry->epsg = 0;
+  if (header->vlr_geo_keys)
+  {
+    for (U32 j = 0; j < header->vlr_geo_keys->number_of_keys; j++)
+    {
+      // ProjectedCSTypeGeoKey wins over GeographicTypeGeoKey
+      if (header->vlr_geo_key_entries[j].key_id == 3072 && header->vlr_geo_key_entries[j].tiff_tag_location == 0)
+      {
+        entry->epsg = header->vlr_geo_key_entries[j].value_offset;
+      }
+      else if (header->vlr_geo_key_entries[j].key_id == 2048 && header->vlr_geo_key_entries[j].tiff_tag_location == 0 && entry->epsg == 0)
+      {
+        entry->epsg = header->vlr_geo_key_entries[j].value_offset;
+      }
+    }
+  }
+  lasreaderlas.close();
+  return TRUE;
+}
+
+// sort-tile-recursive packing: sort by x, cut into vertical slices, sort each slice by y
+
+template<class T> static F64 las_catalog_center_x(const T& t) { return t.min_x + t.max_x; }
+template<class T> static F64 las_catalog_center_y(const T& t) { return t.min_y + t.max_y; }
+
+template<class T> static void las_catalog_str_sort(T* items, U32 num)
+{
+  U32 leaves = (num + LAS_CATALOG_NODE_CAPACITY - 1) / LAS_CATALOG_NODE_CAPACITY;
+  U32 slices = (U32)ceil(sqrt((F64)leaves));
+  U32 slice_size = slices * LAS_CATALOG_NODE_CAPACITY;
+  sort(items, items + num, [](const T& a, const T& b) { return las_catalog_center_x(a) < las_catalog_center_x(b); });
+  for (U32 s = 0; s < num; s += slice_size)
+  {
+    U32 e = (s + slice_size < num ? s + slice_size : num);
+    sort(items + s, items + e, [](const T& a, const T& b) { return las_catalog_center_y(a) < las_catalog_center_y(b); });
+  }
+}
+
+BOOL LAScatalog::create(U32 num, LAScatalogEntry* new_entries, CHAR** file_names)
+{
+  U32 i, j;
+
+  // reorder the entries (and their names) into leaf order
+
+  struct ordered
+  {
+    F64 min_x, min_y, max_x, max_y;
+    U32 index;
+  };
+  vector<ordered> keys(num);
+  for (i = 0; i < num; i++)
+  {
+    keys[i].min_x = new_entries[i].min_x;
+    keys[i].min_y = new_entries[i].min_y;
+    keys[i].max_x = new_entries[i].max_x;
+    keys[i].max_y = new_entries[i].max_y;
+    keys[i].index = i;
+  }
+  if (num) las_catalog_str_sort(&keys[0], num);
+
+  // create the levels of the tree bottom-up
+
+  my_node_vector all_nodes;
+  my_node_vector level;
+  for (i = 0; i < num; i += LAS_CATALOG_NODE_CAPACITY)
+  {
+    LAScatalogNode node;
+    node.first = i;
+    node.number = (U16)(i + LAS_CATALOG_NODE_CAPACITY < num ? LAS_CATALOG_NODE_CAPACITY : num - i);
+    node.leaf = 1;
+    node.min_x = keys[i].min_x;
+    node.min_y = keys[i].min_y;
+    node.max_x = keys[i].max_x;
+    node.max_y = keys[i].max_y;
+    for (j = i + 1; j < i + node.number; j++)
+    {
+      if (keys[j].min_x < node.min_x) node.min_x = keys[j].min_x;
+      if (keys[j].min_y < node.min_y) node.min_y = keys[j].min_y;
+      if (keys[j].max_x > node.max_x) node.max_x = keys[j].max_x;
+      if (keys[j].max_y > node.max_y) node.max_y = keys[j].max_y;
+    }
+    level.push_back(node);
+  }
+  while (level.size() > 1)
+  {
+    las_catalog_str_sort(&level[0], (U32)level.size());
+    U32 level_start = (U32)all_nodes.size();
+    all_nodes.insert(all_nodes.end(), level.begin(), level.end());
+    my_node_vector parents;
+    U32 level_size = (U32)level.size();
+    for (i = 0; i < level_size; i += LAS_CATALOG_NODE_CAPACITY)
+    {
+      LAScatalogNode node = level[i];
+      node.first = level_start + i;
+      node.number = (U16)(i + LAS_CATALOG_NODE_CAPACITY < level_size ? LAS_CATALOG_NODE_CAPACITY : level_size - i);
+      node.leaf = 0;
+      for (j = i + 1; j < i + node.number; j++)
+      {
+        if (level[j].min_x < node.min_x) node.min_x = level[j].min_x;
+        if (level[j].min_y < node.min_y) node.min_y = level[j].min_y;
+        if (level[j].max_x > node.max_x) node.max_x = level[j].max_x;
+        if (level[j].max_y > node.max_y) node.max_y = level[j].max_y;
+      }
+      parents.push_back(node);
+    }
+    level.swap(parents);
+  }
+  all_nodes.insert(all_nodes.end(), level.begin(), level.end());
+
+  // lay everything out in one block exactly as it is stored on disk
+
+  U32 total_string_bytes = 0;
+  for (i = 0; i < num; i++) total_string_bytes += (U32)strlen(file_names[i]) + 1;
+
+  size_t size = sizeof(LAScatalogHeader) + sizeof(LAScatalogEntry)*num + sizeof(LAScatalogNode)*all_nodes.size() + total_string_bytes;
+  U8* block = (U8*)malloc(size);
+  if (block == 0)
+  {
+    fprintf(stderr, "ERROR: allocating %u bytes for LAScatalog with %u entries\n", (U32)size, num);
+    return FALSE;
+  }
+  clean();
+  data = block;
+  number_entries = num;
+  number_nodes = (U32)all_nodes.size();
+  root = (number_nodes ? number_nodes - 1 : 0);
+  string_bytes = total_string_bytes;
+
+  LAScatalogHeader* header = (LAScatalogHeader*)data;
+  memset(header, 0, sizeof(LAScatalogHeader));
+  memcpy(header->file_signature, "LASC", 4);
+  header->version = LAS_CATALOG_VERSION;
+  header->number_entries = number_entries;
+  header->number_nodes = number_nodes;
+  header->root = root;
+  header->string_bytes = string_bytes;
+  header->header_size = sizeof(LAScatalogHeader);
+
+  entries = (LAScatalogEntry*)(data + sizeof(LAScatalogHeader));
+  nodes = (LAScatalogNode*)(entries + number_entries);
+  strings = (CHAR*)(nodes + number_nodes);
+
+  U32 offset = 0;
+  for (i = 0; i < num; i++)
+  {
+    entries[i] = new_entries[keys[i].index];
+    entries[i].file_name_offset = offset;
+    strcpy(strings + offset, file_names[keys[i].index]);
+    offset += (U32)strlen(file_names[keys[i].index]) + 1;
+  }
+  if (number_nodes) memcpy(nodes, &all_nodes[0], sizeof(LAScatalogNode)*number_nodes);
+  return TRUE;
+}
+
+BOOL LAScatalog::scan(const CHAR* directory, U32 threads, BOOL incremental)
+{
+  U32 i;
+  vector<string> file_names;
+  las_catalog_list_directory(directory, file_names);
+
+  U32 num = (U32)file_names.size();
+  vector<LAScatalogEntry> new_entries(num);
+  vector<U32> to_read;
+  vector<BOOL> valid(num, FALSE);
+
+  my_name_map known;
+  if (incremental)
+  {
+    for (i = 0; i < number_entries; i++)
+    {
+      known.insert(my_name_map::value_type(string(get_file_name(i)), i));
+    }
+  }
+
+  for (i = 0; i < num; i++)
+  {
+    memset(&new_entries[i], 0, sizeof(LAScatalogEntry));
+    if (!las_catalog_file_info(file_names[i].c_str(), &new_entries[i].modification_time, &new_entries[i].file_size))
+    {
+      continue;
+    }
+    my_name_map::iterator known_element = known.find(file_names[i]);
+    if (known_element != known.end())
+    {
+      const LAScatalogEntry* old_entry = &entries[(*known_element).second];
+      if (old_entry->modification_time == new_entries[i].modification_time && old_entry->file_size == new_entries[i].file_size)
+      {
+        new_entries[i] = *old_entry;
+        valid[i] = TRUE;
+        continue;
+      }
+    }
+    to_read.push_back(i);
+  }
+
+  // read the headers that are new or have changed with several threads
+
+  if (threads == 0) threads = thread::hardware_concurrency();
+  if (threads == 0) threads = 1;
+  if (threads > to_read.size()) threads = (U32)to_read.size();
+
+  atomic<U32> next(0);
+  auto worker = [&]()
+  {
+    U32 k;
+    while ((k = next++) < to_read.size())
+    {
+      U32 idx = to_read[k];
+      if (las_catalog_read_header(file_names[idx].c_str(), &new_entries[idx]))
+      {
+        valid[idx] = TRUE;
+      }
+      else
+      {
+        fprintf(stderr, "WARNING: cannot read header of '%s'. skipping ...\n", file_names[idx].c_str());
+      }
+    }
+  };
+  vector<thread> pool;
+  for (i = 1; i < threads; i++) pool.push_back(thread(worker));
+  if (threads) worker();
+  for (i = 0; i < pool.size(); i++) pool[i].join();
+
+  // keep only the files whose headers we have
+
+  U32 num_valid = 0;
+  vector<CHAR*> names;
+  for (i = 0; i < num; i++)
+  {
+    if (valid[i])
+    {
+      new_entries[num_valid] = new_entries[i];
+      names.push_back((CHAR*)file_names[i].c_str());
+      num_valid++;
+    }
+  }
+  return create(num_valid, (num_valid ? &new_entries[0] : 0), (num_valid ? &names[0] : 0));
+}
+
+BOOL LAScatalog::build(const CHAR* directory, U32 threads)
+{
+  clean();
+  return scan(directory, threads, FALSE);
+}
+
+BOOL LAScatalog::update(const CHAR* directory, U32 threads)
+{
+  return scan(directory, threads, TRUE);
+}
+
+BOOL LAScatalog::read(const CHAR* file_name)
+{
+  FILE* file = fopen(file_name, "rb");
+  if (file == 0)
+  {
+    return FALSE;
+  }
+  LAScatalogHeader header;
+  if (fread(&header, sizeof(LAScatalogHeader), 1, file) != 1)
+  {
+    fprintf(stderr, "ERROR: reading header of LAScatalog '%s'\n", file_name);
+    fclose(file);
+    return FALSE;
+  }
+  if (strncmp(header.file_signature, "LASC", 4) != 0 || header.header_size != sizeof(LAScatalogHeader))
+  {
+    fprintf(stderr, "ERROR: '%s' is not a LAScatalog\n", file_name);
+    fclose(file);
+    return FALSE;
+  }
+  if (header.version > LAS_CATALOG_VERSION)
+  {
+    fprintf(stderr, "ERROR: LAScatalog '%s' has version %u. this code knows %u.\n", file_name, header.version, LAS_CATALOG_VERSION);
+    fclose(file);
+    return FALSE;
+  }
+  // the counts of the header must describe exactly the bytes of the file
+  fseek(file, 0, SEEK_END);
+  U64 file_size = (U64)ftell(file);
+  fseek(file, sizeof(LAScatalogHeader), SEEK_SET);
+  U64 expected = (U64)sizeof(LAScatalogHeader) + (U64)sizeof(LAScatalogEntry)*header.number_entries + (U64)sizeof(LAScatalogNode)*header.number_nodes + header.string_bytes;
+  if (expected != file_size || (header.number_nodes && header.root >= header.number_nodes) || (header.number_nodes == 0 && header.number_entries))
+  {
+    fprintf(stderr, "ERROR: LAScatalog '%s' is corrupt. header describes %u entries and %u nodes with root %u in %u bytes but file has %u bytes\n", file_name, header.number_entries, header.number_nodes, header.root, (U32)expected, (U32)file_size);
+    fclose(file);
+    return FALSE;
+  }
+  size_t size = (size_t)expected;
+  U8* block = (U8*)malloc(size);
+  if (block == 0)
+  {
+    fprintf(stderr, "ERROR: allocating %u bytes for LAScatalog '%s'\n", (U32)size, file_name);
+    fclose(file);
+    return FALSE;
+  }
+  memcpy(block, &header, sizeof(LAScatalogHeader));
+  if (fread(block + sizeof(LAScatalogHeader), 1, size - sizeof(LAScatalogHeader), file) != size - sizeof(LAScatalogHeader))
+  {
+    fprintf(stderr, "ERROR: LAScatalog '%s' is truncated\n", file_name);
+    free(block);
+    fclose(file);
+    return FALSE;
+  }
+  fclose(file);
+  // the file names and the children of every node must be within the catalog. like build()
+  // writes them, the children of a node come before it so the tree has no cycles.
+  const LAScatalogEntry* new_entries = (const LAScatalogEntry*)(block + sizeof(LAScatalogHeader));
+  const LAScatalogNode* new_nodes = (const LAScatalogNode*)(new_entries + header.number_entries);
+  const CHAR* new_strings = (const CHAR*)(new_nodes + header.number_nodes);
+  if (header.number_entries && (header.string_bytes == 0 || new_strings[header.string_bytes - 1] != '\0'))
+  {
+    fprintf(stderr, "ERROR: file names of LAScatalog '%s' are corrupt\n", file_name);
+    free(block);
+    return FALSE;
+  }
+  for (U32 i = 0; i < header.number_entries; i++)
+  {
+    if (new_entries[i].file_name_offset >= header.string_bytes)
+    {
+      fprintf(stderr, "ERROR: entry %u of LAScatalog '%s' is corrupt\n", i, file_name);
+      free(block);
+      return FALSE;
+    }
+  }
+  for (U32 i = 0; i < header.number_nodes; i++)
+  {
+    if (new_nodes[i].number == 0 || new_nodes[i].number > LAS_CATALOG_NODE_CAPACITY || (U64)new_nodes[i].first + new_nodes[i].number > (new_nodes[i].leaf ? header.number_entries : i))
+    {
+      fprintf(stderr, "ERROR: node %u of LAScatalog '%s' is corrupt\n", i, file_name);
+      free(block);
+      return FALSE;
+    }
+  }
+  clean();
+  data = block;
+  number_entries = header.number_entries;
+  number_nodes = header.number_nodes;
+  root = header.root;
+  string_bytes = header.string_bytes;
+  entries = (LAScatalogEntry*)(data + sizeof(LAScatalogHeader));
+  nodes = (LAScatalogNode*)(entries + number_entries);
+  strings = (CHAR*)(nodes + number_nodes);
+  return TRUE;
+}
+
+BOOL LAScatalog::write(const CHAR* file_name) const
+{
+  if (data == 0)
+  {
+    fprintf(stderr, "ERROR: LAScatalog was not built or read\n");
+    return FALSE;
+  }
+  FILE* file = fopen(file_name, "wb");
+  if (file == 0)
+  {
+    fprintf(stderr, "ERROR: cannot open '%s' for write\n", file_name);
+    return FALSE;
+  }
+  size_t size = sizeof(LAScatalogHeader) + sizeof(LAScatalogEntry)*number_entries + sizeof(LAScatalogNode)*number_nodes + string_bytes;
+  if (fwrite(data, 1, size, file) != size)
+  {
+    fprintf(stderr, "ERROR: writing %u bytes of LAScatalog to '%s'\n", (U32)size, file_name);
+    fclose(file);
+    return FALSE;
+  }
+  fclose(file);
+  return TRUE;
+}
+
+static inline void las_catalog_add(U32 index, U32 count, U32** indices, U32* allocated)
+{
+  if (count == *allocated)
+  {
+    *allocated = (*allocated ? 2 * *allocated : 16);
+    *indices = (U32*)realloc(*indices, sizeof(U32) * *allocated);
+  }
+  (*indices)[count] = index;
+}
+
+U32 LAScatalog::intersect_rectangle(const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y, U32** indices, U32* allocated) const
+{
+  if (number_nodes == 0) return 0;
+  U32 count = 0;
+  U32 stack[256];
+  U32 size = 0;
+  stack[size++] = root;
+  while (size)
+  {
+    const LAScatalogNode* node = &nodes[stack[--size]];
+    if (node->min_x > r_max_x || node->max_x < r_min_x || node->min_y > r_max_y || node->max_y < r_min_y) continue;
+    if (node->leaf)
+    {
+      for (U32 i = node->first; i < (U32)(node->first + node->number); i++)
+      {
+        if (entries[i].min_x > r_max_x || entries[i].max_x < r_min_x || entries[i].min_y > r_max_y || entries[i].max_y < r_min_y) continue;
+        las_catalog_add(i, count, indices, allocated);
+        count++;
+      }
+    }
+    else if (size + node->number > 256)
+    {
+      fprintf(stderr, "WARNING: LAScatalog is too deep. skipping %u nodes ...\n", (U32)node->number);
+    }
+    else
+    {
+      for (U32 i = node->first; i < (U32)(node->first + node->number); i++)
+      {
+        stack[size++] = i;
+      }
+    }
+  }
+  return count;
+}
+
+U32 LAScatalog::intersect_circle(const F64 center_x, const F64 center_y, const F64 radius, U32** indices, U32* allocated) const
+{
+  U32 count = intersect_rectangle(center_x - radius, center_y - radius, center_x + radius, center_y + radius, indices, allocated);
+  F64 radius_squared = radius*radius;
+  U32 kept = 0;
+  for (U32 i = 0; i < count; i++)
+  {
+    const LAScatalogEntry* entry = &entries[(*indices)[i]];
+    F64 dx = (center_x < entry->min_x ? entry->min_x - center_x : (center_x > entry->max_x ? center_x - entry->max_x : 0.0));
+    F64 dy = (center_y < entry->min_y ? entry->min_y - center_y : (center_y > entry->max_y ? center_y - entry->max_y : 0.0));
+    if (dx*dx + dy*dy <= radius_squared)
+    {
+      (*indices)[kept++] = (*indices)[i];
+    }
+  }
+  return kept;
+}
+
+U32 LAScatalog::intersect_point(const F64 x, const F64 y, U32** indices, U32* allocated) const
+{
+  return intersect_rectangle(x, y, x, y, indices, allocated);
+}
+
+U32 LAScatalog::add_file_names(LASreadOpener* lasreadopener, const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y) const
+{
+  U32* indices = 0;
+  U32 allocated = 0;
+  U32 count = intersect_rectangle(r_min_x, r_min_y, r_max_x, r_max_y, &indices, &allocated);
+  for (U32 i = 0; i < count; i++)
+  {
+    lasreadopener->add_file_name(get_file_name(indices[i]));
+  }
+  if (indices) free(indices);
+  return count;
+}
+
+void LAScatalog::clean()
+{
+  if (data) free(data);
+  data = 0;
+  number_entries = 0;
+  number_nodes = 0;
+  root = 0;
+  string_bytes = 0;
+  entries = 0;
+  nodes = 0;
+  strings = 0;
+}
+
+LAScatalog::LAScatalog()
+{
+  data = 0;
+  clean();
+}
+
+LAScatalog::~LAScatalog()
+{
+  clean();
+}
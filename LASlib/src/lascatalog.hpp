@@ -0,0 +1,131 @@
+/*
+===============================================================================
+
+  FILE:  lascatalog.hpp
+
+  CONTENTS:
+
+    A persistent catalog of the LAS/LAZ tiles in a directory. For every file
+    it remembers the bounding box, the point count, the point type and the
+    EPSG code found in the GeoTIFF keys of the header together with the time
+    stamp and the size of the file. The headers are read with several threads
+    and a catalog written earlier is updated incrementally so that only files
+    that are new or whose time stamp or size changed are opened again.
+
+    The entries are organized in a packed R-tree (sort-tile-recursive bulk
+    loading) so that a point or a rectangle is resolved to the overlapping
+    files without touching the others. The file layout is the in-memory one
+    (fixed-size records, offsets instead of pointers, little endian) so the
+    catalog can be read with one fread() or mapped into memory as is.
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the LICENSE.txt file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created to stop resolving tiles for coordinates in Java
+
+===============================================================================
+*/
+#ifndef LAS_CATALOG_HPP
+#define LAS_CATALOG_HPP
+
+#include "lasdefinitions.hpp"
+
+class LASreadOpener;
+
+#define LAS_CATALOG_VERSION 1
+#define LAS_CATALOG_NODE_CAPACITY 16
+
+// the fixed-size records below are written to (and read from) disk as is
+
+class LAScatalogEntry
+{
+public:
+  F64 min_x;
+  F64 min_y;
+  F64 min_z;
+  F64 max_x;
+  F64 max_y;
+  F64 max_z;
+  I64 number_of_point_records;
+  I64 modification_time;
+  I64 file_size;
+  U32 file_name_offset;
+  U32 epsg;
+  U8 point_data_format;
+  U8 version_minor;
+  U16 reserved;
+  U32 flags;
+};
+
+class LAScatalogNode
+{
+public:
+  F64 min_x;
+  F64 min_y;
+  F64 max_x;
+  F64 max_y;
+  U32 first;   // index of the first child node or (for leaves) of the first entry
+  U16 number;  // number of consecutive children or entries
+  U16 leaf;
+};
+
+class LASLIB_DLL LAScatalog
+{
+public:
+  // create from the LAS/LAZ files in a directory (with 0 meaning one thread per core)
+  BOOL build(const CHAR* directory, U32 threads=0);
+
+  // re-reads only those headers of files that are new or whose time stamp or size changed
+  BOOL update(const CHAR* directory, U32 threads=0);
+
+  // read from file or write to file
+  BOOL read(const CHAR* file_name);
+  BOOL write(const CHAR* file_name) const;
+
+  // access the entries
+  inline U32 get_number_entries() const { return number_entries; };
+  inline const LAScatalogEntry* get_entry(U32 index) const { return &entries[index]; };
+  inline const CHAR* get_file_name(U32 index) const { return strings + entries[index].file_name_offset; };
+  inline F64 get_min_x() const { return (number_nodes ? nodes[root].min_x : 0.0); };
+  inline F64 get_min_y() const { return (number_nodes ? nodes[root].min_y : 0.0); };
+  inline F64 get_max_x() const { return (number_nodes ? nodes[root].max_x : 0.0); };
+  inline F64 get_max_y() const { return (number_nodes ? nodes[root].max_y : 0.0); };
+
+  // query the entries whose bounding box overlaps. these are const and can be
+  // called from several threads. the indices are stored in a caller-owned array
+  // that is grown with realloc() as needed and should be released with free().
+  U32 intersect_rectangle(const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y, U32** indices, U32* allocated) const;
+  U32 intersect_circle(const F64 center_x, const F64 center_y, const F64 radius, U32** indices, U32* allocated) const;
+  U32 intersect_point(const F64 x, const F64 y, U32** indices, U32* allocated) const;
+
+  // adds the files overlapping the rectangle to the read opener and returns their number
+  U32 add_file_names(LASreadOpener* lasreadopener, const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y) const;
+
+  void clean();
+
+  LAScatalog();
+  ~LAScatalog();
+
+private:
+  BOOL create(U32 num, LAScatalogEntry* new_entries, CHAR** file_names);
+  BOOL scan(const CHAR* directory, U32 threads, BOOL incremental);
+
+  U8* data;
+  U32 number_entries;
+  U32 number_nodes;
+  U32 root;
+  U32 string_bytes;
+  LAScatalogEntry* entries;
+  LAScatalogNode* nodes;
+  CHAR* strings;
+};
+
+#endif
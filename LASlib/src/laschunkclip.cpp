@@ -0,0 +1,406 @@
+/*
+===============================================================================
+
+  FILE:  laschunkclip.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the LICENSE.txt file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "laschunkclip.hpp"
+
+#include "lasreader_las.hpp"
+#include "laswriter_las.hpp"
+#include "lasindex.hpp"
+#include "lasquadtree.hpp"
+#include "lasinterval.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// what happens to a chunk of the input
+
+#define LAS_CHUNK_CLIP_SKIP    0
+#define LAS_CHUNK_CLIP_ENCODE  1
+#define LAS_CHUNK_CLIP_COPY    2
+
+static int compare_intervals(const void* a, const void* b)
+{
+  const I64* ia = (const I64*)a;
+  const I64* ib = (const I64*)b;
+  return (ia[0] < ib[0] ? -1 : (ia[0] > ib[0] ? 1 : 0));
+}
+
+// the chunk containing the point given the first points of all chunks
+
+static U32 find_chunk(const I64* firsts, const U32 number_chunks, const I64 point)
+{
+  U32 lower = 0;
+  U32 upper = number_chunks;
+  while (lower + 1 < upper)
+  {
+    U32 mid = (lower + upper) / 2;
+    if (point >= firsts[mid])
+      lower = mid;
+    else
+      upper = mid;
+  }
+  return lower;
+}
+
+BOOL LASchunkClip::can_copy_chunks(const LASreaderLAS* lasreader, const BOOL compress) const
+{
+  const LASzip* laszip = lasreader->header.laszip;
+  if (!compress || (laszip == 0))
+  {
+    return FALSE;
+  }
+  if ((laszip->compressor != LASZIP_COMPRESSOR_CHUNKED) && (laszip->compressor != LASZIP_COMPRESSOR_LAYERED_CHUNKED))
+  {
+    return FALSE;
+  }
+
+  // the writer must choose the same compressor and the same item versions
+
+  LASzip output;
+  if (!output.setup(laszip->num_items, laszip->items, LASZIP_COMPRESSOR_LAYERED_CHUNKED) || !output.request_version(2))
+  {
+    return FALSE;
+  }
+  if (output.compressor != laszip->compressor)
+  {
+    return FALSE;
+  }
+  U32 i;
+  for (i = 0; i < laszip->num_items; i++)
+  {
+    if ((output.items[i].type != laszip->items[i].type) || (output.items[i].size != laszip->items[i].size) || (output.items[i].version != laszip->items[i].version))
+    {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+BOOL LASchunkClip::mark_chunks(LASreaderLAS* lasreader, LASindex* index, const F64 min_x, const F64 min_y, const F64 max_x, const F64 max_y)
+{
+  if (chunk_marks)
+  {
+    free(chunk_marks);
+    chunk_marks = 0;
+  }
+  number_chunks = lasreader->get_number_chunks();
+  if (number_chunks == 0)
+  {
+    return FALSE;
+  }
+  chunk_marks = (U8*)calloc(number_chunks, sizeof(U8));
+
+  U32 c, num_points;
+  I64* firsts = (I64*)malloc(sizeof(I64)*(number_chunks+1));
+  for (c = 0; c < number_chunks; c++)
+  {
+    lasreader->get_chunk(c, 0, 0, &firsts[c], &num_points);
+  }
+  firsts[number_chunks] = firsts[number_chunks-1] + num_points;
+
+  // the intervals of cells completely inside the rectangle sorted and joined where they
+  // touch. intervals may hold a few points of other cells so this is only a good guess.
+
+  LASquadtree* spatial = index->get_spatial();
+  LASinterval* interval = index->get_interval();
+  U32 number_inside = 0;
+  U32 allocated_inside = 1024;
+  I64* inside = (I64*)malloc(sizeof(I64)*2*allocated_inside);
+  F32 cell_min[2], cell_max[2];
+  interval->get_cells();
+  while (interval->has_cells())
+  {
+    spatial->get_cell_bounding_box(interval->index, cell_min, cell_max);
+    if ((cell_min[0] < min_x) || (cell_min[1] < min_y) || (cell_max[0] >= max_x) || (cell_max[1] >= max_y)) continue;
+    while (interval->has_intervals())
+    {
+      if (number_inside == allocated_inside)
+      {
+        allocated_inside *= 2;
+        inside = (I64*)realloc(inside, sizeof(I64)*2*allocated_inside);
+      }
+      inside[2*number_inside] = interval->start;
+      inside[2*number_inside+1] = interval->end;
+      number_inside++;
+    }
+  }
+  U32 i, number_joined = 0;
+  if (number_inside)
+  {
+    qsort(inside, number_inside, sizeof(I64)*2, compare_intervals);
+    for (i = 1; i < number_inside; i++)
+    {
+      if (inside[2*i] <= inside[2*number_joined+1] + 1)
+      {
+        if (inside[2*i+1] > inside[2*number_joined+1]) inside[2*number_joined+1] = inside[2*i+1];
+      }
+      else
+      {
+        number_joined++;
+        inside[2*number_joined] = inside[2*i];
+        inside[2*number_joined+1] = inside[2*i+1];
+      }
+    }
+    number_joined++;
+  }
+
+  // chunks with points in cells intersecting the rectangle are encoded unless one joined interval covers them
+
+  U32 first, last;
+  if (index->intersect_rectangle(min_x, min_y, max_x, max_y))
+  {
+    while (index->has_intervals())
+    {
+      first = find_chunk(firsts, number_chunks, index->start);
+      last = find_chunk(firsts, number_chunks, index->end);
+      for (c = first; c <= last; c++)
+      {
+        chunk_marks[c] = LAS_CHUNK_CLIP_ENCODE;
+      }
+    }
+  }
+  for (c = 0; c < number_chunks; c++)
+  {
+    if ((chunk_marks[c] == LAS_CHUNK_CLIP_SKIP) || (number_joined == 0) || (firsts[c+1] == firsts[c])) continue;
+    U32 lower = 0;
+    U32 upper = number_joined;
+    while (lower + 1 < upper)
+    {
+      U32 mid = (lower + upper) / 2;
+      if (firsts[c] >= inside[2*mid])
+        lower = mid;
+      else
+        upper = mid;
+    }
+    if ((inside[2*lower] <= firsts[c]) && (inside[2*lower+1] >= (firsts[c+1] - 1)))
+    {
+      chunk_marks[c] = LAS_CHUNK_CLIP_COPY;
+    }
+  }
+
+  free(inside);
+  free(firsts);
+  return TRUE;
+}
+
+I64 LASchunkClip::clip(const CHAR* file_name_in, const CHAR* file_name_out, const F64 min_x, const F64 min_y, const F64 max_x, const F64 max_y)
+{
+  copied_chunks = 0;
+  copied_points = 0;
+  encoded_chunks = 0;
+  encoded_points = 0;
+
+  if ((file_name_in == 0) || (file_name_out == 0))
+  {
+    fprintf(stderr,"ERROR: file name pointer is zero\n");
+    return -1;
+  }
+
+  LASreaderLAS* lasreader = new LASreaderLAS();
+  if (!lasreader->open(file_name_in))
+  {
+    fprintf(stderr,"ERROR: cannot open '%s' for clipping\n", file_name_in);
+    delete lasreader;
+    return -1;
+  }
+  LASindex* index = new LASindex();
+  if (!index->read(file_name_in))
+  {
+    delete index;
+    index = 0;
+  }
+
+  size_t len = strlen(file_name_out);
+  BOOL compress = (len && ((file_name_out[len-1] == 'z') || (file_name_out[len-1] == 'Z')));
+  BOOL copy = (index && can_copy_chunks(lasreader, compress) && mark_chunks(lasreader, index, min_x, min_y, max_x, max_y));
+
+  // copied chunks can only be mixed with encoded ones when every chunk has its own point count
+
+  LASwriterLAS* laswriter = new LASwriterLAS();
+  if (copy) laswriter->set_adaptive_chunking(TRUE);
+  if (!laswriter->open(file_name_out, &lasreader->header, (compress ? LASZIP_COMPRESSOR_LAYERED_CHUNKED : LASZIP_COMPRESSOR_NONE), 2, (copy ? 0 : LASZIP_CHUNK_SIZE_DEFAULT)))
+  {
+    fprintf(stderr,"ERROR: cannot open '%s' for clipping\n", file_name_out);
+    delete laswriter;
+    remove(file_name_out);
+    lasreader->close();
+    delete lasreader;
+    if (index) delete index;
+    return -1;
+  }
+
+  BOOL failed = FALSE;
+  I64 number = 0;
+
+  if (!copy)
+  {
+    lasreader->set_index(index);
+    lasreader->inside_rectangle(min_x, min_y, max_x, max_y);
+    while (lasreader->read_point())
+    {
+      laswriter->write_point(&lasreader->point);
+      laswriter->update_inventory(&lasreader->point);
+      number++;
+    }
+    encoded_points = number;
+  }
+  else
+  {
+    // a second reader decompresses only what the header needs from the chunks to copy
+
+    LASreaderLAS* lasscanner = new LASreaderLAS();
+    FILE* file = fopen(file_name_in, "rb");
+    if (!lasscanner->open(file_name_in, LAS_TOOLS_IO_IBUFFER_SIZE, FALSE, LASZIP_DECOMPRESS_SELECTIVE_CHANNEL_RETURNS_XY | LASZIP_DECOMPRESS_SELECTIVE_Z) || (file == 0))
+    {
+      fprintf(stderr,"ERROR: cannot re-open '%s' for copying chunks\n", file_name_in);
+      failed = TRUE;
+    }
+
+    // encoded points are chunked like the input
+
+    U32 chunk_size = lasreader->header.laszip->chunk_size;
+    if ((chunk_size == 0) || (chunk_size == U32_MAX)) chunk_size = LASZIP_CHUNK_SIZE_DEFAULT;
+    U32 pending = 0;
+
+    U8* bytes = 0;
+    U32 allocated_bytes = 0;
+    U32 c, j, num_bytes, num_points, verified;
+    I64 start, first_point;
+    for (c = 0; (c < number_chunks) && !failed; c++)
+    {
+      if (chunk_marks[c] == LAS_CHUNK_CLIP_SKIP) continue;
+      lasreader->get_chunk(c, &start, &num_bytes, &first_point, &num_points);
+      if (num_points == 0) continue;
+
+      verified = 0;
+      if (chunk_marks[c] == LAS_CHUNK_CLIP_COPY)
+      {
+        if (!lasscanner->seek(first_point))
+        {
+          fprintf(stderr,"ERROR: cannot seek to point %lld of '%s'\n", first_point, file_name_in);
+          failed = TRUE;
+          break;
+        }
+        while ((verified < num_points) && lasscanner->read_point() && lasscanner->point.inside_rectangle(min_x, min_y, max_x, max_y))
+        {
+          laswriter->update_inventory(&lasscanner->point);
+          verified++;
+        }
+        if (verified == num_points)
+        {
+          if (num_bytes > allocated_bytes)
+          {
+            allocated_bytes = num_bytes;
+            bytes = (U8*)realloc(bytes, allocated_bytes);
+          }
+#if defined _WIN32 && ! defined (__MINGW32__)
+          _fseeki64(file, start, SEEK_SET);
+#elif defined (__MINGW32__)
+          fseeko64(file, (off64_t)start, SEEK_SET);
+#else
+          fseeko(file, (off_t)start, SEEK_SET);
+#endif
+          if ((fread(bytes, 1, num_bytes, file) != num_bytes) || !laswriter->write_chunk(bytes, num_bytes, num_points))
+          {
+            fprintf(stderr,"ERROR: cannot copy chunk %u of '%s'\n", c, file_name_in);
+            failed = TRUE;
+            break;
+          }
+          copied_chunks++;
+          copied_points += num_points;
+          number += num_points;
+          pending = 0;
+          continue;
+        }
+      }
+
+      // the points verified above are all inside and already in the inventory
+
+      if (!lasreader->seek(first_point))
+      {
+        fprintf(stderr,"ERROR: cannot seek to point %lld of '%s'\n", first_point, file_name_in);
+        failed = TRUE;
+        break;
+      }
+      for (j = 0; j < num_points; j++)
+      {
+        if (!lasreader->read_point())
+        {
+          fprintf(stderr,"ERROR: cannot read point %lld of '%s'\n", first_point + j, file_name_in);
+          failed = TRUE;
+          break;
+        }
+        if (lasreader->point.inside_rectangle(min_x, min_y, max_x, max_y))
+        {
+          laswriter->write_point(&lasreader->point);
+          if (j >= verified) laswriter->update_inventory(&lasreader->point);
+          encoded_points++;
+          number++;
+          pending++;
+          if (pending == chunk_size)
+          {
+            laswriter->chunk();
+            pending = 0;
+          }
+        }
+      }
+      encoded_chunks++;
+    }
+
+    if (bytes) free(bytes);
+    if (file) fclose(file);
+    lasscanner->close();
+    delete lasscanner;
+    if (index) delete index;
+  }
+
+  laswriter->update_header(&lasreader->header, TRUE);
+  laswriter->close();
+  delete laswriter;
+  lasreader->close();
+  delete lasreader;
+
+  if (failed)
+  {
+    remove(file_name_out);
+    return -1;
+  }
+  return number;
+}
+
+LASchunkClip::LASchunkClip()
+{
+  number_chunks = 0;
+  chunk_marks = 0;
+  copied_chunks = 0;
+  copied_points = 0;
+  encoded_chunks = 0;
+  encoded_points = 0;
+}
+
+LASchunkClip::~LASchunkClip()
+{
+  if (chunk_marks) free(chunk_marks);
+}
@@ -0,0 +1,77 @@
+/*
+===============================================================================
+
+  FILE:  laschunkclip.hpp
+
+  CONTENTS:
+
+    Clips a LAZ file to a rectangle (like '-keep_xy') without re-encoding the
+    chunks that lie completely inside of it. Which chunks these are follows
+    from the spatial index (*.lax) of the input. The compressed bytes of such
+    a chunk are copied verbatim into the output and only the chunks crossing
+    the border of the rectangle are decoded and their surviving points encoded
+    again. The output uses variable chunking to mix both kinds of chunks.
+
+    The points of a copied chunk are still scanned once to keep the bounding
+    box and the return counts of the header exact and to confirm that all of
+    them are inside. For the new LAS 1.4 point types only the layers with the
+    coordinates and the returns are decompressed for that. A chunk that turns
+    out to have a point outside is clipped the ordinary way.
+
+    Without a spatial index, with a LAS output, or when the items of the input
+    differ from the ones the writer would use, all points are decoded and the
+    surviving ones encoded, which gives the same points as '-keep_xy'.
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the LICENSE.txt file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created to make large clips of tiles for the Java side cheap
+
+===============================================================================
+*/
+#ifndef LAS_CHUNK_CLIP_HPP
+#define LAS_CHUNK_CLIP_HPP
+
+#include "lasdefinitions.hpp"
+
+class LASreaderLAS;
+class LASwriterLAS;
+class LASindex;
+
+class LASLIB_DLL LASchunkClip
+{
+public:
+  // writes the points of the input inside the rectangle to the output (as LAZ if the
+  // file name ends in 'z'). returns the number of points written or -1 on failure, in
+  // which case the partial output is removed.
+  I64 clip(const CHAR* file_name_in, const CHAR* file_name_out, const F64 min_x, const F64 min_y, const F64 max_x, const F64 max_y);
+
+  // how the last clip went
+  inline U32 get_copied_chunks() const { return copied_chunks; };
+  inline I64 get_copied_points() const { return copied_points; };
+  inline U32 get_encoded_chunks() const { return encoded_chunks; };
+  inline I64 get_encoded_points() const { return encoded_points; };
+
+  LASchunkClip();
+  ~LASchunkClip();
+
+private:
+  BOOL can_copy_chunks(const LASreaderLAS* lasreader, const BOOL compress) const;
+  BOOL mark_chunks(LASreaderLAS* lasreader, LASindex* index, const F64 min_x, const F64 min_y, const F64 max_x, const F64 max_y);
+  U32 number_chunks;
+  U8* chunk_marks;
+  U32 copied_chunks;
+  I64 copied_points;
+  U32 encoded_chunks;
+  I64 encoded_points;
+};
+
+#endif
@@ -0,0 +1,414 @@
+/*
+===============================================================================
+
+  FILE:  laschunkstats.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the LICENSE.txt file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "laschunkstats.hpp"
+
+#include "bytestreamin_file.hpp"
+#include "bytestreamout_file.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+BOOL LASchunkStat::outside_circle(const F64 center_x, const F64 center_y, const F64 squared_radius) const
+{
+  // the distance to the closest point of the bounding box is never larger than that to any point
+
+  F64 dx = (center_x < min_x ? min_x - center_x : (center_x > max_x ? center_x - max_x : 0.0));
+  F64 dy = (center_y < min_y ? min_y - center_y : (center_y > max_y ? center_y - max_y : 0.0));
+  return ((dx*dx+dy*dy) >= squared_radius);
+}
+
+void LASchunkStats::init(const LASquantizer* quantizer, const U32 chunk_size)
+{
+  clean();
+  this->quantizer = *quantizer;
+  this->chunk_size = (chunk_size ? chunk_size : U32_MAX);
+  start_chunk();
+}
+
+void LASchunkStats::start_chunk()
+{
+  memset(&current, 0, sizeof(LASchunkStat));
+  current.flags = LAS_CHUNK_STAT_KNOWN;
+  current.min_gps_time = F64_MAX;
+  current.max_gps_time = F64_MIN;
+  current.min_intensity = U16_MAX;
+  current.min_point_source_ID = U16_MAX;
+  current.min_user_data = U8_MAX;
+  min_X = min_Y = min_Z = I32_MAX;
+  max_X = max_Y = max_Z = I32_MIN;
+}
+
+void LASchunkStats::chunk()
+{
+  if (current.number == 0) return;
+  current.min_x = quantizer.get_x(min_X);
+  current.max_x = quantizer.get_x(max_X);
+  if (current.min_x > current.max_x) { F64 swap = current.min_x; current.min_x = current.max_x; current.max_x = swap; }
+  current.min_y = quantizer.get_y(min_Y);
+  current.max_y = quantizer.get_y(max_Y);
+  if (current.min_y > current.max_y) { F64 swap = current.min_y; current.min_y = current.max_y; current.max_y = swap; }
+  current.min_z = quantizer.get_z(min_Z);
+  current.max_z = quantizer.get_z(max_Z);
+  if (current.min_z > current.max_z) { F64 swap = current.min_z; current.min_z = current.max_z; current.max_z = swap; }
+  if (current.min_gps_time <= current.max_gps_time) current.flags |= LAS_CHUNK_STAT_GPS_TIME;
+  else current.min_gps_time = current.max_gps_time = 0.0;
+  U32 i;
+  for (i = 0; i < 8; i++) if (current.extended_classification_mask[i]) break;
+  if (i == 8)
+  {
+    // only old point types. there is nothing to say about the extended classification
+    memset(current.extended_classification_mask, 0xFF, sizeof(current.extended_classification_mask));
+  }
+  add_chunk(&current);
+  start_chunk();
+}
+
+void LASchunkStats::add_unknown(const U32 number)
+{
+  chunk();
+  if (number == 0) return;
+  LASchunkStat unknown;
+  memset(&unknown, 0, sizeof(LASchunkStat));
+  unknown.number = number;
+  add_chunk(&unknown);
+}
+
+void LASchunkStats::done()
+{
+  chunk();
+}
+
+void LASchunkStats::add_chunk(const LASchunkStat* chunk)
+{
+  if (number_chunks == allocated_chunks)
+  {
+    allocated_chunks = (allocated_chunks ? 2*allocated_chunks : 256);
+    chunks = (LASchunkStat*)realloc(chunks, sizeof(LASchunkStat)*allocated_chunks);
+    firsts = (I64*)realloc(firsts, sizeof(I64)*(allocated_chunks+1));
+    if (number_chunks == 0) firsts[0] = 0;
+  }
+  chunks[number_chunks] = *chunk;
+  firsts[number_chunks+1] = firsts[number_chunks] + chunk->number;
+  number_chunks++;
+}
+
+U32 LASchunkStats::get_chunk_index(const I64 p_index) const
+{
+  if ((number_chunks == 0) || (p_index >= firsts[number_chunks])) return number_chunks;
+  U32 lo = 0;
+  U32 hi = number_chunks - 1;
+  while (lo < hi)
+  {
+    U32 mid = (lo + hi + 1) / 2;
+    if (firsts[mid] <= p_index) lo = mid;
+    else hi = mid - 1;
+  }
+  return lo;
+}
+
+BOOL LASchunkStats::read(ByteStreamIn* stream)
+{
+  clean();
+  CHAR signature[4];
+  U32 version, number, c, i;
+  LASchunkStat chunk;
+  try
+  {
+    stream->getBytes((U8*)signature, 4);
+    if (strncmp(signature, "LASC", 4) != 0)
+    {
+      fprintf(stderr,"ERROR (LASchunkStats): wrong signature %.4s instead of 'LASC'\n", signature);
+      return FALSE;
+    }
+    stream->get32bitsLE((U8*)&version);
+    if (version != 1)
+    {
+      fprintf(stderr,"ERROR (LASchunkStats): unknown version %u\n", version);
+      return FALSE;
+    }
+    stream->get64bitsLE((U8*)&file_size);
+    stream->get64bitsLE((U8*)&quantizer.x_scale_factor);
+    stream->get64bitsLE((U8*)&quantizer.y_scale_factor);
+    stream->get64bitsLE((U8*)&quantizer.z_scale_factor);
+    stream->get64bitsLE((U8*)&quantizer.x_offset);
+    stream->get64bitsLE((U8*)&quantizer.y_offset);
+    stream->get64bitsLE((U8*)&quantizer.z_offset);
+    stream->get32bitsLE((U8*)&number);
+    for (c = 0; c < number; c++)
+    {
+      stream->get32bitsLE((U8*)&chunk.number);
+      stream->get32bitsLE((U8*)&chunk.flags);
+      stream->get64bitsLE((U8*)&chunk.min_x);
+      stream->get64bitsLE((U8*)&chunk.min_y);
+      stream->get64bitsLE((U8*)&chunk.min_z);
+      stream->get64bitsLE((U8*)&chunk.max_x);
+      stream->get64bitsLE((U8*)&chunk.max_y);
+      stream->get64bitsLE((U8*)&chunk.max_z);
+      stream->get64bitsLE((U8*)&chunk.min_gps_time);
+      stream->get64bitsLE((U8*)&chunk.max_gps_time);
+      stream->get16bitsLE((U8*)&chunk.min_intensity);
+      stream->get16bitsLE((U8*)&chunk.max_intensity);
+      stream->get16bitsLE((U8*)&chunk.min_point_source_ID);
+      stream->get16bitsLE((U8*)&chunk.max_point_source_ID);
+      chunk.min_user_data = stream->getByte();
+      chunk.max_user_data = stream->getByte();
+      stream->get32bitsLE((U8*)&chunk.classification_mask);
+      for (i = 0; i < 8; i++) stream->get32bitsLE((U8*)&chunk.extended_classification_mask[i]);
+      add_chunk(&chunk);
+    }
+  }
+  catch (...)
+  {
+    fprintf(stderr,"ERROR (LASchunkStats): reading chunk %u\n", number_chunks);
+    clean();
+    return FALSE;
+  }
+  return TRUE;
+}
+
+BOOL LASchunkStats::write(ByteStreamOut* stream) const
+{
+  if (!stream->putBytes((const U8*)"LASC", 4))
+  {
+    fprintf(stderr,"ERROR (LASchunkStats): writing signature\n");
+    return FALSE;
+  }
+  U32 version = 1;
+  if (!stream->put32bitsLE((const U8*)&version))
+  {
+    fprintf(stderr,"ERROR (LASchunkStats): writing version\n");
+    return FALSE;
+  }
+  BOOL ok = stream->put64bitsLE((const U8*)&file_size);
+  ok = ok && stream->put64bitsLE((const U8*)&quantizer.x_scale_factor);
+  ok = ok && stream->put64bitsLE((const U8*)&quantizer.y_scale_factor);
+  ok = ok && stream->put64bitsLE((const U8*)&quantizer.z_scale_factor);
+  ok = ok && stream->put64bitsLE((const U8*)&quantizer.x_offset);
+  ok = ok && stream->put64bitsLE((const U8*)&quantizer.y_offset);
+  ok = ok && stream->put64bitsLE((const U8*)&quantizer.z_offset);
+  if (!ok)
+  {
+    fprintf(stderr,"ERROR (LASchunkStats): writing file size, scale factors, and offsets\n");
+    return FALSE;
+  }
+  if (!stream->put32bitsLE((const U8*)&number_chunks))
+  {
+    fprintf(stderr,"ERROR (LASchunkStats): writing number of chunks\n");
+    return FALSE;
+  }
+  U32 c, i;
+  for (c = 0; c < number_chunks; c++)
+  {
+    const LASchunkStat* chunk = &chunks[c];
+    ok = stream->put32bitsLE((const U8*)&chunk->number);
+    ok = ok && stream->put32bitsLE((const U8*)&chunk->flags);
+    ok = ok && stream->put64bitsLE((const U8*)&chunk->min_x);
+    ok = ok && stream->put64bitsLE((const U8*)&chunk->min_y);
+    ok = ok && stream->put64bitsLE((const U8*)&chunk->min_z);
+    ok = ok && stream->put64bitsLE((const U8*)&chunk->max_x);
+    ok = ok && stream->put64bitsLE((const U8*)&chunk->max_y);
+    ok = ok && stream->put64bitsLE((const U8*)&chunk->max_z);
+    ok = ok && stream->put64bitsLE((const U8*)&chunk->min_gps_time);
+    ok = ok && stream->put64bitsLE((const U8*)&chunk->max_gps_time);
+    ok = ok && stream->put16bitsLE((const U8*)&chunk->min_intensity);
+    ok = ok && stream->put16bitsLE((const U8*)&chunk->max_intensity);
+    ok = ok && stream->put16bitsLE((const U8*)&chunk->min_point_source_ID);
+    ok = ok && stream->put16bitsLE((const U8*)&chunk->max_point_source_ID);
+    ok = ok && stream->putByte(chunk->min_user_data);
+    ok = ok && stream->putByte(chunk->max_user_data);
+    ok = ok && stream->put32bitsLE((const U8*)&chunk->classification_mask);
+    for (i = 0; i < 8; i++) ok = ok && stream->put32bitsLE((const U8*)&chunk->extended_classification_mask[i]);
+    if (!ok)
+    {
+      fprintf(stderr,"ERROR (LASchunkStats): writing chunk %u\n", c);
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+CHAR* LASchunkStats::get_sidecar_name(const CHAR* file_name)
+{
+  CHAR* name = LASCopyString(file_name);
+  I32 len = (I32)strlen(name);
+  if (len < 3) return name;
+  BOOL upper = (strstr(file_name, ".LAS") || strstr(file_name, ".LAZ"));
+  name[len-3] = (upper ? 'L' : 'l');
+  name[len-2] = (upper ? 'C' : 'c');
+  name[len-1] = (upper ? 'S' : 's');
+  return name;
+}
+
+BOOL LASchunkStats::read(const CHAR* file_name)
+{
+  if (file_name == 0) return FALSE;
+  CHAR* name = get_sidecar_name(file_name);
+  FILE* file = fopen(name, "rb");
+  if (file == 0)
+  {
+    free(name);
+    return FALSE;
+  }
+  ByteStreamIn* stream;
+  if (IS_LITTLE_ENDIAN())
+    stream = new ByteStreamInFileLE(file);
+  else
+    stream = new ByteStreamInFileBE(file);
+  BOOL success = read(stream);
+  if (!success)
+  {
+    fprintf(stderr,"ERROR (LASchunkStats): cannot read '%s'\n", name);
+  }
+  delete stream;
+  fclose(file);
+  if (success)
+  {
+    // the file must still have the size it had when the statistics were written
+    I64 size = -1;
+    file = fopen(file_name, "rb");
+    if (file)
+    {
+#if defined _WIN32 && ! defined (__MINGW32__)
+      if (_fseeki64(file, 0, SEEK_END) == 0) size = _ftelli64(file);
+#elif defined (__MINGW32__)
+      if (fseeko64(file, 0, SEEK_END) == 0) size = (I64)ftello64(file);
+#else
+      if (fseeko(file, 0, SEEK_END) == 0) size = (I64)ftello(file);
+#endif
+      fclose(file);
+    }
+    if (size != file_size)
+    {
+#ifdef _WIN32
+      fprintf(stderr,"WARNING: ignoring '%s' written for %I64d bytes because '%s' has %I64d bytes\n", name, file_size, file_name, size);
+#else
+      fprintf(stderr,"WARNING: ignoring '%s' written for %lld bytes because '%s' has %lld bytes\n", name, file_size, file_name, size);
+#endif
+      clean();
+      success = FALSE;
+    }
+  }
+  free(name);
+  return success;
+}
+
+void LASchunkStats::remove(const CHAR* file_name)
+{
+  if (file_name == 0) return;
+  CHAR* name = get_sidecar_name(file_name);
+  ::remove(name);
+  free(name);
+}
+
+BOOL LASchunkStats::matches(const LASheader* header) const
+{
+  if (get_number_of_points() != (header->extended_number_of_point_records ? (I64)header->extended_number_of_point_records : (I64)header->number_of_point_records))
+  {
+    return FALSE;
+  }
+  if ((quantizer.x_scale_factor != header->x_scale_factor) || (quantizer.y_scale_factor != header->y_scale_factor) || (quantizer.z_scale_factor != header->z_scale_factor))
+  {
+    return FALSE;
+  }
+  if ((quantizer.x_offset != header->x_offset) || (quantizer.y_offset != header->y_offset) || (quantizer.z_offset != header->z_offset))
+  {
+    return FALSE;
+  }
+  // with half a unit of slack for the rounding of the bounding box in the header
+  F64 slack_x = 0.5*header->x_scale_factor;
+  F64 slack_y = 0.5*header->y_scale_factor;
+  F64 slack_z = 0.5*header->z_scale_factor;
+  U32 c;
+  for (c = 0; c < number_chunks; c++)
+  {
+    const LASchunkStat* chunk = &chunks[c];
+    if (!(chunk->flags & LAS_CHUNK_STAT_KNOWN)) continue;
+    if ((chunk->min_x < header->min_x - slack_x) || (chunk->max_x > header->max_x + slack_x)) return FALSE;
+    if ((chunk->min_y < header->min_y - slack_y) || (chunk->max_y > header->max_y + slack_y)) return FALSE;
+    if ((chunk->min_z < header->min_z - slack_z) || (chunk->max_z > header->max_z + slack_z)) return FALSE;
+  }
+  return TRUE;
+}
+
+BOOL LASchunkStats::write(const CHAR* file_name) const
+{
+  if (file_name == 0) return FALSE;
+  CHAR* name = get_sidecar_name(file_name);
+  FILE* file = fopen(name, "wb");
+  if (file == 0)
+  {
+    fprintf(stderr,"ERROR (LASchunkStats): cannot open '%s' for write\n", name);
+    free(name);
+    return FALSE;
+  }
+  ByteStreamOut* stream;
+  if (IS_LITTLE_ENDIAN())
+    stream = new ByteStreamOutFileLE(file);
+  else
+    stream = new ByteStreamOutFileBE(file);
+  BOOL success = write(stream);
+  if (!success)
+  {
+    fprintf(stderr,"ERROR (LASchunkStats): cannot write '%s'\n", name);
+  }
+  delete stream;
+  fclose(file);
+  free(name);
+  return success;
+}
+
+void LASchunkStats::clean()
+{
+  if (chunks)
+  {
+    free(chunks);
+    chunks = 0;
+  }
+  if (firsts)
+  {
+    free(firsts);
+    firsts = 0;
+  }
+  number_chunks = 0;
+  allocated_chunks = 0;
+  start_chunk();
+}
+
+LASchunkStats::LASchunkStats()
+{
+  chunk_size = U32_MAX;
+  file_size = 0;
+  number_chunks = 0;
+  allocated_chunks = 0;
+  chunks = 0;
+  firsts = 0;
+  start_chunk();
+}
+
+LASchunkStats::~LASchunkStats()
+{
+  clean();
+}
@@ -0,0 +1,157 @@
+/*
+===============================================================================
+
+  FILE:  laschunkstats.hpp
+
+  CONTENTS:
+
+    Per-chunk statistics of the points of a LAS/LAZ file: the bounding box,
+    the range of intensity, user data, point source ID, and GPS time, and
+    which classifications occur. They are collected by LASwriterLAS while
+    the points are written and stored next to the file as a *.lcs sidecar
+    (like the *.lax of the spatial index). When reading with a filter the
+    LASreader asks the LASfilter whether all points of the next chunk would
+    be filtered and seeks past those chunks without decompressing them.
+
+    A chunk holds the points from one chunk() to the next, which for LAZ are
+    the chunks of the compressor. For LAS files the chunks are blocks of the
+    same size. Chunks that were copied verbatim with write_chunk() have no
+    statistics and are always read.
+
+    The sidecar remembers the size, the scale factors, and the offsets of the
+    file it describes. A sidecar that no longer fits its file (e.g. after the
+    file was rewritten by another tool) is ignored, and LASwriterLAS removes
+    the sidecar of a file it overwrites without chunk statistics.
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the LICENSE.txt file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created to skip chunks of building classes in city tiles
+
+===============================================================================
+*/
+#ifndef LAS_CHUNK_STATS_HPP
+#define LAS_CHUNK_STATS_HPP
+
+#include "lasdefinitions.hpp"
+
+class ByteStreamIn;
+class ByteStreamOut;
+
+#define LAS_CHUNK_STAT_KNOWN     0x01
+#define LAS_CHUNK_STAT_GPS_TIME  0x02
+
+class LASLIB_DLL LASchunkStat
+{
+public:
+  U32 number;
+  U32 flags;
+  F64 min_x, min_y, min_z;
+  F64 max_x, max_y, max_z;
+  F64 min_gps_time, max_gps_time;
+  U16 min_intensity, max_intensity;
+  U16 min_point_source_ID, max_point_source_ID;
+  U8 min_user_data, max_user_data;
+  U32 classification_mask;             // of the 5 bit classification
+  U32 extended_classification_mask[8]; // all set for the old point types
+
+  inline BOOL has_only_classification(const U32 classification_mask) const { return ((this->classification_mask & ~classification_mask) == 0); };
+  inline BOOL has_gps_time() const { return ((flags & LAS_CHUNK_STAT_GPS_TIME) != 0); };
+
+  // no point is inside (all are outside) the rectangle, with the same borders as LASpoint
+  inline BOOL outside_rectangle(const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y) const { return ((max_x < r_min_x) || (min_x >= r_max_x) || (max_y < r_min_y) || (min_y >= r_max_y)); };
+  inline BOOL inside_rectangle(const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y) const { return ((min_x >= r_min_x) && (max_x < r_max_x) && (min_y >= r_min_y) && (max_y < r_max_y)); };
+  BOOL outside_circle(const F64 center_x, const F64 center_y, const F64 squared_radius) const;
+};
+
+class LASLIB_DLL LASchunkStats
+{
+public:
+  // collecting. with a chunk_size of 0 only chunk() ends a chunk.
+  void init(const LASquantizer* quantizer, const U32 chunk_size);
+  inline void add(const LASpoint* point)
+  {
+    if (current.number == chunk_size) chunk();
+    current.number++;
+    if (point->get_X() < min_X) min_X = point->get_X();
+    if (point->get_X() > max_X) max_X = point->get_X();
+    if (point->get_Y() < min_Y) min_Y = point->get_Y();
+    if (point->get_Y() > max_Y) max_Y = point->get_Y();
+    if (point->get_Z() < min_Z) min_Z = point->get_Z();
+    if (point->get_Z() > max_Z) max_Z = point->get_Z();
+    if (point->get_intensity() < current.min_intensity) current.min_intensity = point->get_intensity();
+    if (point->get_intensity() > current.max_intensity) current.max_intensity = point->get_intensity();
+    if (point->get_point_source_ID() < current.min_point_source_ID) current.min_point_source_ID = point->get_point_source_ID();
+    if (point->get_point_source_ID() > current.max_point_source_ID) current.max_point_source_ID = point->get_point_source_ID();
+    if (point->user_data < current.min_user_data) current.min_user_data = point->user_data;
+    if (point->user_data > current.max_user_data) current.max_user_data = point->user_data;
+    if (point->have_gps_time)
+    {
+      if (point->gps_time < current.min_gps_time) current.min_gps_time = point->gps_time;
+      if (point->gps_time > current.max_gps_time) current.max_gps_time = point->gps_time;
+    }
+    if (point->extended_point_type)
+    {
+      // the classification a reader sets for the new point types
+      if (point->extended_classification < 32) current.classification_mask |= (1u << point->extended_classification);
+      else current.classification_mask |= 1u;
+      current.extended_classification_mask[point->extended_classification >> 5] |= (1u << (point->extended_classification & 31));
+    }
+    else
+    {
+      current.classification_mask |= (1u << point->classification);
+    }
+  };
+  void chunk();
+  void add_unknown(const U32 number);
+  void done();
+  inline void set_file_size(const I64 file_size) { this->file_size = file_size; };
+
+  inline U32 get_number_chunks() const { return number_chunks; };
+  inline const LASchunkStat* get_chunk(const U32 c) const { return &chunks[c]; };
+  inline I64 get_first(const U32 c) const { return firsts[c]; };
+  inline I64 get_number_of_points() const { return (firsts ? firsts[number_chunks] : 0); };
+
+  // the chunk of the point or the number of chunks when it is past the last one
+  U32 get_chunk_index(const I64 p_index) const;
+
+  BOOL read(ByteStreamIn* stream);
+  BOOL write(ByteStreamOut* stream) const;
+
+  // the *.lcs next to the LAS/LAZ file. read() fails if the size of the file changed.
+  BOOL read(const CHAR* file_name);
+  BOOL write(const CHAR* file_name) const;
+  static void remove(const CHAR* file_name);
+
+  // the point count and the quantizer agree with the header and all chunks are inside its bounding box
+  BOOL matches(const LASheader* header) const;
+
+  void clean();
+
+  LASchunkStats();
+  ~LASchunkStats();
+
+private:
+  void start_chunk();
+  void add_chunk(const LASchunkStat* chunk);
+  static CHAR* get_sidecar_name(const CHAR* file_name);
+  LASquantizer quantizer;
+  I64 file_size;
+  U32 chunk_size;
+  LASchunkStat current;
+  I32 min_X, min_Y, min_Z, max_X, max_Y, max_Z;
+  U32 number_chunks;
+  U32 allocated_chunks;
+  LASchunkStat* chunks;
+  I64* firsts;             // with one more entry at the end
+};
+
+#endif
@@ -0,0 +1,346 @@
+/*
+===============================================================================
+
+  FILE:  lascolumndecoder.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the LICENSE.txt file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "lascolumndecoder.hpp"
+
+#include "lasreader_las.hpp"
+#include "lasutility.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+#include <thread>
+#include <atomic>
+using namespace std;
+
+// ranges handed to the threads when the file has no fixed chunk size
+
+#define LAS_COLUMN_DECODER_MIN_RANGE 65536
+
+LAScolumns::LAScolumns()
+{
+  memset(this, 0, sizeof(LAScolumns));
+}
+
+U32 LAScolumns::get_decompress_selective() const
+{
+  U32 decompress_selective = LASZIP_DECOMPRESS_SELECTIVE_CHANNEL_RETURNS_XY;
+  if (Z) decompress_selective |= LASZIP_DECOMPRESS_SELECTIVE_Z;
+  if (classification) decompress_selective |= LASZIP_DECOMPRESS_SELECTIVE_CLASSIFICATION;
+  if (flags) decompress_selective |= LASZIP_DECOMPRESS_SELECTIVE_FLAGS;
+  if (intensity) decompress_selective |= LASZIP_DECOMPRESS_SELECTIVE_INTENSITY;
+  if (scan_angle) decompress_selective |= LASZIP_DECOMPRESS_SELECTIVE_SCAN_ANGLE;
+  if (user_data) decompress_selective |= LASZIP_DECOMPRESS_SELECTIVE_USER_DATA;
+  if (point_source_ID) decompress_selective |= LASZIP_DECOMPRESS_SELECTIVE_POINT_SOURCE;
+  if (gps_time) decompress_selective |= LASZIP_DECOMPRESS_SELECTIVE_GPS_TIME;
+  if (R || G || B) decompress_selective |= LASZIP_DECOMPRESS_SELECTIVE_RGB;
+  if (NIR) decompress_selective |= LASZIP_DECOMPRESS_SELECTIVE_NIR;
+  return decompress_selective;
+}
+
+void LAScolumns::set(const I64 index, const LASpoint* point)
+{
+  if (X) X[index] = point->get_X();
+  if (Y) Y[index] = point->get_Y();
+  if (Z) Z[index] = point->get_Z();
+  if (intensity) intensity[index] = point->get_intensity();
+  if (point->extended_point_type)
+  {
+    if (return_number) return_number[index] = point->get_extended_return_number();
+    if (number_of_returns) number_of_returns[index] = point->get_extended_number_of_returns();
+    if (classification) classification[index] = point->get_extended_classification();
+    if (flags) flags[index] = (U8)(point->extended_classification_flags | (point->get_extended_scanner_channel() << 4) | (point->get_scan_direction_flag() << 6) | (point->get_edge_of_flight_line() << 7));
+    if (scan_angle) scan_angle[index] = point->get_extended_scan_angle();
+  }
+  else
+  {
+    if (return_number) return_number[index] = point->get_return_number();
+    if (number_of_returns) number_of_returns[index] = point->get_number_of_returns();
+    if (classification) classification[index] = point->get_classification();
+    if (flags) flags[index] = (U8)(point->get_synthetic_flag() | (point->get_keypoint_flag() << 1) | (point->get_withheld_flag() << 2) | (point->get_scan_direction_flag() << 6) | (point->get_edge_of_flight_line() << 7));
+    if (scan_angle) scan_angle[index] = point->get_scan_angle_rank();
+  }
+  if (user_data) user_data[index] = point->get_user_data();
+  if (point_source_ID) point_source_ID[index] = point->get_point_source_ID();
+  if (gps_time) gps_time[index] = point->get_gps_time();
+  if (R) R[index] = point->get_R();
+  if (G) G[index] = point->get_G();
+  if (B) B[index] = point->get_B();
+  if (NIR) NIR[index] = point->get_NIR();
+}
+
+void LAScolumns::get(const I64 index, LASpoint* point, const BOOL extended) const
+{
+  if (X) point->set_X(X[index]);
+  if (Y) point->set_Y(Y[index]);
+  if (Z) point->set_Z(Z[index]);
+  if (intensity) point->set_intensity(intensity[index]);
+  if (point->extended_point_type)
+  {
+    if (return_number) point->set_extended_return_number(return_number[index]);
+    if (number_of_returns) point->set_extended_number_of_returns(number_of_returns[index]);
+    if (classification) point->set_extended_classification(classification[index]);
+    if (flags)
+    {
+      point->extended_classification_flags = (flags[index] & 0x0F);
+      point->set_synthetic_flag(flags[index] & 0x01);
+      point->set_keypoint_flag((flags[index] >> 1) & 0x01);
+      point->set_withheld_flag((flags[index] >> 2) & 0x01);
+      point->set_extended_scanner_channel((flags[index] >> 4) & 0x03);
+      point->set_scan_direction_flag((flags[index] >> 6) & 0x01);
+      point->set_edge_of_flight_line(flags[index] >> 7);
+    }
+    if (scan_angle) point->set_extended_scan_angle(extended ? scan_angle[index] : I16_QUANTIZE(scan_angle[index]/0.006f));
+  }
+  else
+  {
+    if (return_number) point->set_return_number(return_number[index]);
+    if (number_of_returns) point->set_number_of_returns(number_of_returns[index]);
+    if (classification) point->set_classification(classification[index]);
+    if (flags)
+    {
+      point->set_synthetic_flag(flags[index] & 0x01);
+      point->set_keypoint_flag((flags[index] >> 1) & 0x01);
+      point->set_withheld_flag((flags[index] >> 2) & 0x01);
+      point->set_scan_direction_flag((flags[index] >> 6) & 0x01);
+      point->set_edge_of_flight_line(flags[index] >> 7);
+    }
+    if (scan_angle) point->set_scan_angle_rank(extended ? I8_QUANTIZE(0.006f*scan_angle[index]) : (I8)scan_angle[index]);
+  }
+  if (user_data) point->set_user_data(user_data[index]);
+  if (point_source_ID) point->set_point_source_ID(point_source_ID[index]);
+  if (gps_time) point->set_gps_time(gps_time[index]);
+  if (R) point->set_R(R[index]);
+  if (G) point->set_G(G[index]);
+  if (B) point->set_B(B[index]);
+  if (NIR) point->set_NIR(NIR[index]);
+}
+
+BOOL LAScolumnDecoder::open(const CHAR* file_name, U32 threads)
+{
+  if (file_name == 0)
+  {
+    fprintf(stderr,"ERROR: file name pointer is zero\n");
+    return FALSE;
+  }
+
+  close();
+
+  lasreaderlas = new LASreaderLAS();
+  if (!lasreaderlas->open(file_name))
+  {
+    fprintf(stderr,"ERROR: cannot open '%s' for column decoding\n", file_name);
+    delete lasreaderlas;
+    lasreaderlas = 0;
+    return FALSE;
+  }
+
+  this->file_name = LASCopyString(file_name);
+  npoints = lasreaderlas->npoints;
+
+  // the ranges handed to the threads start at chunk boundaries so no point is decoded twice
+
+  if (lasreaderlas->header.laszip && (lasreaderlas->header.laszip->compressor != LASZIP_COMPRESSOR_NONE) && (lasreaderlas->header.laszip->chunk_size != U32_MAX))
+  {
+    chunk_size = lasreaderlas->header.laszip->chunk_size;
+  }
+  else
+  {
+    chunk_size = 0;
+  }
+
+  if (threads == 0) threads = thread::hardware_concurrency();
+  if (threads == 0) threads = 1;
+  this->threads = threads;
+
+  return TRUE;
+}
+
+const LASheader* LAScolumnDecoder::get_header() const
+{
+  return (lasreaderlas ? &lasreaderlas->header : 0);
+}
+
+I64 LAScolumnDecoder::decode(LAScolumns* columns, const I64 start, I64 count, LASinventory* inventory, LASsummary* summary, LAShistogram* histogram)
+{
+  if (lasreaderlas == 0)
+  {
+    fprintf(stderr,"ERROR: no file opened for column decoding\n");
+    return -1;
+  }
+  if ((start < 0) || (start > npoints))
+  {
+    fprintf(stderr,"ERROR: start %lld is outside of the %lld points\n", start, npoints);
+    return -1;
+  }
+  if ((count < 0) || (count > (npoints - start)))
+  {
+    count = npoints - start;
+  }
+  if (count == 0)
+  {
+    return 0;
+  }
+
+  // split into ranges. several per thread so that threads finishing early pick up more work
+
+  I64 range = count / (4 * threads);
+  if (chunk_size)
+  {
+    range = (range / chunk_size) * chunk_size;
+    if (range < chunk_size) range = chunk_size;
+  }
+  else if (range < LAS_COLUMN_DECODER_MIN_RANGE)
+  {
+    range = LAS_COLUMN_DECODER_MIN_RANGE;
+  }
+
+  const I64 end = start + count;
+  const I64 base = (start / range) * range;
+  const I64 number_ranges = (end - base + range - 1) / range;
+
+  U32 number_threads = threads;
+  if (number_threads > number_ranges) number_threads = (U32)number_ranges;
+
+  U32 decompress_selective = columns->get_decompress_selective();
+  if (inventory) decompress_selective |= LASZIP_DECOMPRESS_SELECTIVE_Z;
+  if (summary || histogram) decompress_selective = LASZIP_DECOMPRESS_SELECTIVE_ALL;
+  const CHAR* name = file_name;
+
+  // every thread accumulates its statistics locally. they are merged after the join.
+
+  const BOOL columns_inventory = (columns->X && columns->Y && columns->Z && columns->return_number);
+  vector<LASinventory> inventories(inventory ? number_threads : 0);
+  vector<LASsummary*> summaries(summary ? number_threads : 0, (LASsummary*)0);
+  vector<LAShistogram*> histograms(histogram ? number_threads : 0, (LAShistogram*)0);
+  U32 i;
+  for (i = 0; i < summaries.size(); i++) summaries[i] = new LASsummary();
+  for (i = 0; i < histograms.size(); i++)
+  {
+    histograms[i] = new LAShistogram();
+    histograms[i]->init(histogram);
+  }
+
+  atomic<I64> next(0);
+  atomic<BOOL> failed(FALSE);
+
+  auto worker = [&](U32 w)
+  {
+    LASreaderLAS reader;
+    if (!reader.open(name, LAS_TOOLS_IO_IBUFFER_SIZE, FALSE, decompress_selective))
+    {
+      fprintf(stderr,"ERROR: cannot re-open '%s' for column decoding\n", name);
+      failed = TRUE;
+      return;
+    }
+    I64 r, p, from, to, current = -1;
+    while (!failed && ((r = next++) < number_ranges))
+    {
+      from = base + r * range;
+      to = from + range;
+      if (from < start) from = start;
+      if (to > end) to = end;
+      if (from != current)
+      {
+        if (!reader.seek(from))
+        {
+          fprintf(stderr,"ERROR: cannot seek to point %lld of '%s'\n", from, name);
+          failed = TRUE;
+          break;
+        }
+      }
+      for (p = from; p < to; p++)
+      {
+        if (!reader.read_point())
+        {
+          fprintf(stderr,"ERROR: cannot read point %lld of '%s'\n", p, name);
+          failed = TRUE;
+          break;
+        }
+        columns->set(p - start, &reader.point);
+        if (inventory && !columns_inventory) inventories[w].add(&reader.point);
+        if (summary) summaries[w]->add(&reader.point);
+        if (histogram) histograms[w]->add(&reader.point);
+      }
+      if (inventory && columns_inventory && (p > from))
+      {
+        inventories[w].add(&columns->X[from - start], &columns->Y[from - start], &columns->Z[from - start], &columns->return_number[from - start], (U32)(p - from));
+      }
+      current = to;
+    }
+    reader.close();
+  };
+
+  vector<thread> pool;
+  for (i = 1; i < number_threads; i++) pool.push_back(thread(worker, i));
+  worker(0);
+  for (i = 0; i < pool.size(); i++) pool[i].join();
+
+  for (i = 0; i < inventories.size(); i++) inventory->merge(&inventories[i]);
+  for (i = 0; i < summaries.size(); i++)
+  {
+    summary->merge(summaries[i], lasreaderlas->point.attributer);
+    delete summaries[i];
+  }
+  for (i = 0; i < histograms.size(); i++)
+  {
+    histogram->merge(histograms[i]);
+    delete histograms[i];
+  }
+
+  return (failed ? -1 : count);
+}
+
+void LAScolumnDecoder::close()
+{
+  if (lasreaderlas)
+  {
+    lasreaderlas->close();
+    delete lasreaderlas;
+    lasreaderlas = 0;
+  }
+  if (file_name)
+  {
+    free(file_name);
+    file_name = 0;
+  }
+  npoints = 0;
+  chunk_size = 0;
+}
+
+LAScolumnDecoder::LAScolumnDecoder()
+{
+  file_name = 0;
+  threads = 1;
+  chunk_size = 0;
+  npoints = 0;
+  lasreaderlas = 0;
+}
+
+LAScolumnDecoder::~LAScolumnDecoder()
+{
+  close();
+}
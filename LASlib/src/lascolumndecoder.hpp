@@ -0,0 +1,110 @@
+/*
+===============================================================================
+
+  FILE:  lascolumndecoder.hpp
+
+  CONTENTS:
+
+    Decodes the points of one LAS/LAZ file with several threads straight into
+    column arrays (one array per attribute) instead of handing out one LASpoint
+    at a time. Each thread owns its own LASreaderLAS and decodes a different
+    range of chunks. Chunks are independent by construction so every thread
+    starts with fresh entropy coder contexts and the output is identical to a
+    sequential read.
+
+    Only the attributes whose column pointer is set are stored and for point
+    types 6 and higher (the layered LAS 1.4 compressor) only their layers are
+    decompressed. The layers within a chunk are not decoded concurrently since
+    the contexts of Z, intensity, scan angle, ... are selected with the return
+    and channel information of the XY layer of the same point.
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the LICENSE.txt file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- thread-local inventory, summary, and histogram merged after the decode
+    19 October 2026 -- created for a columnar decode of big LAS 1.4 files
+
+===============================================================================
+*/
+#ifndef LAS_COLUMN_DECODER_HPP
+#define LAS_COLUMN_DECODER_HPP
+
+#include "lasdefinitions.hpp"
+
+class LASpoint;
+class LASreaderLAS;
+class LASinventory;
+class LASsummary;
+class LAShistogram;
+
+// the destination of a decode. a NULL pointer means the attribute is not wanted.
+
+class LASLIB_DLL LAScolumns
+{
+public:
+  I32* X;
+  I32* Y;
+  I32* Z;
+  U16* intensity;
+  U8* return_number;          // the extended one for point types 6 and higher
+  U8* number_of_returns;      // the extended one for point types 6 and higher
+  U8* classification;         // the extended one for point types 6 and higher
+  U8* flags;                  // classification flags (bits 0-3), scanner channel (bits 4-5), scan direction (bit 6), edge of flight line (bit 7)
+  I16* scan_angle;            // the scan angle rank or (for point types 6 and higher) the extended scan angle in 0.006 degree
+  U8* user_data;
+  U16* point_source_ID;
+  F64* gps_time;
+  U16* R;
+  U16* G;
+  U16* B;
+  U16* NIR;
+
+  // the LASZIP_DECOMPRESS_SELECTIVE_* layers needed to fill the columns that are set
+  U32 get_decompress_selective() const;
+
+  // stores the attributes of one point at position index
+  void set(const I64 index, const LASpoint* point);
+
+  // copies the attributes at position index into the point. extended tells whether the
+  // values follow the conventions of point types 6 and higher or those of the older ones.
+  void get(const I64 index, LASpoint* point, const BOOL extended) const;
+
+  LAScolumns();
+};
+
+class LASLIB_DLL LAScolumnDecoder
+{
+public:
+  BOOL open(const CHAR* file_name, U32 threads=0);
+
+  const LASheader* get_header() const;
+  inline I64 get_number_of_points() const { return npoints; };
+
+  // decodes points [start, start + count) of the file into entries [0, count) of the
+  // columns with a negative count meaning all remaining points. returns the number of
+  // points decoded or -1 if one of the threads failed. the points are also added to the
+  // optional inventory, summary, and histogram, which each thread fills its own copy of.
+  I64 decode(LAScolumns* columns, const I64 start=0, I64 count=-1, LASinventory* inventory=0, LASsummary* summary=0, LAShistogram* histogram=0);
+
+  void close();
+
+  LAScolumnDecoder();
+  ~LAScolumnDecoder();
+
+private:
+  CHAR* file_name;
+  U32 threads;
+  U32 chunk_size;
+  I64 npoints;
+  LASreaderLAS* lasreaderlas;
+};
+
+#endif
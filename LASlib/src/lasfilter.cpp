@@ -29,6 +29,10 @@
 ===============================================================================
 */
 #include "lasfilter.hpp"
+#include "lasthingrid.hpp"
+#include "lasrandom.hpp"
+#include "laspolygon.hpp"
+#include "laschunkstats.hpp"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -48,6 +52,8 @@ public:
   inline I32 get_command(CHAR* string) const { int n = 0; n += one->get_command(&string[n]); n += two->get_command(&string[n]); n += sprintf(&string[n], "-%s ", name()); return n; };
   inline U32 get_decompress_selective() const { return (one->get_decompress_selective() | two->get_decompress_selective()); };
   inline BOOL filter(const LASpoint* point) { return one->filter(point) && two->filter(point); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return one->filter_chunk(stat) && two->filter_chunk(stat); };
+  inline BOOL is_stateless() const { return one->is_stateless() && two->is_stateless(); };
   LAScriterionAnd(LAScriterion* one, LAScriterion* two) { this->one = one; this->two = two; };
 private:
   LAScriterion* one;
@@ -61,6 +67,8 @@ public:
   inline I32 get_command(CHAR* string) const { int n = 0; n += one->get_command(&string[n]); n += two->get_command(&string[n]); n += sprintf(&string[n], "-%s ", name()); return n; };
   inline U32 get_decompress_selective() const { return (one->get_decompress_selective() | two->get_decompress_selective()); };
   inline BOOL filter(const LASpoint* point) { return one->filter(point) || two->filter(point); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return one->filter_chunk(stat) || two->filter_chunk(stat); };
+  inline BOOL is_stateless() const { return one->is_stateless() && two->is_stateless(); };
   LAScriterionOr(LAScriterion* one, LAScriterion* two) { this->one = one; this->two = two; };
 private:
   LAScriterion* one;
@@ -73,6 +81,7 @@ public:
   inline const CHAR* name() const { return "keep_tile"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %g %g %g ", name(), ll_x, ll_y, tile_size); };
   inline BOOL filter(const LASpoint* point) { return (!point->inside_tile(ll_x, ll_y, ur_x, ur_y)); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return stat->outside_rectangle(ll_x, ll_y, ur_x, ur_y); };
   LAScriterionKeepTile(F32 ll_x, F32 ll_y, F32 tile_size) { this->ll_x = ll_x; this->ll_y = ll_y; this->ur_x = ll_x+tile_size; this->ur_y = ll_y+tile_size; this->tile_size = tile_size; };
 private:
   F32 ll_x, ll_y, ur_x, ur_y, tile_size;
@@ -84,11 +93,40 @@ public:
   inline const CHAR* name() const { return "keep_circle"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf %lf %lf ", name(), center_x, center_y, radius); };
   inline BOOL filter(const LASpoint* point) { return (!point->inside_circle(center_x, center_y, radius_squared)); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return stat->outside_circle(center_x, center_y, radius_squared); };
   LAScriterionKeepCircle(F64 x, F64 y, F64 radius) { this->center_x = x; this->center_y = y; this->radius = radius; this->radius_squared = radius*radius; };
 private:
   F64 center_x, center_y, radius, radius_squared;
 };
 
+class LAScriterionKeepPolygon : public LAScriterion
+{
+public:
+  inline const CHAR* name() const { return "keep_polygon"; };
+  inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s \"%s\" ", name(), source); };
+  inline BOOL filter(const LASpoint* point) { return (!polygon->is_inside(point->get_x(), point->get_y())); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { F64 box[4]; polygon->get_bounding_box(box); return stat->outside_rectangle(box[0], box[1], box[2], box[3]); };
+  inline const LASpolygon* get_polygon() const { return polygon; };
+  LAScriterionKeepPolygon(LASpolygon* polygon, const CHAR* source) { this->polygon = polygon; this->source = LASCopyString(source); polygon->prepare(); };
+  ~LAScriterionKeepPolygon() { delete polygon; free(source); };
+private:
+  LASpolygon* polygon;
+  CHAR* source;
+};
+
+class LAScriterionDropPolygon : public LAScriterion
+{
+public:
+  inline const CHAR* name() const { return "drop_polygon"; };
+  inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s \"%s\" ", name(), source); };
+  inline BOOL filter(const LASpoint* point) { return (polygon->is_inside(point->get_x(), point->get_y())); };
+  LAScriterionDropPolygon(LASpolygon* polygon, const CHAR* source) { this->polygon = polygon; this->source = LASCopyString(source); polygon->prepare(); };
+  ~LAScriterionDropPolygon() { delete polygon; free(source); };
+private:
+  LASpolygon* polygon;
+  CHAR* source;
+};
+
 class LAScriterionKeepxyz : public LAScriterion
 {
 public:
@@ -96,6 +134,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf %lf %lf %lf %lf %lf ", name(), min_x, min_y, min_z, max_x, max_y, max_z); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_CHANNEL_RETURNS_XY | LASZIP_DECOMPRESS_SELECTIVE_Z; };
   inline BOOL filter(const LASpoint* point) { return (!point->inside_box(min_x, min_y, min_z, max_x, max_y, max_z)); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return stat->outside_rectangle(min_x, min_y, max_x, max_y) || (stat->max_z < min_z) || (stat->min_z >= max_z); };
   LAScriterionKeepxyz(F64 min_x, F64 min_y, F64 min_z, F64 max_x, F64 max_y, F64 max_z) { this->min_x = min_x; this->min_y = min_y; this->min_z = min_z; this->max_x = max_x; this->max_y = max_y; this->max_z = max_z; };
 private:
   F64 min_x, min_y, min_z, max_x, max_y, max_z;
@@ -108,6 +147,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf %lf %lf %lf %lf %lf ", name(), min_x, min_y, min_z, max_x, max_y, max_z); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_CHANNEL_RETURNS_XY | LASZIP_DECOMPRESS_SELECTIVE_Z; };
   inline BOOL filter(const LASpoint* point) { return (point->inside_box(min_x, min_y, min_z, max_x, max_y, max_z)); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return stat->inside_rectangle(min_x, min_y, max_x, max_y) && (stat->min_z >= min_z) && (stat->max_z < max_z); };
   LAScriterionDropxyz(F64 min_x, F64 min_y, F64 min_z, F64 max_x, F64 max_y, F64 max_z) { this->min_x = min_x; this->min_y = min_y; this->min_z = min_z; this->max_x = max_x; this->max_y = max_y; this->max_z = max_z; };
 private:
   F64 min_x, min_y, min_z, max_x, max_y, max_z;
@@ -119,6 +159,7 @@ public:
   inline const CHAR* name() const { return "keep_xy"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf %lf %lf %lf ", name(), below_x, below_y, above_x, above_y); };
   inline BOOL filter(const LASpoint* point) { return (!point->inside_rectangle(below_x, below_y, above_x, above_y)); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return stat->outside_rectangle(below_x, below_y, above_x, above_y); };
   LAScriterionKeepxy(F64 below_x, F64 below_y, F64 above_x, F64 above_y) { this->below_x = below_x; this->below_y = below_y; this->above_x = above_x; this->above_y = above_y; };
 private:
   F64 below_x, below_y, above_x, above_y;
@@ -130,6 +171,7 @@ public:
   inline const CHAR* name() const { return "drop_xy"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf %lf %lf %lf ", name(), below_x, below_y, above_x, above_y); };
   inline BOOL filter(const LASpoint* point) { return (point->inside_rectangle(below_x, below_y, above_x, above_y)); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return stat->inside_rectangle(below_x, below_y, above_x, above_y); };
   LAScriterionDropxy(F64 below_x, F64 below_y, F64 above_x, F64 above_y) { this->below_x = below_x; this->below_y = below_y; this->above_x = above_x; this->above_y = above_y; };
 private:
   F64 below_x, below_y, above_x, above_y;
@@ -141,6 +183,7 @@ public:
   inline const CHAR* name() const { return "keep_x"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf %lf ", name(), below_x, above_x); };
   inline BOOL filter(const LASpoint* point) { F64 x = point->get_x(); return (x < below_x) || (x >= above_x); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->max_x < below_x) || (stat->min_x >= above_x); };
   LAScriterionKeepx(F64 below_x, F64 above_x) { this->below_x = below_x; this->above_x = above_x; };
 private:
   F64 below_x, above_x;
@@ -152,6 +195,7 @@ public:
   inline const CHAR* name() const { return "drop_x"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf %lf ", name(), below_x, above_x); };
   inline BOOL filter(const LASpoint* point) { F64 x = point->get_x(); return ((below_x <= x) && (x < above_x)); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (below_x <= stat->min_x) && (stat->max_x < above_x); };
   LAScriterionDropx(F64 below_x, F64 above_x) { this->below_x = below_x; this->above_x = above_x; };
 private:
   F64 below_x, above_x;
@@ -163,6 +207,7 @@ public:
   inline const CHAR* name() const { return "keep_y"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf %lf ", name(), below_y, above_y); };
   inline BOOL filter(const LASpoint* point) { F64 y = point->get_y(); return (y < below_y) || (y >= above_y); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->max_y < below_y) || (stat->min_y >= above_y); };
   LAScriterionKeepy(F64 below_y, F64 above_y) { this->below_y = below_y; this->above_y = above_y; };
 private:
   F64 below_y, above_y;
@@ -174,6 +219,7 @@ public:
   inline const CHAR* name() const { return "drop_y"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf %lf ", name(), below_y, above_y); };
   inline BOOL filter(const LASpoint* point) { F64 y = point->get_y(); return ((below_y <= y) && (y < above_y)); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (below_y <= stat->min_y) && (stat->max_y < above_y); };
   LAScriterionDropy(F64 below_y, F64 above_y) { this->below_y = below_y; this->above_y = above_y; };
 private:
   F64 below_y, above_y;
@@ -186,6 +232,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf %lf ", name(), below_z, above_z); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_Z; };
   inline BOOL filter(const LASpoint* point) { F64 z = point->get_z(); return (z < below_z) || (z >= above_z); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->max_z < below_z) || (stat->min_z >= above_z); };
   LAScriterionKeepz(F64 below_z, F64 above_z) { this->below_z = below_z; this->above_z = above_z; };
 private:
   F64 below_z, above_z;
@@ -198,6 +245,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf %lf ", name(), below_z, above_z); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_Z; };
   inline BOOL filter(const LASpoint* point) { F64 z = point->get_z(); return ((below_z <= z) && (z < above_z)); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (below_z <= stat->min_z) && (stat->max_z < above_z); };
   LAScriterionDropz(F64 below_z, F64 above_z) { this->below_z = below_z; this->above_z = above_z; };
 private:
   F64 below_z, above_z;
@@ -209,6 +257,7 @@ public:
   inline const CHAR* name() const { return "drop_x_below"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf ", name(), below_x); };
   inline BOOL filter(const LASpoint* point) { return (point->get_x() < below_x); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->max_x < below_x); };
   LAScriterionDropxBelow(F64 below_x) { this->below_x = below_x; };
 private:
   F64 below_x;
@@ -220,6 +269,7 @@ public:
   inline const CHAR* name() const { return "drop_x_above"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf ", name(), above_x); };
   inline BOOL filter(const LASpoint* point) { return (point->get_x() >= above_x); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->min_x >= above_x); };
   LAScriterionDropxAbove(F64 above_x) { this->above_x = above_x; };
 private:
   F64 above_x;
@@ -231,6 +281,7 @@ public:
   inline const CHAR* name() const { return "drop_y_below"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf ", name(), below_y); };
   inline BOOL filter(const LASpoint* point) { return (point->get_y() < below_y); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->max_y < below_y); };
   LAScriterionDropyBelow(F64 below_y) { this->below_y = below_y; };
 private:
   F64 below_y;
@@ -242,6 +293,7 @@ public:
   inline const CHAR* name() const { return "drop_y_above"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf ", name(), above_y); };
   inline BOOL filter(const LASpoint* point) { return (point->get_y() >= above_y); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->min_y >= above_y); };
   LAScriterionDropyAbove(F64 above_y) { this->above_y = above_y; };
 private:
   F64 above_y;
@@ -254,6 +306,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf ", name(), below_z); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_Z; };
   inline BOOL filter(const LASpoint* point) { return (point->get_z() < below_z); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->max_z < below_z); };
   LAScriterionDropzBelow(F64 below_z) { this->below_z = below_z; };
 private:
   F64 below_z;
@@ -266,6 +319,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf ", name(), above_z); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_Z; };
   inline BOOL filter(const LASpoint* point) { return (point->get_z() >= above_z); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->min_z >= above_z); };
   LAScriterionDropzAbove(F64 above_z) { this->above_z = above_z; };
 private:
   F64 above_z;
@@ -593,6 +647,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s ", name()); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_FLAGS; };
   inline BOOL filter(const LASpoint* point) { if (scan_direction_flag == point->scan_direction_flag) return TRUE; I32 s = scan_direction_flag; scan_direction_flag = point->scan_direction_flag; return s == -1; };
+  inline BOOL is_stateless() const { return FALSE; };
   void reset() { scan_direction_flag = -1; };
   LAScriterionKeepScanDirectionChange() { reset(); };
 private:
@@ -758,6 +813,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d %d ", name(), below_intensity, above_intensity); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_INTENSITY; };
   inline BOOL filter(const LASpoint* point) { return (point->get_intensity() < below_intensity) || (point->get_intensity() > above_intensity); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->max_intensity < below_intensity) || (stat->min_intensity > above_intensity); };
   LAScriterionKeepIntensity(U16 below_intensity, U16 above_intensity) { this->below_intensity = below_intensity; this->above_intensity = above_intensity; };
 private:
   U16 below_intensity, above_intensity;
@@ -770,6 +826,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d ", name(), below_intensity); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_INTENSITY; };
   inline BOOL filter(const LASpoint* point) { return (point->get_intensity() >= below_intensity); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->min_intensity >= below_intensity); };
   LAScriterionKeepIntensityBelow(U16 below_intensity) { this->below_intensity = below_intensity; };
 private:
   U16 below_intensity;
@@ -782,6 +839,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d ", name(), above_intensity); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_INTENSITY; };
   inline BOOL filter(const LASpoint* point) { return (point->get_intensity() <= above_intensity); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->max_intensity <= above_intensity); };
   LAScriterionKeepIntensityAbove(U16 above_intensity) { this->above_intensity = above_intensity; };
 private:
   U16 above_intensity;
@@ -794,6 +852,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d ", name(), below_intensity); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_INTENSITY; };
   inline BOOL filter(const LASpoint* point) { return (point->get_intensity() < below_intensity); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->max_intensity < below_intensity); };
   LAScriterionDropIntensityBelow(I32 below_intensity) { this->below_intensity = below_intensity; };
 private:
   I32 below_intensity;
@@ -806,6 +865,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d ", name(), above_intensity); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_INTENSITY; };
   inline BOOL filter(const LASpoint* point) { return (point->get_intensity() > above_intensity); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->min_intensity > above_intensity); };
   LAScriterionDropIntensityAbove(I32 above_intensity) { this->above_intensity = above_intensity; };
 private:
   I32 above_intensity;
@@ -818,6 +878,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d %d ", name(), below_intensity, above_intensity); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_INTENSITY; };
   inline BOOL filter(const LASpoint* point) { return (below_intensity <= point->get_intensity()) && (point->get_intensity() <= above_intensity); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (below_intensity <= stat->min_intensity) && (stat->max_intensity <= above_intensity); };
   LAScriterionDropIntensityBetween(I32 below_intensity, I32 above_intensity) { this->below_intensity = below_intensity; this->above_intensity = above_intensity; };
 private:
   I32 below_intensity, above_intensity;
@@ -836,6 +897,7 @@ public:
   };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_CLASSIFICATION; };
   inline BOOL filter(const LASpoint* point) { return ((1u << point->classification) & drop_classification_mask); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return stat->has_only_classification(drop_classification_mask); };
   LAScriterionKeepClassifications(U32 keep_classification_mask) { drop_classification_mask = ~keep_classification_mask; };
   inline U32 get_keep_classification_mask() const { return ~drop_classification_mask; };
 private:
@@ -854,6 +916,7 @@ public:
   };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_CLASSIFICATION; };
   inline BOOL filter(const LASpoint* point) { return ((1 << point->classification) & drop_classification_mask); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return stat->has_only_classification(drop_classification_mask); };
   LAScriterionDropClassifications(U32 drop_classification_mask) { this->drop_classification_mask = drop_classification_mask; };
   inline U32 get_drop_classification_mask() const { return drop_classification_mask; };
 private:
@@ -867,6 +930,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %u %u %u %u %u %u %u %u ", name(), drop_extended_classification_mask[7], drop_extended_classification_mask[6], drop_extended_classification_mask[5], drop_extended_classification_mask[4], drop_extended_classification_mask[3], drop_extended_classification_mask[2], drop_extended_classification_mask[1], drop_extended_classification_mask[0]); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_CLASSIFICATION; };
   inline BOOL filter(const LASpoint* point) { return ((1 << (point->extended_classification - (32 * (point->extended_classification / 32)))) & drop_extended_classification_mask[point->extended_classification / 32]); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { for (I32 i = 0; i < 8; i++) if (stat->extended_classification_mask[i] & ~drop_extended_classification_mask[i]) return FALSE; return TRUE; };
   LAScriterionDropExtendedClassifications(U32 drop_extended_classification_mask[8]) { for (I32 i = 0; i < 8; i++) this->drop_extended_classification_mask[i] = drop_extended_classification_mask[i]; };
 private:
   U32 drop_extended_classification_mask[8];
@@ -951,6 +1015,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d ", name(), user_data); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_USER_DATA; };
   inline BOOL filter(const LASpoint* point) { return (point->user_data != user_data); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->max_user_data < user_data) || (stat->min_user_data > user_data); };
   LAScriterionKeepUserData(U8 user_data) { this->user_data = user_data; };
 private:
   U8 user_data;
@@ -963,6 +1028,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d ", name(), below_user_data); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_USER_DATA; };
   inline BOOL filter(const LASpoint* point) { return (point->user_data >= below_user_data); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->min_user_data >= below_user_data); };
   LAScriterionKeepUserDataBelow(U8 below_user_data) { this->below_user_data = below_user_data; };
 private:
   U8 below_user_data;
@@ -975,6 +1041,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d ", name(), above_user_data); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_USER_DATA; };
   inline BOOL filter(const LASpoint* point) { return (point->user_data <= above_user_data); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->max_user_data <= above_user_data); };
   LAScriterionKeepUserDataAbove(U8 above_user_data) { this->above_user_data = above_user_data; };
 private:
   U8 above_user_data;
@@ -987,6 +1054,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d %d ", name(), below_user_data, above_user_data); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_USER_DATA; };
   inline BOOL filter(const LASpoint* point) { return (point->user_data < below_user_data) || (above_user_data < point->user_data); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->max_user_data < below_user_data) || (above_user_data < stat->min_user_data); };
   LAScriterionKeepUserDataBetween(U8 below_user_data, U8 above_user_data) { this->below_user_data = below_user_data; this->above_user_data = above_user_data; };
 private:
   U8 below_user_data, above_user_data;
@@ -999,6 +1067,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d ", name(), user_data); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_USER_DATA; };
   inline BOOL filter(const LASpoint* point) { return (point->user_data == user_data); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->min_user_data == user_data) && (stat->max_user_data == user_data); };
   LAScriterionDropUserData(U8 user_data) { this->user_data = user_data; };
 private:
   U8 user_data;
@@ -1011,6 +1080,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d ", name(), below_user_data); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_USER_DATA; };
   inline BOOL filter(const LASpoint* point) { return (point->user_data < below_user_data) ; };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->max_user_data < below_user_data); };
   LAScriterionDropUserDataBelow(U8 below_user_data) { this->below_user_data = below_user_data; };
 private:
   U8 below_user_data;
@@ -1023,6 +1093,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d ", name(), above_user_data); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_USER_DATA; };
   inline BOOL filter(const LASpoint* point) { return (point->user_data > above_user_data); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->min_user_data > above_user_data); };
   LAScriterionDropUserDataAbove(U8 above_user_data) { this->above_user_data = above_user_data; };
 private:
   U8 above_user_data;
@@ -1035,6 +1106,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d %d ", name(), below_user_data, above_user_data); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_USER_DATA; };
   inline BOOL filter(const LASpoint* point) { return (below_user_data <= point->user_data) && (point->user_data <= above_user_data); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (below_user_data <= stat->min_user_data) && (stat->max_user_data <= above_user_data); };
   LAScriterionDropUserDataBetween(U8 below_user_data, U8 above_user_data) { this->below_user_data = below_user_data; this->above_user_data = above_user_data; };
 private:
   U8 below_user_data, above_user_data;
@@ -1047,6 +1119,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d ", name(), point_source_id); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_POINT_SOURCE; };
   inline BOOL filter(const LASpoint* point) { return (point->get_point_source_ID() != point_source_id); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->max_point_source_ID < point_source_id) || (stat->min_point_source_ID > point_source_id); };
   LAScriterionKeepPointSource(U16 point_source_id) { this->point_source_id = point_source_id; };
 private:
   U16 point_source_id;
@@ -1059,6 +1132,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d %d ", name(), below_point_source_id, above_point_source_id); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_POINT_SOURCE; };
   inline BOOL filter(const LASpoint* point) { return (point->get_point_source_ID() < below_point_source_id) || (above_point_source_id < point->get_point_source_ID()); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->max_point_source_ID < below_point_source_id) || (above_point_source_id < stat->min_point_source_ID); };
   LAScriterionKeepPointSourceBetween(U16 below_point_source_id, U16 above_point_source_id) { this->below_point_source_id = below_point_source_id; this->above_point_source_id = above_point_source_id; };
 private:
   U16 below_point_source_id, above_point_source_id;
@@ -1071,6 +1145,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d ", name(), point_source_id); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_POINT_SOURCE; };
   inline BOOL filter(const LASpoint* point) { return (point->get_point_source_ID() == point_source_id) ; };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->min_point_source_ID == point_source_id) && (stat->max_point_source_ID == point_source_id); };
   LAScriterionDropPointSource(U16 point_source_id) { this->point_source_id = point_source_id; };
 private:
   U16 point_source_id;
@@ -1083,6 +1158,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d ", name(), below_point_source_id); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_POINT_SOURCE; };
   inline BOOL filter(const LASpoint* point) { return (point->get_point_source_ID() < below_point_source_id) ; };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->max_point_source_ID < below_point_source_id); };
   LAScriterionDropPointSourceBelow(U16 below_point_source_id) { this->below_point_source_id = below_point_source_id; };
 private:
   U16 below_point_source_id;
@@ -1095,6 +1171,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d ", name(), above_point_source_id); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_POINT_SOURCE; };
   inline BOOL filter(const LASpoint* point) { return (point->get_point_source_ID() > above_point_source_id); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->min_point_source_ID > above_point_source_id); };
   LAScriterionDropPointSourceAbove(U16 above_point_source_id) { this->above_point_source_id = above_point_source_id; };
 private:
   U16 above_point_source_id;
@@ -1107,6 +1184,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d %d ", name(), below_point_source_id, above_point_source_id); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_POINT_SOURCE; };
   inline BOOL filter(const LASpoint* point) { return (below_point_source_id <= point->get_point_source_ID()) && (point->get_point_source_ID() <= above_point_source_id); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (below_point_source_id <= stat->min_point_source_ID) && (stat->max_point_source_ID <= above_point_source_id); };
   LAScriterionDropPointSourceBetween(U16 below_point_source_id, U16 above_point_source_id) { this->below_point_source_id = below_point_source_id; this->above_point_source_id = above_point_source_id; };
 private:
   U16 below_point_source_id, above_point_source_id;
@@ -1119,6 +1197,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf %lf ", name(), below_gpstime, above_gpstime); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_GPS_TIME; };
   inline BOOL filter(const LASpoint* point) { return (point->have_gps_time && ((point->gps_time < below_gpstime) || (point->gps_time > above_gpstime))); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->has_gps_time() && ((stat->max_gps_time < below_gpstime) || (stat->min_gps_time > above_gpstime))); };
   LAScriterionKeepGpsTime(F64 below_gpstime, F64 above_gpstime) { this->below_gpstime = below_gpstime; this->above_gpstime = above_gpstime; };
 private:
   F64 below_gpstime, above_gpstime;
@@ -1131,6 +1210,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf ", name(), below_gpstime); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_GPS_TIME; };
   inline BOOL filter(const LASpoint* point) { return (point->have_gps_time && (point->gps_time < below_gpstime)); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->has_gps_time() && (stat->max_gps_time < below_gpstime)); };
   LAScriterionDropGpsTimeBelow(F64 below_gpstime) { this->below_gpstime = below_gpstime; };
 private:
   F64 below_gpstime;
@@ -1143,6 +1223,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf ", name(), above_gpstime); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_GPS_TIME; };
   inline BOOL filter(const LASpoint* point) { return (point->have_gps_time && (point->gps_time > above_gpstime)); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->has_gps_time() && (stat->min_gps_time > above_gpstime)); };
   LAScriterionDropGpsTimeAbove(F64 above_gpstime) { this->above_gpstime = above_gpstime; };
 private:
   F64 above_gpstime;
@@ -1155,6 +1236,7 @@ public:
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf %lf ", name(), below_gpstime, above_gpstime); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_GPS_TIME; };
   inline BOOL filter(const LASpoint* point) { return (point->have_gps_time && ((below_gpstime <= point->gps_time) && (point->gps_time <= above_gpstime))); };
+  inline BOOL filter_chunk(const LASchunkStat* stat) const { return (stat->has_gps_time() && ((below_gpstime <= stat->min_gps_time) && (stat->max_gps_time <= above_gpstime))); };
   LAScriterionDropGpsTimeBetween(F64 below_gpstime, F64 above_gpstime) { this->below_gpstime = below_gpstime; this->above_gpstime = above_gpstime; };
 private:
   F64 below_gpstime, above_gpstime;
@@ -1270,6 +1352,7 @@ public:
   inline const CHAR* name() const { return "keep_every_nth"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %u ", name(), every); };
   inline BOOL filter(const LASpoint* point) { if (counter == every) { counter = 1; return FALSE; } else { counter++; return TRUE; } };
+  inline BOOL is_stateless() const { return FALSE; };
   LAScriterionKeepEveryNth(U32 every) { this->every = every; counter = 1; };
 private:
   U32 counter;
@@ -1282,6 +1365,7 @@ public:
   inline const CHAR* name() const { return "drop_every_nth"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %u ", name(), every); };
   inline BOOL filter(const LASpoint* point) { if (counter == every) { counter = 1; return TRUE; } else { counter++; return FALSE; } };
+  inline BOOL is_stateless() const { return FALSE; };
   LAScriterionDropEveryNth(U32 every) { this->every = every; counter = 1; };
 private:
   U32 counter;
@@ -1292,18 +1376,16 @@ class LAScriterionKeepRandomFraction : public LAScriterion
 {
 public:
   inline const CHAR* name() const { return "keep_random_fraction"; };
-  inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %g ", name(), fraction); };
+  inline I32 get_command(CHAR* string) const { if (seed) return sprintf(string, "-%s %g %u ", name(), fraction, seed); else return sprintf(string, "-%s %g ", name(), fraction); };
+  inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_CHANNEL_RETURNS_XY | LASZIP_DECOMPRESS_SELECTIVE_Z | LASZIP_DECOMPRESS_SELECTIVE_GPS_TIME; };
   inline BOOL filter(const LASpoint* point)
   {
-    srand(seed);
-    seed = rand();
-    return ((F32)seed/(F32)RAND_MAX) > fraction;
+    // see lasrandom.hpp
+    return LASrandom::get_fraction(LASrandom::get(seed, point)) >= fraction;
   };
-  void reset() { seed = requested_seed; };
-  LAScriterionKeepRandomFraction(F32 fraction) { requested_seed = seed = 0; this->fraction = fraction; };
-  LAScriterionKeepRandomFraction(U32 seed, F32 fraction) { requested_seed = this->seed = seed; this->fraction = fraction; };
+  LAScriterionKeepRandomFraction(F32 fraction) { seed = 0; this->fraction = fraction; };
+  LAScriterionKeepRandomFraction(U32 seed, F32 fraction) { this->seed = seed; this->fraction = fraction; };
 private:
-  U32 requested_seed;
   U32 seed;
   F32 fraction;
 };
@@ -1312,211 +1394,24 @@ class LAScriterionThinWithGrid : public LAScriterion
 {
 public:
   inline const CHAR* name() const { return "thin_with_grid"; };
-  inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %g ", name(), (grid_spacing > 0 ? grid_spacing : -grid_spacing)); };
+  inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %g ", name(), grid_spacing); };
+  inline BOOL is_stateless() const { return FALSE; };
   inline BOOL filter(const LASpoint* point)
   { 
-    if (grid_spacing < 0)
-    {
-      grid_spacing = -grid_spacing;
-      anker = I32_FLOOR(point->get_y() / grid_spacing);
-    }
-    I32 pos_x = I32_FLOOR(point->get_x() / grid_spacing);
-    I32 pos_y = I32_FLOOR(point->get_y() / grid_spacing) - anker;
-    BOOL no_x_anker = FALSE;
-    U32* array_size;
-    I32** ankers;
-    U32*** array;
-    U16** array_sizes;
-    if (pos_y < 0)
-    {
-      pos_y = -pos_y - 1;
-      ankers = &minus_ankers;
-      if ((U32)pos_y < minus_plus_size && minus_plus_sizes[pos_y])
-      {
-        pos_x -= minus_ankers[pos_y];
-        if (pos_x < 0)
-        {
-          pos_x = -pos_x - 1;
-          array_size = &minus_minus_size;
-          array = &minus_minus;
-          array_sizes = &minus_minus_sizes;
-        }
-        else
-        {
-          array_size = &minus_plus_size;
-          array = &minus_plus;
-          array_sizes = &minus_plus_sizes;
-        }
-      }
-      else
-      {
-        no_x_anker = TRUE;
-        array_size = &minus_plus_size;
-        array = &minus_plus;
-        array_sizes = &minus_plus_sizes;
-      }
-    }
-    else
-    {
-      ankers = &plus_ankers;
-      if ((U32)pos_y < plus_plus_size && plus_plus_sizes[pos_y])
-      {
-        pos_x -= plus_ankers[pos_y];
-        if (pos_x < 0)
-        {
-          pos_x = -pos_x - 1;
-          array_size = &plus_minus_size;
-          array = &plus_minus;
-          array_sizes = &plus_minus_sizes;
-        }
-        else
-        {
-          array_size = &plus_plus_size;
-          array = &plus_plus;
-          array_sizes = &plus_plus_sizes;
-        }
-      }
-      else
-      {
-        no_x_anker = TRUE;
-        array_size = &plus_plus_size;
-        array = &plus_plus;
-        array_sizes = &plus_plus_sizes;
-      }
-    }
-    // maybe grow banded grid in y direction
-    if ((U32)pos_y >= *array_size)
-    {
-      U32 array_size_new = ((pos_y/1024)+1)*1024;
-      if (*array_size)
-      {
-        if (array == &minus_plus || array == &plus_plus) *ankers = (I32*)realloc(*ankers, array_size_new*sizeof(I32));
-        *array = (U32**)realloc(*array, array_size_new*sizeof(U32*));
-        *array_sizes = (U16*)realloc(*array_sizes, array_size_new*sizeof(U16));
-      }
-      else
-      {
-        if (array == &minus_plus || array == &plus_plus) *ankers = (I32*)malloc(array_size_new*sizeof(I32));
-        *array = (U32**)malloc(array_size_new*sizeof(U32*));
-        *array_sizes = (U16*)malloc(array_size_new*sizeof(U16));
-      }
-      for (U32 i = *array_size; i < array_size_new; i++)
-      {
-        (*array)[i] = 0;
-        (*array_sizes)[i] = 0;
-      }
-      *array_size = array_size_new;
-    }
-    // is this the first x anker for this y pos?
-    if (no_x_anker)
-    {
-      (*ankers)[pos_y] = pos_x;
-      pos_x = 0;
-    }
-    // maybe grow banded grid in x direction
-    U32 pos_x_pos = pos_x/32;
-    if (pos_x_pos >= (*array_sizes)[pos_y])
-    {
-      U32 array_sizes_new = ((pos_x_pos/256)+1)*256;
-      if ((*array_sizes)[pos_y])
-      {
-        (*array)[pos_y] = (U32*)realloc((*array)[pos_y], array_sizes_new*sizeof(U32));
-      }
-      else
-      {
-        (*array)[pos_y] = (U32*)malloc(array_sizes_new*sizeof(U32));
-      }
-      for (U16 i = (*array_sizes)[pos_y]; i < array_sizes_new; i++)
-      {
-        (*array)[pos_y][i] = 0;
-      }
-      (*array_sizes)[pos_y] = array_sizes_new;
-    }
-    U32 pos_x_bit = 1 << (pos_x%32);
-    if ((*array)[pos_y][pos_x_pos] & pos_x_bit) return TRUE;
-    (*array)[pos_y][pos_x_pos] |= pos_x_bit;
-    return FALSE;
+    return !grid.add(point);
   }
   void reset()
   {
-    if (grid_spacing > 0) grid_spacing = -grid_spacing;
-    if (minus_minus_size)
-    {
-      for (U32 i = 0; i < minus_minus_size; i++) if (minus_minus[i]) free(minus_minus[i]);
-      free(minus_minus);
-      minus_minus = 0;
-      free(minus_minus_sizes);
-      minus_minus_sizes = 0;
-      minus_minus_size = 0;
-    }
-    if (minus_plus_size)
-    {
-      free(minus_ankers);
-      minus_ankers = 0;
-      for (U32 i = 0; i < minus_plus_size; i++) if (minus_plus[i]) free(minus_plus[i]);
-      free(minus_plus);
-      minus_plus = 0;
-      free(minus_plus_sizes);
-      minus_plus_sizes = 0;
-      minus_plus_size = 0;
-    }
-    if (plus_minus_size)
-    {
-      for (U32 i = 0; i < plus_minus_size; i++) if (plus_minus[i]) free(plus_minus[i]);
-      free(plus_minus);
-      plus_minus = 0;
-      free(plus_minus_sizes);
-      plus_minus_sizes = 0;
-      plus_minus_size = 0;
-    }
-    if (plus_plus_size)
-    {
-      free(plus_ankers);
-      plus_ankers = 0;
-      for (U32 i = 0; i < plus_plus_size; i++) if (plus_plus[i]) free(plus_plus[i]);
-      free(plus_plus);
-      plus_plus = 0;
-      free(plus_plus_sizes);
-      plus_plus_sizes = 0;
-      plus_plus_size = 0;
-    }
+    grid.reset();
   };
-  LAScriterionThinWithGrid(F32 grid_spacing)
+  LAScriterionThinWithGrid(F32 grid_spacing) : grid(grid_spacing, LAS_THIN_FIRST)
   {
-    this->grid_spacing = -grid_spacing;
-    minus_ankers = 0;
-    minus_minus_size = 0;
-    minus_minus = 0;
-    minus_minus_sizes = 0;
-    minus_plus_size = 0;
-    minus_plus = 0;
-    minus_plus_sizes = 0;
-    plus_ankers = 0;
-    plus_minus_size = 0;
-    plus_minus = 0;
-    plus_minus_sizes = 0;
-    plus_plus_size = 0;
-    plus_plus = 0;
-    plus_plus_sizes = 0;
+    this->grid_spacing = grid_spacing;
   };
   ~LAScriterionThinWithGrid() { reset(); };
 private:
   F32 grid_spacing;
-  I32 anker;
-  I32* minus_ankers;
-  U32 minus_minus_size;
-  U32** minus_minus;
-  U16* minus_minus_sizes;
-  U32 minus_plus_size;
-  U32** minus_plus;
-  U16* minus_plus_sizes;
-  I32* plus_ankers;
-  U32 plus_minus_size;
-  U32** plus_minus;
-  U16* plus_minus_sizes;
-  U32 plus_plus_size;
-  U32** plus_plus;
-  U16* plus_plus_sizes;
+  LASthinGrid grid;
 };
 
 class LAScriterionThinPulsesWithTime : public LAScriterion
@@ -1525,6 +1420,7 @@ public:
   inline const CHAR* name() const { return "thin_pulses_with_time"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf ", name(), (time_spacing > 0 ? time_spacing : -time_spacing)); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_GPS_TIME; };
+  inline BOOL is_stateless() const { return FALSE; };
   inline BOOL filter(const LASpoint* point)
   { 
     I64 pos_t = I64_FLOOR(point->get_gps_time() / time_spacing);
@@ -1563,6 +1459,7 @@ public:
   inline const CHAR* name() const { return "thin_points_with_time"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf ", name(), (time_spacing > 0 ? time_spacing : -time_spacing)); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_GPS_TIME; };
+  inline BOOL is_stateless() const { return FALSE; };
   inline BOOL filter(const LASpoint* point)
   { 
     I64 pos_t = I64_FLOOR(point->get_gps_time() / time_spacing);
@@ -1613,6 +1510,8 @@ void LASfilter::usage() const
   fprintf(stderr,"  -keep_circle 630250.00 4834750.00 100 (x y radius)\n");
   fprintf(stderr,"  -keep_xy 630000 4834000 631000 4836000 (min_x min_y max_x max_y)\n");
   fprintf(stderr,"  -drop_xy 630000 4834000 631000 4836000 (min_x min_y max_x max_y)\n");
+  fprintf(stderr,"  -keep_polygon footprints.shp\n");
+  fprintf(stderr,"  -drop_polygon \"POLYGON ((0 0, 10 0, 10 10, 0 10), (2 2, 2 4, 4 4, 4 2))\" (or a file with WKT)\n");
   fprintf(stderr,"  -keep_x 631500.50 631501.00 (min_x max_x)\n");
   fprintf(stderr,"  -drop_x 631500.50 631501.00 (min_x max_x)\n");
   fprintf(stderr,"  -drop_x_below 630000.50 (min_x)\n");
@@ -2283,6 +2182,23 @@ BOOL LASfilter::parse(int argc, char* argv[])
         add_criterion(new LAScriterionKeepCircle(center_x, center_y, radius));
         *argv[i]='\0'; *argv[i+1]='\0'; *argv[i+2]='\0'; *argv[i+3]='\0'; i+=3;
       }
+      else if (strcmp(argv[i],"-keep_polygon") == 0)
+      {
+        if ((i+1) >= argc)
+        {
+          fprintf(stderr,"ERROR: '%s' needs 1 argument: WKT or file name\n", argv[i]);
+          return FALSE;
+        }
+        LASpolygon* polygon = new LASpolygon();
+        if (!polygon->read(argv[i+1]))
+        {
+          fprintf(stderr,"ERROR: '%s' cannot read polygon from '%s'\n", argv[i], argv[i+1]);
+          delete polygon;
+          return FALSE;
+        }
+        add_criterion(new LAScriterionKeepPolygon(polygon, argv[i+1]));
+        *argv[i]='\0'; *argv[i+1]='\0'; i+=1;
+      }
       else if (strncmp(argv[i],"-keep_return", 12) == 0)
       {
         if (strcmp(argv[i],"-keep_return") == 0)
@@ -2973,7 +2889,24 @@ BOOL LASfilter::parse(int argc, char* argv[])
     }
     else if (strncmp(argv[i],"-drop_", 6) == 0)
     {
-      if (strncmp(argv[i],"-drop_first", 11) == 0)
+      if (strcmp(argv[i],"-drop_polygon") == 0)
+      {
+        if ((i+1) >= argc)
+        {
+          fprintf(stderr,"ERROR: '%s' needs 1 argument: WKT or file name\n", argv[i]);
+          return FALSE;
+        }
+        LASpolygon* polygon = new LASpolygon();
+        if (!polygon->read(argv[i+1]))
+        {
+          fprintf(stderr,"ERROR: '%s' cannot read polygon from '%s'\n", argv[i], argv[i+1]);
+          delete polygon;
+          return FALSE;
+        }
+        add_criterion(new LAScriterionDropPolygon(polygon, argv[i+1]));
+        *argv[i]='\0'; *argv[i+1]='\0'; i+=1;
+      }
+      else if (strncmp(argv[i],"-drop_first", 11) == 0)
       {
         if (strcmp(argv[i],"-drop_first") == 0)
         {
@@ -4257,6 +4190,34 @@ U32 LASfilter::get_decompress_selective() const
   return decompress_selective;
 }
 
+BOOL LASfilter::get_polygon_bounding_box(F64* min_max) const
+{
+  U32 i;
+  BOOL found = FALSE;
+  F64 bounding_box[4];
+  for (i = 0; i < num_criteria; i++)
+  {
+    if (strcmp(criteria[i]->name(), "keep_polygon") == 0)
+    {
+      ((const LAScriterionKeepPolygon*)criteria[i])->get_polygon()->get_bounding_box(bounding_box);
+      if (found)
+      {
+        // all polygons must be kept so only their intersection is of interest
+        if (bounding_box[0] > min_max[0]) min_max[0] = bounding_box[0];
+        if (bounding_box[1] > min_max[1]) min_max[1] = bounding_box[1];
+        if (bounding_box[2] < min_max[2]) min_max[2] = bounding_box[2];
+        if (bounding_box[3] < min_max[3]) min_max[3] = bounding_box[3];
+      }
+      else
+      {
+        memcpy(min_max, bounding_box, sizeof(F64)*4);
+        found = TRUE;
+      }
+    }
+  }
+  return found;
+}
+
 void LASfilter::addClipCircle(F64 x, F64 y, F64 radius)
 {
   add_criterion(new LAScriterionKeepCircle(x, y, radius));
@@ -4287,6 +4248,30 @@ BOOL LASfilter::filter(const LASpoint* point)
   return FALSE; // point survived
 }
 
+BOOL LASfilter::filter_chunk(const LASchunkStat* stat)
+{
+  if (!(stat->flags & LAS_CHUNK_STAT_KNOWN))
+  {
+    return FALSE;
+  }
+
+  U32 i;
+
+  for (i = 0; i < num_criteria; i++)
+  {
+    if (!criteria[i]->is_stateless())
+    {
+      return FALSE; // this criterion must see all points that reach it
+    }
+    if (criteria[i]->filter_chunk(stat))
+    {
+      counters[i] += stat->number;
+      return TRUE; // all points of the chunk would be filtered
+    }
+  }
+  return FALSE;
+}
+
 void LASfilter::reset()
 {
   U32 i;
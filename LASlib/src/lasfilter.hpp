@@ -24,6 +24,10 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- filter_chunk() tells from per-chunk statistics that a whole chunk is filtered
+    19 October 2026 -- new '-keep_polygon' and '-drop_polygon' for WKT and shapefile polygons
+    19 October 2026 -- '-keep_random_fraction' keyed on the point instead of rand()
+    19 October 2026 -- '-thin_with_grid' keeps its occupied cells in a hash set
      6 March 2018 -- changed '%g' to '%lf' for all sprintf() of F64 values
     14 December 2017 -- keep multiple flightlines with '-keep_point_source 2 3 4' 
     10 December 2017 -- new '-keep_random_fraction 0.2 4711' uses 4711 as seed
@@ -37,6 +41,8 @@
 #include "lasdefinitions.hpp"
 #include "laszip_decompress_selective_v3.hpp"
 
+class LASchunkStat;
+
 class LAScriterion
 {
 public:
@@ -44,6 +50,10 @@ public:
   virtual I32 get_command(CHAR* string) const = 0;
   virtual U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_CHANNEL_RETURNS_XY; };
   virtual BOOL filter(const LASpoint* point) = 0;
+  // TRUE only if every point of a chunk with these statistics is filtered
+  virtual BOOL filter_chunk(const LASchunkStat* stat) const { return FALSE; };
+  // FALSE for criteria that depend on the points seen before (counters, grids, ...)
+  virtual BOOL is_stateless() const { return TRUE; };
   virtual void reset(){};
   virtual ~LAScriterion(){};
 };
@@ -60,11 +70,18 @@ public:
   inline BOOL active() const { return (num_criteria != 0); };
   U32 get_decompress_selective() const;
 
+  // the bounding box of the points that '-keep_polygon' can keep
+  BOOL get_polygon_bounding_box(F64* min_max) const;
+
   void addClipCircle(F64 x, F64 y, F64 radius);
   void addClipBox(F64 min_x, F64 min_y, F64 min_z, F64 max_x, F64 max_y, F64 max_z);
   void addKeepScanDirectionChange();
 
   BOOL filter(const LASpoint* point);
+  // TRUE if the chunk can be skipped because all its points would be filtered. only the
+  // criteria before the first stateful one are asked because the later ones see every
+  // point that reaches them.
+  BOOL filter_chunk(const LASchunkStat* stat);
   void reset();
 
   LASfilter();
@@ -0,0 +1,428 @@
+/*
+===============================================================================
+
+  FILE:  lasmulticlip.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the LICENSE.txt file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "lasmulticlip.hpp"
+
+#include "lasreader.hpp"
+#include "laswriter_las.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// the grid has about this many cells per region but never more than the maximum
+
+#define LAS_MULTI_CLIP_CELLS_PER_REGION 4
+#define LAS_MULTI_CLIP_MAX_CELLS 1048576
+
+U32 LASmultiClip::add_region(const F64 min_x, const F64 min_y, const F64 max_x, const F64 max_y, const CHAR* file_name)
+{
+  if (number_regions == allocated_regions)
+  {
+    allocated_regions = (allocated_regions ? 2 * allocated_regions : 64);
+    regions = (LASclipRegion*)realloc(regions, sizeof(LASclipRegion)*allocated_regions);
+  }
+  LASclipRegion* region = &regions[number_regions];
+  region->min_x = min_x;
+  region->min_y = min_y;
+  region->max_x = max_x;
+  region->max_y = max_y;
+  region->first_vertex = 0;
+  region->number_vertices = 0;
+  region->file_name = LASCopyString(file_name);
+  region->count = 0;
+  return number_regions++;
+}
+
+U32 LASmultiClip::add_rectangle(const F64 min_x, const F64 min_y, const F64 max_x, const F64 max_y, const CHAR* file_name)
+{
+  return add_region(min_x, min_y, max_x, max_y, file_name);
+}
+
+U32 LASmultiClip::add_polygon(const F64* xy, const U32 number_vertices, const CHAR* file_name)
+{
+  U32 i;
+  F64 min_x = xy[0];
+  F64 min_y = xy[1];
+  F64 max_x = xy[0];
+  F64 max_y = xy[1];
+  for (i = 1; i < number_vertices; i++)
+  {
+    if (xy[2*i] < min_x) min_x = xy[2*i]; else if (xy[2*i] > max_x) max_x = xy[2*i];
+    if (xy[2*i+1] < min_y) min_y = xy[2*i+1]; else if (xy[2*i+1] > max_y) max_y = xy[2*i+1];
+  }
+  U32 index = add_region(min_x, min_y, max_x, max_y, file_name);
+
+  if (this->number_vertices + number_vertices > allocated_vertices)
+  {
+    while (this->number_vertices + number_vertices > allocated_vertices)
+    {
+      allocated_vertices = (allocated_vertices ? 2 * allocated_vertices : 1024);
+    }
+    vertices = (F64*)realloc(vertices, sizeof(F64)*2*allocated_vertices);
+  }
+  memcpy(vertices + 2*this->number_vertices, xy, sizeof(F64)*2*number_vertices);
+  regions[index].first_vertex = this->number_vertices;
+  regions[index].number_vertices = number_vertices;
+  this->number_vertices += number_vertices;
+  return index;
+}
+
+BOOL LASmultiClip::is_inside(const LASclipRegion* region, const F64 x, const F64 y) const
+{
+  if ((x < region->min_x) || (x >= region->max_x) || (y < region->min_y) || (y >= region->max_y))
+  {
+    return FALSE;
+  }
+  if (region->number_vertices == 0)
+  {
+    return TRUE;
+  }
+
+  // even-odd crossing test
+
+  BOOL inside = FALSE;
+  const F64* xy = vertices + 2*region->first_vertex;
+  U32 i, j;
+  for (i = 0, j = region->number_vertices - 1; i < region->number_vertices; j = i++)
+  {
+    if (((xy[2*i+1] > y) != (xy[2*j+1] > y)) && (x < (xy[2*j] - xy[2*i]) * (y - xy[2*i+1]) / (xy[2*j+1] - xy[2*i+1]) + xy[2*i]))
+    {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+void LASmultiClip::build_grid()
+{
+  U32 r;
+
+  if (cell_starts) free(cell_starts);
+  if (cell_regions) free(cell_regions);
+
+  min_x = regions[0].min_x;
+  min_y = regions[0].min_y;
+  max_x = regions[0].max_x;
+  max_y = regions[0].max_y;
+  for (r = 1; r < number_regions; r++)
+  {
+    if (regions[r].min_x < min_x) min_x = regions[r].min_x;
+    if (regions[r].min_y < min_y) min_y = regions[r].min_y;
+    if (regions[r].max_x > max_x) max_x = regions[r].max_x;
+    if (regions[r].max_y > max_y) max_y = regions[r].max_y;
+  }
+
+  F64 cells = (F64)number_regions * LAS_MULTI_CLIP_CELLS_PER_REGION;
+  if (cells > LAS_MULTI_CLIP_MAX_CELLS) cells = LAS_MULTI_CLIP_MAX_CELLS;
+  F64 area = (max_x - min_x) * (max_y - min_y);
+  cell_size = (area > 0.0 ? sqrt(area / cells) : 0.0);
+  if (cell_size <= 0.0) cell_size = ((max_x - min_x) > (max_y - min_y) ? (max_x - min_x) : (max_y - min_y));
+  if (cell_size <= 0.0) cell_size = 1.0;
+  cols = (U32)((max_x - min_x) / cell_size) + 1;
+  rows = (U32)((max_y - min_y) / cell_size) + 1;
+
+  // count, prefix sum, fill
+
+  cell_starts = (U32*)calloc(cols*rows + 1, sizeof(U32));
+  U32 c, row, col, min_col, max_col, min_row, max_row;
+  for (r = 0; r < number_regions; r++)
+  {
+    min_col = (U32)((regions[r].min_x - min_x) / cell_size);
+    max_col = (U32)((regions[r].max_x - min_x) / cell_size);
+    min_row = (U32)((regions[r].min_y - min_y) / cell_size);
+    max_row = (U32)((regions[r].max_y - min_y) / cell_size);
+    for (row = min_row; row <= max_row; row++)
+    {
+      for (col = min_col; col <= max_col; col++)
+      {
+        cell_starts[row*cols + col + 1]++;
+      }
+    }
+  }
+  for (c = 0; c < cols*rows; c++)
+  {
+    cell_starts[c+1] += cell_starts[c];
+  }
+  cell_regions = (U32*)malloc(sizeof(U32)*(cell_starts[cols*rows] + 1));
+  U32* fill = (U32*)malloc(sizeof(U32)*cols*rows);
+  memcpy(fill, cell_starts, sizeof(U32)*cols*rows);
+  for (r = 0; r < number_regions; r++)
+  {
+    min_col = (U32)((regions[r].min_x - min_x) / cell_size);
+    max_col = (U32)((regions[r].max_x - min_x) / cell_size);
+    min_row = (U32)((regions[r].min_y - min_y) / cell_size);
+    max_row = (U32)((regions[r].max_y - min_y) / cell_size);
+    for (row = min_row; row <= max_row; row++)
+    {
+      for (col = min_col; col <= max_col; col++)
+      {
+        cell_regions[fill[row*cols + col]++] = r;
+      }
+    }
+  }
+  free(fill);
+}
+
+// the outputs with an open file are kept in a list from the most to the least recently used
+
+void LASmultiClip::link_file(const U32 r)
+{
+  newer[r] = U32_MAX;
+  older[r] = newest;
+  if (newest != U32_MAX) newer[newest] = r;
+  newest = r;
+  if (oldest == U32_MAX) oldest = r;
+}
+
+void LASmultiClip::unlink_file(const U32 r)
+{
+  if (older[r] != U32_MAX) newer[older[r]] = newer[r];
+  if (newer[r] != U32_MAX) older[newer[r]] = older[r];
+  if (newest == r) newest = older[r];
+  if (oldest == r) oldest = newer[r];
+}
+
+// makes sure the output of region r has its file open and marks it as the most recently used
+
+BOOL LASmultiClip::use_file(const U32 r)
+{
+  if (files[r])
+  {
+    if (newest == r) return TRUE;
+    unlink_file(r);
+  }
+  else
+  {
+    if (number_open == max_open)
+    {
+      close_file(oldest);
+    }
+    files[r] = fopen(regions[r].file_name, "r+b");
+    if (files[r] == 0)
+    {
+      fprintf(stderr,"ERROR: cannot reopen output '%s' of region %u\n", regions[r].file_name, r);
+      return FALSE;
+    }
+    if (fseek(files[r], 0, SEEK_END) || !writers[r]->refile(files[r]))
+    {
+      fprintf(stderr,"ERROR: cannot continue output '%s' of region %u\n", regions[r].file_name, r);
+      fclose(files[r]);
+      files[r] = 0;
+      return FALSE;
+    }
+    number_open++;
+  }
+  link_file(r);
+  return TRUE;
+}
+
+void LASmultiClip::close_file(const U32 r)
+{
+  if (files[r] == 0) return;
+  fclose(files[r]);
+  files[r] = 0;
+  unlink_file(r);
+  number_open--;
+}
+
+I64 LASmultiClip::clip(LASreader* lasreader)
+{
+  if (lasreader == 0)
+  {
+    fprintf(stderr,"ERROR: lasreader pointer is zero\n");
+    return -1;
+  }
+  if (number_regions == 0)
+  {
+    return 0;
+  }
+
+  build_grid();
+
+  // only the union of the regions needs to be read (which uses a spatial index if there is one)
+
+  if (lasreader->get_inside() == 0)
+  {
+    lasreader->inside_rectangle(min_x, min_y, max_x, max_y);
+  }
+
+  U32 r;
+  BOOL failed = FALSE;
+  writers = (LASwriterLAS**)calloc(number_regions, sizeof(LASwriterLAS*));
+  files = (FILE**)calloc(number_regions, sizeof(FILE*));
+  newer = (U32*)malloc(sizeof(U32)*number_regions);
+  older = (U32*)malloc(sizeof(U32)*number_regions);
+  newest = oldest = U32_MAX;
+  number_open = 0;
+
+  // the outputs write their headers as they are created
+
+  U32 created = 0;
+  for (r = 0; r < number_regions; r++)
+  {
+    const CHAR* file_name = regions[r].file_name;
+    size_t len = strlen(file_name);
+    U32 compressor = ((len && ((file_name[len-1] == 'z') || (file_name[len-1] == 'Z'))) ? LASZIP_COMPRESSOR_LAYERED_CHUNKED : LASZIP_COMPRESSOR_NONE);
+    if (number_open == max_open)
+    {
+      close_file(oldest);
+    }
+    FILE* file = fopen(file_name, "wb");
+    if (file == 0)
+    {
+      fprintf(stderr,"ERROR: cannot open output '%s' of region %u\n", file_name, r);
+      failed = TRUE;
+      break;
+    }
+    created++;
+    writers[r] = new LASwriterLAS();
+    if (!writers[r]->open(file, &lasreader->header, compressor, 2, LASZIP_CHUNK_SIZE_DEFAULT))
+    {
+      fprintf(stderr,"ERROR: cannot write header of output '%s' of region %u\n", file_name, r);
+      delete writers[r];
+      writers[r] = 0;
+      fclose(file);
+      failed = TRUE;
+      break;
+    }
+    files[r] = file;
+    number_open++;
+    link_file(r);
+    regions[r].count = 0;
+  }
+
+  I64 number = 0;
+  if (!failed)
+  {
+    F64 x, y;
+    U32 c, i;
+    while (!failed && lasreader->read_point())
+    {
+      number++;
+      x = lasreader->point.get_x();
+      y = lasreader->point.get_y();
+      if ((x < min_x) || (x >= max_x) || (y < min_y) || (y >= max_y)) continue;
+      c = ((U32)((y - min_y) / cell_size))*cols + (U32)((x - min_x) / cell_size);
+      for (i = cell_starts[c]; i < cell_starts[c+1]; i++)
+      {
+        r = cell_regions[i];
+        if (is_inside(&regions[r], x, y))
+        {
+          if (!use_file(r) || !writers[r]->write_point(&lasreader->point))
+          {
+            fprintf(stderr,"ERROR: cannot write point to output '%s' of region %u\n", regions[r].file_name, r);
+            failed = TRUE;
+            break;
+          }
+          writers[r]->update_inventory(&lasreader->point);
+          regions[r].count++;
+        }
+      }
+    }
+  }
+
+  // a writer can only finish with its file open. after a failure all outputs are removed.
+
+  for (r = 0; r < number_regions; r++)
+  {
+    if (writers[r] == 0) continue;
+    if (!use_file(r))
+    {
+      // the writer finishes into a scratch file. without any file it cannot even be deleted.
+      failed = TRUE;
+      FILE* scratch = tmpfile();
+      if (scratch && writers[r]->refile(scratch))
+      {
+        writers[r]->close();
+        delete writers[r];
+      }
+      if (scratch) fclose(scratch);
+      continue;
+    }
+    writers[r]->update_header(&lasreader->header, TRUE);
+    writers[r]->close();
+    delete writers[r];
+    close_file(r);
+  }
+  if (failed)
+  {
+    for (r = 0; r < created; r++)
+    {
+      remove(regions[r].file_name);
+    }
+  }
+  free(writers);
+  free(files);
+  free(newer);
+  free(older);
+  writers = 0;
+  files = 0;
+  newer = older = 0;
+
+  return (failed ? -1 : number);
+}
+
+void LASmultiClip::clean()
+{
+  U32 r;
+  for (r = 0; r < number_regions; r++)
+  {
+    free(regions[r].file_name);
+  }
+  if (regions) free(regions);
+  if (vertices) free(vertices);
+  if (cell_starts) free(cell_starts);
+  if (cell_regions) free(cell_regions);
+  number_regions = 0;
+  allocated_regions = 0;
+  regions = 0;
+  number_vertices = 0;
+  allocated_vertices = 0;
+  vertices = 0;
+  cell_starts = 0;
+  cell_regions = 0;
+  cols = rows = 0;
+}
+
+LASmultiClip::LASmultiClip()
+{
+  max_open = LAS_MULTI_CLIP_MAX_OPEN;
+  regions = 0;
+  vertices = 0;
+  cell_starts = 0;
+  cell_regions = 0;
+  writers = 0;
+  files = 0;
+  newer = 0;
+  older = 0;
+  number_regions = 0;
+  clean();
+}
+
+LASmultiClip::~LASmultiClip()
+{
+  clean();
+}
@@ -0,0 +1,112 @@
+/*
+===============================================================================
+
+  FILE:  lasmulticlip.hpp
+
+  CONTENTS:
+
+    Clips the points of one reader to many rectangles or polygons in a single
+    pass and writes every region to its own LAS/LAZ file. A point that falls
+    into several regions is written to all of them. The regions are bucketed
+    into a uniform grid over their union so each point is only compared with
+    the few regions near it.
+
+    At most max_open outputs have their file open at once. When another output
+    needs its file, the file of the least recently used output is closed and
+    later reopened to continue at its end (via refile() like in lastile), so
+    neither the open file handles nor the memory grow with the number of
+    regions or of points.
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the LICENSE.txt file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created to cut building footprints out of a tile in one pass
+
+===============================================================================
+*/
+#ifndef LAS_MULTI_CLIP_HPP
+#define LAS_MULTI_CLIP_HPP
+
+#include "lasdefinitions.hpp"
+
+class LASreader;
+class LASwriterLAS;
+
+#define LAS_MULTI_CLIP_MAX_OPEN 64
+
+class LASclipRegion
+{
+public:
+  F64 min_x;
+  F64 min_y;
+  F64 max_x;
+  F64 max_y;
+  U32 first_vertex;      // into the vertex array (x and y interleaved)
+  U32 number_vertices;   // zero for a rectangle
+  CHAR* file_name;
+  I64 count;
+};
+
+class LASLIB_DLL LASmultiClip
+{
+public:
+  // both return the index of the new region. the polygon is closed implicitly.
+  U32 add_rectangle(const F64 min_x, const F64 min_y, const F64 max_x, const F64 max_y, const CHAR* file_name);
+  U32 add_polygon(const F64* xy, const U32 number_vertices, const CHAR* file_name);
+
+  void set_max_open(const U32 max_open) { this->max_open = (max_open ? max_open : 1); };
+
+  // reads all points of the reader and writes them to the outputs of all regions containing
+  // them. the output is LAZ if the file name ends in 'z' and LAS otherwise. returns the
+  // number of points read or -1 if an output could not be written.
+  I64 clip(LASreader* lasreader);
+
+  inline U32 get_number_regions() const { return number_regions; };
+  inline const LASclipRegion* get_region(const U32 index) const { return &regions[index]; };
+  inline I64 get_count(const U32 index) const { return regions[index].count; };
+  inline const CHAR* get_file_name(const U32 index) const { return regions[index].file_name; };
+
+  void clean();
+
+  LASmultiClip();
+  ~LASmultiClip();
+
+private:
+  U32 add_region(const F64 min_x, const F64 min_y, const F64 max_x, const F64 max_y, const CHAR* file_name);
+  void build_grid();
+  BOOL is_inside(const LASclipRegion* region, const F64 x, const F64 y) const;
+  void link_file(const U32 r);
+  void unlink_file(const U32 r);
+  BOOL use_file(const U32 r);
+  void close_file(const U32 r);
+  U32 max_open;
+  U32 number_regions;
+  U32 allocated_regions;
+  LASclipRegion* regions;
+  U32 number_vertices;
+  U32 allocated_vertices;
+  F64* vertices;
+  // the grid over the union of the regions with the regions of each cell stored consecutively
+  F64 min_x, min_y, max_x, max_y;
+  F64 cell_size;
+  U32 cols, rows;
+  U32* cell_starts;
+  U32* cell_regions;
+  // the outputs during clip() with their open files in a list from most to least recently used
+  LASwriterLAS** writers;
+  FILE** files;
+  U32* newer;
+  U32* older;
+  U32 newest, oldest;
+  U32 number_open;
+};
+
+#endif
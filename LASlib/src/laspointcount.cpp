@@ -0,0 +1,401 @@
+/*
+===============================================================================
+
+  FILE:  laspointcount.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the LICENSE.txt file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "laspointcount.hpp"
+
+#include "lasreader_las.hpp"
+#include "lasindex.hpp"
+#include "lasquadtree.hpp"
+#include "lasinterval.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int compare_intervals(const void* a, const void* b)
+{
+  const I64* ia = (const I64*)a;
+  const I64* ib = (const I64*)b;
+  return (ia[0] < ib[0] ? -1 : (ia[0] > ib[0] ? 1 : 0));
+}
+
+BOOL LASpointCount::open(const CHAR* file_name)
+{
+  if (file_name == 0)
+  {
+    fprintf(stderr,"ERROR: file name pointer is zero\n");
+    return FALSE;
+  }
+
+  close();
+
+  // only the coordinates are ever decoded
+
+  lasreader = new LASreaderLAS();
+  if (!lasreader->open(file_name, LAS_TOOLS_IO_IBUFFER_SIZE, FALSE, LASZIP_DECOMPRESS_SELECTIVE_CHANNEL_RETURNS_XY))
+  {
+    fprintf(stderr,"ERROR: cannot open '%s' for counting\n", file_name);
+    delete lasreader;
+    lasreader = 0;
+    return FALSE;
+  }
+  npoints = lasreader->npoints;
+
+  index = new LASindex();
+  if (!index->read(file_name))
+  {
+    delete index;
+    index = 0;
+  }
+
+  number_chunks = lasreader->get_number_chunks();
+  if (number_chunks)
+  {
+    U32 c, num_points;
+    chunk_firsts = (I64*)malloc(sizeof(I64)*(number_chunks+1));
+    chunk_bytes = (U32*)malloc(sizeof(U32)*number_chunks);
+    for (c = 0; c < number_chunks; c++)
+    {
+      lasreader->get_chunk(c, 0, &chunk_bytes[c], &chunk_firsts[c], &num_points);
+    }
+    chunk_firsts[number_chunks] = chunk_firsts[number_chunks-1] + num_points;
+  }
+  return TRUE;
+}
+
+U32 LASpointCount::add_intervals(I64** intervals, U32 number, U32* allocated, const I64 start, const I64 end) const
+{
+  if (number == *allocated)
+  {
+    *allocated = (*allocated ? 2 * (*allocated) : 1024);
+    *intervals = (I64*)realloc(*intervals, sizeof(I64)*2*(*allocated));
+  }
+  (*intervals)[2*number] = start;
+  (*intervals)[2*number+1] = end;
+  return number + 1;
+}
+
+// sorts the intervals (inclusive start and end) and joins those that overlap or touch
+
+U32 LASpointCount::join_intervals(I64* intervals, U32 number) const
+{
+  if (number == 0)
+  {
+    return 0;
+  }
+  qsort(intervals, number, sizeof(I64)*2, compare_intervals);
+  U32 i, joined = 0;
+  for (i = 1; i < number; i++)
+  {
+    if (intervals[2*i] <= intervals[2*joined+1] + 1)
+    {
+      if (intervals[2*i+1] > intervals[2*joined+1]) intervals[2*joined+1] = intervals[2*i+1];
+    }
+    else
+    {
+      joined++;
+      intervals[2*joined] = intervals[2*i];
+      intervals[2*joined+1] = intervals[2*i+1];
+    }
+  }
+  return joined + 1;
+}
+
+// marks the chunks with points in the (sorted) intervals and returns how many there are
+
+U32 LASpointCount::mark_chunks(const I64* intervals, const U32 number, U8* marks) const
+{
+  U32 i, c = 0, marked = 0;
+  for (i = 0; i < number; i++)
+  {
+    while ((c < number_chunks) && (chunk_firsts[c+1] <= intervals[2*i])) c++;
+    while ((c < number_chunks) && (chunk_firsts[c] <= intervals[2*i+1]))
+    {
+      if (!marks[c])
+      {
+        marks[c] = 1;
+        marked++;
+      }
+      if (chunk_firsts[c+1] > intervals[2*i+1]) break;
+      c++;
+    }
+  }
+  return marked;
+}
+
+BOOL LASpointCount::count_approximate(const F64 min_x, const F64 min_y, const F64 max_x, const F64 max_y, I64* inside, I64* estimate, I64* intersecting, F64* bounding_box, I64* bytes)
+{
+  if (lasreader == 0)
+  {
+    fprintf(stderr,"ERROR: no file opened for counting\n");
+    return FALSE;
+  }
+
+  if (index == 0)
+  {
+    // all the header can tell
+
+    const LASheader* header = &lasreader->header;
+    BOOL overlap = !((header->max_x < min_x) || (header->min_x >= max_x) || (header->max_y < min_y) || (header->min_y >= max_y));
+    BOOL contained = ((header->min_x >= min_x) && (header->max_x < max_x) && (header->min_y >= min_y) && (header->max_y < max_y));
+    F64 box[4] = { 0.0, 0.0, 0.0, 0.0 };
+    F64 fraction = 0.0;
+    if (overlap)
+    {
+      box[0] = (header->min_x > min_x ? header->min_x : min_x);
+      box[1] = (header->min_y > min_y ? header->min_y : min_y);
+      box[2] = (header->max_x < max_x ? header->max_x : max_x);
+      box[3] = (header->max_y < max_y ? header->max_y : max_y);
+      F64 area = (header->max_x - header->min_x) * (header->max_y - header->min_y);
+      fraction = (area > 0.0 ? ((box[2] - box[0]) * (box[3] - box[1])) / area : 1.0);
+    }
+    if (inside) *inside = (contained ? npoints : 0);
+    if (estimate) *estimate = (I64)(fraction * npoints + 0.5);
+    if (intersecting) *intersecting = (overlap ? npoints : 0);
+    if (bounding_box) memcpy(bounding_box, box, sizeof(F64)*4);
+    if (bytes)
+    {
+      *bytes = 0;
+      if (overlap)
+      {
+        if (number_chunks)
+        {
+          U32 c;
+          for (c = 0; c < number_chunks; c++) *bytes += chunk_bytes[c];
+        }
+        else
+        {
+          *bytes = npoints * lasreader->header.point_data_record_length;
+        }
+      }
+    }
+    return TRUE;
+  }
+
+  index->count_rectangle(min_x, min_y, max_x, max_y, inside, estimate, intersecting, bounding_box);
+
+  // the chunks a query of the rectangle would decompress (or for LAS the records it would read)
+
+  if (bytes)
+  {
+    *bytes = 0;
+    I64* intervals = 0;
+    U32 number = 0;
+    U32 allocated = 0;
+    if (index->intersect_rectangle(min_x, min_y, max_x, max_y))
+    {
+      while (index->has_intervals())
+      {
+        number = add_intervals(&intervals, number, &allocated, index->start, index->end);
+      }
+    }
+    number = join_intervals(intervals, number);
+    U32 i;
+    if (number_chunks)
+    {
+      U8* marks = (U8*)calloc(number_chunks, sizeof(U8));
+      mark_chunks(intervals, number, marks);
+      for (i = 0; i < number_chunks; i++)
+      {
+        if (marks[i]) *bytes += chunk_bytes[i];
+      }
+      free(marks);
+    }
+    else
+    {
+      for (i = 0; i < number; i++)
+      {
+        *bytes += (intervals[2*i+1] - intervals[2*i] + 1) * lasreader->header.point_data_record_length;
+      }
+    }
+    if (intervals) free(intervals);
+  }
+  return TRUE;
+}
+
+I64 LASpointCount::count_exact(const F64 min_x, const F64 min_y, const F64 max_x, const F64 max_y)
+{
+  decoded_points = 0;
+  decoded_chunks = 0;
+
+  if (lasreader == 0)
+  {
+    fprintf(stderr,"ERROR: no file opened for counting\n");
+    return -1;
+  }
+
+  U32 i, j;
+  I64* candidates = 0;
+  U32 number_candidates = 0;
+  U32 allocated_candidates = 0;
+  I64* trusted = 0;
+  U32 number_trusted = 0;
+  U32 allocated_trusted = 0;
+  I64 count = 0;
+
+  if (index)
+  {
+    // the points of all cells overlapping the rectangle
+
+    if (index->intersect_rectangle(min_x, min_y, max_x, max_y))
+    {
+      while (index->has_intervals())
+      {
+        number_candidates = add_intervals(&candidates, number_candidates, &allocated_candidates, index->start, index->end);
+      }
+    }
+    number_candidates = join_intervals(candidates, number_candidates);
+
+    // the points of cells inside the rectangle whose intervals hold only their own points
+
+    LASquadtree* spatial = index->get_spatial();
+    LASinterval* interval = index->get_interval();
+    F32 cell_min[2], cell_max[2];
+    interval->get_cells();
+    while (interval->has_cells())
+    {
+      if (interval->full != interval->total) continue;
+      spatial->get_cell_bounding_box(interval->index, cell_min, cell_max);
+      if ((cell_min[0] < min_x) || (cell_min[1] < min_y) || (cell_max[0] >= max_x) || (cell_max[1] >= max_y)) continue;
+      count += interval->full;
+      while (interval->has_intervals())
+      {
+        number_trusted = add_intervals(&trusted, number_trusted, &allocated_trusted, interval->start, interval->end);
+      }
+    }
+    number_trusted = join_intervals(trusted, number_trusted);
+  }
+  else if (npoints)
+  {
+    number_candidates = add_intervals(&candidates, number_candidates, &allocated_candidates, 0, npoints - 1);
+  }
+
+  // the candidates minus the trusted intervals are decoded
+
+  I64* decode = 0;
+  U32 number_decode = 0;
+  U32 allocated_decode = 0;
+  I64 start, end;
+  for (i = 0, j = 0; i < number_candidates; i++)
+  {
+    start = candidates[2*i];
+    end = candidates[2*i+1];
+    while ((j < number_trusted) && (trusted[2*j+1] < start)) j++;
+    while ((j < number_trusted) && (trusted[2*j] <= end))
+    {
+      if (trusted[2*j] > start) number_decode = add_intervals(&decode, number_decode, &allocated_decode, start, trusted[2*j] - 1);
+      start = trusted[2*j+1] + 1;
+      if (start > end) break;
+      j++;
+    }
+    if (start <= end) number_decode = add_intervals(&decode, number_decode, &allocated_decode, start, end);
+  }
+
+  BOOL failed = FALSE;
+  for (i = 0; (i < number_decode) && !failed; i++)
+  {
+    if (!lasreader->seek(decode[2*i]))
+    {
+      fprintf(stderr,"ERROR: cannot seek to point %lld for counting\n", decode[2*i]);
+      failed = TRUE;
+      break;
+    }
+    for (start = decode[2*i]; start <= decode[2*i+1]; start++)
+    {
+      if (!lasreader->read_point())
+      {
+        fprintf(stderr,"ERROR: cannot read point %lld for counting\n", start);
+        failed = TRUE;
+        break;
+      }
+      if (lasreader->point.inside_rectangle(min_x, min_y, max_x, max_y)) count++;
+    }
+    decoded_points += (decode[2*i+1] - decode[2*i] + 1);
+  }
+  if (number_chunks && number_decode)
+  {
+    U8* marks = (U8*)calloc(number_chunks, sizeof(U8));
+    decoded_chunks = mark_chunks(decode, number_decode, marks);
+    free(marks);
+  }
+
+  if (candidates) free(candidates);
+  if (trusted) free(trusted);
+  if (decode) free(decode);
+  return (failed ? -1 : count);
+}
+
+U32 LASpointCount::get_number_cells() const
+{
+  return (index ? index->get_number_cells() : 0);
+}
+
+U32 LASpointCount::get_cell_counts(F32* bounding_boxes, U32* counts)
+{
+  return (index ? index->get_cell_counts(bounding_boxes, counts) : 0);
+}
+
+void LASpointCount::close()
+{
+  if (lasreader)
+  {
+    lasreader->close();
+    delete lasreader;
+    lasreader = 0;
+  }
+  if (index)
+  {
+    delete index;
+    index = 0;
+  }
+  if (chunk_firsts)
+  {
+    free(chunk_firsts);
+    chunk_firsts = 0;
+  }
+  if (chunk_bytes)
+  {
+    free(chunk_bytes);
+    chunk_bytes = 0;
+  }
+  npoints = 0;
+  number_chunks = 0;
+}
+
+LASpointCount::LASpointCount()
+{
+  lasreader = 0;
+  index = 0;
+  npoints = 0;
+  number_chunks = 0;
+  chunk_firsts = 0;
+  chunk_bytes = 0;
+  decoded_points = 0;
+  decoded_chunks = 0;
+}
+
+LASpointCount::~LASpointCount()
+{
+  close();
+}
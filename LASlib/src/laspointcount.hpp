@@ -0,0 +1,83 @@
+/*
+===============================================================================
+
+  FILE:  laspointcount.hpp
+
+  CONTENTS:
+
+    Answers how many points of a LAS/LAZ file fall into a rectangle before the
+    file is read. The approximate answer comes from the cells of the spatial
+    index (*.lax) alone: the points of the cells inside the rectangle, of the
+    cells overlapping it, an estimate in between, and a coarse bounding box.
+    Together with the chunk table of a LAZ file it also tells how many bytes
+    reading the rectangle would have to decompress.
+
+    The exact answer trusts the cells inside the rectangle whose intervals hold
+    no points of other cells and decodes the coordinates of the other points
+    in cells overlapping the rectangle. Without spatial index the approximate
+    answer is taken from the header and the exact one decodes every point.
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the LICENSE.txt file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created to decide from Java which regions are worth reading
+
+===============================================================================
+*/
+#ifndef LAS_POINT_COUNT_HPP
+#define LAS_POINT_COUNT_HPP
+
+#include "lasdefinitions.hpp"
+
+class LASreaderLAS;
+class LASindex;
+
+class LASLIB_DLL LASpointCount
+{
+public:
+  BOOL open(const CHAR* file_name);
+  inline BOOL has_index() const { return (index != 0); };
+  inline I64 get_number_of_points() const { return npoints; };
+
+  // without decompressing anything. the bounding box (min_x, min_y, max_x, max_y) and the
+  // number of compressed bytes of the chunks holding candidate points are optional.
+  BOOL count_approximate(const F64 min_x, const F64 min_y, const F64 max_x, const F64 max_y, I64* inside, I64* estimate, I64* intersecting, F64* bounding_box=0, I64* bytes=0);
+
+  // decodes only the coordinates of points whose cells do not settle the question.
+  // returns -1 on failure.
+  I64 count_exact(const F64 min_x, const F64 min_y, const F64 max_x, const F64 max_y);
+  inline I64 get_decoded_points() const { return decoded_points; };
+  inline U32 get_decoded_chunks() const { return decoded_chunks; };
+
+  // the bounding box (four values) and the number of points of every cell of the index
+  U32 get_number_cells() const;
+  U32 get_cell_counts(F32* bounding_boxes, U32* counts);
+
+  void close();
+
+  LASpointCount();
+  ~LASpointCount();
+
+private:
+  U32 add_intervals(I64** intervals, U32 number, U32* allocated, const I64 start, const I64 end) const;
+  U32 join_intervals(I64* intervals, U32 number) const;
+  U32 mark_chunks(const I64* intervals, const U32 number, U8* marks) const;
+  LASreaderLAS* lasreader;
+  LASindex* index;
+  I64 npoints;
+  U32 number_chunks;
+  I64* chunk_firsts;
+  U32* chunk_bytes;
+  I64 decoded_points;
+  U32 decoded_chunks;
+};
+
+#endif
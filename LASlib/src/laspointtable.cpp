@@ -0,0 +1,323 @@
+/*
+===============================================================================
+
+  FILE:  laspointtable.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the LICENSE.txt file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "laspointtable.hpp"
+
+#include "lasreader.hpp"
+#include "laswriter.hpp"
+#include "lastransform.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LAS_POINT_TABLE_ALIGNMENT 64
+#define LAS_POINT_TABLE_INITIAL_CAPACITY 1048576
+#define LAS_POINT_TABLE_INVENTORY_BLOCK 1024
+
+static const U32 column_value_size[LAS_COLUMN_NUMBER] = { 4, 4, 4, 2, 1, 1, 1, 1, 2, 1, 2, 8, 2, 2, 2, 2 };
+
+static const U32 column_attribute[LAS_COLUMN_NUMBER] =
+{
+  LASZIP_DECOMPRESS_SELECTIVE_CHANNEL_RETURNS_XY,
+  LASZIP_DECOMPRESS_SELECTIVE_CHANNEL_RETURNS_XY,
+  LASZIP_DECOMPRESS_SELECTIVE_Z,
+  LASZIP_DECOMPRESS_SELECTIVE_INTENSITY,
+  LASZIP_DECOMPRESS_SELECTIVE_CHANNEL_RETURNS_XY,
+  LASZIP_DECOMPRESS_SELECTIVE_CHANNEL_RETURNS_XY,
+  LASZIP_DECOMPRESS_SELECTIVE_CLASSIFICATION,
+  LASZIP_DECOMPRESS_SELECTIVE_FLAGS,
+  LASZIP_DECOMPRESS_SELECTIVE_SCAN_ANGLE,
+  LASZIP_DECOMPRESS_SELECTIVE_USER_DATA,
+  LASZIP_DECOMPRESS_SELECTIVE_POINT_SOURCE,
+  LASZIP_DECOMPRESS_SELECTIVE_GPS_TIME,
+  LASZIP_DECOMPRESS_SELECTIVE_RGB,
+  LASZIP_DECOMPRESS_SELECTIVE_RGB,
+  LASZIP_DECOMPRESS_SELECTIVE_RGB,
+  LASZIP_DECOMPRESS_SELECTIVE_NIR
+};
+
+U32 LASpointTable::get_column_value_size(const U32 column)
+{
+  return (column < LAS_COLUMN_NUMBER ? column_value_size[column] : 0);
+}
+
+void** LASpointTable::get_column_pointer(const U32 column)
+{
+  switch (column)
+  {
+  case LAS_COLUMN_X: return (void**)&columns.X;
+  case LAS_COLUMN_Y: return (void**)&columns.Y;
+  case LAS_COLUMN_Z: return (void**)&columns.Z;
+  case LAS_COLUMN_INTENSITY: return (void**)&columns.intensity;
+  case LAS_COLUMN_RETURN_NUMBER: return (void**)&columns.return_number;
+  case LAS_COLUMN_NUMBER_OF_RETURNS: return (void**)&columns.number_of_returns;
+  case LAS_COLUMN_CLASSIFICATION: return (void**)&columns.classification;
+  case LAS_COLUMN_FLAGS: return (void**)&columns.flags;
+  case LAS_COLUMN_SCAN_ANGLE: return (void**)&columns.scan_angle;
+  case LAS_COLUMN_USER_DATA: return (void**)&columns.user_data;
+  case LAS_COLUMN_POINT_SOURCE_ID: return (void**)&columns.point_source_ID;
+  case LAS_COLUMN_GPS_TIME: return (void**)&columns.gps_time;
+  case LAS_COLUMN_R: return (void**)&columns.R;
+  case LAS_COLUMN_G: return (void**)&columns.G;
+  case LAS_COLUMN_B: return (void**)&columns.B;
+  case LAS_COLUMN_NIR: return (void**)&columns.NIR;
+  }
+  return 0;
+}
+
+void* LASpointTable::get_column(const U32 column, I64* bytes) const
+{
+  void** pointer = ((LASpointTable*)this)->get_column_pointer(column);
+  if ((pointer == 0) || (*pointer == 0))
+  {
+    if (bytes) *bytes = 0;
+    return 0;
+  }
+  if (bytes) *bytes = number_of_points * column_value_size[column];
+  return *pointer;
+}
+
+BOOL LASpointTable::init(const LASheader* header, U32 attributes)
+{
+  clean();
+
+  // drop what the point type does not have
+
+  U8 point_data_format = (header->point_data_format & 0x3F);
+  if ((point_data_format == 0) || (point_data_format == 2))
+  {
+    attributes &= ~LASZIP_DECOMPRESS_SELECTIVE_GPS_TIME;
+  }
+  if ((point_data_format != 2) && (point_data_format != 3) && (point_data_format != 5) && (point_data_format != 7) && (point_data_format != 8) && (point_data_format != 10))
+  {
+    attributes &= ~LASZIP_DECOMPRESS_SELECTIVE_RGB;
+  }
+  if ((point_data_format != 8) && (point_data_format != 10))
+  {
+    attributes &= ~LASZIP_DECOMPRESS_SELECTIVE_NIR;
+  }
+
+  this->attributes = attributes;
+  quantizer = *header;
+  extended = (point_data_format >= 6);
+  return TRUE;
+}
+
+BOOL LASpointTable::reserve(const I64 capacity)
+{
+  if (capacity <= this->capacity)
+  {
+    return TRUE;
+  }
+
+  // one block with every column starting at an aligned offset
+
+  U32 c;
+  I64 offsets[LAS_COLUMN_NUMBER];
+  I64 total = 0;
+  for (c = 0; c < LAS_COLUMN_NUMBER; c++)
+  {
+    if (column_attribute[c] && ((attributes & column_attribute[c]) == 0))
+    {
+      offsets[c] = -1;
+      continue;
+    }
+    offsets[c] = total;
+    total += capacity * column_value_size[c];
+    total = (total + LAS_POINT_TABLE_ALIGNMENT - 1) & ~((I64)LAS_POINT_TABLE_ALIGNMENT - 1);
+  }
+
+  U8* block = (U8*)malloc((size_t)(total + LAS_POINT_TABLE_ALIGNMENT));
+  if (block == 0)
+  {
+    fprintf(stderr,"ERROR: cannot allocate %lld bytes for %lld points\n", total, capacity);
+    return FALSE;
+  }
+  U8* base = (U8*)(((size_t)block + LAS_POINT_TABLE_ALIGNMENT - 1) & ~((size_t)LAS_POINT_TABLE_ALIGNMENT - 1));
+
+  for (c = 0; c < LAS_COLUMN_NUMBER; c++)
+  {
+    void** pointer = get_column_pointer(c);
+    if (offsets[c] < 0)
+    {
+      *pointer = 0;
+      continue;
+    }
+    if (*pointer && number_of_points)
+    {
+      memcpy(base + offsets[c], *pointer, (size_t)(number_of_points * column_value_size[c]));
+    }
+    *pointer = base + offsets[c];
+  }
+
+  if (data) free(data);
+  data = block;
+  this->capacity = capacity;
+  return TRUE;
+}
+
+BOOL LASpointTable::read(const CHAR* file_name, U32 attributes, U32 threads)
+{
+  LAScolumnDecoder decoder;
+  if (!decoder.open(file_name, threads))
+  {
+    return FALSE;
+  }
+  if (!init(decoder.get_header(), attributes) || !reserve(decoder.get_number_of_points()))
+  {
+    clean();
+    return FALSE;
+  }
+  I64 number = decoder.decode(&columns);
+  decoder.close();
+  if (number < 0)
+  {
+    clean();
+    return FALSE;
+  }
+  number_of_points = number;
+  return TRUE;
+}
+
+BOOL LASpointTable::read(LASreader* lasreader, U32 attributes)
+{
+  if (lasreader == 0)
+  {
+    fprintf(stderr,"ERROR: lasreader pointer is zero\n");
+    return FALSE;
+  }
+  init(&lasreader->header, attributes);
+
+  // with a filter or an area of interest the point count of the header is only an upper bound
+
+  I64 initial = LAS_POINT_TABLE_INITIAL_CAPACITY;
+  if ((lasreader->npoints > 0) && (lasreader->get_filter() == 0) && (lasreader->get_inside() == 0))
+  {
+    initial = lasreader->npoints;
+  }
+  if (!reserve(initial))
+  {
+    clean();
+    return FALSE;
+  }
+
+  while (lasreader->read_point())
+  {
+    if (number_of_points == capacity)
+    {
+      if (!reserve(2 * capacity))
+      {
+        clean();
+        return FALSE;
+      }
+    }
+    columns.set(number_of_points, &lasreader->point);
+    number_of_points++;
+  }
+  return TRUE;
+}
+
+BOOL LASpointTable::write(LASwriter* laswriter, const LASheader* header, const BOOL update_inventory) const
+{
+  if ((laswriter == 0) || (header == 0))
+  {
+    fprintf(stderr,"ERROR: laswriter or header pointer is zero\n");
+    return FALSE;
+  }
+
+  LASpoint point;
+  if (!point.init(header, header->point_data_format, header->point_data_record_length, header))
+  {
+    fprintf(stderr,"ERROR: cannot init point of type %d\n", header->point_data_format);
+    return FALSE;
+  }
+
+  // the inventory is updated for blocks of points rather than for every single one
+
+  I32 X[LAS_POINT_TABLE_INVENTORY_BLOCK];
+  I32 Y[LAS_POINT_TABLE_INVENTORY_BLOCK];
+  I32 Z[LAS_POINT_TABLE_INVENTORY_BLOCK];
+  U8 return_numbers[LAS_POINT_TABLE_INVENTORY_BLOCK];
+  U32 block = 0;
+
+  I64 i;
+  for (i = 0; i < number_of_points; i++)
+  {
+    columns.get(i, &point, extended);
+    if (!laswriter->write_point(&point))
+    {
+      fprintf(stderr,"ERROR: cannot write point %lld of %lld\n", i, number_of_points);
+      return FALSE;
+    }
+    if (!update_inventory) continue;
+    X[block] = point.get_X();
+    Y[block] = point.get_Y();
+    Z[block] = point.get_Z();
+    return_numbers[block] = (point.extended_point_type ? point.extended_return_number : point.return_number);
+    block++;
+    if (block == LAS_POINT_TABLE_INVENTORY_BLOCK)
+    {
+      laswriter->inventory.add(X, Y, Z, return_numbers, block);
+      block = 0;
+    }
+  }
+  if (block) laswriter->inventory.add(X, Y, Z, return_numbers, block);
+  return TRUE;
+}
+
+BOOL LASpointTable::transform(LAStransform* lastransform)
+{
+  if (lastransform == 0)
+  {
+    fprintf(stderr,"ERROR: lastransform pointer is zero\n");
+    return FALSE;
+  }
+  return lastransform->transform(&columns, number_of_points, &quantizer, extended);
+}
+
+void LASpointTable::clean()
+{
+  if (data)
+  {
+    free(data);
+    data = 0;
+  }
+  columns = LAScolumns();
+  number_of_points = 0;
+  capacity = 0;
+  attributes = 0;
+  extended = FALSE;
+}
+
+LASpointTable::LASpointTable()
+{
+  data = 0;
+  clean();
+}
+
+LASpointTable::~LASpointTable()
+{
+  clean();
+}
@@ -0,0 +1,114 @@
+/*
+===============================================================================
+
+  FILE:  laspointtable.hpp
+
+  CONTENTS:
+
+    Holds points in memory as columns (one array per attribute) instead of as
+    LASpoint records. Every column starts at a 64 byte boundary so scans over
+    one attribute (heights, classifications, ...) touch only the bytes they
+    need and can be vectorized by the compiler.
+
+    Which attributes are stored is selected with the LASZIP_DECOMPRESS_SELECTIVE_*
+    flags. X, Y, the return number and the number of returns are always there.
+    A LAS/LAZ file is loaded with the multi-threaded LAScolumnDecoder while all
+    other input is loaded from a LASreader (so filters and transforms apply).
+    The table is written back point by point to any LASwriter.
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the LICENSE.txt file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- transform of all points with a (compiled) LAStransform
+    19 October 2026 -- inventory of the written points updated in blocks
+    19 October 2026 -- created for the height statistics and gridding in Java
+
+===============================================================================
+*/
+#ifndef LAS_POINT_TABLE_HPP
+#define LAS_POINT_TABLE_HPP
+
+#include "lasdefinitions.hpp"
+#include "lascolumndecoder.hpp"
+#include "laszip_decompress_selective_v3.hpp"
+
+class LASreader;
+class LASwriter;
+class LAStransform;
+
+#define LAS_COLUMN_X                  0
+#define LAS_COLUMN_Y                  1
+#define LAS_COLUMN_Z                  2
+#define LAS_COLUMN_INTENSITY          3
+#define LAS_COLUMN_RETURN_NUMBER      4
+#define LAS_COLUMN_NUMBER_OF_RETURNS  5
+#define LAS_COLUMN_CLASSIFICATION     6
+#define LAS_COLUMN_FLAGS              7
+#define LAS_COLUMN_SCAN_ANGLE         8
+#define LAS_COLUMN_USER_DATA          9
+#define LAS_COLUMN_POINT_SOURCE_ID   10
+#define LAS_COLUMN_GPS_TIME          11
+#define LAS_COLUMN_R                 12
+#define LAS_COLUMN_G                 13
+#define LAS_COLUMN_B                 14
+#define LAS_COLUMN_NIR               15
+#define LAS_COLUMN_NUMBER            16
+
+class LASLIB_DLL LASpointTable
+{
+public:
+  LASquantizer quantizer;
+  BOOL extended;   // values follow the conventions of point types 6 and higher
+
+  // load a LAS/LAZ file with several threads (with 0 meaning one thread per core)
+  BOOL read(const CHAR* file_name, U32 attributes=LASZIP_DECOMPRESS_SELECTIVE_ALL, U32 threads=0);
+
+  // load all (remaining) points of a reader
+  BOOL read(LASreader* lasreader, U32 attributes=LASZIP_DECOMPRESS_SELECTIVE_ALL);
+
+  // write all points. the point type of the header decides which attributes are written.
+  // with update_inventory the points are also added to the inventory of the writer, so
+  // the caller must not call update_inventory() for them again.
+  BOOL write(LASwriter* laswriter, const LASheader* header, const BOOL update_inventory=TRUE) const;
+
+  // apply the operations to all points. compile the transform first to have the fused
+  // coordinate, classification, and user data operations run over whole columns.
+  BOOL transform(LAStransform* lastransform);
+
+  inline I64 get_number_of_points() const { return number_of_points; };
+  inline U32 get_attributes() const { return attributes; };
+  inline const LAScolumns* get_columns() const { return &columns; };
+
+  // one of the LAS_COLUMN_* arrays (or NULL if not stored) and its size in bytes
+  void* get_column(const U32 column, I64* bytes=0) const;
+  static U32 get_column_value_size(const U32 column);
+
+  inline F64 get_x(const I64 index) const { return quantizer.get_x(columns.X[index]); };
+  inline F64 get_y(const I64 index) const { return quantizer.get_y(columns.Y[index]); };
+  inline F64 get_z(const I64 index) const { return quantizer.get_z(columns.Z[index]); };
+
+  void clean();
+
+  LASpointTable();
+  ~LASpointTable();
+
+private:
+  BOOL init(const LASheader* header, U32 attributes);
+  BOOL reserve(const I64 capacity);
+  void** get_column_pointer(const U32 column);
+  I64 number_of_points;
+  I64 capacity;
+  U32 attributes;
+  U8* data;
+  LAScolumns columns;
+};
+
+#endif
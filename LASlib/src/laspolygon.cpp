@@ -0,0 +1,599 @@
+/*
+===============================================================================
+
+  FILE:  laspolygon.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the LICENSE.txt file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "laspolygon.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+// shapefiles mix big and little endian integers and little endian doubles
+
+static I32 get_big_endian_int(const U8* bytes)
+{
+  return (I32)(((U32)bytes[0] << 24) | ((U32)bytes[1] << 16) | ((U32)bytes[2] << 8) | (U32)bytes[3]);
+}
+
+static I32 get_little_endian_int(const U8* bytes)
+{
+  return (I32)(((U32)bytes[3] << 24) | ((U32)bytes[2] << 16) | ((U32)bytes[1] << 8) | (U32)bytes[0]);
+}
+
+static F64 get_little_endian_double(const U8* bytes)
+{
+  U64 bits = 0;
+  I32 i;
+  for (i = 7; i >= 0; i--) bits = (bits << 8) | bytes[i];
+  F64 value;
+  memcpy(&value, &bits, sizeof(F64));
+  return value;
+}
+
+// twice the signed area. positive for counterclockwise rings.
+
+static F64 get_ring_area(const F64* xy, const U32 number)
+{
+  F64 area = 0.0;
+  U32 i, j;
+  for (i = 0; i < number; i++)
+  {
+    j = (i + 1 < number ? i + 1 : 0);
+    area += (xy[2*i] - xy[0]) * (xy[2*j+1] - xy[1]) - (xy[2*j] - xy[0]) * (xy[2*i+1] - xy[1]);
+  }
+  return area;
+}
+
+static const CHAR* skip_spaces(const CHAR* p)
+{
+  while (*p && isspace((unsigned char)*p)) p++;
+  return p;
+}
+
+BOOL LASpolygon::add_ring(const F64* xy, U32 number, const BOOL hole)
+{
+  if ((number > 1) && (xy[0] == xy[2*(number-1)]) && (xy[1] == xy[2*(number-1)+1]))
+  {
+    number--;
+  }
+  if (number < 3)
+  {
+    fprintf(stderr,"WARNING: ignoring ring with only %u vertices\n", number);
+    return FALSE;
+  }
+
+  clean_grid();
+
+  if (number_rings + 1 >= allocated_rings)
+  {
+    allocated_rings = (allocated_rings ? 2 * allocated_rings : 16);
+    ring_starts = (U32*)realloc(ring_starts, sizeof(U32)*allocated_rings);
+  }
+  if (number_vertices + number > allocated_vertices)
+  {
+    while (number_vertices + number > allocated_vertices) allocated_vertices = (allocated_vertices ? 2 * allocated_vertices : 1024);
+    vertices = (F64*)realloc(vertices, sizeof(F64)*2*allocated_vertices);
+  }
+
+  // outer rings counterclockwise and holes clockwise
+
+  F64 area = get_ring_area(xy, number);
+  BOOL reverse = (hole ? (area > 0.0) : (area < 0.0));
+  U32 i;
+  for (i = 0; i < number; i++)
+  {
+    const F64* v = (reverse ? &xy[2*(number-1-i)] : &xy[2*i]);
+    vertices[2*(number_vertices+i)] = v[0];
+    vertices[2*(number_vertices+i)+1] = v[1];
+    if (number_rings == 0 && i == 0)
+    {
+      min_x = max_x = v[0];
+      min_y = max_y = v[1];
+    }
+    else
+    {
+      if (v[0] < min_x) min_x = v[0]; else if (v[0] > max_x) max_x = v[0];
+      if (v[1] < min_y) min_y = v[1]; else if (v[1] > max_y) max_y = v[1];
+    }
+  }
+  ring_starts[number_rings] = number_vertices;
+  number_vertices += number;
+  number_rings++;
+  ring_starts[number_rings] = number_vertices;
+  return TRUE;
+}
+
+// parses '((x y, x y, ...), (x y, ...))' where the first ring is the outer one
+
+const CHAR* LASpolygon::parse_rings(const CHAR* p)
+{
+  p = skip_spaces(p);
+  if (*p != '(') return 0;
+  p++;
+
+  F64* xy = 0;
+  U32 number = 0;
+  U32 allocated = 0;
+  U32 ring = 0;
+  while (TRUE)
+  {
+    p = skip_spaces(p);
+    if (*p != '(') break;
+    p++;
+    number = 0;
+    while (TRUE)
+    {
+      CHAR* end;
+      F64 x = strtod(p, &end);
+      if (end == p) break;
+      p = end;
+      F64 y = strtod(p, &end);
+      if (end == p) break;
+      p = end;
+      // a Z or M value is ignored
+      while (TRUE)
+      {
+        strtod(p, &end);
+        if (end == p) break;
+        p = end;
+      }
+      if (number == allocated)
+      {
+        allocated = (allocated ? 2 * allocated : 64);
+        xy = (F64*)realloc(xy, sizeof(F64)*2*allocated);
+      }
+      xy[2*number] = x;
+      xy[2*number+1] = y;
+      number++;
+      p = skip_spaces(p);
+      if (*p != ',') break;
+      p++;
+    }
+    p = skip_spaces(p);
+    if (*p != ')') break;
+    p++;
+    add_ring(xy, number, (ring > 0));
+    ring++;
+    p = skip_spaces(p);
+    if (*p == ',')
+    {
+      p++;
+      continue;
+    }
+    if (*p == ')')
+    {
+      if (xy) free(xy);
+      return p + 1;
+    }
+    break;
+  }
+  if (xy) free(xy);
+  return 0;
+}
+
+BOOL LASpolygon::parse_wkt(const CHAR* wkt)
+{
+  if (wkt == 0)
+  {
+    fprintf(stderr,"ERROR: WKT pointer is zero\n");
+    return FALSE;
+  }
+
+  const CHAR* p = skip_spaces(wkt);
+  BOOL multi;
+  if (strncmp(p, "MULTIPOLYGON", 12) == 0 || strncmp(p, "multipolygon", 12) == 0)
+  {
+    multi = TRUE;
+    p += 12;
+  }
+  else if (strncmp(p, "POLYGON", 7) == 0 || strncmp(p, "polygon", 7) == 0)
+  {
+    multi = FALSE;
+    p += 7;
+  }
+  else
+  {
+    fprintf(stderr,"ERROR: WKT '%.32s' is neither POLYGON nor MULTIPOLYGON\n", p);
+    return FALSE;
+  }
+  p = skip_spaces(p);
+  while (isalpha((unsigned char)*p)) p++; // Z, M, or ZM
+  p = skip_spaces(p);
+  if (strncmp(p, "EMPTY", 5) == 0 || strncmp(p, "empty", 5) == 0)
+  {
+    return TRUE;
+  }
+
+  if (multi)
+  {
+    if (*p != '(')
+    {
+      fprintf(stderr,"ERROR: WKT MULTIPOLYGON misses '('\n");
+      return FALSE;
+    }
+    p++;
+    while (TRUE)
+    {
+      p = parse_rings(p);
+      if (p == 0) break;
+      p = skip_spaces(p);
+      if (*p == ',')
+      {
+        p++;
+        continue;
+      }
+      if (*p == ')') return TRUE;
+      break;
+    }
+  }
+  else if (parse_rings(p))
+  {
+    return TRUE;
+  }
+  fprintf(stderr,"ERROR: cannot parse the rings of the WKT polygon\n");
+  return FALSE;
+}
+
+BOOL LASpolygon::read_shp(const CHAR* file_name)
+{
+  if (file_name == 0)
+  {
+    fprintf(stderr,"ERROR: file name pointer is zero\n");
+    return FALSE;
+  }
+
+  FILE* file = fopen(file_name, "rb");
+  if (file == 0)
+  {
+    fprintf(stderr,"ERROR: cannot open shapefile '%s'\n", file_name);
+    return FALSE;
+  }
+
+  U8 header[100];
+  if (fread(header, 1, 100, file) != 100)
+  {
+    fprintf(stderr,"ERROR: cannot read header of shapefile '%s'\n", file_name);
+    fclose(file);
+    return FALSE;
+  }
+  if (get_big_endian_int(header) != 9994)
+  {
+    fprintf(stderr,"ERROR: wrong shapefile code %d != 9994\n", get_big_endian_int(header));
+    fclose(file);
+    return FALSE;
+  }
+  I32 shape_type = get_little_endian_int(&header[32]);
+  if (shape_type != 5 && shape_type != 15 && shape_type != 25)
+  {
+    fprintf(stderr,"ERROR: wrong shape type %d != 5,15,25\n", shape_type);
+    fclose(file);
+    return FALSE;
+  }
+
+  U8 record[8];
+  U8* content = 0;
+  U32 allocated_content = 0;
+  F64* xy = 0;
+  U32 allocated_xy = 0;
+  BOOL success = TRUE;
+  while (fread(record, 1, 8, file) == 8)
+  {
+    U32 bytes = 2 * (U32)get_big_endian_int(&record[4]);
+    if (bytes > allocated_content)
+    {
+      allocated_content = bytes;
+      content = (U8*)realloc(content, allocated_content);
+    }
+    if (fread(content, 1, bytes, file) != bytes)
+    {
+      fprintf(stderr,"ERROR: truncated record %d in shapefile '%s'\n", get_big_endian_int(record), file_name);
+      success = FALSE;
+      break;
+    }
+    if ((bytes < 4) || (get_little_endian_int(content) == 0)) continue; // null shape
+    if (bytes < 44)
+    {
+      fprintf(stderr,"ERROR: record %d in shapefile '%s' is too short\n", get_big_endian_int(record), file_name);
+      success = FALSE;
+      break;
+    }
+    U32 number_parts = (U32)get_little_endian_int(&content[36]);
+    U32 number_points = (U32)get_little_endian_int(&content[40]);
+    if (44 + 4*(U64)number_parts + 16*(U64)number_points > bytes)
+    {
+      fprintf(stderr,"ERROR: record %d in shapefile '%s' has %u parts and %u points in %u bytes\n", get_big_endian_int(record), file_name, number_parts, number_points, bytes);
+      success = FALSE;
+      break;
+    }
+    if (number_points > allocated_xy)
+    {
+      allocated_xy = number_points;
+      xy = (F64*)realloc(xy, sizeof(F64)*2*allocated_xy);
+    }
+    const U8* points = &content[44 + 4*number_parts];
+    U32 i, p, start, end;
+    for (i = 0; i < 2*number_points; i++)
+    {
+      xy[i] = get_little_endian_double(&points[8*i]);
+    }
+    for (p = 0; p < number_parts; p++)
+    {
+      start = (U32)get_little_endian_int(&content[44 + 4*p]);
+      end = (p + 1 < number_parts ? (U32)get_little_endian_int(&content[44 + 4*(p+1)]) : number_points);
+      if ((start >= end) || (end > number_points)) continue;
+      // the outer rings of shapefiles are clockwise
+      add_ring(&xy[2*start], end - start, (get_ring_area(&xy[2*start], end - start) > 0.0));
+    }
+  }
+  if (content) free(content);
+  if (xy) free(xy);
+  fclose(file);
+  return success;
+}
+
+BOOL LASpolygon::read(const CHAR* source)
+{
+  if (source == 0)
+  {
+    fprintf(stderr,"ERROR: polygon source pointer is zero\n");
+    return FALSE;
+  }
+  const CHAR* p = skip_spaces(source);
+  if (strncmp(p, "POLYGON", 7) == 0 || strncmp(p, "polygon", 7) == 0 || strncmp(p, "MULTIPOLYGON", 12) == 0 || strncmp(p, "multipolygon", 12) == 0)
+  {
+    return parse_wkt(p);
+  }
+  size_t len = strlen(source);
+  if ((len > 4) && (strcmp(&source[len-4], ".shp") == 0 || strcmp(&source[len-4], ".SHP") == 0))
+  {
+    return read_shp(source);
+  }
+
+  FILE* file = fopen(source, "rb");
+  if (file == 0)
+  {
+    fprintf(stderr,"ERROR: '%s' is neither WKT nor a file that can be opened\n", source);
+    return FALSE;
+  }
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  CHAR* wkt = (CHAR*)malloc(size + 1);
+  size_t read = fread(wkt, 1, size, file);
+  wkt[read] = '\0';
+  fclose(file);
+  BOOL success = parse_wkt(wkt);
+  free(wkt);
+  return success;
+}
+
+void LASpolygon::prepare(U32 max_cells)
+{
+  clean_grid();
+
+  if (number_rings == 0)
+  {
+    // an empty bounding box that nothing is inside of
+    min_x = min_y = max_x = max_y = 0.0;
+    cols = rows = 1;
+    cell_size = 1.0;
+    flags = (U8*)calloc(1, sizeof(U8));
+    row_starts = (U32*)calloc(2, sizeof(U32));
+    return;
+  }
+
+  // about four cells per edge
+
+  F64 width = max_x - min_x;
+  F64 height = max_y - min_y;
+  F64 target = 4.0 * number_vertices;
+  if (target > max_cells) target = max_cells;
+  if (target < 1.0) target = 1.0;
+  cell_size = sqrt(width * height / target);
+  if (cell_size < width / target) cell_size = width / target;
+  if (cell_size < height / target) cell_size = height / target;
+  if (cell_size <= 0.0) cell_size = 1.0;
+  cols = (U32)(width / cell_size) + 1;
+  rows = (U32)(height / cell_size) + 1;
+
+  U32 r, v, e;
+  edge_ends = (U32*)malloc(sizeof(U32)*number_vertices);
+  for (r = 0; r < number_rings; r++)
+  {
+    for (v = ring_starts[r]; v < ring_starts[r+1]; v++)
+    {
+      edge_ends[v] = (v + 1 < ring_starts[r+1] ? v + 1 : ring_starts[r]);
+    }
+  }
+
+  // the rows of cells each edge spans, widened by one against rounding
+
+  U32* first_rows = (U32*)malloc(sizeof(U32)*number_vertices);
+  U32* last_rows = (U32*)malloc(sizeof(U32)*number_vertices);
+  row_starts = (U32*)calloc(rows + 1, sizeof(U32));
+  for (v = 0; v < number_vertices; v++)
+  {
+    F64 y1 = vertices[2*v+1];
+    F64 y2 = vertices[2*edge_ends[v]+1];
+    U32 first = get_row(y1 < y2 ? y1 : y2);
+    U32 last = get_row(y1 < y2 ? y2 : y1);
+    first_rows[v] = (first ? first - 1 : 0);
+    last_rows[v] = (last + 1 < rows ? last + 1 : rows - 1);
+    for (r = first_rows[v]; r <= last_rows[v]; r++) row_starts[r+1]++;
+  }
+  for (r = 0; r < rows; r++) row_starts[r+1] += row_starts[r];
+  row_edges = (U32*)malloc(sizeof(U32)*(row_starts[rows] ? row_starts[rows] : 1));
+  U32* next = (U32*)malloc(sizeof(U32)*rows);
+  memcpy(next, row_starts, sizeof(U32)*rows);
+
+  // the cells the edges pass through
+
+  flags = (U8*)calloc((size_t)cols*rows, sizeof(U8));
+  U32 c, first_col, last_col;
+  for (v = 0; v < number_vertices; v++)
+  {
+    F64 x1 = vertices[2*v];
+    F64 y1 = vertices[2*v+1];
+    F64 x2 = vertices[2*edge_ends[v]];
+    F64 y2 = vertices[2*edge_ends[v]+1];
+    for (r = first_rows[v]; r <= last_rows[v]; r++)
+    {
+      row_edges[next[r]++] = v;
+      F64 xa = x1, xb = x2;
+      if (y1 != y2)
+      {
+        F64 ta = (min_y + r*cell_size - y1) / (y2 - y1);
+        F64 tb = (min_y + (r+1)*cell_size - y1) / (y2 - y1);
+        if (ta < 0.0) ta = 0.0; else if (ta > 1.0) ta = 1.0;
+        if (tb < 0.0) tb = 0.0; else if (tb > 1.0) tb = 1.0;
+        xa = x1 + ta * (x2 - x1);
+        xb = x1 + tb * (x2 - x1);
+      }
+      first_col = get_col(xa < xb ? xa : xb);
+      last_col = get_col(xa < xb ? xb : xa);
+      if (first_col) first_col--;
+      if (last_col + 1 < cols) last_col++;
+      for (c = first_col; c <= last_col; c++) flags[r*cols + c] = LAS_POLYGON_BOUNDARY;
+    }
+  }
+  free(next);
+  free(first_rows);
+  free(last_rows);
+
+  // a run of cells in a row without edges is entirely inside or entirely outside
+
+  for (r = 0; r < rows; r++)
+  {
+    F64 y = min_y + (r + 0.5) * cell_size;
+    U8 flag = LAS_POLYGON_BOUNDARY;
+    for (c = 0; c < cols; c++)
+    {
+      e = r*cols + c;
+      if (flags[e] == LAS_POLYGON_BOUNDARY)
+      {
+        flag = LAS_POLYGON_BOUNDARY;
+        continue;
+      }
+      if (flag == LAS_POLYGON_BOUNDARY)
+      {
+        flag = (get_winding(r, min_x + (c + 0.5) * cell_size, y) ? LAS_POLYGON_INSIDE : LAS_POLYGON_OUTSIDE);
+      }
+      flags[e] = flag;
+    }
+  }
+}
+
+// the winding number of the ray from (x, y) to the right counted with the edges of the row
+
+I32 LASpolygon::get_winding(const U32 row, const F64 x, const F64 y) const
+{
+  I32 winding = 0;
+  U32 e, v, w;
+  for (e = row_starts[row]; e < row_starts[row+1]; e++)
+  {
+    v = row_edges[e];
+    w = edge_ends[v];
+    const F64 x1 = vertices[2*v];
+    const F64 y1 = vertices[2*v+1];
+    const F64 x2 = vertices[2*w];
+    const F64 y2 = vertices[2*w+1];
+    if (y1 <= y)
+    {
+      if ((y2 > y) && (x < x1 + (y - y1) * (x2 - x1) / (y2 - y1))) winding++;
+    }
+    else if (y2 <= y)
+    {
+      if (x < x1 + (y - y1) * (x2 - x1) / (y2 - y1)) winding--;
+    }
+  }
+  return winding;
+}
+
+void LASpolygon::clean_grid()
+{
+  if (flags)
+  {
+    free(flags);
+    flags = 0;
+  }
+  if (row_starts)
+  {
+    free(row_starts);
+    row_starts = 0;
+  }
+  if (row_edges)
+  {
+    free(row_edges);
+    row_edges = 0;
+  }
+  if (edge_ends)
+  {
+    free(edge_ends);
+    edge_ends = 0;
+  }
+  cols = rows = 0;
+}
+
+void LASpolygon::clean()
+{
+  clean_grid();
+  if (ring_starts)
+  {
+    free(ring_starts);
+    ring_starts = 0;
+  }
+  if (vertices)
+  {
+    free(vertices);
+    vertices = 0;
+  }
+  number_rings = 0;
+  allocated_rings = 0;
+  number_vertices = 0;
+  allocated_vertices = 0;
+  min_x = min_y = max_x = max_y = 0.0;
+}
+
+LASpolygon::LASpolygon()
+{
+  number_rings = 0;
+  allocated_rings = 0;
+  ring_starts = 0;
+  number_vertices = 0;
+  allocated_vertices = 0;
+  vertices = 0;
+  min_x = min_y = max_x = max_y = 0.0;
+  cell_size = 1.0;
+  cols = rows = 0;
+  flags = 0;
+  row_starts = 0;
+  row_edges = 0;
+  edge_ends = 0;
+}
+
+LASpolygon::~LASpolygon()
+{
+  clean();
+}
@@ -0,0 +1,105 @@
+/*
+===============================================================================
+
+  FILE:  laspolygon.hpp
+
+  CONTENTS:
+
+    A (multi-)polygon with holes that is prepared for many point-in-polygon
+    tests. The rings come from WKT (POLYGON or MULTIPOLYGON) or from the
+    polygons of an ESRI shapefile. Outer rings are stored counterclockwise
+    and holes clockwise so that a non-zero winding number means inside. This
+    also gives the union of overlapping polygons.
+
+    The bounding box is divided into a grid of cells. Cells that no edge passes
+    through are entirely inside or entirely outside, which is decided once,
+    so most points are answered with a single lookup. For the other cells the
+    winding number is computed with the edges of the row of cells only.
+
+    Points on the lower left boundary are inside and those on the upper right
+    are outside, like for '-keep_xy'.
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the LICENSE.txt file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created to clip building footprints while reading
+
+===============================================================================
+*/
+#ifndef LAS_POLYGON_HPP
+#define LAS_POLYGON_HPP
+
+#include "lasdefinitions.hpp"
+
+#define LAS_POLYGON_OUTSIDE   0
+#define LAS_POLYGON_INSIDE    1
+#define LAS_POLYGON_BOUNDARY  2
+
+class LASLIB_DLL LASpolygon
+{
+public:
+  // the ring is closed implicitly. a repeated first vertex at the end is ignored.
+  BOOL add_ring(const F64* xy, U32 number, const BOOL hole);
+
+  // 'POLYGON ((...), (...))' or 'MULTIPOLYGON (((...)), ((...)))' with optional Z or M values
+  BOOL parse_wkt(const CHAR* wkt);
+
+  // all polygons (shape types 5, 15, and 25) of the shapefile
+  BOOL read_shp(const CHAR* file_name);
+
+  // WKT, the name of a shapefile, or the name of a file with WKT
+  BOOL read(const CHAR* source);
+
+  // builds the grid. must be called after the last ring was added and before is_inside().
+  void prepare(U32 max_cells=1048576);
+  inline BOOL is_prepared() const { return (flags != 0); };
+
+  inline BOOL is_inside(const F64 x, const F64 y) const
+  {
+    if ((x < min_x) || (x >= max_x) || (y < min_y) || (y >= max_y)) return FALSE;
+    U32 col = get_col(x);
+    U32 row = get_row(y);
+    U8 flag = flags[row*cols + col];
+    if (flag != LAS_POLYGON_BOUNDARY) return flag;
+    return (get_winding(row, x, y) != 0);
+  };
+
+  inline U32 get_number_rings() const { return number_rings; };
+  inline U32 get_number_vertices() const { return number_vertices; };
+  inline BOOL get_bounding_box(F64* min_max) const { min_max[0] = min_x; min_max[1] = min_y; min_max[2] = max_x; min_max[3] = max_y; return (number_rings != 0); };
+
+  void clean();
+
+  LASpolygon();
+  ~LASpolygon();
+
+private:
+  inline U32 get_col(const F64 x) const { I32 col = (I32)((x - min_x) / cell_size); return (col < 0 ? 0 : (col >= (I32)cols ? cols - 1 : col)); };
+  inline U32 get_row(const F64 y) const { I32 row = (I32)((y - min_y) / cell_size); return (row < 0 ? 0 : (row >= (I32)rows ? rows - 1 : row)); };
+  I32 get_winding(const U32 row, const F64 x, const F64 y) const;
+  const CHAR* parse_rings(const CHAR* p);
+  void clean_grid();
+  U32 number_rings;
+  U32 allocated_rings;
+  U32* ring_starts;      // into the vertices with one more entry at the end
+  U32 number_vertices;
+  U32 allocated_vertices;
+  F64* vertices;         // x and y interleaved
+  F64 min_x, min_y, max_x, max_y;
+  F64 cell_size;
+  U32 cols, rows;
+  U8* flags;             // per cell inside, outside, or boundary
+  U32* row_starts;       // the edges crossing each row stored consecutively
+  U32* row_edges;        // as the index of their first vertex
+  U32* edge_ends;        // the index of the second vertex of every edge
+};
+
+#endif
@@ -0,0 +1,75 @@
+/*
+===============================================================================
+
+  FILE:  lasrandom.hpp
+
+  CONTENTS:
+
+    Counter-based random numbers for filters and transforms. The n-th number
+    of a seed is computed directly by mixing seed and counter with the SplitMix64
+    finalizer, so there is no state to carry from one point to the next, no
+    global lock as with rand(), and the same numbers come out no matter how
+    the points are split into chunks or across threads.
+
+    For a point the counter is a key made from its raw coordinates, its GPS
+    time, and its return number. A point therefore gets the same number in a
+    sequential read, a spatially indexed query, or a multi-threaded decode.
+    Points that agree in all of these also get the same number.
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the LICENSE.txt file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created to take rand() out of random subsampling and jitter
+
+===============================================================================
+*/
+#ifndef LAS_RANDOM_HPP
+#define LAS_RANDOM_HPP
+
+#include "lasdefinitions.hpp"
+
+#include <string.h>
+
+class LASrandom
+{
+public:
+  static inline U64 mix(U64 z)
+  {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  };
+
+  // the number with the given counter in the sequence of the seed
+  static inline U64 get(const U64 seed, const U64 counter)
+  {
+    return mix(mix(seed + 0x9E3779B97F4A7C15ULL) + counter * 0x9E3779B97F4A7C15ULL);
+  };
+
+  static inline U64 get_key(const LASpoint* point)
+  {
+    U64 gps_time;
+    memcpy(&gps_time, &point->gps_time, sizeof(U64));
+    U64 key = mix(((U64)(U32)point->get_X() << 32) | (U64)(U32)point->get_Y());
+    key = mix(key ^ (((U64)(U32)point->get_Z() << 8) | (point->extended_point_type ? point->extended_return_number : point->return_number)));
+    return key ^ gps_time;
+  };
+
+  static inline U64 get(const U64 seed, const LASpoint* point) { return get(seed, get_key(point)); };
+
+  // uniform in [0,1) from the upper 53 bits
+  static inline F64 get_fraction(const U64 random) { return (F64)(random >> 11) * (1.0/9007199254740992.0); };
+
+  // uniform in [0,range) from 32 of the bits without a division
+  static inline U32 get_below(const U32 random, const U32 range) { return (U32)(((U64)random * range) >> 32); };
+};
+
+#endif
@@ -31,6 +31,7 @@
 #include "lasreader.hpp"
 
 #include "lasindex.hpp"
+#include "laschunkstats.hpp"
 #include "lasfilter.hpp"
 #include "lastransform.hpp"
 
@@ -58,6 +59,9 @@ LASreader::LASreader()
   read_simple = &LASreader::read_point_default;
   read_complex = 0;
   index = 0;
+  chunk_stats = 0;
+  chunk_first = 0;
+  chunk_end = 0;
   filter = 0;
   transform = 0;
   inside = 0;
@@ -83,6 +87,7 @@ LASreader::LASreader()
 LASreader::~LASreader()
 {
   if (index) delete index;
+  if (chunk_stats) delete chunk_stats;
 }
 
 void LASreader::set_index(LASindex* index)
@@ -91,6 +96,14 @@ void LASreader::set_index(LASindex* index)
   this->index = index;
 }
 
+void LASreader::set_chunk_stats(LASchunkStats* chunk_stats)
+{
+  if (this->chunk_stats) delete this->chunk_stats;
+  this->chunk_stats = chunk_stats;
+  chunk_first = 0;
+  chunk_end = 0;
+}
+
 void LASreader::set_filter(LASfilter* filter)
 {
   this->filter = filter;
@@ -377,13 +390,40 @@ BOOL LASreader::read_point_none()
   return FALSE;
 }
 
+// seeks past the chunks whose points would all be filtered. the area-of-interest
+// queries seek on their own so there it is left to them.
+
+BOOL LASreader::skip_filtered_chunks()
+{
+  U32 number = chunk_stats->get_number_chunks();
+  U32 c = chunk_stats->get_chunk_index(p_count);
+  while ((c < number) && filter->filter_chunk(chunk_stats->get_chunk(c))) c++;
+  if (c == number)
+  {
+    chunk_first = 0;
+    chunk_end = 0;
+    return (p_count < chunk_stats->get_first(c) ? FALSE : TRUE);
+  }
+  if (p_count < chunk_stats->get_first(c))
+  {
+    if (!seek(chunk_stats->get_first(c))) return FALSE;
+  }
+  chunk_first = chunk_stats->get_first(c);
+  chunk_end = chunk_stats->get_first(c+1);
+  return TRUE;
+}
+
 BOOL LASreader::read_point_filtered()
 {
-  while ((this->*read_complex)())
+  while (TRUE)
   {
+    if (chunk_stats && ((p_count >= chunk_end) || (p_count < chunk_first)) && (inside == 0))
+    {
+      if (!skip_filtered_chunks()) return FALSE;
+    }
+    if (!(this->*read_complex)()) return FALSE;
     if (!filter->filter(&point)) return TRUE;
   }
-  return FALSE;
 }
 
 BOOL LASreader::read_point_transformed()
@@ -434,6 +474,7 @@ I32 LASreadOpener::unparse(CHAR* string) const
   if (stored)
   {
     n += sprintf(string + n, "-stored ");
+    if (stored_megabytes != LAS_READER_STORED_MAX_MEGABYTES) n += sprintf(string + n, "-stored_memory %u ", stored_megabytes);
   }
   if (merged)
   {
@@ -537,6 +578,7 @@ LASreader* LASreadOpener::open(const CHAR* other_file_name, BOOL reset_after_oth
       lasreadermerged->set_translate_scan_angle(translate_scan_angle);
       lasreadermerged->set_scale_scan_angle(scale_scan_angle);
       lasreadermerged->set_io_ibuffer_size(io_ibuffer_size);
+      lasreadermerged->set_decompress_selective(decompress_selective);
       for (file_name_current = 0; file_name_current < file_name_number; file_name_current++) lasreadermerged->add_file_name(file_names[file_name_current]);
       if (!lasreadermerged->open())
       {
@@ -555,6 +597,7 @@ LASreader* LASreadOpener::open(const CHAR* other_file_name, BOOL reset_after_oth
       if (stored)
       {
         LASreaderStored* lasreaderstored = new LASreaderStored();
+        lasreaderstored->set_spill(stored_megabytes, temp_file_base);
         if (!lasreaderstored->open(lasreadermerged))
         {
           fprintf(stderr, "ERROR: could not open lasreaderstored with lasreadermerged\n");
@@ -640,6 +683,7 @@ LASreader* LASreadOpener::open(const CHAR* other_file_name, BOOL reset_after_oth
       if (stored)
       {
         LASreaderStored* lasreaderstored = new LASreaderStored();
+        lasreaderstored->set_spill(stored_megabytes, temp_file_base);
         if (!lasreaderstored->open(lasreaderbuffered))
         {
           fprintf(stderr, "ERROR: could not open lasreaderstored with lasreaderbuffered\n");
@@ -719,6 +763,27 @@ LASreader* LASreadOpener::open(const CHAR* other_file_name, BOOL reset_after_oth
           lasreaderlas->set_index(index);
         else
           delete index;
+        if (filter && (scale_factor == 0) && (offset == 0))
+        {
+          // the chunk statistics hold coordinates in the scale and offset of the file
+          LASchunkStats* chunk_stats = new LASchunkStats();
+          if (chunk_stats->read(file_name) && chunk_stats->matches(&lasreaderlas->header))
+          {
+            lasreaderlas->set_chunk_stats(chunk_stats);
+          }
+          else
+          {
+            if (chunk_stats->get_number_chunks())
+            {
+#ifdef _WIN32
+              fprintf(stderr,"WARNING: ignoring chunk statistics of %I64d points that do not fit the header of '%s'\n", chunk_stats->get_number_of_points(), file_name);
+#else
+              fprintf(stderr,"WARNING: ignoring chunk statistics of %lld points that do not fit the header of '%s'\n", chunk_stats->get_number_of_points(), file_name);
+#endif
+            }
+            delete chunk_stats;
+          }
+        }
         if (files_are_flightlines)
         {
           lasreaderlas->header.file_source_ID = file_name_current + files_are_flightlines + files_are_flightlines_index;
@@ -736,6 +801,7 @@ LASreader* LASreadOpener::open(const CHAR* other_file_name, BOOL reset_after_oth
         if (stored)
         {
           LASreaderStored* lasreaderstored = new LASreaderStored();
+          lasreaderstored->set_spill(stored_megabytes, temp_file_base);
           if (!lasreaderstored->open(lasreaderlas))
           {
             fprintf(stderr, "ERROR: could not open lasreaderstored with lasreaderlas\n");
@@ -796,6 +862,7 @@ LASreader* LASreadOpener::open(const CHAR* other_file_name, BOOL reset_after_oth
         if (stored)
         {
           LASreaderStored* lasreaderstored = new LASreaderStored();
+          lasreaderstored->set_spill(stored_megabytes, temp_file_base);
           if (!lasreaderstored->open(lasreaderbin))
           {
             fprintf(stderr, "ERROR: could not open lasreaderstored with lasreaderbin\n");
@@ -851,6 +918,7 @@ LASreader* LASreadOpener::open(const CHAR* other_file_name, BOOL reset_after_oth
         if (stored)
         {
           LASreaderStored* lasreaderstored = new LASreaderStored();
+          lasreaderstored->set_spill(stored_megabytes, temp_file_base);
           if (!lasreaderstored->open(lasreadershp))
           {
             fprintf(stderr, "ERROR: could not open lasreaderstored with lasreadershp\n");
@@ -906,6 +974,7 @@ LASreader* LASreadOpener::open(const CHAR* other_file_name, BOOL reset_after_oth
         if (stored)
         {
           LASreaderStored* lasreaderstored = new LASreaderStored();
+          lasreaderstored->set_spill(stored_megabytes, temp_file_base);
           if (!lasreaderstored->open(lasreaderasc))
           {
             fprintf(stderr, "ERROR: could not open lasreaderstored with lasreaderasc\n");
@@ -961,6 +1030,7 @@ LASreader* LASreadOpener::open(const CHAR* other_file_name, BOOL reset_after_oth
         if (stored)
         {
           LASreaderStored* lasreaderstored = new LASreaderStored();
+          lasreaderstored->set_spill(stored_megabytes, temp_file_base);
           if (!lasreaderstored->open(lasreaderbil))
           {
             fprintf(stderr, "ERROR: could not open lasreaderstored with lasreaderbil\n");
@@ -1016,6 +1086,7 @@ LASreader* LASreadOpener::open(const CHAR* other_file_name, BOOL reset_after_oth
         if (stored)
         {
           LASreaderStored* lasreaderstored = new LASreaderStored();
+          lasreaderstored->set_spill(stored_megabytes, temp_file_base);
           if (!lasreaderstored->open(lasreaderdtm))
           {
             fprintf(stderr, "ERROR: could not open lasreaderstored with lasreaderdtm\n");
@@ -1067,6 +1138,7 @@ LASreader* LASreadOpener::open(const CHAR* other_file_name, BOOL reset_after_oth
         if (stored)
         {
           LASreaderStored* lasreaderstored = new LASreaderStored();
+          lasreaderstored->set_spill(stored_megabytes, temp_file_base);
           if (!lasreaderstored->open(lasreaderply))
           {
             fprintf(stderr, "ERROR: could not open lasreaderstored with lasreaderply\n");
@@ -1127,6 +1199,7 @@ LASreader* LASreadOpener::open(const CHAR* other_file_name, BOOL reset_after_oth
         if (stored)
         {
           LASreaderStored* lasreaderstored = new LASreaderStored();
+          lasreaderstored->set_spill(stored_megabytes, temp_file_base);
           if (!lasreaderstored->open(lasreaderqfit))
           {
             fprintf(stderr, "ERROR: could not open lasreaderstored with lasreaderqfit\n");
@@ -1189,6 +1262,7 @@ LASreader* LASreadOpener::open(const CHAR* other_file_name, BOOL reset_after_oth
         if (stored)
         {
           LASreaderStored* lasreaderstored = new LASreaderStored();
+          lasreaderstored->set_spill(stored_megabytes, temp_file_base);
           if (!lasreaderstored->open(lasreadertxt))
           {
             fprintf(stderr, "ERROR: could not open lasreaderstored with lasreadertxt\n");
@@ -1256,6 +1330,7 @@ LASreader* LASreadOpener::open(const CHAR* other_file_name, BOOL reset_after_oth
       if (stored)
       {
         LASreaderStored* lasreaderstored = new LASreaderStored();
+        lasreaderstored->set_spill(stored_megabytes, temp_file_base);
         if (!lasreaderstored->open(lasreadertxt))
         {
           fprintf(stderr, "ERROR: could not open lasreaderstored with lasreadertxt\n");
@@ -1310,6 +1385,7 @@ LASreader* LASreadOpener::open(const CHAR* other_file_name, BOOL reset_after_oth
       if (stored)
       {
         LASreaderStored* lasreaderstored = new LASreaderStored();
+        lasreaderstored->set_spill(stored_megabytes, temp_file_base);
         if (!lasreaderstored->open(lasreaderlas))
         {
           fprintf(stderr, "ERROR: could not open lasreaderstored with lasreaderlas\n");
@@ -1920,6 +1996,16 @@ BOOL LASreadOpener::parse(int argc, char* argv[])
       set_stored(TRUE);
       *argv[i]='\0';
     }
+    else if (strcmp(argv[i],"-stored_memory") == 0)
+    {
+      if ((i+1) >= argc)
+      {
+        fprintf(stderr,"ERROR: '%s' needs 1 argument: megabytes\n", argv[i]);
+        return FALSE;
+      }
+      set_stored_memory((U32)atoi(argv[i+1]));
+      *argv[i]='\0'; *argv[i+1]='\0'; i+=1;
+    }
     else if (strcmp(argv[i],"-buffered") == 0)
     {
       if ((i+1) >= argc)
@@ -2087,6 +2173,17 @@ BOOL LASreadOpener::parse(int argc, char* argv[])
     transform->setPointSource(0);
   }
 
+  // only the part of the spatial index under the polygons needs to be read
+
+  if (filter && (inside_tile == 0) && (inside_circle == 0) && (inside_rectangle == 0))
+  {
+    F64 bounding_box[4];
+    if (filter->get_polygon_bounding_box(bounding_box))
+    {
+      set_inside_rectangle(bounding_box[0], bounding_box[1], bounding_box[2], bounding_box[3]);
+    }
+  }
+
   return TRUE;
 }
 
@@ -2208,6 +2305,11 @@ void LASreadOpener::set_stored(const BOOL stored)
   this->stored = stored;
 }
 
+void LASreadOpener::set_stored_memory(const U32 megabytes)
+{
+  this->stored_megabytes = megabytes;
+}
+
 void LASreadOpener::set_buffer_size(const F32 buffer_size)
 {
   this->buffer_size = buffer_size;
@@ -2640,6 +2742,7 @@ LASreadOpener::LASreadOpener()
   neighbor_file_names = 0;
   merged = FALSE;
   stored = FALSE;
+  stored_megabytes = LAS_READER_STORED_MAX_MEGABYTES;
   use_stdin = FALSE;
   comma_not_point = FALSE;
   scale_factor = 0;
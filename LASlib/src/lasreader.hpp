@@ -25,6 +25,10 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- '-stored_memory' bounds the memory of '-stored' input
+    19 October 2026 -- read_ahead() lets the spatial index hint upcoming intervals to the OS
+    19 October 2026 -- with a filter skips chunks that the *.lcs chunk statistics rule out
+    19 October 2026 -- '-keep_polygon' reads only the bounding box of its polygons
      7 September 2018 -- replaced calls to _strdup with calls to the LASCopyString macro
      8 February 2018 -- new LASreaderStored via '-stored' option to allow piped operation
     15 December 2017 -- optional '-files_are_flightline 101' start number like '-faf 101'
@@ -51,6 +55,7 @@
 #include "lasdefinitions.hpp"
 
 class LASindex;
+class LASchunkStats;
 class LASfilter;
 class LAStransform;
 class ByteStreamIn;
@@ -69,6 +74,9 @@ public:
 
   void set_index(LASindex* index);
   inline LASindex* get_index() const { return index; };
+  // with a filter the chunks whose points would all be filtered are skipped
+  void set_chunk_stats(LASchunkStats* chunk_stats);
+  inline LASchunkStats* get_chunk_stats() const { return chunk_stats; };
   virtual void set_filter(LASfilter* filter);
   inline LASfilter* get_filter() const { return filter; };
   virtual void set_transform(LAStransform* transform);
@@ -91,6 +99,8 @@ public:
   inline F64 get_r_max_y() const { return r_max_y; };
 
   virtual BOOL seek(const I64 p_index) = 0;
+  // hints that the points first to last will be read soon. used by the spatial index.
+  virtual BOOL read_ahead(const I64 first, const I64 last) { return FALSE; };
   BOOL read_point() { return (this->*read_simple)(); };
 
   inline void compute_coordinates() { point.compute_coordinates(); };
@@ -125,6 +135,7 @@ protected:
   virtual BOOL read_point_default() = 0;
 
   LASindex* index;
+  LASchunkStats* chunk_stats;
   LASfilter* filter;
   LAStransform* transform;
 
@@ -139,6 +150,7 @@ private:
   BOOL (LASreader::*read_complex)();
 
   BOOL read_point_none();
+  BOOL skip_filtered_chunks();
   BOOL read_point_filtered();
   BOOL read_point_transformed();
   BOOL read_point_filtered_and_transformed();
@@ -149,6 +161,9 @@ private:
   BOOL read_point_inside_circle_indexed();
   BOOL read_point_inside_rectangle();
   BOOL read_point_inside_rectangle_indexed();
+
+  I64 chunk_first;
+  I64 chunk_end;
 };
 
 #include "laswaveform13reader.hpp"
@@ -174,6 +189,8 @@ public:
   BOOL is_merged() const { return merged; };
   void set_stored(const BOOL stored);
   BOOL is_stored() const { return stored; };
+  // beyond this the stored points move to a scratch file (see '-temp_files' for its name)
+  void set_stored_memory(const U32 megabytes);
   void set_buffer_size(const F32 buffer_size);
   F32 get_buffer_size() const;
   void set_neighbor_file_name(const CHAR* neighbor_file_name, BOOL unique=FALSE);
@@ -235,6 +252,7 @@ private:
   const CHAR* file_name;
   BOOL merged;
   BOOL stored;
+  U32 stored_megabytes;
   U32 file_name_number;
   U32 file_name_allocated;
   U32 file_name_current;
@@ -32,6 +32,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -356,11 +357,89 @@ BOOL LASreaderASC::seek(const I64 p_index)
   return FALSE;
 }
 
+BOOL LASreaderASC::inside_none()
+{
+  BOOL result = LASreader::inside_none();
+  set_window();
+  return result;
+}
+
+BOOL LASreaderASC::inside_tile(const F32 ll_x, const F32 ll_y, const F32 size)
+{
+  BOOL result = LASreader::inside_tile(ll_x, ll_y, size);
+  set_window();
+  return result;
+}
+
+BOOL LASreaderASC::inside_circle(const F64 center_x, const F64 center_y, const F64 radius)
+{
+  BOOL result = LASreader::inside_circle(center_x, center_y, radius);
+  set_window();
+  return result;
+}
+
+BOOL LASreaderASC::inside_rectangle(const F64 min_x, const F64 min_y, const F64 max_x, const F64 max_y)
+{
+  BOOL result = LASreader::inside_rectangle(min_x, min_y, max_x, max_y);
+  set_window();
+  return result;
+}
+
+static I32 clamp_cell(const F64 cell, const I32 number)
+{
+  if (cell < 0.0) return 0;
+  if (cell >= number) return number - 1;
+  return (I32)cell;
+}
+
+void LASreaderASC::set_window()
+{
+  // the text cannot be seeked into. the values before the window are skipped without
+  // being parsed and reading stops after the last row of the window.
+  if (inside)
+  {
+    F64 min_x, min_y, max_x, max_y;
+    if (inside == 1)
+    {
+      min_x = t_ll_x; min_y = t_ll_y; max_x = t_ur_x; max_y = t_ur_y;
+    }
+    else if (inside == 2)
+    {
+      min_x = c_center_x - c_radius; min_y = c_center_y - c_radius; max_x = c_center_x + c_radius; max_y = c_center_y + c_radius;
+    }
+    else
+    {
+      min_x = r_min_x; min_y = r_min_y; max_x = r_max_x; max_y = r_max_y;
+    }
+    // one cell of slack on each side as the exact test is still done for every point. rows go from top to bottom.
+    window_min_col = clamp_cell(floor((min_x - xllcenter) / cellsize) - 1, ncols);
+    window_max_col = clamp_cell(ceil((max_x - xllcenter) / cellsize) + 1, ncols);
+    window_min_row = clamp_cell(nrows - 1 - ceil((max_y - yllcenter) / cellsize) - 1, nrows);
+    window_max_row = clamp_cell(nrows - 1 - floor((min_y - yllcenter) / cellsize) + 1, nrows);
+  }
+  else
+  {
+    window_min_col = 0;
+    window_max_col = ncols - 1;
+    window_min_row = 0;
+    window_max_row = nrows - 1;
+  }
+}
+
 BOOL LASreaderASC::read_point_default()
 {
   F32 elevation;
   while (p_count < npoints)
   {
+    if (col == ncols)
+    {
+      col = 0;
+      row++;
+    }
+    if (row > window_max_row)
+    {
+      return FALSE;
+    }
     if (line[line_curr] == '\0')
     {
       if (!fgets(line, line_size, file))
@@ -388,10 +467,13 @@ BOOL LASreaderASC::read_point_default()
       // skip leading spaces
       while ((line[line_curr] != '\0') && (line[line_curr] <= ' ')) line_curr++;
     }
-    if (col == ncols)
+    // skip values outside the window without parsing them
+    if ((row < window_min_row) || (col < window_min_col) || (col > window_max_col))
     {
-      col = 0;
-      row++;
+      while ((line[line_curr] != '\0') && (line[line_curr] > ' ')) line_curr++;
+      while ((line[line_curr] != '\0') && (line[line_curr] <= ' ')) line_curr++;
+      col++;
+      continue;
     }
     // get elevation value
     sscanf(&(line[line_curr]), "%f", &elevation);
@@ -475,6 +557,7 @@ BOOL LASreaderASC::reopen(const CHAR* file_name)
   col = 0;
   row = 0;
   p_count = 0;
+  set_window();
 
   // skip leading spaces
   line_curr = 0;
@@ -503,6 +586,10 @@ void LASreaderASC::clean()
   col = 0;
   ncols = 0;
   nrows = 0;
+  window_min_col = 0;
+  window_max_col = -1;
+  window_min_row = 0;
+  window_max_row = -1;
   xllcenter = F64_MAX;
   yllcenter = F64_MAX;
   cellsize = 0;
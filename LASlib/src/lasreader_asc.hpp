@@ -24,6 +24,7 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- only read the rows and columns covered by inside_rectangle() and friends
     06 December 2013 -- option to deal with European '-comma_not_dot' numbers
     26 March 2012 -- created after forgetting my laptop adaptor in the pre-fab
   
@@ -48,6 +49,11 @@ public:
 
   BOOL seek(const I64 p_index);
 
+  BOOL inside_none();
+  BOOL inside_tile(const F32 ll_x, const F32 ll_y, const F32 size);
+  BOOL inside_circle(const F64 center_x, const F64 center_y, const F64 radius);
+  BOOL inside_rectangle(const F64 min_x, const F64 min_y, const F64 max_x, const F64 max_y);
+
   ByteStreamIn* get_stream() const;
   void close(BOOL close_stream=TRUE);
   BOOL reopen(const CHAR* file_name);
@@ -73,7 +79,11 @@ private:
   F32 cellsize;
   F32 nodata;
 
+  // the rows and columns that cover the area of interest
+  I32 window_min_col, window_max_col, window_min_row, window_max_row;
+
   void clean();
+  void set_window();
   void populate_scale_and_offset();
   void populate_bounding_box();
 };
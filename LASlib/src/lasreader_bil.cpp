@@ -32,6 +32,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -637,15 +638,115 @@ BOOL LASreaderBIL::seek(const I64 p_index)
   return FALSE;
 }
 
+BOOL LASreaderBIL::inside_none()
+{
+  BOOL result = LASreader::inside_none();
+  set_window();
+  return result;
+}
+
+BOOL LASreaderBIL::inside_tile(const F32 ll_x, const F32 ll_y, const F32 size)
+{
+  BOOL result = LASreader::inside_tile(ll_x, ll_y, size);
+  set_window();
+  return result;
+}
+
+BOOL LASreaderBIL::inside_circle(const F64 center_x, const F64 center_y, const F64 radius)
+{
+  BOOL result = LASreader::inside_circle(center_x, center_y, radius);
+  set_window();
+  return result;
+}
+
+BOOL LASreaderBIL::inside_rectangle(const F64 min_x, const F64 min_y, const F64 max_x, const F64 max_y)
+{
+  BOOL result = LASreader::inside_rectangle(min_x, min_y, max_x, max_y);
+  set_window();
+  return result;
+}
+
+static I32 clamp_cell(const F64 cell, const I32 number)
+{
+  if (cell < 0.0) return 0;
+  if (cell >= number) return number - 1;
+  return (I32)cell;
+}
+
+void LASreaderBIL::set_window()
+{
+  if (inside)
+  {
+    F64 min_x, min_y, max_x, max_y;
+    if (inside == 1)
+    {
+      min_x = t_ll_x; min_y = t_ll_y; max_x = t_ur_x; max_y = t_ur_y;
+    }
+    else if (inside == 2)
+    {
+      min_x = c_center_x - c_radius; min_y = c_center_y - c_radius; max_x = c_center_x + c_radius; max_y = c_center_y + c_radius;
+    }
+    else
+    {
+      min_x = r_min_x; min_y = r_min_y; max_x = r_max_x; max_y = r_max_y;
+    }
+    // one cell of slack on each side as the exact test is still done for every point. rows go from top to bottom.
+    window_min_col = clamp_cell(floor((min_x - ulxcenter) / xdim) - 1, ncols);
+    window_max_col = clamp_cell(ceil((max_x - ulxcenter) / xdim) + 1, ncols);
+    window_min_row = clamp_cell(floor((ulycenter - max_y) / ydim) - 1, nrows);
+    window_max_row = clamp_cell(ceil((ulycenter - min_y) / ydim) + 1, nrows);
+  }
+  else
+  {
+    window_min_col = 0;
+    window_max_col = ncols - 1;
+    window_min_row = 0;
+    window_max_row = nrows - 1;
+  }
+
+  // start at the first cell of the window
+
+  col = window_min_col;
+  row = window_min_row;
+  p_count = 0;
+  if (file) seek_cell(row, col);
+}
+
+BOOL LASreaderBIL::seek_cell(const I32 row, const I32 col)
+{
+  // the raster is stored row by row from the top with the same number of bytes per cell that read_point_default() consumes
+  I64 bytes = (nbits == 32 ? 4 : (nbits == 16 ? 2 : nbands));
+  I64 position = ((I64)row * ncols + col) * bytes;
+#if defined _WIN32 && ! defined (__MINGW32__)
+  return !(_fseeki64(file, position, SEEK_SET));
+#elif defined (__MINGW32__)
+  return !(fseeko64(file, (off_t)position, SEEK_SET));
+#else
+  return !(fseeko(file, (off_t)position, SEEK_SET));
+#endif
+}
+
 BOOL LASreaderBIL::read_point_default()
 {
   F32 elevation;
   while (p_count < npoints)
   {
-    if (col == ncols)
+    if (col > window_max_col)
     {
-      col = 0;
+      col = window_min_col;
       row++;
+      if (row > window_max_row)
+      {
+        return FALSE;
+      }
+      // jump over the columns of the row that are outside the window
+      if ((window_min_col > 0) || (window_max_col < ncols - 1))
+      {
+        if (!seek_cell(row, col))
+        {
+          return FALSE;
+        }
+      }
     }
 
     if (nbits == 32)
@@ -797,9 +898,7 @@ BOOL LASreaderBIL::reopen(const CHAR* file_name)
     fprintf(stderr, "WARNING: setvbuf() failed with buffer size %d\n", 2*LAS_TOOLS_IO_IBUFFER_SIZE);
   }
 
-  col = 0;
-  row = 0;
-  p_count = 0;
+  set_window();
 
   return TRUE;
 }
@@ -815,6 +914,10 @@ void LASreaderBIL::clean()
   row = 0;
   ncols = 0;
   nrows = 0;
+  window_min_col = 0;
+  window_max_col = -1;
+  window_min_row = 0;
+  window_max_row = -1;
   nbands = 0;
   nbits = 0;
   ulxcenter = F64_MAX;
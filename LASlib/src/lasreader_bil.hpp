@@ -24,6 +24,7 @@
 
   CHANGE HISTORY:
 
+    19 October 2026 -- only read the rows and columns covered by inside_rectangle() and friends
      7 September 2018 -- replaced calls to _strdup with calls to the LASCopyString macro
     20 June 2017 -- fixed reading of signed versus unsigned 16 and 8 bit intergers
      3 April 2012 -- created after joining the Spar Europe 2012 Advisory Board
@@ -49,6 +50,11 @@ public:
 
   BOOL seek(const I64 p_index);
 
+  BOOL inside_none();
+  BOOL inside_tile(const F32 ll_x, const F32 ll_y, const F32 size);
+  BOOL inside_circle(const F64 center_x, const F64 center_y, const F64 radius);
+  BOOL inside_rectangle(const F64 min_x, const F64 min_y, const F64 max_x, const F64 max_y);
+
   ByteStreamIn* get_stream() const;
   void close(BOOL close_stream=TRUE);
   BOOL reopen(const CHAR* file_name);
@@ -70,7 +76,12 @@ private:
   BOOL floatpixels;
   BOOL signedpixels;
 
+  // the rows and columns that cover the area of interest
+  I32 window_min_col, window_max_col, window_min_row, window_max_row;
+
   void clean();
+  void set_window();
+  BOOL seek_cell(const I32 row, const I32 col);
   BOOL read_hdr_file(const CHAR* file_name);
   BOOL read_blw_file(const CHAR* file_name);
   void populate_scale_and_offset();
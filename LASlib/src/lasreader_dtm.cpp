@@ -280,6 +280,7 @@ static const unsigned short GCTP_NAD83_Puerto_Rico = 5200;
 
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -1201,14 +1202,114 @@ BOOL LASreaderDTM::seek(const I64 p_index)
   return FALSE;
 }
 
+BOOL LASreaderDTM::inside_none()
+{
+  BOOL result = LASreader::inside_none();
+  set_window();
+  return result;
+}
+
+BOOL LASreaderDTM::inside_tile(const F32 ll_x, const F32 ll_y, const F32 size)
+{
+  BOOL result = LASreader::inside_tile(ll_x, ll_y, size);
+  set_window();
+  return result;
+}
+
+BOOL LASreaderDTM::inside_circle(const F64 center_x, const F64 center_y, const F64 radius)
+{
+  BOOL result = LASreader::inside_circle(center_x, center_y, radius);
+  set_window();
+  return result;
+}
+
+BOOL LASreaderDTM::inside_rectangle(const F64 min_x, const F64 min_y, const F64 max_x, const F64 max_y)
+{
+  BOOL result = LASreader::inside_rectangle(min_x, min_y, max_x, max_y);
+  set_window();
+  return result;
+}
+
+static I32 clamp_cell(const F64 cell, const I32 number)
+{
+  if (cell < 0.0) return 0;
+  if (cell >= number) return number - 1;
+  return (I32)cell;
+}
+
+void LASreaderDTM::set_window()
+{
+  if (inside)
+  {
+    F64 min_x, min_y, max_x, max_y;
+    if (inside == 1)
+    {
+      min_x = t_ll_x; min_y = t_ll_y; max_x = t_ur_x; max_y = t_ur_y;
+    }
+    else if (inside == 2)
+    {
+      min_x = c_center_x - c_radius; min_y = c_center_y - c_radius; max_x = c_center_x + c_radius; max_y = c_center_y + c_radius;
+    }
+    else
+    {
+      min_x = r_min_x; min_y = r_min_y; max_x = r_max_x; max_y = r_max_y;
+    }
+    // one cell of slack on each side as the exact test is still done for every point
+    window_min_col = clamp_cell(floor((min_x - ll_x) / xdim) - 1, ncols);
+    window_max_col = clamp_cell(ceil((max_x - ll_x) / xdim) + 1, ncols);
+    window_min_row = clamp_cell(floor((min_y - ll_y) / ydim) - 1, nrows);
+    window_max_row = clamp_cell(ceil((max_y - ll_y) / ydim) + 1, nrows);
+  }
+  else
+  {
+    window_min_col = 0;
+    window_max_col = ncols - 1;
+    window_min_row = 0;
+    window_max_row = nrows - 1;
+  }
+
+  // start at the first cell of the window
+
+  col = window_min_col;
+  row = window_min_row;
+  p_count = 0;
+  if (file) seek_cell(row, col);
+}
+
+BOOL LASreaderDTM::seek_cell(const I32 row, const I32 col)
+{
+  // the raster is stored column by column after a 200 byte header
+  I64 bytes = (data_type == 0 ? 2 : (data_type == 3 ? 8 : 4));
+  I64 position = 200 + ((I64)col * nrows + row) * bytes;
+#if defined _WIN32 && ! defined (__MINGW32__)
+  return !(_fseeki64(file, position, SEEK_SET));
+#elif defined (__MINGW32__)
+  return !(fseeko64(file, (off_t)position, SEEK_SET));
+#else
+  return !(fseeko(file, (off_t)position, SEEK_SET));
+#endif
+}
+
 BOOL LASreaderDTM::read_point_default()
 {
   while (p_count < npoints)
   {
-    if (row == nrows)
+    if (row > window_max_row)
     {
-      row = 0;
+      row = window_min_row;
       col++;
+      if (col > window_max_col)
+      {
+        return FALSE;
+      }
+      // jump over the rows of the column that are outside the window
+      if ((window_min_row > 0) || (window_max_row < nrows - 1))
+      {
+        if (!seek_cell(row, col))
+        {
+          return FALSE;
+        }
+      }
     }
 
     F32 elevation;
@@ -1348,6 +1449,8 @@ BOOL LASreaderDTM::reopen(const CHAR* file_name)
     fgetc(file);
   }
 
+  set_window();
+
   return TRUE;
 }
 
@@ -1362,6 +1465,10 @@ void LASreaderDTM::clean()
   row = 0;
   ncols = 0;
   nrows = 0;
+  window_min_col = 0;
+  window_max_col = -1;
+  window_min_row = 0;
+  window_max_row = -1;
   nodata = -9999.0f;
   data_type = -1;
   ll_x = 0.0;
@@ -24,6 +24,7 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- only read the rows and columns covered by inside_rectangle() and friends
     10 October 2013 -- created after returning from INTERGEO 2013 in Essen
   
 ===============================================================================
@@ -47,6 +48,11 @@ public:
 
   BOOL seek(const I64 p_index);
 
+  BOOL inside_none();
+  BOOL inside_tile(const F32 ll_x, const F32 ll_y, const F32 size);
+  BOOL inside_circle(const F64 center_x, const F64 center_y, const F64 radius);
+  BOOL inside_rectangle(const F64 min_x, const F64 min_y, const F64 max_x, const F64 max_y);
+
   ByteStreamIn* get_stream() const;
   void close(BOOL close_stream=TRUE);
   BOOL reopen(const CHAR* file_name);
@@ -67,7 +73,12 @@ private:
   F32 nodata;
   I16 data_type;  // 2 = F32, 1 = I32, 0 = I16, 3 = F64
 
+  // the rows and columns that cover the area of interest
+  I32 window_min_col, window_max_col, window_min_row, window_max_row;
+
   void clean();
+  void set_window();
+  BOOL seek_cell(const I32 row, const I32 col);
   void populate_scale_and_offset();
   void populate_bounding_box();
 };
@@ -1340,6 +1340,18 @@ BOOL LASreaderLAS::seek(const I64 p_index)
   return FALSE;
 }
 
+BOOL LASreaderLAS::read_ahead(const I64 first, const I64 last)
+{
+  if (reader)
+  {
+    if ((first <= last) && (last < npoints))
+    {
+      return reader->read_ahead((U32)first, (U32)last);
+    }
+  }
+  return FALSE;
+}
+
 BOOL LASreaderLAS::read_point_default()
 {
   if (p_count < npoints)
@@ -1401,6 +1413,28 @@ BOOL LASreaderLAS::read_point_default()
   return FALSE;
 }
 
+U32 LASreaderLAS::get_number_chunks()
+{
+  return (reader ? reader->get_number_chunks() : 0);
+}
+
+BOOL LASreaderLAS::get_chunk(const U32 index, I64* start, U32* num_bytes, I64* first_point, U32* num_points)
+{
+  I64 first;
+  U32 number;
+  if ((reader == 0) || !reader->get_chunk(index, start, num_bytes, &first, &number))
+  {
+    return FALSE;
+  }
+  if ((first + number) > npoints)
+  {
+    number = (first < npoints ? (U32)(npoints - first) : 0);
+  }
+  if (first_point) *first_point = first;
+  if (num_points) *num_points = number;
+  return TRUE;
+}
+
 ByteStreamIn* LASreaderLAS::get_stream() const
 {
   return stream;
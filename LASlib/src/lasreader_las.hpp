@@ -24,6 +24,8 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- read_ahead() is passed to LASreadPoint for chunk-aligned hints
+    19 October 2026 -- access to the chunk table for copying compressed chunks
     10 July 2018 -- user must set seek-ability of istream (hard to determine) 
     19 April 2017 -- support for selective decompression for new LAS 1.4 points 
     1 February 2017 -- better support for OGC WKT strings in VLRs or EVLRs
@@ -70,6 +72,11 @@ public:
   I32 get_format() const;
 
   BOOL seek(const I64 p_index);
+  BOOL read_ahead(const I64 first, const I64 last);
+
+  // the chunks of chunked LAZ (or zero chunks for anything else)
+  U32 get_number_chunks();
+  BOOL get_chunk(const U32 index, I64* start, U32* num_bytes, I64* first_point, U32* num_points);
 
   ByteStreamIn* get_stream() const;
   void close(BOOL close_stream=TRUE);
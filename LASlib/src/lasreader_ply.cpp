@@ -39,6 +39,10 @@
 
 #include "bytestreamin_file.hpp"
 
+#include <vector>
+#include <thread>
+using namespace std;
+
 extern "C" FILE* fopen_compressed(const char* filename, const char* mode, bool* piped);
 
 BOOL LASreaderPLY::open(const CHAR* file_name, U8 point_type, BOOL populate_header)
@@ -592,6 +596,7 @@ BOOL LASreaderPLY::seek(const I64 p_index)
   {
     if (piped) return FALSE;
     fseek(file, 0, SEEK_SET);
+    reset_block();
     // read the first line with full parse_string
     I32 i = 0;
     while (fgets(line, 512, file))
@@ -637,22 +642,43 @@ BOOL LASreaderPLY::read_point_default()
     {
       if (streamin) // binary
       {
+        if (vertex_size && (block_next == block_count) && !read_binary_block())
+        {
+#ifdef _WIN32
+          fprintf(stderr,"WARNING: end-of-file after %I64d of %I64d points\n", p_count, npoints);
+#else
+          fprintf(stderr,"WARNING: end-of-file after %lld of %lld points\n", p_count, npoints);
+#endif
+          npoints = p_count;
+          if (!populated_header)
+          {
+            populate_bounding_box();
+          }
+          return FALSE;
+        }
         read_binary_point();
       }
       else // ascii
       {
         while (true)
         {
-          if (fgets(line, 512, file))
+          if ((block_next < block_count) || read_ascii_block())
           {
-            if (parse(parse_string))
+            if (parsed[block_next])
             {
+              point = points[block_next];
+              point.coordinates[0] = points[block_next].coordinates[0];
+              point.coordinates[1] = points[block_next].coordinates[1];
+              point.coordinates[2] = points[block_next].coordinates[2];
+              block_next++;
               break;
             }
             else
             {
-              line[strlen(line)-1] = '\0';
-              fprintf(stderr, "WARNING: cannot parse '%s' with '%s'. skipping ...\n", line, parse_string);
+              CHAR* l = lines + 512*block_next;
+              l[strlen(l)-1] = '\0';
+              fprintf(stderr, "WARNING: cannot parse '%s' with '%s'. skipping ...\n", l, parse_string);
+              block_next++;
             }
           }
           else
@@ -754,6 +780,8 @@ BOOL LASreaderPLY::reopen(const char* file_name)
     fprintf(stderr, "WARNING: setvbuf() failed with buffer size %d\n", 10*LAS_TOOLS_IO_IBUFFER_SIZE);
   }
 
+  reset_block();
+
   // read the first line with full parse_string
 
   i = 0;
@@ -804,6 +832,28 @@ void LASreaderPLY::clean()
     free(type_string);
     type_string = 0;
   }
+  if (vertices)
+  {
+    free(vertices);
+    vertices = 0;
+  }
+  if (lines)
+  {
+    free(lines);
+    lines = 0;
+  }
+  if (parsed)
+  {
+    free(parsed);
+    parsed = 0;
+  }
+  if (points)
+  {
+    delete [] points;
+    points = 0;
+  }
+  vertex_size = 0;
+  reset_block();
   populated_header = FALSE;
 }
 
@@ -815,6 +865,10 @@ LASreaderPLY::LASreaderPLY()
   point_type = 0;
   parse_string = 0;
   type_string = 0;
+  vertices = 0;
+  lines = 0;
+  parsed = 0;
+  points = 0;
   scale_factor = 0;
   offset = 0;
   translate_intensity = 0.0f;
@@ -838,7 +892,7 @@ LASreaderPLY::~LASreaderPLY()
   }
 }
 
-BOOL LASreaderPLY::set_attribute(I32 index, F64 value)
+BOOL LASreaderPLY::set_attribute(I32 index, F64 value, LASpoint& point) const
 {
   if (index >= header.number_attributes)
   {
@@ -1015,7 +1069,7 @@ F64 LASreaderPLY::read_binary_value(CHAR type)
   }
   else if (type == 'd')
   {
-    streamin->get32bitsLE((U8*)&value);
+    streamin->get64bitsLE((U8*)&value);
   }
   else if (type == 'C')
   {
@@ -1054,16 +1108,83 @@ F64 LASreaderPLY::read_binary_value(CHAR type)
   return value;
 }
 
+static F64 unpack_binary_value(CHAR type, const U8* bytes)
+{
+  if (type == 'f')
+  {
+    F32 temp_f32;
+    memcpy(&temp_f32, bytes, 4);
+    return (F64)temp_f32;
+  }
+  else if (type == 'd')
+  {
+    F64 temp_f64;
+    memcpy(&temp_f64, bytes, 8);
+    return temp_f64;
+  }
+  else if (type == 'C')
+  {
+    return (F64)bytes[0];
+  }
+  else if (type == 'c')
+  {
+    return (F64)((I8)bytes[0]);
+  }
+  else if (type == 'I')
+  {
+    U32 temp_u32;
+    memcpy(&temp_u32, bytes, 4);
+    return (F64)temp_u32;
+  }
+  else if (type == 'i')
+  {
+    I32 temp_i32;
+    memcpy(&temp_i32, bytes, 4);
+    return (F64)temp_i32;
+  }
+  else if (type == 'S')
+  {
+    U16 temp_u16;
+    memcpy(&temp_u16, bytes, 2);
+    return (F64)temp_u16;
+  }
+  else if (type == 's')
+  {
+    I16 temp_i16;
+    memcpy(&temp_i16, bytes, 2);
+    return (F64)temp_i16;
+  }
+  return 0;
+}
+
 BOOL LASreaderPLY::read_binary_point()
 {
   const CHAR* p = parse_string;
   const CHAR* t = type_string;
+  const U8* vertex = 0;
 
   F64 value;
 
+  if (vertex_size)
+  {
+    if ((block_next == block_count) && !read_binary_block())
+    {
+      return FALSE;
+    }
+    vertex = vertices + vertex_size*block_next;
+    block_next++;
+  }
+
   while (p[0])
   {
-    value = read_binary_value(t[0]);
+    if (vertex)
+    {
+      value = unpack_binary_value(t[0], vertex + vertex_offsets[t - type_string]);
+    }
+    else
+    {
+      value = read_binary_value(t[0]);
+    }
     if (p[0] == 'x') // we expect the x coordinate
     {
       point.coordinates[0] = value;
@@ -1182,15 +1303,15 @@ BOOL LASreaderPLY::read_binary_point()
   return TRUE;
 }
 
-BOOL LASreaderPLY::parse_attribute(const char* l, I32 index)
+BOOL LASreaderPLY::parse_attribute(const char* l, I32 index, LASpoint& point) const
 {
   F64 temp_d;
   if (sscanf(l, "%lf", &temp_d) != 1) return FALSE;
-  if (!set_attribute(index, temp_d)) return FALSE;
+  if (!set_attribute(index, temp_d, point)) return FALSE;
   return TRUE;
 }
 
-BOOL LASreaderPLY::parse(const char* parse_string)
+BOOL LASreaderPLY::parse(const char* parse_string, const char* line, LASpoint& point) const
 {
   I32 temp_i;
   F32 temp_f;
@@ -1463,7 +1584,7 @@ BOOL LASreaderPLY::parse(const char* parse_string)
       while (l[0] && (l[0] == ' ' || l[0] == ',' || l[0] == '\t' || l[0] == ';')) l++; // first skip white spaces
       if (l[0] == 0) return FALSE;
       I32 index = (I32)(p[0] - '0');
-      if (!parse_attribute(l, index)) return FALSE;
+      if (!parse_attribute(l, index, point)) return FALSE;
       while (l[0] && l[0] != ' ' && l[0] != ',' && l[0] != '\t' && l[0] != ';') l++; // then advance to next white space
     }
     else if (p[0] == '(') // we expect attribute number 10 or higher
@@ -1477,7 +1598,7 @@ BOOL LASreaderPLY::parse(const char* parse_string)
         index = 10*index + (I32)(p[0] - '0');
         p++;
       }
-      if (!parse_attribute(l, index)) return FALSE;
+      if (!parse_attribute(l, index, point)) return FALSE;
       while (l[0] && l[0] != ' ' && l[0] != ',' && l[0] != '\t' && l[0] != ';') l++; // then advance to next white space
     }
     else if (p[0] == 'H') // we expect a hexadecimal coded RGB color
@@ -1520,6 +1641,7 @@ BOOL LASreaderPLY::parse(const char* parse_string)
 BOOL LASreaderPLY::parse_header(BOOL quiet)
 {
   BOOL skip_remaining = FALSE;
+  BOOL little_endian = FALSE;
   CHAR line[512];
   U32 items = 0;
   U32 offset = 0;
@@ -1560,6 +1682,7 @@ BOOL LASreaderPLY::parse_header(BOOL quiet)
       if (strncmp(&line[7], "binary_little_endian", 20) == 0)
       {
         streamin = new ByteStreamInFileLE(file);
+        little_endian = TRUE;
       }
       else if (strncmp(&line[7], "binary_big_endian", 18) == 0)
       {
@@ -1688,19 +1811,19 @@ BOOL LASreaderPLY::parse_header(BOOL quiet)
         if (strncmp(&line[offset], "x", 1) == 0)
         {
           parse_string[items] = 'x';
-          type_string[items] = 'f';
+          type_string[items] = 'd';
           items++;
         }
         else if (strncmp(&line[offset], "y", 1) == 0)
         {
           parse_string[items] = 'y';
-          type_string[items] = 'f';
+          type_string[items] = 'd';
           items++;
         }
         else if (strncmp(&line[offset], "z", 1) == 0)
         {
           parse_string[items] = 'z';
-          type_string[items] = 'f';
+          type_string[items] = 'd';
           items++;
         }
         else if (strncmp(&line[offset], "nx", 2) == 0)
@@ -1708,7 +1831,7 @@ BOOL LASreaderPLY::parse_header(BOOL quiet)
           I32 num = number_attributes;
           add_attribute(LAS_ATTRIBUTE_I16, "nx", "normal x coordinate", 0.00005);
           parse_string[items] = '0' + num;
-          type_string[items] = 'f';
+          type_string[items] = 'd';
           items++;
         }
         else if (strncmp(&line[offset], "ny", 2) == 0)
@@ -1716,7 +1839,7 @@ BOOL LASreaderPLY::parse_header(BOOL quiet)
           I32 num = number_attributes;
           add_attribute(LAS_ATTRIBUTE_I16, "ny", "normal y coordinate", 0.00005);
           parse_string[items] = '0' + num;
-          type_string[items] = 'f';
+          type_string[items] = 'd';
           items++;
         }
         else if (strncmp(&line[offset], "nz", 2) == 0)
@@ -1724,7 +1847,7 @@ BOOL LASreaderPLY::parse_header(BOOL quiet)
           I32 num = number_attributes;
           add_attribute(LAS_ATTRIBUTE_I16, "nz", "normal z coordinate", 0.00005);
           parse_string[items] = '0' + num;
-          type_string[items] = 'f';
+          type_string[items] = 'd';
           items++;
         }
         else
@@ -1738,7 +1861,7 @@ BOOL LASreaderPLY::parse_header(BOOL quiet)
           sscanf(&line[offset], "%31s", description);
           add_attribute(LAS_ATTRIBUTE_F32, name, description);
           parse_string[items] = '0' + num;
-          type_string[items] = 'f';
+          type_string[items] = 'd';
           items++;
         }
       }
@@ -1779,7 +1902,7 @@ BOOL LASreaderPLY::parse_header(BOOL quiet)
           sscanf(&line[15], "%31s", description);
           add_attribute(LAS_ATTRIBUTE_U8, name, description);
           parse_string[items] = '0' + num;
-          type_string[items] = 'f';
+          type_string[items] = 'C';
           items++;
         }
       }
@@ -1797,9 +1920,123 @@ BOOL LASreaderPLY::parse_header(BOOL quiet)
     if (!quiet) fprintf(stderr, "parsed: %s", line);
   }
 
+  layout_binary_vertex(little_endian);
+
+  return TRUE;
+}
+
+void LASreaderPLY::layout_binary_vertex(BOOL little_endian)
+{
+  reset_block();
+  vertex_size = 0;
+  if (vertices)
+  {
+    free(vertices);
+    vertices = 0;
+  }
+
+  // only little endian data on a little endian host can be unpacked with memcpy()
+
+  if ((streamin == 0) || !little_endian || !IS_LITTLE_ENDIAN())
+  {
+    return;
+  }
+
+  U32 size = 0;
+  const CHAR* t = type_string;
+  while (t[0])
+  {
+    vertex_offsets[t - type_string] = (U16)size;
+    if (t[0] == 'd') size += 8;
+    else if ((t[0] == 'f') || (t[0] == 'I') || (t[0] == 'i')) size += 4;
+    else if ((t[0] == 'S') || (t[0] == 's')) size += 2;
+    else if ((t[0] == 'C') || (t[0] == 'c')) size += 1;
+    else return;
+    t++;
+  }
+  if (size == 0)
+  {
+    return;
+  }
+  vertices = (U8*)malloc(size*LAS_READER_PLY_BLOCK);
+  if (vertices)
+  {
+    vertex_size = size;
+  }
+}
+
+BOOL LASreaderPLY::read_binary_block()
+{
+  I64 number = npoints - vertices_read;
+  if (number > LAS_READER_PLY_BLOCK) number = LAS_READER_PLY_BLOCK;
+  if (number <= 0)
+  {
+    return FALSE;
+  }
+  block_count = (U32)fread(vertices, vertex_size, (size_t)number, file);
+  block_next = 0;
+  vertices_read += block_count;
+  return (block_count > 0);
+}
+
+BOOL LASreaderPLY::read_ascii_block()
+{
+  if (lines == 0)
+  {
+    lines = (CHAR*)malloc(512*LAS_READER_PLY_BLOCK);
+    parsed = (BOOL*)malloc(sizeof(BOOL)*LAS_READER_PLY_BLOCK);
+    points = new LASpoint[LAS_READER_PLY_BLOCK];
+    for (U32 i = 0; i < LAS_READER_PLY_BLOCK; i++)
+    {
+      points[i].init(&header, header.point_data_format, header.point_data_record_length, &header);
+    }
+  }
+
+  // read no more lines than there are points left
+
+  I64 number = npoints - p_count;
+  if (number > LAS_READER_PLY_BLOCK) number = LAS_READER_PLY_BLOCK;
+  block_count = 0;
+  block_next = 0;
+  while ((block_count < number) && fgets(lines + 512*block_count, 512, file))
+  {
+    block_count++;
+  }
+  if (block_count == 0)
+  {
+    return FALSE;
+  }
+
+  // parse interleaved ranges of lines with as many threads as the block warrants
+
+  U32 threads = thread::hardware_concurrency();
+  if (threads > block_count / 256) threads = block_count / 256;
+  if (threads == 0) threads = 1;
+
+  auto worker = [&](U32 first)
+  {
+    for (U32 i = first; i < block_count; i += threads)
+    {
+      parsed[i] = parse(parse_string, lines + 512*i, points[i]);
+    }
+  };
+
+  vector<thread> pool;
+  U32 i;
+  for (i = 1; i < threads; i++) pool.push_back(thread(worker, i));
+  worker(0);
+  for (i = 0; i < pool.size(); i++) pool[i].join();
+
   return TRUE;
 }
 
+void LASreaderPLY::reset_block()
+{
+  block_count = 0;
+  block_next = 0;
+  vertices_read = 0;
+}
+
 void LASreaderPLY::populate_scale_and_offset()
 {
   // if not specified in the command line, set a reasonable scale_factor
@@ -24,6 +24,7 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- binary vertices read in blocks and ascii lines parsed by several threads
     4 September 2018 -- created after returning to Samara with locks changed
   
 ===============================================================================
@@ -35,6 +36,8 @@
 
 #include <stdio.h>
 
+#define LAS_READER_PLY_BLOCK 4096
+
 class LASreaderPLY : public LASreader
 {
 public:
@@ -83,12 +86,29 @@ private:
   F64 attribute_pre_scales[32];
   F64 attribute_pre_offsets[32];
   F64 attribute_no_datas[32];
+  // vertices of binary little endian files are read a block at a time and unpacked at fixed offsets
+  U32 vertex_size;
+  U16 vertex_offsets[64];
+  U8* vertices;
+  I64 vertices_read;
+  // lines of ascii files are read a block at a time and parsed by several threads
+  CHAR* lines;
+  LASpoint* points;
+  BOOL* parsed;
+  U32 block_count;
+  U32 block_next;
   BOOL parse_header(BOOL quiet);
-  BOOL set_attribute(I32 index, F64 value);
-  BOOL parse_attribute(const CHAR* l, I32 index);
-  BOOL parse(const CHAR* parse_string);
+  BOOL set_attribute(I32 index, F64 value) { return set_attribute(index, value, point); };
+  BOOL set_attribute(I32 index, F64 value, LASpoint& point) const;
+  BOOL parse_attribute(const CHAR* l, I32 index, LASpoint& point) const;
+  BOOL parse(const CHAR* parse_string) { return parse(parse_string, line, point); };
+  BOOL parse(const CHAR* parse_string, const CHAR* line, LASpoint& point) const;
   F64 read_binary_value(CHAR type);
   BOOL read_binary_point();
+  void layout_binary_vertex(BOOL little_endian);
+  BOOL read_binary_block();
+  BOOL read_ascii_block();
+  void reset_block();
   void populate_scale_and_offset();
   void populate_bounding_box();
   void clean();
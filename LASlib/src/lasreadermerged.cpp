@@ -42,6 +42,11 @@ void LASreaderMerged::set_io_ibuffer_size(I32 io_ibuffer_size)
   this->io_ibuffer_size = io_ibuffer_size;
 }
 
+void LASreaderMerged::set_decompress_selective(U32 decompress_selective)
+{
+  this->decompress_selective = decompress_selective;
+}
+
 BOOL LASreaderMerged::add_file_name(const char* file_name)
 {
   // do we have a file name
@@ -1400,6 +1405,7 @@ LASreaderMerged::LASreaderMerged()
   apply_file_source_ID = FALSE;
   parse_string = 0;
   io_ibuffer_size = LAS_TOOLS_IO_IBUFFER_SIZE;
+  decompress_selective = LASZIP_DECOMPRESS_SELECTIVE_ALL;
   file_names = 0;
   bounding_boxes = 0;
   clean();
@@ -1458,7 +1464,7 @@ BOOL LASreaderMerged::open_next_file()
     // open the lasreader with the next file name
     if (lasreaderlas)
     {
-      if (!lasreaderlas->open(file_names[file_name_current], io_ibuffer_size))
+      if (!lasreaderlas->open(file_names[file_name_current], io_ibuffer_size, FALSE, decompress_selective))
       {
         fprintf(stderr, "ERROR: could not open lasreaderlas for file '%s'\n", file_names[file_name_current]);
         return FALSE;
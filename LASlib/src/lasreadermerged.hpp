@@ -24,6 +24,7 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- pass selective decompression on to the merged LAS/LAZ files
      5 September 2018 -- support for reading points from the PLY format
      1 December 2017 -- support extra bytes during '-merged' operations
      3 May 2015 -- header sets file source ID to 0 when merging flightlines 
@@ -50,6 +51,8 @@ public:
 
   void set_io_ibuffer_size(I32 io_ibuffer_size);
   inline I32 get_io_ibuffer_size() const { return io_ibuffer_size; };
+  void set_decompress_selective(U32 decompress_selective);
+  inline U32 get_decompress_selective() const { return decompress_selective; };
   BOOL add_file_name(const CHAR* file_name);
   void set_scale_factor(const F64* scale_factor);
   void set_offset(const F64* offset);
@@ -121,6 +124,7 @@ private:
   U32 file_name_number;
   U32 file_name_allocated;
   I32 io_ibuffer_size;
+  U32 decompress_selective;
   CHAR** file_names;
   F64* bounding_boxes;
 };
@@ -36,10 +36,24 @@
 
 #include "laswriter_las.hpp"
 #include "lasreader_las.hpp"
+#include "bytestreamin_file.hpp"
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+void LASreaderStored::set_spill(const U32 max_megabytes, const CHAR* temp_file_base)
+{
+  this->max_megabytes = (max_megabytes > 2047 ? 2047 : max_megabytes);
+  if (spill_file_name) free(spill_file_name);
+  spill_file_name = 0;
+  if (temp_file_base)
+  {
+    spill_file_name = (CHAR*)malloc(strlen(temp_file_base) + 16);
+    sprintf(spill_file_name, "%s_stored.tmp", temp_file_base);
+  }
+}
+
 BOOL LASreaderStored::open(LASreader* lasreader)
 {
   if (lasreader == 0)
@@ -76,19 +90,18 @@ BOOL LASreaderStored::open(LASreader* lasreader)
     if (!point.init(&header, header.point_data_format, header.point_data_record_length)) return FALSE;
   }
 
-  // create the stream output array
+  // create the stream output that spills to a scratch file
 
-  if (streamoutarray) delete streamoutarray;
-  streamoutarray = 0;
+  if (streamoutspill) delete streamoutspill;
+  streamoutspill = 0;
+  if (streamin) delete streamin;
+  streamin = 0;
 
-  if (IS_LITTLE_ENDIAN())
-    streamoutarray = new ByteStreamOutArrayLE((header.number_of_point_records ? (I64)header.number_of_point_records : header.extended_number_of_point_records)*2);
-  else
-    streamoutarray = new ByteStreamOutArrayBE((header.number_of_point_records ? (I64)header.number_of_point_records : header.extended_number_of_point_records)*2);
+  streamoutspill = new ByteStreamOutSpill((I64)max_megabytes << 20, spill_file_name, (header.number_of_point_records ? (I64)header.number_of_point_records : header.extended_number_of_point_records)*2);
 
-  if (streamoutarray == 0)
+  if (streamoutspill == 0)
   {
-    fprintf(stderr, "ERROR: allocating streamoutarray\n");
+    fprintf(stderr, "ERROR: allocating streamoutspill\n");
     return FALSE;
   }
 
@@ -105,11 +118,11 @@ BOOL LASreaderStored::open(LASreader* lasreader)
     return FALSE;
   }
 
-  if (!laswriterlas->open(streamoutarray, &header, LASZIP_COMPRESSOR_DEFAULT))
+  if (!laswriterlas->open(streamoutspill, &header, LASZIP_COMPRESSOR_DEFAULT))
   {
     delete laswriterlas;
     laswriterlas = 0;
-    fprintf(stderr, "ERROR: opening laswriterlas to streamoutarray\n");
+    fprintf(stderr, "ERROR: opening laswriterlas to streamoutspill\n");
     return FALSE;
   }
 
@@ -119,38 +132,60 @@ BOOL LASreaderStored::open(LASreader* lasreader)
 
   npoints = (header.number_of_point_records ? header.number_of_point_records : header.extended_number_of_point_records);
   p_count = 0;
+  failed = FALSE;
 
   return TRUE;
 }
 
 BOOL LASreaderStored::reopen()
 {
-  if (streaminarray)
+  if (streamin)
   {
-    streaminarray->seek(0);
+    streamin->seek(0);
   }
   else
   {
-    if (streamoutarray == 0)
+    if (streamoutspill == 0)
     {
-      fprintf(stderr, "ERROR: no streamoutarray\n");
+      fprintf(stderr, "ERROR: no streamoutspill\n");
       return FALSE;
     }
 
-    if (streamoutarray->getSize() == 0)
+    FILE* file = streamoutspill->getFile();
+
+    if (failed || streamoutspill->hasFailed())
     {
-      fprintf(stderr, "ERROR: nothing stored in streamoutarray\n");
+      fprintf(stderr, "ERROR: not all points were stored. cannot read them again\n");
       return FALSE;
     }
 
-    if (IS_LITTLE_ENDIAN())
-      streaminarray = new ByteStreamInArrayLE(streamoutarray->takeData(), streamoutarray->getSize());
+    if (streamoutspill->isSpilled())
+    {
+      // the second pass streams the points back from the scratch file
+
+      fseek(file, 0, SEEK_SET);
+      if (IS_LITTLE_ENDIAN())
+        streamin = new ByteStreamInFileLE(file);
+      else
+        streamin = new ByteStreamInFileBE(file);
+    }
     else
-      streaminarray = new ByteStreamInArrayBE(streamoutarray->takeData(), streamoutarray->getSize());
+    {
+      if (streamoutspill->getSize() == 0)
+      {
+        fprintf(stderr, "ERROR: nothing stored in streamoutspill\n");
+        return FALSE;
+      }
+
+      if (IS_LITTLE_ENDIAN())
+        streamin = new ByteStreamInArrayLE(streamoutspill->getData(), streamoutspill->getSize());
+      else
+        streamin = new ByteStreamInArrayBE(streamoutspill->getData(), streamoutspill->getSize());
+    }
 
-    if (streaminarray == 0)
+    if (streamin == 0)
     {
-      fprintf(stderr, "ERROR: creating streaminarray\n");
+      fprintf(stderr, "ERROR: creating streamin\n");
       return FALSE;
     }
   }
@@ -168,11 +203,11 @@ BOOL LASreaderStored::reopen()
     return FALSE;
   }
 
-  if (!lasreaderlas->open(streaminarray))
+  if (!lasreaderlas->open(streamin))
   {
     delete lasreaderlas;
     lasreaderlas = 0;
-    fprintf(stderr, "ERROR: opening lasreaderlas from streaminarray\n");
+    fprintf(stderr, "ERROR: opening lasreaderlas from streamin\n");
     return FALSE;
   }
 
@@ -237,9 +272,17 @@ BOOL LASreaderStored::read_point_default()
     if (lasreader->read_point())
     {
       point = lasreader->point;
-      if (laswriter)
+      if (laswriter && !failed)
       {
-        laswriter->write_point(&point);
+        if (!laswriter->write_point(&point))
+        {
+#ifdef _WIN32
+          fprintf(stderr, "ERROR: cannot store point %I64d\n", p_count);
+#else
+          fprintf(stderr, "ERROR: cannot store point %lld\n", p_count);
+#endif
+          failed = TRUE;
+        }
       }
       p_count++;
       return TRUE;
@@ -278,8 +321,11 @@ LASreaderStored::LASreaderStored()
 {
   lasreader = 0;
   laswriter = 0;
-  streaminarray = 0;
-  streamoutarray = 0;
+  streamin = 0;
+  streamoutspill = 0;
+  max_megabytes = LAS_READER_STORED_MAX_MEGABYTES;
+  spill_file_name = 0;
+  failed = FALSE;
 }
 
 LASreaderStored::~LASreaderStored()
@@ -287,6 +333,7 @@ LASreaderStored::~LASreaderStored()
   if (lasreader || laswriter) close();
   if (lasreader) delete lasreader;
   if (laswriter) delete laswriter;
-  if (streaminarray) delete streaminarray;
-  if (streamoutarray) delete streamoutarray;
+  if (streamin) delete streamin;
+  if (streamoutspill) delete streamoutspill;
+  if (spill_file_name) free(spill_file_name);
 }
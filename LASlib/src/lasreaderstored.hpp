@@ -8,7 +8,9 @@
     Reads LiDAR points from another LASreader and stores them in compressed form
     so they can be read from memory on the second read. This is especially used
     for piping LiDAR from one process to another for those modules that perform
-    two reading passes over the input.
+    two reading passes over the input. Once the compressed points pass a memory
+    limit they move to a scratch file and the second read streams them back
+    from there, so that inputs of any size can be read twice.
 
   PROGRAMMERS:
 
@@ -27,6 +29,7 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- stored points spill to a scratch file beyond '-stored_memory' megabytes
      9 December 2017 -- created at Octopus Resort on Waya Island in Fiji
   
 ===============================================================================
@@ -37,12 +40,21 @@
 #include "lasreader.hpp"
 #include "laswriter.hpp"
 #include "bytestreamin_array.hpp"
-#include "bytestreamout_array.hpp"
+#include "bytestreamout_spill.hpp"
+
+// the stored points are kept in memory up to this many megabytes
+
+#define LAS_READER_STORED_MAX_MEGABYTES 1024
 
 class LASreaderStored : public LASreader
 {
 public:
 
+  // beyond max_megabytes (at most 2047) the stored points move to a scratch file. it is
+  // named after the temp_file_base if there is one and is a tmpfile() otherwise. if they
+  // cannot all be stored, reopen() fails.
+  void set_spill(const U32 max_megabytes, const CHAR* temp_file_base=0);
+
   BOOL open(LASreader* lasreader);
   BOOL reopen();
   LASreader* get_lasreader() const { return lasreader; };
@@ -72,8 +84,11 @@ protected:
 private:
   LASreader* lasreader;
   LASwriter* laswriter;
-  ByteStreamInArray* streaminarray;
-  ByteStreamOutArray* streamoutarray;
+  ByteStreamIn* streamin;
+  ByteStreamOutSpill* streamoutspill;
+  U32 max_megabytes;
+  CHAR* spill_file_name;
+  BOOL failed;
 };
 
 #endif
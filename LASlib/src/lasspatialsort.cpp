@@ -0,0 +1,716 @@
+/*
+===============================================================================
+
+  FILE:  lasspatialsort.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the LICENSE.txt file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "lasspatialsort.hpp"
+
+#include "lasreader.hpp"
+#include "laswriter_las.hpp"
+#include "lasindex.hpp"
+#include "lasquadtree.hpp"
+#include "laschunkstats.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+using namespace std;
+
+// a run smaller than this is sorted by one thread
+
+#define LAS_SPATIAL_SORT_MIN_PARALLEL 65536
+
+// the records of a run read from its temporary file at once
+
+#define LAS_SPATIAL_SORT_MIN_BUFFER 1024
+
+// the runs merged at once. with more runs there are several passes so that only few files are
+// open at the same time (the C runtime of MSVC has 512 streams by default).
+
+#define LAS_SPATIAL_SORT_MAX_RUNS 64
+
+// a record is the key, the GPS time, and the point
+
+#define LAS_SPATIAL_SORT_RECORD_HEADER 12
+
+// the cells of the spatial index hold about this many points. this is much finer than
+// usual because after sorting the points of a cell are in one or a few intervals.
+
+#define LAS_SPATIAL_SORT_INDEX_POINTS 1000
+
+class LASspatialSortEntry
+{
+public:
+  U32 key;
+  U32 index;
+  F64 gps_time;
+  inline bool operator<(const LASspatialSortEntry& other) const
+  {
+    if (key != other.key) return (key < other.key);
+    if (gps_time != other.gps_time) return (gps_time < other.gps_time);
+    return (index < other.index);
+  };
+};
+
+class LASspatialSortRun
+{
+public:
+  FILE* file;
+  CHAR* file_name;
+  I64 remaining;       // records still in the file
+  U32 number;          // records in the buffer
+  U32 next;
+  U8* buffer;
+  U32 key;
+  F64 gps_time;
+};
+
+// the 16 bits of v spread to the even bits
+
+static U32 spread_bits(U32 v)
+{
+  v &= 0x0000FFFF;
+  v = (v | (v << 8)) & 0x00FF00FF;
+  v = (v | (v << 4)) & 0x0F0F0F0F;
+  v = (v | (v << 2)) & 0x33333333;
+  v = (v | (v << 1)) & 0x55555555;
+  return v;
+}
+
+static U32 get_morton_key(const U32 x, const U32 y)
+{
+  return (spread_bits(x) | (spread_bits(y) << 1));
+}
+
+static U32 get_hilbert_key(U32 x, U32 y)
+{
+  U32 s, rx, ry, t, d = 0;
+  for (s = (1u << 15); s; s >>= 1)
+  {
+    rx = ((x & s) ? 1 : 0);
+    ry = ((y & s) ? 1 : 0);
+    d += s * s * ((3 * rx) ^ ry);
+    // rotate the quadrant so that the curve inside starts and ends at the right corners
+    if (ry == 0)
+    {
+      if (rx == 1)
+      {
+        x = ~x;
+        y = ~y;
+      }
+      t = x;
+      x = y;
+      y = t;
+    }
+  }
+  return d;
+}
+
+// all bits below the highest set bit set, so that keys differing first in the same bit compare equal
+
+static U32 smear_bits(U32 v)
+{
+  v |= (v >> 1);
+  v |= (v >> 2);
+  v |= (v >> 4);
+  v |= (v >> 8);
+  v |= (v >> 16);
+  return v;
+}
+
+// every thread sorts a slice. the slices are then merged pairwise, also in parallel.
+
+static void sort_entries(LASspatialSortEntry* entries, LASspatialSortEntry* scratch, const U32 number, U32 threads)
+{
+  if ((threads < 2) || (number < LAS_SPATIAL_SORT_MIN_PARALLEL))
+  {
+    sort(entries, entries + number);
+    return;
+  }
+  U32 t;
+  vector<U32> bounds(threads + 1);
+  for (t = 0; t <= threads; t++) bounds[t] = (U32)(((U64)number * t) / threads);
+  vector<thread> pool;
+  for (t = 0; t < threads; t++)
+  {
+    LASspatialSortEntry* first = entries + bounds[t];
+    LASspatialSortEntry* last = entries + bounds[t+1];
+    pool.push_back(thread([first, last]() { sort(first, last); }));
+  }
+  for (t = 0; t < pool.size(); t++) pool[t].join();
+
+  LASspatialSortEntry* from = entries;
+  LASspatialSortEntry* to = scratch;
+  while (bounds.size() > 2)
+  {
+    vector<U32> merged;
+    pool.clear();
+    for (t = 0; t + 1 < bounds.size(); t += 2)
+    {
+      if (t + 2 < bounds.size())
+      {
+        LASspatialSortEntry* a = from + bounds[t];
+        LASspatialSortEntry* b = from + bounds[t+1];
+        LASspatialSortEntry* c = from + bounds[t+2];
+        LASspatialSortEntry* out = to + bounds[t];
+        pool.push_back(thread([a, b, c, out]() { merge(a, b, b, c, out); }));
+      }
+      else
+      {
+        copy(from + bounds[t], from + bounds[t+1], to + bounds[t]);
+      }
+      merged.push_back(bounds[t]);
+    }
+    merged.push_back(number);
+    for (t = 0; t < pool.size(); t++) pool[t].join();
+    bounds.swap(merged);
+    swap(from, to);
+  }
+  if (from != entries) copy(from, from + number, entries);
+}
+
+// sorts a run and stores its records to a temporary file
+
+static BOOL store_run(LASspatialSortEntry* entries, LASspatialSortEntry* scratch, const U8* points, const U32 number, const U32 point_size, const U32 threads, FILE* file)
+{
+  sort_entries(entries, scratch, number, threads);
+  const U32 record_size = LAS_SPATIAL_SORT_RECORD_HEADER + point_size;
+  const U32 block = 4096;
+  U8* records = (U8*)malloc((size_t)record_size*block);
+  if (records == 0) return FALSE;
+  U32 i, j = 0;
+  for (i = 0; i < number; i++)
+  {
+    U8* record = records + (size_t)record_size*j;
+    memcpy(record, &entries[i].key, 4);
+    memcpy(record + 4, &entries[i].gps_time, 8);
+    memcpy(record + LAS_SPATIAL_SORT_RECORD_HEADER, points + (size_t)point_size*entries[i].index, point_size);
+    j++;
+    if ((j == block) || (i + 1 == number))
+    {
+      if (fwrite(records, record_size, j, file) != j)
+      {
+        free(records);
+        return FALSE;
+      }
+      j = 0;
+    }
+  }
+  free(records);
+  return (fflush(file) == 0);
+}
+
+static BOOL fill_run(LASspatialSortRun* run, const U32 record_size, const U32 capacity)
+{
+  run->number = (U32)(run->remaining < capacity ? run->remaining : capacity);
+  run->next = 0;
+  if (run->number == 0) return FALSE;
+  if (fread(run->buffer, record_size, run->number, run->file) != run->number) return FALSE;
+  run->remaining -= run->number;
+  return TRUE;
+}
+
+class LASspatialSortRunLater
+{
+public:
+  inline bool operator()(const LASspatialSortRun* a, const LASspatialSortRun* b) const
+  {
+    // the heap has the first record on top. equal records come from the earlier run first.
+    if (a->key != b->key) return (a->key > b->key);
+    if (a->gps_time != b->gps_time) return (a->gps_time > b->gps_time);
+    return (a > b);
+  };
+};
+
+BOOL LASspatialSort::write_records(const U8* records, const U32 number)
+{
+  U32 i;
+  for (i = 0; i < number; i++)
+  {
+    point->copy_from(records + (size_t)record_size*i + LAS_SPATIAL_SORT_RECORD_HEADER);
+    if (!laswriter->write_point(point)) return FALSE;
+    laswriter->update_inventory(point);
+    if (lasindex) lasindex->add(point->get_x(), point->get_y(), (U32)number_written);
+    number_written++;
+  }
+  return TRUE;
+}
+
+BOOL LASspatialSort::output_chunk(const BOOL last)
+{
+  if (number_pending == 0) return TRUE;
+  U32 number = number_pending;
+  if (!last)
+  {
+    // end the chunk where the curve leaves the largest square but not before half of it
+
+    U32 i, key, previous, level, best_level = 0;
+    memcpy(&previous, pending + (size_t)record_size*(chunk_size/2 - 1), 4);
+    for (i = chunk_size/2; i < number_pending; i++)
+    {
+      memcpy(&key, pending + (size_t)record_size*i, 4);
+      level = smear_bits(key ^ previous);
+      if (level >= best_level)
+      {
+        best_level = level;
+        number = i;
+      }
+      previous = key;
+    }
+  }
+  if (!write_records(pending, number)) return FALSE;
+  if (compress && !last && !laswriter->chunk()) return FALSE;
+  number_chunks++;
+  number_pending -= number;
+  memmove(pending, pending + (size_t)record_size*number, (size_t)record_size*number_pending);
+  return TRUE;
+}
+
+BOOL LASspatialSort::output(const U8* record)
+{
+  memcpy(pending + (size_t)record_size*number_pending, record, record_size);
+  number_pending++;
+  if (number_pending < chunk_size) return TRUE;
+  return output_chunk(FALSE);
+}
+
+// merges the runs with a heap of the runs ordered by their next record. equal records come from
+// the earlier run first. the records go to the temporary file or, without one, to the output.
+
+BOOL LASspatialSort::merge_runs(LASspatialSortRun* runs, const U32 number, FILE* file)
+{
+  U32 capacity = points_in_memory / number;
+  if (capacity < LAS_SPATIAL_SORT_MIN_BUFFER) capacity = LAS_SPATIAL_SORT_MIN_BUFFER;
+  BOOL failed = FALSE;
+  vector<LASspatialSortRun*> heap;
+  U32 r;
+  for (r = 0; r < number; r++)
+  {
+    LASspatialSortRun* run = &runs[r];
+    run->file = fopen(run->file_name, "rb");
+    run->buffer = (U8*)malloc((size_t)record_size*capacity);
+    if ((run->file == 0) || (run->buffer == 0) || !fill_run(run, record_size, capacity))
+    {
+      fprintf(stderr,"ERROR: cannot read temporary file '%s'\n", run->file_name);
+      failed = TRUE;
+      break;
+    }
+    memcpy(&run->key, run->buffer, 4);
+    memcpy(&run->gps_time, run->buffer + 4, 8);
+    heap.push_back(run);
+  }
+  LASspatialSortRunLater later;
+  make_heap(heap.begin(), heap.end(), later);
+  while (!failed && heap.size())
+  {
+    pop_heap(heap.begin(), heap.end(), later);
+    LASspatialSortRun* run = heap.back();
+    const U8* record = run->buffer + (size_t)record_size*run->next;
+    if (file ? (fwrite(record, record_size, 1, file) != 1) : !output(record))
+    {
+      failed = TRUE;
+      break;
+    }
+    run->next++;
+    if ((run->next == run->number) && !fill_run(run, record_size, capacity))
+    {
+      if (run->remaining)
+      {
+        fprintf(stderr,"ERROR: cannot read temporary file '%s'\n", run->file_name);
+        failed = TRUE;
+      }
+      heap.pop_back();
+      continue;
+    }
+    memcpy(&run->key, run->buffer + (size_t)record_size*run->next, 4);
+    memcpy(&run->gps_time, run->buffer + (size_t)record_size*run->next + 4, 8);
+    push_heap(heap.begin(), heap.end(), later);
+  }
+  for (r = 0; r < number; r++)
+  {
+    if (runs[r].file)
+    {
+      fclose(runs[r].file);
+      runs[r].file = 0;
+    }
+    if (runs[r].buffer)
+    {
+      free(runs[r].buffer);
+      runs[r].buffer = 0;
+    }
+  }
+  return !failed;
+}
+
+I64 LASspatialSort::sort(LASreader* lasreader, const CHAR* file_name_out)
+{
+  number_runs = 0;
+  number_chunks = 0;
+  number_written = 0;
+  number_pending = 0;
+
+  if ((lasreader == 0) || (file_name_out == 0))
+  {
+    fprintf(stderr,"ERROR: reader or file name pointer is zero\n");
+    return -1;
+  }
+
+  const LASheader* header = &lasreader->header;
+  point = &lasreader->point;
+  const U32 point_size = point->total_point_size;
+  record_size = LAS_SPATIAL_SORT_RECORD_HEADER + point_size;
+  U32 number_threads = (threads ? threads : thread::hardware_concurrency());
+  if (number_threads == 0) number_threads = 1;
+
+  // the grid of the keys over the bounding box of the header
+
+  I64 min_X = header->get_X(header->min_x);
+  I64 min_Y = header->get_Y(header->min_y);
+  I64 max_X = header->get_X(header->max_x);
+  I64 max_Y = header->get_Y(header->max_y);
+  if (min_X > max_X) { I64 swap_X = min_X; min_X = max_X; max_X = swap_X; }
+  if (min_Y > max_Y) { I64 swap_Y = min_Y; min_Y = max_Y; max_Y = swap_Y; }
+  const F64 scale_x = 65536.0 / (F64)(max_X - min_X + 1);
+  const F64 scale_y = 65536.0 / (F64)(max_Y - min_Y + 1);
+
+  // the runs are read into one half of the memory while the other half is sorted and stored
+
+  const U32 run_points = points_in_memory / 2;
+  U8* points[2];
+  LASspatialSortEntry* entries[2];
+  LASspatialSortEntry* scratch[2];
+  U32 h;
+  for (h = 0; h < 2; h++)
+  {
+    points[h] = (U8*)malloc((size_t)point_size*run_points);
+    entries[h] = (LASspatialSortEntry*)malloc(sizeof(LASspatialSortEntry)*run_points);
+    scratch[h] = (LASspatialSortEntry*)malloc(sizeof(LASspatialSortEntry)*run_points);
+  }
+  if (!points[0] || !points[1] || !entries[0] || !entries[1] || !scratch[0] || !scratch[1])
+  {
+    fprintf(stderr,"ERROR: cannot allocate memory for sorting %u points\n", points_in_memory);
+    for (h = 0; h < 2; h++)
+    {
+      if (points[h]) free(points[h]);
+      if (entries[h]) free(entries[h]);
+      if (scratch[h]) free(scratch[h]);
+    }
+    return -1;
+  }
+
+  vector<LASspatialSortRun> runs;
+  thread worker;
+  BOOL stored = TRUE;
+  BOOL failed = FALSE;
+  BOOL end = FALSE;
+  U32 n = 0;
+  h = 0;
+  while (!end)
+  {
+    I64 X, Y;
+    U32 x, y;
+    n = 0;
+    while ((n < run_points) && lasreader->read_point())
+    {
+      point->copy_to(points[h] + (size_t)point_size*n);
+      X = point->get_X();
+      Y = point->get_Y();
+      X = (X < min_X ? min_X : (X > max_X ? max_X : X));
+      Y = (Y < min_Y ? min_Y : (Y > max_Y ? max_Y : Y));
+      x = (U32)((X - min_X) * scale_x);
+      y = (U32)((Y - min_Y) * scale_y);
+      if (x > 65535) x = 65535;
+      if (y > 65535) y = 65535;
+      entries[h][n].key = (curve == LAS_SPATIAL_SORT_HILBERT ? get_hilbert_key(x, y) : get_morton_key(x, y));
+      entries[h][n].index = n;
+      entries[h][n].gps_time = (point->have_gps_time ? point->gps_time : 0.0);
+      n++;
+    }
+    end = ((n < run_points) || (lasreader->npoints && (lasreader->p_count >= lasreader->npoints)));
+
+    if (worker.joinable()) worker.join();
+    if (!stored)
+    {
+      fprintf(stderr,"ERROR: cannot store run %u to '%s'\n", number_runs - 1, runs.back().file_name);
+      failed = TRUE;
+      break;
+    }
+    if (n == 0) break;
+    if (end && (number_runs == 0))
+    {
+      // all points fit into memory. they are sorted here and written without temporary files.
+      sort_entries(entries[h], scratch[h], n, number_threads);
+      number_runs = 1;
+      break;
+    }
+
+    LASspatialSortRun run;
+    memset(&run, 0, sizeof(LASspatialSortRun));
+    run.file_name = (CHAR*)malloc(strlen(file_name_out) + 32);
+    sprintf(run.file_name, "%s.run%u.tmp", file_name_out, number_runs);
+    run.file = fopen(run.file_name, "wb");
+    run.remaining = n;
+    runs.push_back(run);
+    number_runs++;
+    if (run.file == 0)
+    {
+      fprintf(stderr,"ERROR: cannot open temporary file '%s'\n", run.file_name);
+      failed = TRUE;
+      break;
+    }
+    LASspatialSortEntry* run_entries = entries[h];
+    LASspatialSortEntry* run_scratch = scratch[h];
+    const U8* run_points_bytes = points[h];
+    FILE* run_file = run.file;
+    runs.back().file = 0;
+    worker = thread([&stored, run_entries, run_scratch, run_points_bytes, n, point_size, number_threads, run_file]()
+    {
+      stored = store_run(run_entries, run_scratch, run_points_bytes, n, point_size, number_threads, run_file);
+      if (fclose(run_file) != 0) stored = FALSE;
+    });
+    h = 1 - h;
+  }
+  if (worker.joinable()) worker.join();
+  if (!stored && !failed)
+  {
+    fprintf(stderr,"ERROR: cannot store run %u to '%s'\n", number_runs - 1, runs.back().file_name);
+    failed = TRUE;
+  }
+  if (runs.size())
+  {
+    for (h = 0; h < 2; h++)
+    {
+      free(points[h]);
+      free(entries[h]);
+      free(scratch[h]);
+      points[h] = 0;
+      entries[h] = 0;
+      scratch[h] = 0;
+    }
+  }
+
+  // the output
+
+  size_t len = strlen(file_name_out);
+  compress = (len && ((file_name_out[len-1] == 'z') || (file_name_out[len-1] == 'Z')));
+  laswriter = 0;
+  lasindex = 0;
+  pending = 0;
+  if (!failed)
+  {
+    laswriter = new LASwriterLAS();
+    laswriter->set_adaptive_chunking(TRUE);
+    if (chunk_stats && compress) laswriter->set_chunk_stats(TRUE);
+    if (!laswriter->open(file_name_out, header, (compress ? LASZIP_COMPRESSOR_LAYERED_CHUNKED : LASZIP_COMPRESSOR_NONE), 2, 0))
+    {
+      fprintf(stderr,"ERROR: cannot open '%s' for sorting\n", file_name_out);
+      failed = TRUE;
+    }
+    pending = (U8*)malloc((size_t)record_size*chunk_size);
+    if (pending == 0)
+    {
+      fprintf(stderr,"ERROR: cannot allocate memory for a chunk of %u points\n", chunk_size);
+      failed = TRUE;
+    }
+  }
+  if (!failed && index)
+  {
+    F32 size = cell_size;
+    if (size <= 0.0f)
+    {
+      F64 area = (header->max_x - header->min_x) * (header->max_y - header->min_y);
+      I64 npoints = (lasreader->npoints ? lasreader->npoints : lasreader->p_count);
+      size = (F32)((area > 0.0) && (npoints > 0) ? sqrt(area * LAS_SPATIAL_SORT_INDEX_POINTS / npoints) : 1000.0);
+      if (size < 0.01f) size = 0.01f;
+    }
+    LASquadtree* lasquadtree = new LASquadtree;
+    if (lasquadtree->setup(header->min_x, header->max_x, header->min_y, header->max_y, size))
+    {
+      lasindex = new LASindex;
+      lasindex->prepare(lasquadtree, 1000);
+    }
+    else
+    {
+      fprintf(stderr,"ERROR: cannot set up the spatial index of '%s'\n", file_name_out);
+      delete lasquadtree;
+      failed = TRUE;
+    }
+  }
+
+  if (!failed && (runs.size() == 0))
+  {
+    U8* record = (U8*)malloc(record_size);
+    U32 i;
+    for (i = 0; (i < n) && !failed; i++)
+    {
+      memcpy(record, &entries[h][i].key, 4);
+      memcpy(record + 4, &entries[h][i].gps_time, 8);
+      memcpy(record + LAS_SPATIAL_SORT_RECORD_HEADER, points[h] + (size_t)point_size*entries[h][i].index, point_size);
+      if (!output(record)) failed = TRUE;
+    }
+    free(record);
+  }
+  else if (!failed)
+  {
+    // while there are too many runs, consecutive groups of them are merged into longer runs
+    // that take their place. the last pass merges into the output.
+
+    U32 number_files = number_runs;
+    while (!failed && (runs.size() > LAS_SPATIAL_SORT_MAX_RUNS))
+    {
+      vector<LASspatialSortRun> merged;
+      U32 first, r;
+      for (first = 0; first < runs.size(); first += LAS_SPATIAL_SORT_MAX_RUNS)
+      {
+        U32 number = (U32)runs.size() - first;
+        if (number > LAS_SPATIAL_SORT_MAX_RUNS) number = LAS_SPATIAL_SORT_MAX_RUNS;
+        if (failed || (number == 1))
+        {
+          for (r = first; r < first + number; r++) merged.push_back(runs[r]);
+          continue;
+        }
+        LASspatialSortRun run;
+        memset(&run, 0, sizeof(LASspatialSortRun));
+        run.file_name = (CHAR*)malloc(strlen(file_name_out) + 32);
+        sprintf(run.file_name, "%s.run%u.tmp", file_name_out, number_files++);
+        for (r = first; r < first + number; r++) run.remaining += runs[r].remaining;
+        merged.push_back(run);
+        FILE* file = fopen(run.file_name, "wb");
+        if (file == 0)
+        {
+          fprintf(stderr,"ERROR: cannot open temporary file '%s'\n", run.file_name);
+          failed = TRUE;
+        }
+        else
+        {
+          if (!merge_runs(&runs[first], number, file)) failed = TRUE;
+          if (fclose(file) != 0)
+          {
+            fprintf(stderr,"ERROR: cannot write temporary file '%s'\n", run.file_name);
+            failed = TRUE;
+          }
+        }
+        for (r = first; r < first + number; r++)
+        {
+          remove(runs[r].file_name);
+          free(runs[r].file_name);
+        }
+      }
+      runs.swap(merged);
+    }
+    if (!failed && !merge_runs(&runs[0], (U32)runs.size(), 0))
+    {
+      failed = TRUE;
+    }
+  }
+  if (!failed && !output_chunk(TRUE))
+  {
+    failed = TRUE;
+  }
+  if (failed && laswriter)
+  {
+    fprintf(stderr,"ERROR: cannot write point %lld to '%s'\n", number_written, file_name_out);
+  }
+
+  // clean up
+
+  U32 r;
+  for (r = 0; r < runs.size(); r++)
+  {
+    if (runs[r].file) fclose(runs[r].file);
+    if (runs[r].buffer) free(runs[r].buffer);
+    remove(runs[r].file_name);
+    free(runs[r].file_name);
+  }
+  for (h = 0; h < 2; h++)
+  {
+    if (points[h]) free(points[h]);
+    if (entries[h]) free(entries[h]);
+    if (scratch[h]) free(scratch[h]);
+  }
+  if (pending)
+  {
+    free(pending);
+    pending = 0;
+  }
+  const BOOL opened = (laswriter != 0);
+  if (laswriter)
+  {
+    laswriter->update_header(header, TRUE);
+    laswriter->close();
+    delete laswriter;
+    laswriter = 0;
+  }
+  if (lasindex)
+  {
+    if (!failed)
+    {
+      lasindex->complete(LAS_SPATIAL_SORT_INDEX_POINTS, -20, FALSE);
+      if (!lasindex->write(file_name_out))
+      {
+        fprintf(stderr,"ERROR: cannot write the spatial index of '%s'\n", file_name_out);
+        failed = TRUE;
+      }
+    }
+    delete lasindex;
+    lasindex = 0;
+  }
+  if (failed && opened)
+  {
+    // no partial output and no chunk statistics that would describe it
+    remove(file_name_out);
+    LASchunkStats::remove(file_name_out);
+  }
+  point = 0;
+
+  return (failed ? -1 : number_written);
+}
+
+LASspatialSort::LASspatialSort()
+{
+  curve = LAS_SPATIAL_SORT_HILBERT;
+  points_in_memory = 4000000;
+  threads = 0;
+  chunk_size = LASZIP_CHUNK_SIZE_DEFAULT;
+  index = FALSE;
+  cell_size = 0.0f;
+  chunk_stats = FALSE;
+  number_runs = 0;
+  number_chunks = 0;
+  point = 0;
+  laswriter = 0;
+  lasindex = 0;
+  compress = FALSE;
+  record_size = 0;
+  number_pending = 0;
+  pending = 0;
+  number_written = 0;
+}
+
+LASspatialSort::~LASspatialSort()
+{
+}
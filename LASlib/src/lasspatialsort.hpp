@@ -0,0 +1,107 @@
+/*
+===============================================================================
+
+  FILE:  lasspatialsort.hpp
+
+  CONTENTS:
+
+    Rewrites the points of a reader in the order of a space-filling curve (like
+    lassort) so that a spatial query touches few chunks of the output. The key
+    of a point is its cell in a 65536 by 65536 grid over the bounding box of
+    the header numbered along a Morton (Z-order) or a Hilbert curve. Points of
+    the same cell are ordered by GPS time and then by their input order, so the
+    output is the same no matter how many threads sort.
+
+    The sort runs in external memory with a bounded number of points in memory.
+    The points are read in runs. While one run is read the previous one is
+    sorted by several threads and stored to a temporary file next to the
+    output. The runs are then merged into the output. With many runs they are
+    first merged in groups into longer runs so that only a few files are open
+    at once. If all points fit into one run there are no temporary files.
+
+    LAZ output uses variable chunking. A chunk ends where the curve leaves the
+    largest square between half and all of the chunk size, so every chunk covers
+    few cells of the grid. The spatial index (*.lax) of the output and the per-
+    chunk statistics (*.lcs) of LAZ output can be created in the same pass.
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the LICENSE.txt file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created to make circle queries on flight-line ordered tiles cheap
+
+===============================================================================
+*/
+#ifndef LAS_SPATIAL_SORT_HPP
+#define LAS_SPATIAL_SORT_HPP
+
+#include "lasdefinitions.hpp"
+
+class LASreader;
+class LASwriterLAS;
+class LASindex;
+class LASspatialSortRun;
+
+#define LAS_SPATIAL_SORT_MORTON   0
+#define LAS_SPATIAL_SORT_HILBERT  1
+
+class LASLIB_DLL LASspatialSort
+{
+public:
+  void set_curve(const U32 curve) { this->curve = curve; };
+  // the points in memory at once, half of them being read and half being sorted
+  void set_points_in_memory(const U32 points_in_memory) { this->points_in_memory = (points_in_memory < 2 ? 2 : points_in_memory); };
+  // the threads sorting a run. 0 uses one per core.
+  void set_threads(const U32 threads) { this->threads = threads; };
+  // chunks of LAZ output hold between half of this and this many points
+  void set_chunk_size(const U32 chunk_size) { this->chunk_size = (chunk_size < 2 ? 2 : chunk_size); };
+  // also writes the *.lax of the output. with a cell size of 0 a cell holds about 1000 points.
+  void set_index(const BOOL index=TRUE, const F32 cell_size=0.0f) { this->index = index; this->cell_size = cell_size; };
+  // also writes the *.lcs of LAZ output
+  void set_chunk_stats(const BOOL chunk_stats=TRUE) { this->chunk_stats = chunk_stats; };
+
+  // reads all points of the reader and writes them sorted to the output (as LAZ if the
+  // file name ends in 'z'). returns the number of points written or -1 on failure, in
+  // which case the partial output is removed.
+  I64 sort(LASreader* lasreader, const CHAR* file_name_out);
+
+  // how the last sort went
+  inline U32 get_number_runs() const { return number_runs; };
+  inline U32 get_number_chunks() const { return number_chunks; };
+
+  LASspatialSort();
+  ~LASspatialSort();
+
+private:
+  BOOL output(const U8* record);
+  BOOL output_chunk(const BOOL last);
+  BOOL write_records(const U8* records, const U32 number);
+  BOOL merge_runs(LASspatialSortRun* runs, const U32 number, FILE* file);
+  U32 curve;
+  U32 points_in_memory;
+  U32 threads;
+  U32 chunk_size;
+  BOOL index;
+  F32 cell_size;
+  BOOL chunk_stats;
+  U32 number_runs;
+  U32 number_chunks;
+  // the output. records are the key, the GPS time, and the point.
+  LASpoint* point;
+  LASwriterLAS* laswriter;
+  LASindex* lasindex;
+  BOOL compress;
+  U32 record_size;
+  U32 number_pending;
+  U8* pending;
+  I64 number_written;
+};
+
+#endif
@@ -0,0 +1,266 @@
+/*
+===============================================================================
+
+  FILE:  lasthingrid.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the LICENSE.txt file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "lasthingrid.hpp"
+
+#include "laspoint.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// marks an empty slot. it is the key of the cell (I32_MAX, I32_MAX), which no point reaches
+// because the cell positions are clamped to one less.
+
+#define LAS_THIN_GRID_EMPTY          0xFFFFFFFFFFFFFFFFULL
+#define LAS_THIN_GRID_MIN_CAPACITY   1024
+
+// the finalizer of MurmurHash3 spreads the neighbouring cells over the whole table
+
+static inline U32 hash_key(U64 key)
+{
+  key ^= (key >> 33);
+  key *= 0xFF51AFD7ED558CCDULL;
+  key ^= (key >> 33);
+  key *= 0xC4CEB9FE1A85EC53ULL;
+  key ^= (key >> 33);
+  return (U32)key;
+}
+
+static inline U32 get_position(const F64 coordinate, const F64 grid_spacing)
+{
+  F64 position = coordinate / grid_spacing;
+  I64 floor = I64_FLOOR(position);
+  if (floor < I32_MIN) floor = I32_MIN;
+  else if (floor >= I32_MAX) floor = I32_MAX - 1;
+  // flip the sign bit so the order of the unsigned positions is that of the signed ones
+  return ((U32)((I32)floor)) ^ 0x80000000;
+}
+
+U64 LASthinGrid::get_key(const F64 x, const F64 y) const
+{
+  return (((U64)get_position(x, grid_spacing)) << 32) | ((U64)get_position(y, grid_spacing));
+}
+
+U32 LASthinGrid::find(const U64 key) const
+{
+  U32 mask = capacity - 1;
+  U32 slot = hash_key(key) & mask;
+  while ((keys[slot] != LAS_THIN_GRID_EMPTY) && (keys[slot] != key))
+  {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+BOOL LASthinGrid::grow()
+{
+  U32 old_capacity = capacity;
+  U64* old_keys = keys;
+  I64* old_indices = indices;
+  F64* old_values = values;
+
+  if (old_capacity >= 0x80000000)
+  {
+    fprintf(stderr,"ERROR: thinning grid cannot hold more than %u cells\n", number_cells);
+    return FALSE;
+  }
+  capacity = (old_capacity ? 2 * old_capacity : LAS_THIN_GRID_MIN_CAPACITY);
+  keys = (U64*)malloc(sizeof(U64)*capacity);
+  if (mode != LAS_THIN_FIRST)
+  {
+    indices = (I64*)malloc(sizeof(I64)*capacity);
+    values = (F64*)malloc(sizeof(F64)*capacity);
+  }
+  if ((keys == 0) || ((mode != LAS_THIN_FIRST) && ((indices == 0) || (values == 0))))
+  {
+    fprintf(stderr,"ERROR: allocating thinning grid with %u cells\n", capacity);
+    if (keys) free(keys);
+    if ((mode != LAS_THIN_FIRST) && indices) free(indices);
+    if ((mode != LAS_THIN_FIRST) && values) free(values);
+    capacity = old_capacity;
+    keys = old_keys;
+    indices = old_indices;
+    values = old_values;
+    return FALSE;
+  }
+  memset(keys, 0xFF, sizeof(U64)*capacity);
+
+  U32 i, slot;
+  for (i = 0; i < old_capacity; i++)
+  {
+    if (old_keys[i] != LAS_THIN_GRID_EMPTY)
+    {
+      slot = find(old_keys[i]);
+      keys[slot] = old_keys[i];
+      if (mode != LAS_THIN_FIRST)
+      {
+        indices[slot] = old_indices[i];
+        values[slot] = old_values[i];
+      }
+    }
+  }
+  if (old_keys) free(old_keys);
+  if (old_indices) free(old_indices);
+  if (old_values) free(old_values);
+  return TRUE;
+}
+
+BOOL LASthinGrid::init(const F64 grid_spacing, const U32 mode)
+{
+  if (grid_spacing <= 0.0)
+  {
+    fprintf(stderr,"ERROR: grid spacing %g is not positive\n", grid_spacing);
+    return FALSE;
+  }
+  if (mode > LAS_THIN_CENTRAL)
+  {
+    fprintf(stderr,"ERROR: thinning mode %u not implemented\n", mode);
+    return FALSE;
+  }
+  clean();
+  this->grid_spacing = grid_spacing;
+  this->mode = mode;
+  return TRUE;
+}
+
+BOOL LASthinGrid::add(const LASpoint* point, const I64 index)
+{
+  return add(point->get_x(), point->get_y(), point->get_z(), index);
+}
+
+BOOL LASthinGrid::add(const F64 x, const F64 y, const F64 z, const I64 index)
+{
+  // at most three quarters of the slots are used to keep the probe sequences short
+  if (4 * (U64)(number_cells + 1) > 3 * (U64)capacity)
+  {
+    if (!grow())
+    {
+      failed = TRUE;
+      return FALSE;
+    }
+  }
+
+  U64 key = get_key(x, y);
+  U32 slot = find(key);
+
+  F64 value = 0.0;
+  if (mode == LAS_THIN_LOWEST)
+  {
+    value = z;
+  }
+  else if (mode == LAS_THIN_HIGHEST)
+  {
+    value = -z;
+  }
+  else if (mode == LAS_THIN_CENTRAL)
+  {
+    F64 dx = x - (I64_FLOOR(x / grid_spacing) + 0.5) * grid_spacing;
+    F64 dy = y - (I64_FLOOR(y / grid_spacing) + 0.5) * grid_spacing;
+    value = dx*dx + dy*dy;
+  }
+
+  if (keys[slot] == LAS_THIN_GRID_EMPTY)
+  {
+    keys[slot] = key;
+    if (mode != LAS_THIN_FIRST)
+    {
+      indices[slot] = index;
+      values[slot] = value;
+    }
+    number_cells++;
+    return TRUE;
+  }
+  if ((mode != LAS_THIN_FIRST) && (value < values[slot]))
+  {
+    indices[slot] = index;
+    values[slot] = value;
+    return TRUE;
+  }
+  return FALSE;
+}
+
+BOOL LASthinGrid::is_kept(const LASpoint* point, const I64 index) const
+{
+  return is_kept(point->get_x(), point->get_y(), index);
+}
+
+BOOL LASthinGrid::is_kept(const F64 x, const F64 y, const I64 index) const
+{
+  if ((mode == LAS_THIN_FIRST) || (capacity == 0))
+  {
+    return FALSE;
+  }
+  U32 slot = find(get_key(x, y));
+  return ((keys[slot] != LAS_THIN_GRID_EMPTY) && (indices[slot] == index));
+}
+
+void LASthinGrid::reset()
+{
+  if (capacity)
+  {
+    memset(keys, 0xFF, sizeof(U64)*capacity);
+  }
+  number_cells = 0;
+  failed = FALSE;
+}
+
+void LASthinGrid::clean()
+{
+  if (keys)
+  {
+    free(keys);
+    keys = 0;
+  }
+  if (indices)
+  {
+    free(indices);
+    indices = 0;
+  }
+  if (values)
+  {
+    free(values);
+    values = 0;
+  }
+  capacity = 0;
+  number_cells = 0;
+  failed = FALSE;
+}
+
+LASthinGrid::LASthinGrid(const F64 grid_spacing, const U32 mode)
+{
+  keys = 0;
+  indices = 0;
+  values = 0;
+  capacity = 0;
+  number_cells = 0;
+  failed = FALSE;
+  this->grid_spacing = grid_spacing;
+  this->mode = mode;
+}
+
+LASthinGrid::~LASthinGrid()
+{
+  clean();
+}
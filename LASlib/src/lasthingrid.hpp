@@ -0,0 +1,88 @@
+/*
+===============================================================================
+
+  FILE:  lasthingrid.hpp
+
+  CONTENTS:
+
+    Thins points with a grid by keeping one point per occupied cell. Only the
+    occupied cells are stored, as 64 bit keys in an open-addressing hash set,
+    so the memory grows with the number of occupied cells and not with the
+    extent of the points or the fineness of the grid.
+
+    Which point of a cell survives depends on the mode. LAS_THIN_FIRST keeps
+    the first point and decides in a single pass. LAS_THIN_LOWEST, _HIGHEST,
+    and _CENTRAL keep the point with the lowest or highest z or the one that
+    is closest to the center of the cell and need two passes: all points are
+    offered with add() and afterwards is_kept() tells for every point whether
+    it is the one kept. Ties go to the point offered first.
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the LICENSE.txt file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created for thinning ground points before making a DTM
+
+===============================================================================
+*/
+#ifndef LAS_THIN_GRID_HPP
+#define LAS_THIN_GRID_HPP
+
+#include "lasdefinitions.hpp"
+
+#define LAS_THIN_FIRST    0
+#define LAS_THIN_LOWEST   1
+#define LAS_THIN_HIGHEST  2
+#define LAS_THIN_CENTRAL  3
+
+class LASLIB_DLL LASthinGrid
+{
+public:
+  BOOL init(const F64 grid_spacing, const U32 mode=LAS_THIN_FIRST);
+  inline U32 get_mode() const { return mode; };
+  inline F64 get_grid_spacing() const { return grid_spacing; };
+
+  // offers the point with the given (running) index. returns TRUE if the point is kept for
+  // now, which for LAS_THIN_FIRST is final and means its cell was still empty.
+  BOOL add(const LASpoint* point, const I64 index=0);
+  BOOL add(const F64 x, const F64 y, const F64 z, const I64 index=0);
+
+  // after all points were offered: is the point with the given index kept. not available
+  // for LAS_THIN_FIRST, which does not remember the indices.
+  BOOL is_kept(const LASpoint* point, const I64 index) const;
+  BOOL is_kept(const F64 x, const F64 y, const I64 index) const;
+
+  inline U32 get_number_cells() const { return number_cells; };
+
+  // TRUE once the grid could not grow, after which the points of new cells were dropped
+  inline BOOL has_failed() const { return failed; };
+
+  // forgets all cells but keeps the grid spacing and the mode
+  void reset();
+
+  LASthinGrid(const F64 grid_spacing=1.0, const U32 mode=LAS_THIN_FIRST);
+  ~LASthinGrid();
+
+private:
+  U64 get_key(const F64 x, const F64 y) const;
+  U32 find(const U64 key) const;
+  BOOL grow();
+  void clean();
+  F64 grid_spacing;
+  U32 mode;
+  U32 number_cells;
+  U32 capacity;     // always a power of two
+  U64* keys;
+  I64* indices;     // not used for LAS_THIN_FIRST
+  F64* values;      // not used for LAS_THIN_FIRST
+  BOOL failed;
+};
+
+#endif
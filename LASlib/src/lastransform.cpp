@@ -31,17 +31,26 @@
 #include "lastransform.hpp"
 
 #include "lasfilter.hpp"
+#include "lascolumndecoder.hpp"
+#include "lasrandom.hpp"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 
+static inline void set_identity(F64* matrix)
+{
+  memset(matrix, 0, sizeof(F64)*12);
+  matrix[0] = matrix[5] = matrix[10] = 1.0;
+}
+
 class LASoperationTranslateX : public LASoperation
 {
 public:
   inline const CHAR* name() const { return "translate_x"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf ", name(), offset); };
+  inline BOOL get_affine(F64* matrix) const { set_identity(matrix); matrix[3] = offset; return TRUE; };
   inline void transform(LASpoint* point) {
     point->set_x(point->get_x() + offset);
   };
@@ -55,6 +64,7 @@ class LASoperationTranslateY : public LASoperation
 public:
   inline const CHAR* name() const { return "translate_y"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf ", name(), offset); };
+  inline BOOL get_affine(F64* matrix) const { set_identity(matrix); matrix[7] = offset; return TRUE; };
   inline void transform(LASpoint* point) {
     point->set_y(point->get_y() + offset);
   };
@@ -69,6 +79,7 @@ public:
   inline const CHAR* name() const { return "translate_z"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf ", name(), offset); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_Z; };
+  inline BOOL get_affine(F64* matrix) const { set_identity(matrix); matrix[11] = offset; return TRUE; };
   inline void transform(LASpoint* point) {
     point->set_z(point->get_z() + offset);
   };
@@ -83,6 +94,7 @@ public:
   inline const CHAR* name() const { return "translate_xyz"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf %lf %lf ", name(), offset[0], offset[1], offset[2]); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_CHANNEL_RETURNS_XY | LASZIP_DECOMPRESS_SELECTIVE_Z; };
+  inline BOOL get_affine(F64* matrix) const { set_identity(matrix); matrix[3] = offset[0]; matrix[7] = offset[1]; matrix[11] = offset[2]; return TRUE; };
   inline void transform(LASpoint* point) {
     point->set_x(point->get_x() + offset[0]);
     point->set_y(point->get_y() + offset[1]);
@@ -98,6 +110,7 @@ class LASoperationScaleX : public LASoperation
 public:
   inline const CHAR* name() const { return "scale_x"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf ", name(), scale); };
+  inline BOOL get_affine(F64* matrix) const { set_identity(matrix); matrix[0] = scale; return TRUE; };
   inline void transform(LASpoint* point) {
     point->set_x(point->get_x() * scale);
   };
@@ -111,6 +124,7 @@ class LASoperationScaleY : public LASoperation
 public:
   inline const CHAR* name() const { return "scale_y"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf ", name(), scale); };
+  inline BOOL get_affine(F64* matrix) const { set_identity(matrix); matrix[5] = scale; return TRUE; };
   inline void transform(LASpoint* point) {
     point->set_y(point->get_y() * scale);
   };
@@ -125,6 +139,7 @@ public:
   inline const CHAR* name() const { return "scale_z"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf ", name(), scale); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_Z; };
+  inline BOOL get_affine(F64* matrix) const { set_identity(matrix); matrix[10] = scale; return TRUE; };
   inline void transform(LASpoint* point) {
     point->set_z(point->get_z() * scale);
   };
@@ -139,6 +154,7 @@ public:
   inline const CHAR* name() const { return "scale_xyz"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf %lf %lf ", name(), scale[0], scale[1], scale[2]); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_CHANNEL_RETURNS_XY | LASZIP_DECOMPRESS_SELECTIVE_Z; };
+  inline BOOL get_affine(F64* matrix) const { set_identity(matrix); matrix[0] = scale[0]; matrix[5] = scale[1]; matrix[10] = scale[2]; return TRUE; };
   inline void transform(LASpoint* point) {
     point->set_x(point->get_x() * scale[0]);
     point->set_y(point->get_y() * scale[1]);
@@ -154,6 +170,7 @@ class LASoperationTranslateThenScaleX : public LASoperation
 public:
   inline const CHAR* name() const { return "translate_then_scale_x"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf %lf ", name(), offset, scale); };
+  inline BOOL get_affine(F64* matrix) const { set_identity(matrix); matrix[0] = scale; matrix[3] = offset*scale; return TRUE; };
   inline void transform(LASpoint* point) {
     point->set_x((point->get_x()+offset)*scale);
   };
@@ -168,6 +185,7 @@ class LASoperationTranslateThenScaleY : public LASoperation
 public:
   inline const CHAR* name() const { return "translate_then_scale_y"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf %lf ", name(), offset, scale); };
+  inline BOOL get_affine(F64* matrix) const { set_identity(matrix); matrix[5] = scale; matrix[7] = offset*scale; return TRUE; };
   inline void transform(LASpoint* point) {
     point->set_y((point->get_y()+offset)*scale);
   };
@@ -183,6 +201,7 @@ public:
   inline const CHAR* name() const { return "translate_then_scale_z"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf %lf ", name(), offset, scale); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_Z; };
+  inline BOOL get_affine(F64* matrix) const { set_identity(matrix); matrix[10] = scale; matrix[11] = offset*scale; return TRUE; };
   inline void transform(LASpoint* point) {
     point->set_z((point->get_z()+offset)*scale);
   };
@@ -197,6 +216,12 @@ class LASoperationRotateXY : public LASoperation
 public:
   inline const CHAR* name() const { return "rotate_xy"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf %lf %lf ", name(), angle, x_offset, y_offset); };
+  inline BOOL get_affine(F64* matrix) const {
+    set_identity(matrix);
+    matrix[0] = cos_angle; matrix[1] = -sin_angle; matrix[3] = x_offset - cos_angle*x_offset + sin_angle*y_offset;
+    matrix[4] = sin_angle; matrix[5] = cos_angle; matrix[7] = y_offset - sin_angle*x_offset - cos_angle*y_offset;
+    return TRUE;
+  };
   inline void transform(LASpoint* point) {
     F64 x = point->get_x() - x_offset;
     F64 y = point->get_y() - y_offset;
@@ -216,6 +241,12 @@ public:
   inline const CHAR* name() const { return "rotate_xz"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf %lf %lf ", name(), angle, x_offset, z_offset); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_CHANNEL_RETURNS_XY | LASZIP_DECOMPRESS_SELECTIVE_Z; };
+  inline BOOL get_affine(F64* matrix) const {
+    set_identity(matrix);
+    matrix[0] = cos_angle; matrix[2] = -sin_angle; matrix[3] = x_offset - cos_angle*x_offset + sin_angle*z_offset;
+    matrix[8] = sin_angle; matrix[10] = cos_angle; matrix[11] = z_offset - sin_angle*x_offset - cos_angle*z_offset;
+    return TRUE;
+  };
   inline void transform(LASpoint* point) {
     F64 x = point->get_x() - x_offset;
     F64 z = point->get_z() - z_offset;
@@ -235,6 +266,12 @@ public:
   inline const CHAR* name() const { return "transform_helmert"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf,%lf,%lf,%lf,%lf,%lf,%lf ", name(), dx, dy, dz, rx, ry, rz, m); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_CHANNEL_RETURNS_XY | LASZIP_DECOMPRESS_SELECTIVE_Z; };
+  inline BOOL get_affine(F64* matrix) const {
+    matrix[0] = scale; matrix[1] = -scale*rz_rad; matrix[2] = scale*ry_rad; matrix[3] = dx;
+    matrix[4] = scale*rz_rad; matrix[5] = scale; matrix[6] = -scale*rx_rad; matrix[7] = dy;
+    matrix[8] = -scale*ry_rad; matrix[9] = scale*rx_rad; matrix[10] = scale; matrix[11] = dz;
+    return TRUE;
+  };
   inline void transform(LASpoint* point) {
     F64 x = scale*( (       point->get_x())-(rz_rad*point->get_y())+(ry_rad*point->get_z())) + dx;
     F64 y = scale*( (rz_rad*point->get_x())+(       point->get_y())-(rx_rad*point->get_z())) + dy;
@@ -254,6 +291,12 @@ public:
   inline const CHAR* name() const { return "transform_affine"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %lf,%lf,%lf,%lf ", name(), r, w, tx, ty); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_CHANNEL_RETURNS_XY; };
+  inline BOOL get_affine(F64* matrix) const {
+    set_identity(matrix);
+    matrix[0] = r*cosw; matrix[1] = r*sinw; matrix[3] = tx;
+    matrix[4] = -r*sinw; matrix[5] = r*cosw; matrix[7] = ty;
+    return TRUE;
+  };
   inline void transform(LASpoint* point) {
     F64 x = r * ((cosw * point->get_x()) + (sinw * point->get_y())) + tx;
     F64 y = r * ((cosw * point->get_y()) - (sinw * point->get_x())) + ty;
@@ -396,19 +439,18 @@ class LASoperationTranslateRawXYatRandom : public LASoperation
 public:
   inline const CHAR* name() const { return "translate_raw_xy_at_random"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d %d ", name(), max_raw_offset[0], max_raw_offset[1]); };
+  inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_CHANNEL_RETURNS_XY | LASZIP_DECOMPRESS_SELECTIVE_Z | LASZIP_DECOMPRESS_SELECTIVE_GPS_TIME; };
   inline void transform(LASpoint* point) {
+    // see lasrandom.hpp
+    U64 random = LASrandom::get(0, point);
     I32 r;
-    srand(seed);
-    seed = rand();
-    r = ((seed >> 3) % ((2 * max_raw_offset[0]) + 1)) - max_raw_offset[0];
+    r = (I32)LASrandom::get_below((U32)(random >> 32), (2 * max_raw_offset[0]) + 1) - max_raw_offset[0];
     point->set_X(point->get_X() + r);
-    r = ((seed >> 6) % ((2 * max_raw_offset[1]) + 1)) - max_raw_offset[1];
+    r = (I32)LASrandom::get_below((U32)random, (2 * max_raw_offset[1]) + 1) - max_raw_offset[1];
     point->set_Y(point->get_Y() + r);
   };
-  void reset() { seed = 0; };
-  LASoperationTranslateRawXYatRandom(I32 max_raw_x_offset, I32 max_raw_y_offset) { seed = 0; max_raw_offset[0] = max_raw_x_offset; max_raw_offset[1] = max_raw_y_offset; };
+  LASoperationTranslateRawXYatRandom(I32 max_raw_x_offset, I32 max_raw_y_offset) { max_raw_offset[0] = max_raw_x_offset; max_raw_offset[1] = max_raw_y_offset; };
 private:
-  U32 seed;
   I32 max_raw_offset[2];
 };
 
@@ -650,6 +692,7 @@ class LASoperationSetClassification : public LASoperation
 public:
   inline const CHAR* name() const { return "set_classification"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d ", name(), classification); };
+  inline U32 get_lookup() const { return LAS_OPERATION_LOOKUP_CLASSIFICATION; };
   inline void transform(LASpoint* point) { point->set_extended_classification(classification); };
   LASoperationSetClassification(U8 classification) { this->classification = classification; };
 private:
@@ -662,6 +705,7 @@ public:
   inline const CHAR* name() const { return "change_classification_from_to"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d %d ", name(), class_from, class_to); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_CLASSIFICATION; };
+  inline U32 get_lookup() const { return LAS_OPERATION_LOOKUP_CLASSIFICATION; };
   inline void transform(LASpoint* point) {
     if (class_from > 31)
     {
@@ -928,6 +972,7 @@ class LASoperationSetUserData : public LASoperation
 public:
   inline const CHAR* name() const { return "set_user_data"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d ", name(), user_data); };
+  inline U32 get_lookup() const { return LAS_OPERATION_LOOKUP_USER_DATA; };
   inline void transform(LASpoint* point) { point->user_data = user_data; };
   LASoperationSetUserData(U8 user_data) { this->user_data = user_data; };
 private:
@@ -940,6 +985,7 @@ public:
   inline const CHAR* name() const { return "scale_user_data"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %g ", name(), scale); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_USER_DATA; };
+  inline U32 get_lookup() const { return LAS_OPERATION_LOOKUP_USER_DATA; };
   inline void transform(LASpoint* point) {
     point->set_user_data(U8_CLAMP(scale*point->get_user_data()));
   };
@@ -954,6 +1000,7 @@ public:
   inline const CHAR* name() const { return "change_user_data_from_to"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s %d %d ", name(), user_data_from, user_data_to); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_USER_DATA; };
+  inline U32 get_lookup() const { return LAS_OPERATION_LOOKUP_USER_DATA; };
   inline void transform(LASpoint* point) { if (point->get_user_data() == user_data_from) point->set_user_data(user_data_to); };
   LASoperationChangeUserDataFromTo(U8 user_data_from, U8 user_data_to) { this->user_data_from = user_data_from; this->user_data_to = user_data_to; };
 private:
@@ -967,6 +1014,7 @@ public:
   inline const CHAR* name() const { return "map_user_data"; };
   inline I32 get_command(CHAR* string) const { return sprintf(string, "-%s \"%s\" ", name(), map_file_name); };
   inline U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_USER_DATA; };
+  inline U32 get_lookup() const { return LAS_OPERATION_LOOKUP_USER_DATA; };
   inline void transform(LASpoint* point) { U8 user_data = point->get_user_data(); point->set_user_data(map[user_data]); };
   LASoperationMapUserData(const CHAR* file_name)
   {
@@ -1597,6 +1645,163 @@ private:
   F64 offset;
 };
 
+// one step of a compiled transform: a single operation, a run of affine operations fused
+// into one matrix, or a run of classification or user data operations fused into a table
+
+#define LAS_TRANSFORM_STAGE_OPERATION       0
+#define LAS_TRANSFORM_STAGE_AFFINE          1
+#define LAS_TRANSFORM_STAGE_CLASSIFICATION  2
+#define LAS_TRANSFORM_STAGE_USER_DATA       3
+
+class LAStransformStage
+{
+public:
+  U32 type;
+  LASoperation* operation;
+  F64 matrix[12];
+  BOOL change[3];
+  U16* classification;   // indexed with (classification << 8) | extended_classification
+  U8 user_data[256];
+
+  inline void transform(LASpoint* point) const
+  {
+    if (type == LAS_TRANSFORM_STAGE_OPERATION)
+    {
+      operation->transform(point);
+    }
+    else if (type == LAS_TRANSFORM_STAGE_AFFINE)
+    {
+      F64 x = point->get_x();
+      F64 y = point->get_y();
+      F64 z = point->get_z();
+      if (change[0]) point->set_x(matrix[0]*x + matrix[1]*y + matrix[2]*z + matrix[3]);
+      if (change[1]) point->set_y(matrix[4]*x + matrix[5]*y + matrix[6]*z + matrix[7]);
+      if (change[2]) point->set_z(matrix[8]*x + matrix[9]*y + matrix[10]*z + matrix[11]);
+    }
+    else if (type == LAS_TRANSFORM_STAGE_CLASSIFICATION)
+    {
+      U16 lookup = classification[(point->classification << 8) | point->extended_classification];
+      point->classification = (lookup >> 8);
+      point->extended_classification = (lookup & 255);
+    }
+    else
+    {
+      point->user_data = user_data[point->user_data];
+    }
+  };
+
+  LAStransformStage()
+  {
+    type = LAS_TRANSFORM_STAGE_OPERATION;
+    operation = 0;
+    classification = 0;
+  };
+
+  ~LAStransformStage()
+  {
+    if (classification) delete [] classification;
+  };
+};
+
+// the same matrix in raw integer coordinates and the columns rewritten with it
+
+static void transform_columns_affine(const F64* matrix, const BOOL* change, LAScolumns* columns, const I64 number, const LASquantizer* quantizer)
+{
+  const F64 scale[3] = { quantizer->x_scale_factor, quantizer->y_scale_factor, quantizer->z_scale_factor };
+  const F64 offset[3] = { quantizer->x_offset, quantizer->y_offset, quantizer->z_offset };
+  F64 a[12];
+  U32 r, c;
+  for (r = 0; r < 3; r++)
+  {
+    a[4*r+3] = matrix[4*r+3] - offset[r];
+    for (c = 0; c < 3; c++)
+    {
+      a[4*r+c] = matrix[4*r+c]*scale[c]/scale[r];
+      a[4*r+3] += matrix[4*r+c]*offset[c];
+    }
+    a[4*r+3] /= scale[r];
+  }
+
+  I32* X = columns->X;
+  I32* Y = columns->Y;
+  I32* Z = columns->Z;
+  I64 i;
+  if (Z && change[2])
+  {
+    for (i = 0; i < number; i++)
+    {
+      F64 x = X[i];
+      F64 y = Y[i];
+      F64 z = Z[i];
+      F64 tx = a[0]*x + a[1]*y + a[2]*z + a[3];
+      F64 ty = a[4]*x + a[5]*y + a[6]*z + a[7];
+      F64 tz = a[8]*x + a[9]*y + a[10]*z + a[11];
+      X[i] = I32_QUANTIZE(tx);
+      Y[i] = I32_QUANTIZE(ty);
+      Z[i] = I32_QUANTIZE(tz);
+    }
+  }
+  else if (Z)
+  {
+    for (i = 0; i < number; i++)
+    {
+      F64 x = X[i];
+      F64 y = Y[i];
+      F64 z = Z[i];
+      F64 tx = a[0]*x + a[1]*y + a[2]*z + a[3];
+      F64 ty = a[4]*x + a[5]*y + a[6]*z + a[7];
+      X[i] = I32_QUANTIZE(tx);
+      Y[i] = I32_QUANTIZE(ty);
+    }
+  }
+  else
+  {
+    // without heights every raw Z is taken to be zero
+    for (i = 0; i < number; i++)
+    {
+      F64 x = X[i];
+      F64 y = Y[i];
+      F64 tx = a[0]*x + a[1]*y + a[3];
+      F64 ty = a[4]*x + a[5]*y + a[7];
+      X[i] = I32_QUANTIZE(tx);
+      Y[i] = I32_QUANTIZE(ty);
+    }
+  }
+}
+
+// the columns hold the extended classification for point types 6 and higher and the
+// classification otherwise. the table maps both back to the state of a LASpoint.
+
+static void transform_columns_classification(const U16* lookup, U8* classification, const I64 number, const BOOL extended)
+{
+  I64 i;
+  if (extended)
+  {
+    for (i = 0; i < number; i++)
+    {
+      U32 e = classification[i];
+      classification[i] = (U8)(lookup[((e < 32 ? e : 0) << 8) | e] & 255);
+    }
+  }
+  else
+  {
+    for (i = 0; i < number; i++)
+    {
+      U32 c = classification[i];
+      classification[i] = (U8)(lookup[((c & 31) << 8) | c] >> 8);
+    }
+  }
+}
+
+static void transform_columns_user_data(const U8* lookup, U8* user_data, const I64 number)
+{
+  I64 i;
+  for (i = 0; i < number; i++)
+  {
+    user_data[i] = lookup[user_data[i]];
+  }
+}
+
 void LAStransform::clean()
 {
   U32 i;
@@ -1614,6 +1819,15 @@ void LAStransform::clean()
     delete filter;
     filter = 0;
   }
+  clean_stages();
+  compile_requested = FALSE;
+}
+
+void LAStransform::clean_stages()
+{
+  if (stages) delete [] stages;
+  num_stages = 0;
+  stages = 0;
 }
 
 void LAStransform::usage() const
@@ -1720,6 +1934,8 @@ void LAStransform::usage() const
   fprintf(stderr,"Transform attributes in \"Extra Bytes\".\n");
   fprintf(stderr,"  -scale_attribute 0 1.5\n");
   fprintf(stderr,"  -translate_attribute 1 0.2\n");
+  fprintf(stderr,"Fuse the operations (coordinates quantized once).\n");
+  fprintf(stderr,"  -compile_transform\n");
 }
 
 BOOL LAStransform::parse(int argc, char* argv[])
@@ -3821,6 +4037,11 @@ BOOL LAStransform::parse(int argc, char* argv[])
       is_filtered = TRUE;
       *argv[i]='\0'; 
     }
+    else if (strcmp(argv[i],"-compile_transform") == 0)
+    {
+      compile_requested = TRUE;
+      *argv[i]='\0'; 
+    }
     else if (strncmp(argv[i],"-add_", 5) == 0)
     {
       if (strncmp(argv[i],"-add_scaled_", 12) == 0)
@@ -3890,6 +4111,10 @@ BOOL LAStransform::parse(int argc, char* argv[])
       }
     }
   }
+  if (compile_requested)
+  {
+    compile();
+  }
   return TRUE;
 }
 
@@ -3929,6 +4154,10 @@ I32 LAStransform::unparse(CHAR* string) const
   {
     n += operations[i]->get_command(&string[n]);
   }
+  if (compile_requested)
+  {
+    n += sprintf(&string[n], "-compile_transform ");
+  }
   return n;
 }
 
@@ -3953,9 +4182,154 @@ void LAStransform::transform(LASpoint* point)
       return;
     }
   }
+  if (stages)
+  {
+    for (i = 0; i < num_stages; i++) stages[i].transform(point);
+    return;
+  }
   for (i = 0; i < num_operations; i++) operations[i]->transform(point);
 }
 
+void LAStransform::compile()
+{
+  clean_stages();
+  if (num_operations == 0)
+  {
+    return;
+  }
+  stages = new LAStransformStage[num_operations];
+
+  U32 i = 0, j, k;
+  F64 matrix[12], product[12];
+  LASpoint point;
+  while (i < num_operations)
+  {
+    LAStransformStage* stage = &stages[num_stages];
+    U32 lookup = operations[i]->get_lookup();
+    if (operations[i]->get_affine(stage->matrix))
+    {
+      // each further matrix is multiplied onto the left
+      stage->type = LAS_TRANSFORM_STAGE_AFFINE;
+      for (i++; (i < num_operations) && operations[i]->get_affine(matrix); i++)
+      {
+        for (j = 0; j < 3; j++)
+        {
+          for (k = 0; k < 4; k++)
+          {
+            product[4*j+k] = matrix[4*j+0]*stage->matrix[k] + matrix[4*j+1]*stage->matrix[4+k] + matrix[4*j+2]*stage->matrix[8+k] + (k == 3 ? matrix[4*j+3] : 0.0);
+          }
+        }
+        memcpy(stage->matrix, product, sizeof(F64)*12);
+      }
+      set_identity(matrix);
+      for (j = 0; j < 3; j++)
+      {
+        stage->change[j] = (memcmp(&stage->matrix[4*j], &matrix[4*j], sizeof(F64)*4) != 0);
+      }
+    }
+    else if (lookup == LAS_OPERATION_LOOKUP_CLASSIFICATION)
+    {
+      // every classification / extended classification pair a point can have is run through the operations
+      stage->type = LAS_TRANSFORM_STAGE_CLASSIFICATION;
+      stage->classification = new U16[32*256];
+      for (j = i; (j < num_operations) && (operations[j]->get_lookup() == lookup); j++);
+      for (k = 0; k < 32*256; k++)
+      {
+        point.classification = (k >> 8);
+        point.extended_classification = (k & 255);
+        for (U32 o = i; o < j; o++) operations[o]->transform(&point);
+        stage->classification[k] = (point.classification << 8) | point.extended_classification;
+      }
+      i = j;
+    }
+    else if (lookup == LAS_OPERATION_LOOKUP_USER_DATA)
+    {
+      stage->type = LAS_TRANSFORM_STAGE_USER_DATA;
+      for (j = i; (j < num_operations) && (operations[j]->get_lookup() == lookup); j++);
+      for (k = 0; k < 256; k++)
+      {
+        point.user_data = (U8)k;
+        for (U32 o = i; o < j; o++) operations[o]->transform(&point);
+        stage->user_data[k] = point.user_data;
+      }
+      i = j;
+    }
+    else
+    {
+      stage->type = LAS_TRANSFORM_STAGE_OPERATION;
+      stage->operation = operations[i];
+      i++;
+    }
+    num_stages++;
+  }
+}
+
+BOOL LAStransform::transform(LAScolumns* columns, const I64 number, const LASquantizer* quantizer, const BOOL extended)
+{
+  if ((columns == 0) || (quantizer == 0))
+  {
+    fprintf(stderr,"ERROR: no columns or no quantizer to transform\n");
+    return FALSE;
+  }
+
+  // the other operations go through a point that the columns are copied into and out of
+
+  LASpoint point;
+  if (!point.init(quantizer, (extended ? 8 : 3), (extended ? 38 : 34)))
+  {
+    fprintf(stderr,"ERROR: cannot init point to transform columns\n");
+    return FALSE;
+  }
+
+  I64 p;
+  if (filter || (stages == 0))
+  {
+    for (p = 0; p < number; p++)
+    {
+      point.zero();
+      columns->get(p, &point, extended);
+      transform(&point);
+      columns->set(p, &point);
+    }
+    return TRUE;
+  }
+
+  U32 i = 0, j;
+  while (i < num_stages)
+  {
+    const LAStransformStage* stage = &stages[i];
+    if ((stage->type == LAS_TRANSFORM_STAGE_AFFINE) && columns->X && columns->Y)
+    {
+      transform_columns_affine(stage->matrix, stage->change, columns, number, quantizer);
+      i++;
+    }
+    else if ((stage->type == LAS_TRANSFORM_STAGE_CLASSIFICATION) && columns->classification)
+    {
+      transform_columns_classification(stage->classification, columns->classification, number, extended);
+      i++;
+    }
+    else if ((stage->type == LAS_TRANSFORM_STAGE_USER_DATA) && columns->user_data)
+    {
+      transform_columns_user_data(stage->user_data, columns->user_data, number);
+      i++;
+    }
+    else
+    {
+      // consecutive operations share one copy into the point and back
+      for (j = i + 1; (j < num_stages) && (stages[j].type == LAS_TRANSFORM_STAGE_OPERATION); j++);
+      for (p = 0; p < number; p++)
+      {
+        point.zero();
+        columns->get(p, &point, extended);
+        for (U32 s = i; s < j; s++) stages[s].transform(&point);
+        columns->set(p, &point);
+      }
+      i = j;
+    }
+  }
+  return TRUE;
+}
+
 void LAStransform::reset()
 {
   U32 i;
@@ -3973,11 +4347,15 @@ LAStransform::LAStransform()
   operations = 0;
   is_filtered = FALSE;
   filter = 0;
+  compile_requested = FALSE;
+  num_stages = 0;
+  stages = 0;
 }
 
 LAStransform::~LAStransform()
 {
   if (operations) clean();
+  clean_stages();
 }
 
 void LAStransform::add_operation(LASoperation* transform_operation)
@@ -4019,9 +4397,11 @@ void LAStransform::setPointSource(U16 value)
       {
         delete operations[i];
         operations[i] = new LASoperationSetPointSource(value);
+        if (stages) compile();
         return;
       }
     }
   }
   add_operation(new LASoperationSetPointSource(value));
+  if (stages) compile();
 }
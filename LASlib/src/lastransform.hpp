@@ -24,6 +24,8 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- '-translate_raw_xy_at_random' keyed on the point instead of rand()
+    19 October 2026 -- new '-compile_transform' fuses operations for point batches
      6 March 2018 -- changed '%g' to '%lf' for all sprintf() of F64 values
     28 February 2017 -- now '-set_RGB_of_class' also works for classifications > 31
      1 February 2017 -- new '-copy_intensity_into_z' for use in lasgrid or lascanopy
@@ -43,6 +45,13 @@
 #include "laszip_decompress_selective_v3.hpp"
 
 class LASfilter;
+class LASquantizer;
+class LAScolumns;
+class LAStransformStage;
+
+#define LAS_OPERATION_LOOKUP_NONE            0
+#define LAS_OPERATION_LOOKUP_CLASSIFICATION  1
+#define LAS_OPERATION_LOOKUP_USER_DATA       2
 
 class LASoperation
 {
@@ -50,6 +59,10 @@ public:
   virtual const CHAR * name() const = 0;
   virtual I32 get_command(CHAR* string) const = 0;
   virtual U32 get_decompress_selective() const { return LASZIP_DECOMPRESS_SELECTIVE_CHANNEL_RETURNS_XY; };
+  // operations that are affine in world coordinates give their 3x4 matrix (row by row)
+  virtual BOOL get_affine(F64* matrix) const { return FALSE; };
+  // operations whose result only depends on the classification or the user data say which
+  virtual U32 get_lookup() const { return LAS_OPERATION_LOOKUP_NONE; };
   virtual void transform(LASpoint* point) = 0;
   virtual void reset(){};
   virtual ~LASoperation(){};
@@ -77,17 +90,31 @@ public:
   void transform(LASpoint* point);
   void reset();
 
+  // fuses runs of affine coordinate operations into one matrix and runs of classification
+  // or user data operations into lookup tables. the fused coordinates are quantized once
+  // instead of after every operation and may differ from the step-wise result by one unit.
+  void compile();
+  inline BOOL compiled() const { return (stages != 0); };
+
+  // transforms entries [0, number) of the columns. the fused stages of a compiled transform
+  // run as loops over whole columns and the other operations on one point at a time.
+  BOOL transform(LAScolumns* columns, const I64 number, const LASquantizer* quantizer, const BOOL extended);
+
   LAStransform();
   ~LAStransform();
 
 private:
 
   void add_operation(LASoperation* operation);
+  void clean_stages();
   U32 num_operations;
   U32 alloc_operations;
   LASoperation** operations;
   BOOL is_filtered;
   LASfilter* filter;
+  BOOL compile_requested;
+  U32 num_stages;
+  LAStransformStage* stages;
 };
 
 #endif
@@ -96,6 +96,109 @@ BOOL LASinventory::add(const LASpoint* point)
   return TRUE;
 }
 
+// the min and max of a block in separate branch-free loops that the compiler vectorizes
+
+static void min_max(const I32* values, const U32 number, I32* min, I32* max)
+{
+  I32 lo = *min;
+  I32 hi = *max;
+  U32 i;
+  for (i = 0; i < number; i++)
+  {
+    lo = (values[i] < lo ? values[i] : lo);
+    hi = (values[i] > hi ? values[i] : hi);
+  }
+  *min = lo;
+  *max = hi;
+}
+
+BOOL LASinventory::add(const I32* X, const I32* Y, const I32* Z, const U8* return_numbers, const U32 number)
+{
+  if (number == 0)
+  {
+    return TRUE;
+  }
+  if ((X == 0) || (Y == 0) || (Z == 0))
+  {
+    fprintf(stderr,"ERROR: coordinate array pointer is zero\n");
+    return FALSE;
+  }
+  extended_number_of_point_records += number;
+  if (return_numbers)
+  {
+    // four sets of counters so that runs of the same return number do not stall on one counter
+    U32 counts[4][16];
+    memset(counts, 0, sizeof(counts));
+    U32 i, r;
+    for (i = 0; (i + 4) <= number; i += 4)
+    {
+      counts[0][return_numbers[i] & 15]++;
+      counts[1][return_numbers[i+1] & 15]++;
+      counts[2][return_numbers[i+2] & 15]++;
+      counts[3][return_numbers[i+3] & 15]++;
+    }
+    for (; i < number; i++)
+    {
+      counts[0][return_numbers[i] & 15]++;
+    }
+    for (r = 0; r < 16; r++)
+    {
+      extended_number_of_points_by_return[r] += (counts[0][r] + counts[1][r] + counts[2][r] + counts[3][r]);
+    }
+  }
+  else
+  {
+    extended_number_of_points_by_return[0] += number;
+  }
+  if (first)
+  {
+    min_X = max_X = X[0];
+    min_Y = max_Y = Y[0];
+    min_Z = max_Z = Z[0];
+    first = FALSE;
+  }
+  min_max(X, number, &min_X, &max_X);
+  min_max(Y, number, &min_Y, &max_Y);
+  min_max(Z, number, &min_Z, &max_Z);
+  return TRUE;
+}
+
+BOOL LASinventory::merge(const LASinventory* inventory)
+{
+  if (inventory == 0)
+  {
+    fprintf(stderr,"ERROR: inventory pointer is zero\n");
+    return FALSE;
+  }
+  if (!inventory->active())
+  {
+    return TRUE;
+  }
+  U32 i;
+  extended_number_of_point_records += inventory->extended_number_of_point_records;
+  for (i = 0; i < 16; i++) extended_number_of_points_by_return[i] += inventory->extended_number_of_points_by_return[i];
+  if (first)
+  {
+    min_X = inventory->min_X;
+    max_X = inventory->max_X;
+    min_Y = inventory->min_Y;
+    max_Y = inventory->max_Y;
+    min_Z = inventory->min_Z;
+    max_Z = inventory->max_Z;
+    first = FALSE;
+  }
+  else
+  {
+    if (inventory->min_X < min_X) min_X = inventory->min_X;
+    if (inventory->max_X > max_X) max_X = inventory->max_X;
+    if (inventory->min_Y < min_Y) min_Y = inventory->min_Y;
+    if (inventory->max_Y > max_Y) max_Y = inventory->max_Y;
+    if (inventory->min_Z < min_Z) min_Z = inventory->min_Z;
+    if (inventory->max_Z > max_Z) max_Z = inventory->max_Z;
+  }
+  return TRUE;
+}
+
 BOOL LASinventory::update_header(LASheader* header) const
 {
   if (header)
@@ -379,6 +482,152 @@ BOOL LASsummary::add(const LASpoint* point)
   return TRUE;
 }
 
+BOOL LASsummary::merge(const LASsummary* summary, const LASattributer* attributer)
+{
+  if (summary == 0)
+  {
+    fprintf(stderr,"ERROR: summary pointer is zero\n");
+    return FALSE;
+  }
+  if (!summary->active())
+  {
+    return TRUE;
+  }
+  U32 i;
+  number_of_point_records += summary->number_of_point_records;
+  for (i = 0; i < 16; i++) number_of_points_by_return[i] += summary->number_of_points_by_return[i];
+  for (i = 0; i < 16; i++) number_of_returns[i] += summary->number_of_returns[i];
+  for (i = 0; i < 32; i++) classification[i] += summary->classification[i];
+  for (i = 0; i < 256; i++) extended_classification[i] += summary->extended_classification[i];
+  classification_synthetic += summary->classification_synthetic;
+  classification_keypoint += summary->classification_keypoint;
+  classification_withheld += summary->classification_withheld;
+  classification_extended_overlap += summary->classification_extended_overlap;
+  if (first)
+  {
+    // take over min and max (with their extra bytes) and the fluff detection
+    if (summary->min.extra_bytes_number && (min.extra_bytes == 0))
+    {
+      min.extra_bytes = new U8[summary->min.extra_bytes_number];
+      min.extra_bytes_number = summary->min.extra_bytes_number;
+      max.extra_bytes = new U8[summary->max.extra_bytes_number];
+      max.extra_bytes_number = summary->max.extra_bytes_number;
+    }
+    min = summary->min;
+    max = summary->max;
+    // the assignment skips what the point type of the summary points does not flag as present
+    min.gps_time = summary->min.gps_time;
+    max.gps_time = summary->max.gps_time;
+    memcpy(min.rgb, summary->min.rgb, sizeof(U16)*4);
+    memcpy(max.rgb, summary->max.rgb, sizeof(U16)*4);
+    min.wavepacket = summary->min.wavepacket;
+    max.wavepacket = summary->max.wavepacket;
+    for (i = 0; i < 3; i++)
+    {
+      xyz_low_digits_10[i] = summary->xyz_low_digits_10[i];
+      xyz_low_digits_100[i] = summary->xyz_low_digits_100[i];
+      xyz_low_digits_1000[i] = summary->xyz_low_digits_1000[i];
+      xyz_low_digits_10000[i] = summary->xyz_low_digits_10000[i];
+      xyz_fluff_10[i] = summary->xyz_fluff_10[i];
+      xyz_fluff_100[i] = summary->xyz_fluff_100[i];
+      xyz_fluff_1000[i] = summary->xyz_fluff_1000[i];
+      xyz_fluff_10000[i] = summary->xyz_fluff_10000[i];
+    }
+    first = FALSE;
+    return TRUE;
+  }
+  // the attributes that a point type does not have are zero in both and stay zero
+  if (summary->min.get_X() < min.get_X()) min.set_X(summary->min.get_X());
+  if (summary->max.get_X() > max.get_X()) max.set_X(summary->max.get_X());
+  if (summary->min.get_Y() < min.get_Y()) min.set_Y(summary->min.get_Y());
+  if (summary->max.get_Y() > max.get_Y()) max.set_Y(summary->max.get_Y());
+  if (summary->min.get_Z() < min.get_Z()) min.set_Z(summary->min.get_Z());
+  if (summary->max.get_Z() > max.get_Z()) max.set_Z(summary->max.get_Z());
+  if (summary->min.intensity < min.intensity) min.intensity = summary->min.intensity;
+  if (summary->max.intensity > max.intensity) max.intensity = summary->max.intensity;
+  if (summary->min.edge_of_flight_line < min.edge_of_flight_line) min.edge_of_flight_line = summary->min.edge_of_flight_line;
+  if (summary->max.edge_of_flight_line > max.edge_of_flight_line) max.edge_of_flight_line = summary->max.edge_of_flight_line;
+  if (summary->min.scan_direction_flag < min.scan_direction_flag) min.scan_direction_flag = summary->min.scan_direction_flag;
+  if (summary->max.scan_direction_flag > max.scan_direction_flag) max.scan_direction_flag = summary->max.scan_direction_flag;
+  if (summary->min.number_of_returns < min.number_of_returns) min.number_of_returns = summary->min.number_of_returns;
+  if (summary->max.number_of_returns > max.number_of_returns) max.number_of_returns = summary->max.number_of_returns;
+  if (summary->min.return_number < min.return_number) min.return_number = summary->min.return_number;
+  if (summary->max.return_number > max.return_number) max.return_number = summary->max.return_number;
+  if (summary->min.classification < min.classification) min.classification = summary->min.classification;
+  if (summary->max.classification > max.classification) max.classification = summary->max.classification;
+  if (summary->min.scan_angle_rank < min.scan_angle_rank) min.scan_angle_rank = summary->min.scan_angle_rank;
+  if (summary->max.scan_angle_rank > max.scan_angle_rank) max.scan_angle_rank = summary->max.scan_angle_rank;
+  if (summary->min.user_data < min.user_data) min.user_data = summary->min.user_data;
+  if (summary->max.user_data > max.user_data) max.user_data = summary->max.user_data;
+  if (summary->min.point_source_ID < min.point_source_ID) min.point_source_ID = summary->min.point_source_ID;
+  if (summary->max.point_source_ID > max.point_source_ID) max.point_source_ID = summary->max.point_source_ID;
+  if (summary->min.gps_time < min.gps_time) min.gps_time = summary->min.gps_time;
+  if (summary->max.gps_time > max.gps_time) max.gps_time = summary->max.gps_time;
+  for (i = 0; i < 4; i++)
+  {
+    if (summary->min.rgb[i] < min.rgb[i]) min.rgb[i] = summary->min.rgb[i];
+    if (summary->max.rgb[i] > max.rgb[i]) max.rgb[i] = summary->max.rgb[i];
+  }
+  if (summary->min.extended_classification < min.extended_classification) min.extended_classification = summary->min.extended_classification;
+  if (summary->max.extended_classification > max.extended_classification) max.extended_classification = summary->max.extended_classification;
+  if (summary->min.extended_return_number < min.extended_return_number) min.extended_return_number = summary->min.extended_return_number;
+  if (summary->max.extended_return_number > max.extended_return_number) max.extended_return_number = summary->max.extended_return_number;
+  if (summary->min.extended_number_of_returns < min.extended_number_of_returns) min.extended_number_of_returns = summary->min.extended_number_of_returns;
+  if (summary->max.extended_number_of_returns > max.extended_number_of_returns) max.extended_number_of_returns = summary->max.extended_number_of_returns;
+  if (summary->min.extended_scan_angle < min.extended_scan_angle) min.extended_scan_angle = summary->min.extended_scan_angle;
+  if (summary->max.extended_scan_angle > max.extended_scan_angle) max.extended_scan_angle = summary->max.extended_scan_angle;
+  if (summary->min.extended_scanner_channel < min.extended_scanner_channel) min.extended_scanner_channel = summary->min.extended_scanner_channel;
+  if (summary->max.extended_scanner_channel > max.extended_scanner_channel) max.extended_scanner_channel = summary->max.extended_scanner_channel;
+  if (summary->min.wavepacket.getIndex() < min.wavepacket.getIndex()) min.wavepacket.setIndex(summary->min.wavepacket.getIndex());
+  if (summary->max.wavepacket.getIndex() > max.wavepacket.getIndex()) max.wavepacket.setIndex(summary->max.wavepacket.getIndex());
+  if (summary->min.wavepacket.getOffset() < min.wavepacket.getOffset()) min.wavepacket.setOffset(summary->min.wavepacket.getOffset());
+  if (summary->max.wavepacket.getOffset() > max.wavepacket.getOffset()) max.wavepacket.setOffset(summary->max.wavepacket.getOffset());
+  if (summary->min.wavepacket.getSize() < min.wavepacket.getSize()) min.wavepacket.setSize(summary->min.wavepacket.getSize());
+  if (summary->max.wavepacket.getSize() > max.wavepacket.getSize()) max.wavepacket.setSize(summary->max.wavepacket.getSize());
+  if (summary->min.wavepacket.getLocation() < min.wavepacket.getLocation()) min.wavepacket.setLocation(summary->min.wavepacket.getLocation());
+  if (summary->max.wavepacket.getLocation() > max.wavepacket.getLocation()) max.wavepacket.setLocation(summary->max.wavepacket.getLocation());
+  if (summary->min.wavepacket.getXt() < min.wavepacket.getXt()) min.wavepacket.setXt(summary->min.wavepacket.getXt());
+  if (summary->max.wavepacket.getXt() > max.wavepacket.getXt()) max.wavepacket.setXt(summary->max.wavepacket.getXt());
+  if (summary->min.wavepacket.getYt() < min.wavepacket.getYt()) min.wavepacket.setYt(summary->min.wavepacket.getYt());
+  if (summary->max.wavepacket.getYt() > max.wavepacket.getYt()) max.wavepacket.setYt(summary->max.wavepacket.getYt());
+  if (summary->min.wavepacket.getZt() < min.wavepacket.getZt()) min.wavepacket.setZt(summary->min.wavepacket.getZt());
+  if (summary->max.wavepacket.getZt() > max.wavepacket.getZt()) max.wavepacket.setZt(summary->max.wavepacket.getZt());
+  if (attributer && min.extra_bytes && summary->min.extra_bytes)
+  {
+    I32 a;
+    F64 value;
+    for (a = 0; a < attributer->number_attributes; a++)
+    {
+      const LASattribute* attribute = &attributer->attributes[a];
+      const I32 start = attributer->attribute_starts[a];
+      value = attribute->get_value_as_float(summary->min.extra_bytes + start);
+      if (value < attribute->get_value_as_float(min.extra_bytes + start))
+      {
+        attribute->set_value_as_float(min.extra_bytes + start, value);
+      }
+      value = attribute->get_value_as_float(summary->max.extra_bytes + start);
+      if (value > attribute->get_value_as_float(max.extra_bytes + start))
+      {
+        attribute->set_value_as_float(max.extra_bytes + start, value);
+      }
+    }
+  }
+  // the points of the other summary match the low digits of its own first point. only
+  // where these are the same as ours are its matches also matches of our first point.
+  for (i = 0; i < 3; i++)
+  {
+    if (summary->xyz_low_digits_10[i] != xyz_low_digits_10[i]) continue;
+    xyz_fluff_10[i] += summary->xyz_fluff_10[i];
+    if (summary->xyz_low_digits_100[i] != xyz_low_digits_100[i]) continue;
+    xyz_fluff_100[i] += summary->xyz_fluff_100[i];
+    if (summary->xyz_low_digits_1000[i] != xyz_low_digits_1000[i]) continue;
+    xyz_fluff_1000[i] += summary->xyz_fluff_1000[i];
+    if (summary->xyz_low_digits_10000[i] != xyz_low_digits_10000[i]) continue;
+    xyz_fluff_10000[i] += summary->xyz_fluff_10000[i];
+  }
+  return TRUE;
+}
+
 F64 LASbin::get_step() const
 {
   return step;
@@ -734,6 +983,77 @@ void LASbin::add(F64 item, F64 value)
   }
 }
 
+void LASbin::merge(const LASbin* bin)
+{
+  if (bin->count == 0)
+  {
+    return;
+  }
+  total += bin->total;
+  count += bin->count;
+  I32 i;
+  for (i = 0; i < bin->size_neg; i++)
+  {
+    if (bin->bins_neg[i]) merge_bin(-(i+1) + bin->anker, bin->bins_neg[i], (bin->values_neg ? &(bin->values_neg[i]) : 0));
+  }
+  for (i = 0; i < bin->size_pos; i++)
+  {
+    if (bin->bins_pos[i]) merge_bin(i + bin->anker, bin->bins_pos[i], (bin->values_pos ? &(bin->values_pos[i]) : 0));
+  }
+}
+
+void LASbin::merge_bin(I32 bin, U32 number, const F64* value)
+{
+  if (first)
+  {
+    anker = bin;
+    first = FALSE;
+  }
+  bin = bin - anker;
+  U32** bins;
+  F64** values;
+  I32* size;
+  if (bin >= 0)
+  {
+    bins = &bins_pos;
+    values = &values_pos;
+    size = &size_pos;
+  }
+  else
+  {
+    bin = -(bin+1);
+    bins = &bins_neg;
+    values = &values_neg;
+    size = &size_neg;
+  }
+  if ((bin >= *size) || (value && (*values == 0)))
+  {
+    I32 i;
+    I32 new_size = (bin >= *size ? bin + 1024 : *size);
+    *bins = (U32*)realloc(*bins, sizeof(U32)*new_size);
+    if (*bins == 0)
+    {
+      fprintf(stderr, "ERROR: reallocating %u bins\012", new_size);
+      exit(1);
+    }
+    for (i = *size; i < new_size; i++) (*bins)[i] = 0;
+    if (value || *values)
+    {
+      I32 old_size = (*values ? *size : 0);
+      *values = (F64*)realloc(*values, sizeof(F64)*new_size);
+      if (*values == 0)
+      {
+        fprintf(stderr, "ERROR: reallocating %u values\012", new_size);
+        exit(1);
+      }
+      for (i = old_size; i < new_size; i++) (*values)[i] = 0.0;
+    }
+    *size = new_size;
+  }
+  (*bins)[bin] += number;
+  if (value) (*values)[bin] += *value;
+}
+
 static void lidardouble2string(CHAR* string, F64 value)
 {
   int len;
@@ -1223,6 +1543,116 @@ void LAShistogram::add(const LASpoint* point)
   }
 }
 
+static void init_bin(LASbin** bin, const LASbin* other)
+{
+  if (*bin)
+  {
+    delete *bin;
+    *bin = 0;
+  }
+  if (other)
+  {
+    *bin = new LASbin(other->get_step());
+  }
+}
+
+static void merge_bin(LASbin* bin, const LASbin* other)
+{
+  if (bin && other)
+  {
+    bin->merge(other);
+  }
+}
+
+BOOL LAShistogram::init(const LAShistogram* histogram)
+{
+  if (histogram == 0)
+  {
+    fprintf(stderr,"ERROR: histogram pointer is zero\n");
+    return FALSE;
+  }
+  // counter bins
+  init_bin(&x_bin, histogram->x_bin);
+  init_bin(&y_bin, histogram->y_bin);
+  init_bin(&z_bin, histogram->z_bin);
+  init_bin(&X_bin, histogram->X_bin);
+  init_bin(&Y_bin, histogram->Y_bin);
+  init_bin(&Z_bin, histogram->Z_bin);
+  init_bin(&intensity_bin, histogram->intensity_bin);
+  init_bin(&classification_bin, histogram->classification_bin);
+  init_bin(&scan_angle_bin, histogram->scan_angle_bin);
+  init_bin(&extended_scan_angle_bin, histogram->extended_scan_angle_bin);
+  init_bin(&return_number_bin, histogram->return_number_bin);
+  init_bin(&number_of_returns_bin, histogram->number_of_returns_bin);
+  init_bin(&user_data_bin, histogram->user_data_bin);
+  init_bin(&point_source_id_bin, histogram->point_source_id_bin);
+  init_bin(&gps_time_bin, histogram->gps_time_bin);
+  init_bin(&scanner_channel_bin, histogram->scanner_channel_bin);
+  init_bin(&R_bin, histogram->R_bin);
+  init_bin(&G_bin, histogram->G_bin);
+  init_bin(&B_bin, histogram->B_bin);
+  init_bin(&I_bin, histogram->I_bin);
+  init_bin(&attribute0_bin, histogram->attribute0_bin);
+  init_bin(&attribute1_bin, histogram->attribute1_bin);
+  init_bin(&attribute2_bin, histogram->attribute2_bin);
+  init_bin(&attribute3_bin, histogram->attribute3_bin);
+  init_bin(&attribute4_bin, histogram->attribute4_bin);
+  init_bin(&wavepacket_index_bin, histogram->wavepacket_index_bin);
+  init_bin(&wavepacket_offset_bin, histogram->wavepacket_offset_bin);
+  init_bin(&wavepacket_size_bin, histogram->wavepacket_size_bin);
+  init_bin(&wavepacket_location_bin, histogram->wavepacket_location_bin);
+  // averages bins
+  init_bin(&classification_bin_intensity, histogram->classification_bin_intensity);
+  init_bin(&classification_bin_scan_angle, histogram->classification_bin_scan_angle);
+  init_bin(&scan_angle_bin_z, histogram->scan_angle_bin_z);
+  init_bin(&scan_angle_bin_number_of_returns, histogram->scan_angle_bin_number_of_returns);
+  init_bin(&scan_angle_bin_intensity, histogram->scan_angle_bin_intensity);
+  init_bin(&return_map_bin_intensity, histogram->return_map_bin_intensity);
+  is_active = histogram->is_active;
+  return TRUE;
+}
+
+void LAShistogram::merge(const LAShistogram* histogram)
+{
+  // counter bins
+  merge_bin(x_bin, histogram->x_bin);
+  merge_bin(y_bin, histogram->y_bin);
+  merge_bin(z_bin, histogram->z_bin);
+  merge_bin(X_bin, histogram->X_bin);
+  merge_bin(Y_bin, histogram->Y_bin);
+  merge_bin(Z_bin, histogram->Z_bin);
+  merge_bin(intensity_bin, histogram->intensity_bin);
+  merge_bin(classification_bin, histogram->classification_bin);
+  merge_bin(scan_angle_bin, histogram->scan_angle_bin);
+  merge_bin(extended_scan_angle_bin, histogram->extended_scan_angle_bin);
+  merge_bin(return_number_bin, histogram->return_number_bin);
+  merge_bin(number_of_returns_bin, histogram->number_of_returns_bin);
+  merge_bin(user_data_bin, histogram->user_data_bin);
+  merge_bin(point_source_id_bin, histogram->point_source_id_bin);
+  merge_bin(gps_time_bin, histogram->gps_time_bin);
+  merge_bin(scanner_channel_bin, histogram->scanner_channel_bin);
+  merge_bin(R_bin, histogram->R_bin);
+  merge_bin(G_bin, histogram->G_bin);
+  merge_bin(B_bin, histogram->B_bin);
+  merge_bin(I_bin, histogram->I_bin);
+  merge_bin(attribute0_bin, histogram->attribute0_bin);
+  merge_bin(attribute1_bin, histogram->attribute1_bin);
+  merge_bin(attribute2_bin, histogram->attribute2_bin);
+  merge_bin(attribute3_bin, histogram->attribute3_bin);
+  merge_bin(attribute4_bin, histogram->attribute4_bin);
+  merge_bin(wavepacket_index_bin, histogram->wavepacket_index_bin);
+  merge_bin(wavepacket_offset_bin, histogram->wavepacket_offset_bin);
+  merge_bin(wavepacket_size_bin, histogram->wavepacket_size_bin);
+  merge_bin(wavepacket_location_bin, histogram->wavepacket_location_bin);
+  // averages bins
+  merge_bin(classification_bin_intensity, histogram->classification_bin_intensity);
+  merge_bin(classification_bin_scan_angle, histogram->classification_bin_scan_angle);
+  merge_bin(scan_angle_bin_z, histogram->scan_angle_bin_z);
+  merge_bin(scan_angle_bin_number_of_returns, histogram->scan_angle_bin_number_of_returns);
+  merge_bin(scan_angle_bin_intensity, histogram->scan_angle_bin_intensity);
+  merge_bin(return_map_bin_intensity, histogram->return_map_bin_intensity);
+}
+
 void LAShistogram::report(FILE* file) const
 {
   // counter bins
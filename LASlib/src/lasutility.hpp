@@ -24,6 +24,7 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- mergeable inventory, summary, and histogram for threads
     27 August 2017 -- added '-histo scanner_channel 1'
      1 June 2017 -- improved "fluff" detection
      3 May 2015 -- updated LASinventory to handle LAS 1.4 content 
@@ -50,6 +51,10 @@ public:
   I32 min_Z;
   BOOL init(const LASheader* header);
   BOOL add(const LASpoint* point);
+  // adds a block of points given as coordinate and return number arrays (which may be zero)
+  BOOL add(const I32* X, const I32* Y, const I32* Z, const U8* return_numbers, const U32 number);
+  // adds the points of another (for example thread-local) inventory
+  BOOL merge(const LASinventory* inventory);
   BOOL update_header(LASheader* header) const;
   LASinventory();
 private:
@@ -80,6 +85,9 @@ public:
   I64 xyz_fluff_1000[3];
   I64 xyz_fluff_10000[3];
   BOOL add(const LASpoint* point);
+  // adds the points of another (for example thread-local) summary. the attributer is needed
+  // for the extra bytes. afterwards the fluff counts only tell whether all points have fluff.
+  BOOL merge(const LASsummary* summary, const LASattributer* attributer=0);
   BOOL has_fluff() const { return has_fluff(0) || has_fluff(1) || has_fluff(2); };
   BOOL has_fluff(U32 i) const { return (number_of_point_records && (number_of_point_records == xyz_fluff_10[i])); };
   BOOL has_serious_fluff() const { return has_serious_fluff(0) || has_serious_fluff(1) || has_serious_fluff(2); };
@@ -101,6 +109,7 @@ public:
   void add(F64 item);
   void add(I32 item, I32 value);
   void add(F64 item, F64 value);
+  void merge(const LASbin* bin);
   void report(FILE* file, const CHAR* name=0, const CHAR* name_avg=0) const;
   void reset();
   F64 get_step() const;
@@ -108,6 +117,7 @@ public:
   ~LASbin();
 private:
   void add_to_bin(I32 bin);
+  void merge_bin(I32 bin, U32 number, const F64* value);
   F64 total;
   I64 count;
   F64 step;
@@ -133,6 +143,9 @@ public:
   BOOL histo(const CHAR* name, F64 step);
   BOOL histo_avg(const CHAR* name, F64 step, const CHAR* name_avg);
   void add(const LASpoint* point);
+  // creates the same (empty) histograms as another one, for example for each thread
+  BOOL init(const LAShistogram* histogram);
+  void merge(const LAShistogram* histogram);
   void report(FILE* file) const;
   void reset();
   LAShistogram();
@@ -31,9 +31,24 @@
 #include "laswaveform13reader.hpp"
 
 #include "bytestreamin_file.hpp"
+#include "bytestreamin_array.hpp"
 #include "arithmeticdecoder.hpp"
 #include "integercompressor.hpp"
 
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+using namespace std;
+
+// packets that are closer than this are fetched with one read
+
+#define LAS_WAVEFORM_BATCH_GAP 65536
+
+// zero bytes after each read so the decoder can look ahead past the last packet
+
+#define LAS_WAVEFORM_BATCH_PADDING 16
+
 LASwaveform13reader::LASwaveform13reader()
 {
   nbits = 0;
@@ -62,6 +77,12 @@ LASwaveform13reader::LASwaveform13reader()
   dec = 0;
   ic8 = 0;
   ic16 = 0;
+  spans = 0;
+  spans_allocated = 0;
+  packets = 0;
+  packets_allocated = 0;
+  arena = 0;
+  arena_allocated = 0;
 }
 
 LASwaveform13reader::~LASwaveform13reader()
@@ -70,6 +91,9 @@ LASwaveform13reader::~LASwaveform13reader()
   if (ic8) delete ic8;
   if (ic16) delete ic16;
   if (dec) delete dec;
+  if (spans) free(spans);
+  if (packets) free(packets);
+  if (arena) free(arena);
 }
 
 BOOL LASwaveform13reader::is_compressed() const
@@ -360,6 +384,230 @@ BOOL LASwaveform13reader::read_waveform(const LASpoint* point)
   return TRUE;
 }
 
+U32 LASwaveform13reader::read_waveforms(const LASwavepacket* wavepackets, const U32 number, U32 threads)
+{
+  if (stream == 0)
+  {
+    fprintf(stderr, "ERROR: no waveform file opened\n");
+    return 0;
+  }
+  if (number == 0)
+  {
+    return 0;
+  }
+  if (number > spans_allocated)
+  {
+    if (spans) free(spans);
+    spans = (LASwaveformSpan*)malloc(sizeof(LASwaveformSpan)*number);
+    spans_allocated = number;
+  }
+
+  // check the packets and give each its place in the sample arena
+
+  U32 i;
+  vector<U32> order;
+  vector<I64> position(number);
+  vector<I64> bytes(number);
+  vector<I64> source(number, -1);
+  vector<I64> target(number);
+  I64 total = 0;
+  for (i = 0; i < number; i++)
+  {
+    spans[i].nbits = 0;
+    spans[i].nsamples = 0;
+    spans[i].samples = 0;
+    U32 index = wavepackets[i].getIndex();
+    if (index == 0)
+    {
+      continue;
+    }
+    if (wave_packet_descr[index] == 0)
+    {
+      fprintf(stderr, "ERROR: wavepacket %u is indexing non-existant descriptor %u\n", i, index);
+      continue;
+    }
+    U32 nbits = wave_packet_descr[index]->getBitsPerSample();
+    if ((nbits != 8) && (nbits != 16))
+    {
+      fprintf(stderr, "ERROR: waveform with %d bits per samples not supported yet\n", nbits);
+      continue;
+    }
+    U32 nsamples = wave_packet_descr[index]->getNumberOfSamples();
+    if (nsamples == 0)
+    {
+      fprintf(stderr, "ERROR: waveform has no samples\n");
+      continue;
+    }
+    if (wave_packet_descr[index]->getCompressionType() == 0)
+    {
+      bytes[i] = (nbits/8) * nsamples;
+    }
+    else if ((bytes[i] = wavepackets[i].getSize()) == 0)
+    {
+      fprintf(stderr, "ERROR: compressed wavepacket %u has no size\n", i);
+      continue;
+    }
+    spans[i].nbits = nbits;
+    spans[i].nsamples = nsamples;
+    position[i] = start_of_waveform_data_packet_record + wavepackets[i].getOffset();
+    target[i] = total;
+    // every packet starts at a multiple of 8 bytes so that 16 bit samples are aligned
+    total += (((nbits/8) * nsamples) + 7) & ~((I64)7);
+    order.push_back(i);
+  }
+  if (order.size() == 0)
+  {
+    return 0;
+  }
+
+  // read the packets in file order. those close to each other are fetched together with one read.
+
+  sort(order.begin(), order.end(), [&](U32 a, U32 b) { return position[a] < position[b]; });
+
+  vector<I64> runs; // start, end, and first entry in order of each run
+  I64 needed = 0;
+  size_t o;
+  for (o = 0; o < order.size(); o++)
+  {
+    i = order[o];
+    if (runs.size() && (position[i] <= runs[runs.size()-2] + LAS_WAVEFORM_BATCH_GAP))
+    {
+      if (position[i] + bytes[i] > runs[runs.size()-2])
+      {
+        needed += position[i] + bytes[i] - runs[runs.size()-2];
+        runs[runs.size()-2] = position[i] + bytes[i];
+      }
+    }
+    else
+    {
+      runs.push_back(position[i]);
+      runs.push_back(position[i] + bytes[i]);
+      runs.push_back(o);
+      needed += bytes[i] + LAS_WAVEFORM_BATCH_PADDING;
+    }
+  }
+  if (needed > packets_allocated)
+  {
+    if (packets) free(packets);
+    packets = (U8*)malloc((size_t)needed);
+    packets_allocated = needed;
+  }
+  if (total > arena_allocated)
+  {
+    if (arena) free(arena);
+    arena = (U8*)malloc((size_t)total);
+    arena_allocated = total;
+  }
+  if ((packets == 0) || (arena == 0))
+  {
+    fprintf(stderr, "ERROR: cannot allocate %lld bytes for %u waveforms\n", needed + total, number);
+    packets_allocated = 0;
+    arena_allocated = 0;
+    return 0;
+  }
+
+  size_t r;
+  I64 offset = 0;
+  for (r = 0; r < runs.size(); r += 3)
+  {
+    I64 length = runs[r+1] - runs[r];
+    BOOL read = TRUE;
+    try { stream->seek(runs[r]); stream->getBytes(packets + offset, (U32)length); } catch(...)
+    {
+      fprintf(stderr, "ERROR: cannot read %lld bytes of waveforms at offset %lld\n", length, runs[r]);
+      read = FALSE;
+    }
+    memset(packets + offset + length, 0, LAS_WAVEFORM_BATCH_PADDING);
+    size_t end = ((r + 3) < runs.size() ? (size_t)runs[r+5] : order.size());
+    for (o = (size_t)runs[r+2]; o < end; o++)
+    {
+      i = order[o];
+      if (read) source[i] = offset + (position[i] - runs[r]);
+    }
+    offset += length + LAS_WAVEFORM_BATCH_PADDING;
+  }
+
+  // decompress with several threads that each have their own decoder
+
+  if (threads == 0) threads = thread::hardware_concurrency();
+  if (threads == 0) threads = 1;
+  if (threads > order.size() / 64) threads = (U32)(order.size() / 64);
+  if (threads == 0) threads = 1;
+
+  atomic<size_t> next(0);
+  atomic<U32> count(0);
+
+  auto worker = [&]()
+  {
+    ArithmeticDecoder dec;
+    IntegerCompressor ic8(&dec, 8);
+    IntegerCompressor ic16(&dec, 16);
+    ByteStreamInArray* in;
+    if (IS_LITTLE_ENDIAN())
+      in = new ByteStreamInArrayLE();
+    else
+      in = new ByteStreamInArrayBE();
+    size_t o;
+    U32 i, s;
+    while ((o = next++) < order.size())
+    {
+      i = order[o];
+      if (source[i] < 0) continue;
+      U8* samples = arena + target[i];
+      const U8* packet = packets + source[i];
+      U32 nsamples = spans[i].nsamples;
+      U32 index = wavepackets[i].getIndex();
+      if (wave_packet_descr[index]->getCompressionType() == 0)
+      {
+        memcpy(samples, packet, (size_t)bytes[i]);
+      }
+      else
+      {
+        in->init(packet, bytes[i] + LAS_WAVEFORM_BATCH_PADDING);
+        try
+        {
+          if (spans[i].nbits == 8)
+          {
+            in->getBytes(samples, 1);
+            dec.init(in);
+            ic8.initDecompressor();
+            for (s = 1; s < nsamples; s++)
+            {
+              samples[s] = ic8.decompress(samples[s-1]);
+            }
+          }
+          else
+          {
+            in->getBytes(samples, 2);
+            dec.init(in);
+            ic16.initDecompressor();
+            for (s = 1; s < nsamples; s++)
+            {
+              ((U16*)samples)[s] = ic16.decompress(((U16*)samples)[s-1]);
+            }
+          }
+          dec.done();
+        }
+        catch(...)
+        {
+          fprintf(stderr, "ERROR: cannot decompress waveform of wavepacket %u\n", i);
+          continue;
+        }
+      }
+      spans[i].samples = samples;
+      count++;
+    }
+    delete in;
+  };
+
+  vector<thread> pool;
+  for (i = 1; i < threads; i++) pool.push_back(thread(worker));
+  worker();
+  for (i = 0; i < pool.size(); i++) pool[i].join();
+
+  return count;
+}
+
 BOOL LASwaveform13reader::get_samples()
 {
   if (nbits == 8)
@@ -25,6 +25,7 @@
 
   CHANGE HISTORY:
 
+    19 October 2026 -- batch reading of many waveforms with coalesced reads and threads
      7 September 2018 -- replaced calls to _strdup with calls to the LASCopyString macro
     17 October 2011 -- created after bauarbeiter on the roof next door woke me
 
@@ -40,6 +41,14 @@ class LASwaveformDescription;
 class ArithmeticDecoder;
 class IntegerCompressor;
 
+class LASwaveformSpan
+{
+public:
+  U32 nbits;
+  U32 nsamples;
+  const U8* samples;   // zero if the waveform could not be read
+};
+
 class LASwaveform13reader
 {
 public:
@@ -65,6 +74,12 @@ public:
 
   BOOL read_waveform(const LASpoint* point);
 
+  // reads the waveforms of many wave packets at once. the packets are read in file order with
+  // few large reads and decompressed by several threads (with 0 meaning one thread per core).
+  // the samples stay valid until the next call. returns the number of waveforms read.
+  U32 read_waveforms(const LASwavepacket* wavepackets, const U32 number, U32 threads=0);
+  inline const LASwaveformSpan* get_span(const U32 i) const { return &spans[i]; };
+
   BOOL get_samples();
   BOOL has_samples();
 
@@ -87,6 +102,13 @@ private:
   ArithmeticDecoder* dec;
   IntegerCompressor* ic8;
   IntegerCompressor* ic16;
+  // reused by read_waveforms()
+  LASwaveformSpan* spans;
+  U32 spans_allocated;
+  U8* packets;
+  I64 packets_allocated;
+  U8* arena;
+  I64 arena_allocated;
 };
 
 #endif
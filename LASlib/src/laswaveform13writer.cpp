@@ -31,9 +31,16 @@
 #include "laswaveform13writer.hpp"
 
 #include "bytestreamout_file.hpp"
+#include "bytestreamout_array.hpp"
 #include "arithmeticencoder.hpp"
 #include "integercompressor.hpp"
 
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+using namespace std;
+
 class LASwaveformDescription
 {
 public:
@@ -42,6 +49,63 @@ public:
   U16 nsamples;
 };
 
+// a waveform waiting in the queue. slots are reused round robin.
+
+class LASwaveformJob
+{
+public:
+  U32 index;
+  U32 state;           // 0 = free, 1 = queued, 2 = compressing, 3 = compressed
+  U32 allocated;
+  U8* samples;
+  ByteStreamOutArray* packet;
+};
+
+class LASwaveformQueue
+{
+public:
+  U32 capacity;
+  LASwaveformJob* jobs;
+  I64 queued;          // waveforms handed to queue_waveform()
+  I64 compressing;     // waveforms taken by the compressor threads
+  I64 written;         // waveforms appended to the file
+  BOOL stop;
+  BOOL failed;
+  vector<I64> offsets; // of the written packets or -1 without a waveform
+  vector<U32> sizes;
+  vector<U8> indices;
+  vector<thread> compressors;
+  thread writer;
+  mutex lock;
+  condition_variable changed;
+};
+
+static void compress_waveform(ByteStreamOut* stream, ArithmeticEncoder* enc, IntegerCompressor* ic8, IntegerCompressor* ic16, U32 nbits, U32 nsamples, const U8* samples)
+{
+  U32 s_count;
+  if (nbits == 8)
+  {
+    stream->putBytes(samples, 1);
+    enc->init(stream);
+    ic8->initCompressor();
+    for (s_count = 1; s_count < nsamples; s_count++)
+    {
+      ic8->compress(samples[s_count-1], samples[s_count]);
+    }
+  }
+  else
+  {
+    stream->putBytes(samples, 2);
+    enc->init(stream);
+    ic16->initCompressor();
+    for (s_count = 1; s_count < nsamples; s_count++)
+    {
+      ic16->compress(((U16*)samples)[s_count-1], ((U16*)samples)[s_count]);
+    }
+  }
+  enc->done();
+}
+
 LASwaveform13writer::LASwaveform13writer()
 {
   waveforms = 0;
@@ -50,6 +114,7 @@ LASwaveform13writer::LASwaveform13writer()
   enc = 0;
   ic8 = 0;
   ic16 = 0;
+  queue = 0;
 }
 
 LASwaveform13writer::~LASwaveform13writer()
@@ -63,6 +128,18 @@ LASwaveform13writer::~LASwaveform13writer()
     }
     delete [] waveforms;
   }
+  if (queue)
+  {
+    close();
+    U32 i;
+    for (i = 0; i < queue->capacity; i++)
+    {
+      if (queue->jobs[i].samples) free(queue->jobs[i].samples);
+      if (queue->jobs[i].packet) delete queue->jobs[i].packet;
+    }
+    delete [] queue->jobs;
+    delete queue;
+  }
   if (ic8) delete ic8;
   if (ic16) delete ic16;
   if (enc) delete enc;
@@ -300,37 +377,302 @@ BOOL LASwaveform13writer::write_waveform(LASpoint* point, U8* samples)
   }
   else
   {
-    U32 s_count;
-    if (nbits == 8)
+    compress_waveform(stream, enc, ic8, ic16, nbits, nsamples, samples);
+    U32 size = (U32)(stream->tell() - offset);
+    point->wavepacket.setSize(size);
+  }
+
+  return TRUE;
+}
+
+BOOL LASwaveform13writer::set_threads(U32 threads, U32 capacity)
+{
+  if (stream == 0)
+  {
+    fprintf(stderr, "ERROR: open the waveform file before starting the threads\n");
+    return FALSE;
+  }
+  if (queue)
+  {
+    fprintf(stderr, "ERROR: waveform threads were already started\n");
+    return FALSE;
+  }
+  if (threads == 0) threads = thread::hardware_concurrency();
+  if (threads == 0) threads = 1;
+  if (capacity < 2*threads) capacity = 2*threads;
+
+  queue = new LASwaveformQueue();
+  queue->capacity = capacity;
+  queue->jobs = new LASwaveformJob[capacity];
+  memset(queue->jobs, 0, sizeof(LASwaveformJob)*capacity);
+  queue->queued = 0;
+  queue->compressing = 0;
+  queue->written = 0;
+  queue->stop = FALSE;
+  queue->failed = FALSE;
+
+  LASwaveformQueue* q = queue;
+  LASwaveformDescription** waveforms = this->waveforms;
+  ByteStreamOut* stream = this->stream;
+
+  // compressors take the queued waveforms in order but may finish them in any order
+
+  auto compressor = [q, waveforms]()
+  {
+    ArithmeticEncoder enc;
+    IntegerCompressor ic8(&enc, 8);
+    IntegerCompressor ic16(&enc, 16);
+    while (true)
     {
-      stream->putBytes(samples, 1);
-      enc->init(stream);
-      ic8->initCompressor();
-      for (s_count = 1; s_count < nsamples; s_count++)
+      unique_lock<mutex> guard(q->lock);
+      q->changed.wait(guard, [q]() { return (q->compressing < q->queued) || q->stop; });
+      if (q->compressing == q->queued)
       {
-        ic8->compress(samples[s_count-1], samples[s_count]);
+        return;
       }
+      LASwaveformJob* job = &q->jobs[q->compressing % q->capacity];
+      q->compressing++;
+      job->state = 2;
+      guard.unlock();
+
+      if (job->index && waveforms[job->index]->compression)
+      {
+        if (job->packet == 0)
+        {
+          if (IS_LITTLE_ENDIAN())
+            job->packet = new ByteStreamOutArrayLE();
+          else
+            job->packet = new ByteStreamOutArrayBE();
+        }
+        job->packet->seek(0);
+        compress_waveform(job->packet, &enc, &ic8, &ic16, waveforms[job->index]->nbits, waveforms[job->index]->nsamples, job->samples);
+      }
+
+      guard.lock();
+      job->state = 3;
+      q->changed.notify_all();
     }
-    else
+  };
+
+  // the writer appends the compressed waveforms to the file in the order they were queued
+
+  auto writer = [q, waveforms, stream]()
+  {
+    while (true)
     {
-      stream->putBytes(samples, 2);
-      enc->init(stream);
-      ic16->initCompressor();
-      for (s_count = 1; s_count < nsamples; s_count++)
+      unique_lock<mutex> guard(q->lock);
+      q->changed.wait(guard, [q]() { return (q->written < q->queued && q->jobs[q->written % q->capacity].state == 3) || (q->stop && (q->written == q->queued)); });
+      if (q->written == q->queued)
+      {
+        return;
+      }
+      LASwaveformJob* job = &q->jobs[q->written % q->capacity];
+      guard.unlock();
+
+      I64 offset = -1;
+      U32 size = 0;
+      if (job->index)
       {
-        ic16->compress(((U16*)samples)[s_count-1], ((U16*)samples)[s_count]);
+        offset = stream->tell();
+        BOOL written;
+        if (waveforms[job->index]->compression)
+        {
+          size = (U32)job->packet->getCurr();
+          written = stream->putBytes(job->packet->getData(), size);
+        }
+        else
+        {
+          size = (waveforms[job->index]->nbits/8) * waveforms[job->index]->nsamples;
+          written = stream->putBytes(job->samples, size);
+        }
+        if (!written)
+        {
+          fprintf(stderr, "ERROR: cannot write %u bytes for waveform %lld\n", size, q->written);
+          offset = -1;
+        }
       }
+
+      guard.lock();
+      if (job->index && (offset == -1)) q->failed = TRUE;
+      q->offsets[q->written] = offset;
+      q->sizes[q->written] = size;
+      job->state = 0;
+      q->written++;
+      q->changed.notify_all();
     }
-    enc->done();
-    U32 size = (U32)(stream->tell() - offset);
-    point->wavepacket.setSize(size);
+  };
+
+  U32 i;
+  for (i = 0; i < threads; i++) queue->compressors.push_back(thread(compressor));
+  queue->writer = thread(writer);
+  return TRUE;
+}
+
+I64 LASwaveform13writer::queue_waveform(const LASpoint* point, const U8* samples)
+{
+  if (queue == 0)
+  {
+    fprintf(stderr, "ERROR: waveform threads were not started\n");
+    return -1;
   }
 
+  U32 index = point->wavepacket.getIndex();
+  U32 size = 0;
+  if (index)
+  {
+    if ((waveforms[index] == 0) || ((waveforms[index]->nbits != 8) && (waveforms[index]->nbits != 16)) || (waveforms[index]->nsamples == 0))
+    {
+      fprintf(stderr, "ERROR: waveform with index %u cannot be written\n", index);
+      return -1;
+    }
+    size = (waveforms[index]->nbits/8) * waveforms[index]->nsamples;
+  }
+
+  unique_lock<mutex> guard(queue->lock);
+  queue->changed.wait(guard, [this]() { return (queue->queued - queue->written) < queue->capacity; });
+  LASwaveformJob* job = &queue->jobs[queue->queued % queue->capacity];
+  guard.unlock();
+
+  // the slot is free so no other thread touches it until it is queued
+
+  job->index = index;
+  if (size > job->allocated)
+  {
+    if (job->samples) free(job->samples);
+    job->samples = (U8*)malloc(size);
+    job->allocated = size;
+  }
+  if (size) memcpy(job->samples, samples, size);
+
+  guard.lock();
+  job->state = 1;
+  queue->offsets.push_back(-1);
+  queue->sizes.push_back(0);
+  queue->indices.push_back((U8)index);
+  I64 number = queue->queued++;
+  queue->changed.notify_all();
+  return number;
+}
+
+BOOL LASwaveform13writer::get_wavepacket(const I64 number, LASwavepacket* wavepacket)
+{
+  if ((queue == 0) || (number < 0))
+  {
+    return FALSE;
+  }
+  unique_lock<mutex> guard(queue->lock);
+  if (number >= queue->queued)
+  {
+    return FALSE;
+  }
+  queue->changed.wait(guard, [this, number]() { return number < queue->written; });
+  if (queue->offsets[number] < 0)
+  {
+    return FALSE;
+  }
+  wavepacket->setIndex(queue->indices[number]);
+  wavepacket->setOffset(queue->offsets[number]);
+  wavepacket->setSize(queue->sizes[number]);
+  return TRUE;
+}
+
+BOOL LASwaveform13writer::patch_points(const char* file_name) const
+{
+  if (queue == 0)
+  {
+    fprintf(stderr, "ERROR: no waveforms were queued\n");
+    return FALSE;
+  }
+  if (queue->written != queue->queued)
+  {
+    fprintf(stderr, "ERROR: close the waveform writer before patching the points\n");
+    return FALSE;
+  }
+
+  FILE* file = fopen(file_name, "r+b");
+  if (file == 0)
+  {
+    fprintf(stderr, "ERROR: cannot open '%s' for patching the wave packets\n", file_name);
+    return FALSE;
+  }
+
+  // the fields of the header that locate the wave packets in the point records
+
+  U8 header[107];
+  if (fread(header, 1, 107, file) != 107)
+  {
+    fprintf(stderr, "ERROR: cannot read header of '%s'\n", file_name);
+    fclose(file);
+    return FALSE;
+  }
+  U32 offset_to_point_data;
+  U16 point_data_record_length;
+  memcpy(&offset_to_point_data, &header[96], 4);
+  memcpy(&point_data_record_length, &header[105], 2);
+  U8 point_data_format = header[104];
+  I64 start;
+  if (point_data_format == 4) start = 28;
+  else if (point_data_format == 5) start = 34;
+  else if (point_data_format == 9) start = 30;
+  else if (point_data_format == 10) start = 38;
+  else
+  {
+    fprintf(stderr, "ERROR: '%s' is compressed or has points of type %d without wave packets\n", file_name, point_data_format);
+    fclose(file);
+    return FALSE;
+  }
+
+  // rewrite index, offset, and size of every wave packet
+
+  I64 i;
+  U8 packet[13];
+  for (i = 0; i < queue->written; i++)
+  {
+    if (queue->offsets[i] < 0) continue;
+    packet[0] = queue->indices[i];
+    U64 offset = (U64)queue->offsets[i];
+    memcpy(&packet[1], &offset, 8);
+    memcpy(&packet[9], &queue->sizes[i], 4);
+    I64 position = offset_to_point_data + i*point_data_record_length + start;
+#if defined _WIN32 && ! defined (__MINGW32__)
+    _fseeki64(file, position, SEEK_SET);
+#elif defined (__MINGW32__)
+    fseeko64(file, (off64_t)position, SEEK_SET);
+#else
+    fseeko(file, (off_t)position, SEEK_SET);
+#endif
+    if (fwrite(packet, 1, 13, file) != 13)
+    {
+      fprintf(stderr, "ERROR: cannot patch wave packet of point %lld in '%s'\n", i, file_name);
+      fclose(file);
+      return FALSE;
+    }
+  }
+  fclose(file);
   return TRUE;
 }
 
 void LASwaveform13writer::close()
 {
+  if (queue && queue->writer.joinable())
+  {
+    unique_lock<mutex> guard(queue->lock);
+    queue->stop = TRUE;
+    queue->changed.notify_all();
+    guard.unlock();
+    U32 i;
+    for (i = 0; i < queue->compressors.size(); i++) queue->compressors[i].join();
+    queue->compressors.clear();
+    queue->writer.join();
+    if (queue->failed)
+    {
+      fprintf(stderr, "ERROR: not all queued waveforms were written\n");
+    }
+  }
+  if (stream == 0)
+  {
+    return;
+  }
   if (stream->isSeekable())
   {
     I64 record_length_after_header = stream->tell();
@@ -25,6 +25,7 @@
 
   CHANGE HISTORY:
 
+    19 October 2026 -- optional queue that compresses waveforms on a pool of threads
      7 September 2018 -- replaced calls to _strdup with calls to the LASCopyString macro
     17 October 2011 -- created after bauarbeiter on the roof next door woke me
 
@@ -39,6 +40,7 @@ class ByteStreamOut;
 class LASwaveformDescription;
 class ArithmeticEncoder;
 class IntegerCompressor;
+class LASwaveformQueue;
 
 class LASwaveform13writer
 {
@@ -47,6 +49,17 @@ public:
 
   BOOL write_waveform(LASpoint* point, U8* samples);
 
+  // instead of write_waveform() the waveform of every point can be queued and get compressed
+  // by a pool of threads (with 0 meaning one thread per core) while the caller writes points.
+  // the packets are appended to the file in the order they were queued. their offsets and
+  // sizes are only known later: either wait for them with get_wavepacket() or write the points
+  // first and patch them into an uncompressed LAS file with patch_points() after close(). the
+  // n-th queued waveform belongs to the n-th point. returns the number of the waveform or -1.
+  BOOL set_threads(U32 threads=0, U32 capacity=4096);
+  I64 queue_waveform(const LASpoint* point, const U8* samples);
+  BOOL get_wavepacket(const I64 number, LASwavepacket* wavepacket);
+  BOOL patch_points(const char* file_name) const;
+
   void close();
 
   LASwaveform13writer();
@@ -60,6 +73,8 @@ private:
   ArithmeticEncoder* enc;
   IntegerCompressor* ic8;
   IntegerCompressor* ic16;
+
+  LASwaveformQueue* queue;
 };
 
 #endif
@@ -70,6 +70,7 @@ LASwriter* LASwriteOpener::open(const LASheader* header)
     if (format <= LAS_TOOLS_FORMAT_LAZ)
     {
       LASwriterLAS* laswriterlas = new LASwriterLAS();
+      if (chunk_stats) laswriterlas->set_chunk_stats(TRUE);
       if (!laswriterlas->open(file_name, header, (format == LAS_TOOLS_FORMAT_LAZ ? (native ? LASZIP_COMPRESSOR_LAYERED_CHUNKED : LASZIP_COMPRESSOR_CHUNKED) : LASZIP_COMPRESSOR_NONE), 2, chunk_size, io_obuffer_size))
       {
         fprintf(stderr,"ERROR: cannot open laswriterlas with file name '%s'\n", file_name);
@@ -231,6 +232,7 @@ void LASwriteOpener::usage() const
   fprintf(stderr,"  -odix _classified (specify file name appendix)\n");
   fprintf(stderr,"  -ocut 2 (cut the last two characters from name)\n");
   fprintf(stderr,"  -olas -olaz -otxt -obin -oqfit (specify format)\n");
+  fprintf(stderr,"  -chunk_stats (write per-chunk statistics to a *.lcs file)\n");
   fprintf(stderr,"  -stdout (pipe to stdout)\n");
   fprintf(stderr,"  -nil    (pipe to NULL)\n");
 }
@@ -361,6 +363,11 @@ BOOL LASwriteOpener::parse(int argc, char* argv[])
       set_chunk_size(atoi(argv[i+1]));
       *argv[i]='\0'; *argv[i+1]='\0'; i+=1;
     }
+    else if (strcmp(argv[i],"-chunk_stats") == 0)
+    {
+      set_chunk_stats(TRUE);
+      *argv[i]='\0';
+    }
     else if (strcmp(argv[i],"-oparse") == 0)
     {
       if ((i+1) >= argc)
@@ -737,6 +744,11 @@ void LASwriteOpener::set_chunk_size(U32 chunk_size)
   this->chunk_size = chunk_size;
 }
 
+void LASwriteOpener::set_chunk_stats(BOOL chunk_stats)
+{
+  this->chunk_stats = chunk_stats;
+}
+
 void LASwriteOpener::make_numbered_file_name(const CHAR* file_name, I32 digits)
 {
   I32 len;
@@ -1157,6 +1169,7 @@ LASwriteOpener::LASwriteOpener()
   specified = FALSE;
   force = FALSE;
   chunk_size = LASZIP_CHUNK_SIZE_DEFAULT;
+  chunk_stats = FALSE;
   use_stdout = FALSE;
   use_nil = FALSE;
 }
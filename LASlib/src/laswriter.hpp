@@ -25,6 +25,7 @@
 
   CHANGE HISTORY:
 
+    19 October 2026 -- '-chunk_stats' writes per-chunk statistics for skipping chunks with filters
     7 September 2018 -- replaced calls to _strdup with calls to the LASCopyString macro
     17 August 2017 -- switch on "native LAS 1.4 extension". turns off with '-no_native'.
     29 March 2017 -- enable "native LAS 1.4 extension" for LASzip via '-native'
@@ -83,6 +84,7 @@ public:
   BOOL set_format(const CHAR* format);
   void set_force(BOOL force);
   void set_chunk_size(U32 chunk_size);
+  void set_chunk_stats(BOOL chunk_stats);
   void make_numbered_file_name(const CHAR* file_name, I32 digits);
   void make_file_name(const CHAR* file_name, I32 file_number=-1);
   const CHAR* get_directory() const;
@@ -127,6 +129,7 @@ private:
   BOOL force;
   BOOL native;
   U32 chunk_size;
+  BOOL chunk_stats;
   BOOL use_stdout;
   BOOL use_nil;
   BOOL buffered;
@@ -34,6 +34,7 @@
 #include "bytestreamout_file.hpp"
 #include "bytestreamout_ostream.hpp"
 #include "laswritepoint.hpp"
+#include "laschunkstats.hpp"
 
 #ifdef _WIN32
 #include <fcntl.h>
@@ -50,6 +51,19 @@ BOOL LASwriterLAS::refile(FILE* file)
   return ((ByteStreamOutFile*)stream)->refile(file);
 }
 
+void LASwriterLAS::set_chunk_stats(BOOL chunk_stats)
+{
+  if (chunk_stats)
+  {
+    if (this->chunk_stats == 0) this->chunk_stats = new LASchunkStats();
+  }
+  else if (this->chunk_stats)
+  {
+    delete this->chunk_stats;
+    this->chunk_stats = 0;
+  }
+}
+
 BOOL LASwriterLAS::open(const LASheader* header, U32 compressor, I32 requested_version, I32 chunk_size)
 {
   ByteStreamOut* out = new ByteStreamOutNil();
@@ -82,7 +96,22 @@ BOOL LASwriterLAS::open(const char* file_name, const LASheader* header, U32 comp
   else
     out = new ByteStreamOutFileBE(file);
 
-  return open(out, header, compressor, requested_version, chunk_size);
+  if (!open(out, header, compressor, requested_version, chunk_size))
+  {
+    return FALSE;
+  }
+
+  if (chunk_stats)
+  {
+    if (chunk_stats_file_name) free(chunk_stats_file_name);
+    chunk_stats_file_name = LASCopyString(file_name);
+  }
+  else
+  {
+    // the statistics of whatever was written here before would no longer fit
+    LASchunkStats::remove(file_name);
+  }
+  return TRUE;
 }
 
 BOOL LASwriterLAS::open(FILE* file, const LASheader* header, U32 compressor, I32 requested_version, I32 chunk_size)
@@ -189,7 +218,7 @@ BOOL LASwriterLAS::open(ByteStreamOut* stream, const LASheader* header, U32 comp
     laszip->setup(point.num_items, point.items, compressor);
     if (chunk_size > -1) laszip->set_chunk_size((U32)chunk_size);
     if (compressor == LASZIP_COMPRESSOR_NONE) laszip->request_version(0);
-    else if (chunk_size == 0 && (point_data_format <= 5)) { fprintf(stderr,"ERROR: adaptive chunking is depricated for point type %d.\n       only available for new LAS 1.4 point types 6 or higher.\n", point_data_format); return FALSE; }
+    else if (chunk_size == 0 && (point_data_format <= 5) && !adaptive_chunking) { fprintf(stderr,"ERROR: adaptive chunking is depricated for point type %d.\n       only available for new LAS 1.4 point types 6 or higher.\n", point_data_format); return FALSE; }
     else if (requested_version) laszip->request_version(requested_version);
     else laszip->request_version(2);
     laszip_vlr_data_size = 34 + 6*laszip->num_items;
@@ -882,18 +911,42 @@ BOOL LASwriterLAS::open(ByteStreamOut* stream, const LASheader* header, U32 comp
   npoints = (header->number_of_point_records ? header->number_of_point_records : header->extended_number_of_point_records);
   p_count = 0;
 
+  if (chunk_stats)
+  {
+    // the chunks of the compressor or blocks of the same size for LAS
+    if (compressor) chunk_stats->init(header, (chunk_size < 0 ? LASZIP_CHUNK_SIZE_DEFAULT : (U32)chunk_size));
+    else chunk_stats->init(header, (chunk_size > 0 ? (U32)chunk_size : LASZIP_CHUNK_SIZE_DEFAULT));
+  }
+
   return TRUE;
 }
 
 BOOL LASwriterLAS::write_point(const LASpoint* point)
 {
   p_count++;
+  if (chunk_stats) chunk_stats->add(point);
   return writer->write(point->point);
 }
 
 BOOL LASwriterLAS::chunk()
 {
-  return writer->chunk();
+  if (!writer->chunk())
+  {
+    return FALSE;
+  }
+  if (chunk_stats) chunk_stats->chunk();
+  return TRUE;
+}
+
+BOOL LASwriterLAS::write_chunk(const U8* bytes, const U32 num_bytes, const U32 num_points)
+{
+  if (!writer->write_chunk(bytes, num_bytes, num_points))
+  {
+    return FALSE;
+  }
+  p_count += num_points;
+  if (chunk_stats) chunk_stats->add_unknown(num_points);
+  return TRUE;
 }
 
 BOOL LASwriterLAS::update_header(const LASheader* header, BOOL use_inventory, BOOL update_extra_bytes)
@@ -1339,6 +1392,7 @@ I64 LASwriterLAS::close(BOOL update_npoints)
       }
     }
     bytes = stream->tell() - header_start_position;
+    if (chunk_stats) chunk_stats->set_file_size(stream->tell());
     if (delete_stream)
     {
       delete stream;
@@ -1352,6 +1406,17 @@ I64 LASwriterLAS::close(BOOL update_npoints)
     file = 0;
   }
 
+  if (chunk_stats)
+  {
+    chunk_stats->done();
+    if (chunk_stats_file_name)
+    {
+      chunk_stats->write(chunk_stats_file_name);
+      free(chunk_stats_file_name);
+      chunk_stats_file_name = 0;
+    }
+  }
+
   npoints = p_count;
   p_count = 0;
 
@@ -1363,6 +1428,9 @@ LASwriterLAS::LASwriterLAS()
   file = 0;
   stream = 0;
   delete_stream = TRUE;
+  adaptive_chunking = FALSE;
+  chunk_stats = 0;
+  chunk_stats_file_name = 0;
   writer = 0;
   writing_las_1_4 = FALSE;
   writing_new_point_type = FALSE;
@@ -1375,4 +1443,6 @@ LASwriterLAS::LASwriterLAS()
 LASwriterLAS::~LASwriterLAS()
 {
   if (writer || stream) close();
+  if (chunk_stats) delete chunk_stats;
+  if (chunk_stats_file_name) free(chunk_stats_file_name);
 }
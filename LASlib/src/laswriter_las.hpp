@@ -24,6 +24,8 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- set_chunk_stats() writes per-chunk statistics to a *.lcs file
+    19 October 2026 -- write_chunk() appends compressed chunks copied from another file
     29 March 2017 -- read and write support "native LAS 1.4 extension" for LASzip
     23 October 2016 -- support writing Extended Variable Length Records (ELVRs)
     29 April 2016 -- added WARNINGs when rescale / reoffset overflows integers
@@ -55,6 +57,7 @@ using namespace std;
 
 class ByteStreamOut;
 class LASwritePoint;
+class LASchunkStats;
 
 class LASwriterLAS : public LASwriter
 {
@@ -62,6 +65,12 @@ public:
 
   BOOL refile(FILE* file);
   void set_delete_stream(BOOL delete_stream=TRUE) { this->delete_stream = delete_stream; };
+  // allows a chunk_size of 0 (variable chunking) also for the old point types
+  void set_adaptive_chunking(BOOL adaptive_chunking=TRUE) { this->adaptive_chunking = adaptive_chunking; };
+  // collects per-chunk statistics for skipping chunks when reading with a filter. must be
+  // called before open(). when opened with a file name close() writes them to a *.lcs file.
+  void set_chunk_stats(BOOL chunk_stats=TRUE);
+  inline const LASchunkStats* get_chunk_stats() const { return chunk_stats; };
 
   BOOL open(const LASheader* header, U32 compressor=LASZIP_COMPRESSOR_NONE, I32 requested_version=0, I32 chunk_size=50000);
   BOOL open(const char* file_name, const LASheader* header, U32 compressor=LASZIP_COMPRESSOR_NONE, I32 requested_version=0, I32 chunk_size=50000, I32 io_buffer_size=LAS_TOOLS_IO_OBUFFER_SIZE);
@@ -72,6 +81,9 @@ public:
   BOOL write_point(const LASpoint* point);
   BOOL chunk();
 
+  // appends a chunk of compressed points copied from a LAZ file with the same items
+  BOOL write_chunk(const U8* bytes, const U32 num_bytes, const U32 num_points);
+
   BOOL update_header(const LASheader* header, BOOL use_inventory=FALSE, BOOL update_extra_bytes=FALSE);
   I64 close(BOOL update_npoints=TRUE);
 
@@ -82,6 +94,9 @@ private:
   FILE* file;
   ByteStreamOut* stream;
   BOOL delete_stream;
+  BOOL adaptive_chunking;
+  LASchunkStats* chunk_stats;
+  CHAR* chunk_stats_file_name;
   LASwritePoint* writer;
   I64 header_start_position;
   BOOL writing_las_1_4;
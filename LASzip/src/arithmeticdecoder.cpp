@@ -73,23 +73,26 @@
 #include <assert.h>
 
 #include "arithmeticmodel.hpp"
+#include "bytestreamin_array.hpp"
 
 ArithmeticDecoder::ArithmeticDecoder()
 {
   instream = 0;
+  inarray = 0;
 }
 
 BOOL ArithmeticDecoder::init(ByteStreamIn* instream, BOOL really_init)
 {
   if (instream == 0) return FALSE;
   this->instream = instream;
+  inarray = instream->getArray();
   length = AC__MaxLength;
   if (really_init)
   {
-    value = (instream->getByte() << 24);
-    value |= (instream->getByte() << 16);
-    value |= (instream->getByte() << 8);
-    value |= (instream->getByte());
+    value = (getByte() << 24);
+    value |= (getByte() << 16);
+    value |= (getByte() << 8);
+    value |= (getByte());
   }
   return TRUE;
 }
@@ -97,6 +100,7 @@ BOOL ArithmeticDecoder::init(ByteStreamIn* instream, BOOL really_init)
 void ArithmeticDecoder::done()
 {
   instream = 0;
+  inarray = 0;
 }
 
 ArithmeticBitModel* ArithmeticDecoder::createBitModel()
@@ -167,7 +171,9 @@ U32 ArithmeticDecoder::decodeSymbol(ArithmeticModel* m)
 
     while (n > sym + 1) {                      // finish with bisection search
       U32 k = (sym + n) >> 1;
-      if (m->distribution[k] > dv) n = k; else sym = k;
+      U32 above = (m->distribution[k] > dv);           // select without a branch
+      n = (above ? k : n);
+      sym = (above ? sym : k);
     }
                                                            // compute products
     x = m->distribution[sym] * length;
@@ -308,9 +314,15 @@ ArithmeticDecoder::~ArithmeticDecoder()
 {
 }
 
+inline U32 ArithmeticDecoder::getByte()
+{
+  if (inarray) return inarray->ByteStreamInArray::getByte();  // no virtual call
+  return instream->getByte();
+}
+
 inline void ArithmeticDecoder::renorm_dec_interval()
 {
   do {                                          // read least-significant byte
-    value = (value << 8) | instream->getByte();
+    value = (value << 8) | getByte();
   } while ((length <<= 8) < AC__MinLength);        // length multiplied by 256
 }
@@ -25,6 +25,7 @@
 
   CHANGE HISTORY:
 
+    19 October 2026 -- reads in-memory streams without virtual calls and bisects without branches
     22 August 2016 -- can be used as init dummy by "native LAS 1.4 compressor"
     13 November 2014 -- integrity check in readBits(), readByte(), readShort()
      6 September 2014 -- removed the (unused) inheritance from EntropyDecoder
@@ -101,7 +102,9 @@ public:
 private:
 
   ByteStreamIn* instream;
+  ByteStreamInArray* inarray;   // the same stream if it is in memory
 
+  U32 getByte();
   void renorm_dec_interval();
   U32 value, length;
 };
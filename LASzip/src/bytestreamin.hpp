@@ -24,6 +24,8 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- readAhead() hints the byte ranges an indexed read will seek to next
+    19 October 2026 -- getArray() lets decoders read in-memory streams without virtual calls
      2 January 2013 -- new functions for reading a stream of groups of bits  
      1 October 2011 -- added 64 bit file support in MSVC 6.0 at McCafe at Hbf Linz
     10 January 2011 -- licensing change for LGPL release and liblas integration
@@ -36,6 +38,8 @@
 
 #include "mydefs.hpp"
 
+class ByteStreamInArray;
+
 class ByteStreamIn
 {
 public:
@@ -80,6 +84,10 @@ public:
   virtual BOOL seekEnd(const I64 distance=0) = 0;
 /* seek to the end of the file                               */
   virtual BOOL skipBytes(const U32 num_bytes) { I64 curr = tell(); return seek(curr + num_bytes); };
+/* in-memory streams return themselves for non-virtual reads */
+  virtual ByteStreamInArray* getArray() { return 0; };
+/* hint that these bytes will be read soon (e.g. fadvise)    */
+  virtual BOOL readAhead(const I64 position, const I64 num_bytes) { return FALSE; };
 /* constructor                                               */
   inline ByteStreamIn() { bit_buffer = 0; num_buffer = 0; };
 /* destructor                                                */
@@ -22,6 +22,7 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- returns itself from getArray()
     23 June 2016 -- alternative init option for "native LAS 1.4 compressor"
     19 July 2015 -- moved from LASlib to LASzip for "compatibility mode" in DLL
      9 April 2012 -- created after cooking Zuccini/Onion/Potatoe dinner for Mara
@@ -55,6 +56,8 @@ public:
   BOOL seek(const I64 position);
 /* seek to the end of the stream                             */
   BOOL seekEnd(const I64 distance=0);
+/* in-memory streams return themselves for non-virtual reads */
+  ByteStreamInArray* getArray() { return this; };
 /* destructor                                                */
   ~ByteStreamInArray(){};
 protected:
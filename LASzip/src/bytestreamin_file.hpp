@@ -24,6 +24,7 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- readAhead() with posix_fadvise() where the platform has it
      1 October 2011 -- added 64 bit file support in MSVC 6.0 at McCafe at Hbf Linz
     10 January 2011 -- licensing change for LGPL release and liblas integration
     12 December 2010 -- created from ByteStreamOutFile after Howard got pushy (-;
@@ -37,6 +38,10 @@
 
 #include <stdio.h>
 
+#if !defined(_WIN32)
+#include <fcntl.h>
+#endif
+
 #if defined(_MSC_VER) && (_MSC_VER < 1300)
 extern "C" __int64 _cdecl _ftelli64(FILE*);
 extern "C" int _cdecl _fseeki64(FILE*, __int64, int);
@@ -58,6 +63,8 @@ public:
   BOOL seek(const I64 position);
 /* seek to the end of the file                               */
   BOOL seekEnd(const I64 distance=0);
+/* hint that these bytes will be read soon (e.g. fadvise)    */
+  BOOL readAhead(const I64 position, const I64 num_bytes);
 /* destructor                                                */
   ~ByteStreamInFile(){};
 protected:
@@ -169,6 +176,16 @@ inline BOOL ByteStreamInFile::seekEnd(const I64 distance)
 #endif
 }
 
+inline BOOL ByteStreamInFile::readAhead(const I64 position, const I64 num_bytes)
+{
+  if (file == stdin) return FALSE;
+#if defined(POSIX_FADV_WILLNEED)
+  return (posix_fadvise(fileno(file), (off_t)position, (off_t)num_bytes, POSIX_FADV_WILLNEED) == 0);
+#else
+  return FALSE;
+#endif
+}
+
 inline ByteStreamInFileLE::ByteStreamInFileLE(FILE* file) : ByteStreamInFile(file)
 {
 }
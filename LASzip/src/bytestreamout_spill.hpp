@@ -0,0 +1,159 @@
+/*
+===============================================================================
+
+  FILE:  bytestreamout_spill.hpp
+
+  CONTENTS:
+
+    Output stream that is kept in memory up to a limit and then continues in
+    a scratch file. When the next write would pass the limit, everything in
+    memory is written to the file and the memory is freed. All later writes,
+    seeks, and tells go to the file. Without a file name the scratch file
+    comes from tmpfile(). A named scratch file is removed by the destructor.
+    After a failed write the stream takes no more bytes and reports it.
+
+  COPYRIGHT:
+
+    This is free software; you can redistribute and/or modify it under the
+    terms of the GNU Lesser General Licence as published by the Free Software
+    Foundation. See the COPYING file for more information.
+
+    This software is distributed WITHOUT ANY WARRANTY and without even the
+    implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created so that '-stored' input no longer has to fit into memory
+
+===============================================================================
+*/
+#ifndef BYTE_STREAM_OUT_SPILL_HPP
+#define BYTE_STREAM_OUT_SPILL_HPP
+
+#include "bytestreamout_array.hpp"
+#include "bytestreamout_file.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+class ByteStreamOutSpill : public ByteStreamOut
+{
+public:
+  ByteStreamOutSpill(const I64 max_memory, const char* file_name=0, const I64 alloc=1024);
+/* write a single byte                                       */
+  BOOL putByte(U8 byte) { return check(reserve(1) && stream->putByte(byte)); };
+/* write an array of bytes                                   */
+  BOOL putBytes(const U8* bytes, U32 num_bytes) { return check(reserve(num_bytes) && stream->putBytes(bytes, num_bytes)); };
+/* write 16 bit low-endian field                             */
+  BOOL put16bitsLE(const U8* bytes) { return check(reserve(2) && stream->put16bitsLE(bytes)); };
+/* write 32 bit low-endian field                             */
+  BOOL put32bitsLE(const U8* bytes) { return check(reserve(4) && stream->put32bitsLE(bytes)); };
+/* write 64 bit low-endian field                             */
+  BOOL put64bitsLE(const U8* bytes) { return check(reserve(8) && stream->put64bitsLE(bytes)); };
+/* write 16 bit big-endian field                             */
+  BOOL put16bitsBE(const U8* bytes) { return check(reserve(2) && stream->put16bitsBE(bytes)); };
+/* write 32 bit big-endian field                             */
+  BOOL put32bitsBE(const U8* bytes) { return check(reserve(4) && stream->put32bitsBE(bytes)); };
+/* write 64 bit big-endian field                             */
+  BOOL put64bitsBE(const U8* bytes) { return check(reserve(8) && stream->put64bitsBE(bytes)); };
+/* is the stream seekable (e.g. standard out is not)         */
+  BOOL isSeekable() const { return TRUE; };
+/* get current position of stream                            */
+  I64 tell() const { return stream->tell(); };
+/* seek to this position in the stream                       */
+  BOOL seek(const I64 position) { return stream->seek(position); };
+/* seek to the end of the file                               */
+  BOOL seekEnd() { return stream->seekEnd(); };
+/* has everything moved to the scratch file                  */
+  inline BOOL isSpilled() const { return (file != 0); };
+/* the bytes while they are in memory                        */
+  inline const U8* getData() const { return (array ? array->getData() : 0); };
+  inline I64 getSize() const { return (array ? array->getSize() : 0); };
+/* the scratch file after spilling (flushed for reading)     */
+  inline FILE* getFile() { if (file && fflush(file)) failed = TRUE; return file; };
+/* did a write fail (no more bytes are taken after one)      */
+  inline BOOL hasFailed() const { return failed; };
+/* destructor                                                */
+  ~ByteStreamOutSpill();
+private:
+  inline BOOL reserve(const U32 num_bytes) { return (!failed && ((array == 0) || ((array->getCurr() + num_bytes) <= max_memory) || spill())); };
+  inline BOOL check(const BOOL ok) { if (!ok) failed = TRUE; return ok; };
+  BOOL spill();
+  I64 max_memory;
+  char* file_name;
+  ByteStreamOutArray* array;
+  ByteStreamOut* stream;
+  FILE* file;
+  BOOL failed;
+};
+
+inline ByteStreamOutSpill::ByteStreamOutSpill(const I64 max_memory, const char* file_name, const I64 alloc)
+{
+  this->max_memory = max_memory;
+  this->file_name = 0;
+  if (file_name)
+  {
+    this->file_name = (char*)malloc(strlen(file_name) + 1);
+    strcpy(this->file_name, file_name);
+  }
+  if (IS_LITTLE_ENDIAN())
+    array = new ByteStreamOutArrayLE(alloc < max_memory ? alloc : max_memory);
+  else
+    array = new ByteStreamOutArrayBE(alloc < max_memory ? alloc : max_memory);
+  stream = array;
+  file = 0;
+  failed = FALSE;
+}
+
+inline BOOL ByteStreamOutSpill::spill()
+{
+  if (file_name)
+  {
+    file = fopen(file_name, "w+b");
+  }
+  else
+  {
+    file = tmpfile();
+  }
+  if (file == 0)
+  {
+    fprintf(stderr, "ERROR: cannot open scratch file '%s' after %lld bytes\n", (file_name ? file_name : "tmpfile()"), array->getSize());
+    return FALSE;
+  }
+  ByteStreamOutFile* out;
+  if (IS_LITTLE_ENDIAN())
+    out = new ByteStreamOutFileLE(file);
+  else
+    out = new ByteStreamOutFileBE(file);
+  if (!out->putBytes(array->getData(), (U32)array->getSize()) || !out->seek(array->getCurr()))
+  {
+    fprintf(stderr, "ERROR: cannot write %lld bytes to scratch file\n", array->getSize());
+    delete out;
+    fclose(file);
+    file = 0;
+    return FALSE;
+  }
+  free(array->takeData());
+  delete array;
+  array = 0;
+  stream = out;
+  return TRUE;
+}
+
+inline ByteStreamOutSpill::~ByteStreamOutSpill()
+{
+  if (array)
+  {
+    free(array->takeData());
+  }
+  delete stream;
+  if (file)
+  {
+    fclose(file);
+    if (file_name) remove(file_name);
+  }
+  if (file_name) free(file_name);
+}
+
+#endif
@@ -72,11 +72,18 @@ using namespace std;
 typedef unordered_map<I32, U32> my_cell_hash;
 #endif
 
+#include <algorithm>
+
+// the intervals ahead of the current one whose chunks the operating system is asked to fetch
+#define LAS_INDEX_READ_AHEAD_POINTS 1000000
+
 LASindex::LASindex()
 {
   spatial = 0;
   interval = 0;
   have_interval = FALSE;
+  read_ahead_cell = 0;
+  read_ahead_points = 0;
   start = 0;
   end = 0;
   full = 0;
@@ -240,9 +247,88 @@ LASinterval* LASindex::get_interval() const
   return interval;
 }
 
+BOOL LASindex::count_rectangle(const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y, I64* inside, I64* estimate, I64* intersecting, F64* bounding_box)
+{
+  I64 count_inside = 0;
+  I64 count_intersecting = 0;
+  F64 count_estimate = 0.0;
+  F64 box[4] = { 0.0, 0.0, 0.0, 0.0 };
+  BOOL first = TRUE;
+  F32 min[2], max[2];
+  F64 overlap_min_x, overlap_min_y, overlap_max_x, overlap_max_y, area;
+
+  // a point of a cell can be anywhere from its minimum up to and including its maximum
+
+  interval->get_cells();
+  while (interval->has_cells())
+  {
+    spatial->get_cell_bounding_box(interval->index, min, max);
+    if ((max[0] < r_min_x) || (min[0] >= r_max_x) || (max[1] < r_min_y) || (min[1] >= r_max_y)) continue;
+    count_intersecting += interval->full;
+    if ((min[0] >= r_min_x) && (max[0] < r_max_x) && (min[1] >= r_min_y) && (max[1] < r_max_y))
+    {
+      count_inside += interval->full;
+      count_estimate += interval->full;
+    }
+    else
+    {
+      area = ((F64)max[0] - min[0]) * ((F64)max[1] - min[1]);
+      overlap_min_x = (min[0] > r_min_x ? min[0] : r_min_x);
+      overlap_min_y = (min[1] > r_min_y ? min[1] : r_min_y);
+      overlap_max_x = (max[0] < r_max_x ? max[0] : r_max_x);
+      overlap_max_y = (max[1] < r_max_y ? max[1] : r_max_y);
+      if (area > 0.0) count_estimate += interval->full * ((overlap_max_x - overlap_min_x) * (overlap_max_y - overlap_min_y)) / area;
+    }
+    if (first)
+    {
+      box[0] = min[0]; box[1] = min[1]; box[2] = max[0]; box[3] = max[1];
+      first = FALSE;
+    }
+    else
+    {
+      if (min[0] < box[0]) box[0] = min[0];
+      if (min[1] < box[1]) box[1] = min[1];
+      if (max[0] > box[2]) box[2] = max[0];
+      if (max[1] > box[3]) box[3] = max[1];
+    }
+  }
+  if (!first)
+  {
+    if (box[0] < r_min_x) box[0] = r_min_x;
+    if (box[1] < r_min_y) box[1] = r_min_y;
+    if (box[2] > r_max_x) box[2] = r_max_x;
+    if (box[3] > r_max_y) box[3] = r_max_y;
+  }
+
+  if (inside) *inside = count_inside;
+  if (estimate) *estimate = (I64)(count_estimate + 0.5);
+  if (intersecting) *intersecting = count_intersecting;
+  if (bounding_box) memcpy(bounding_box, box, sizeof(F64)*4);
+  return (count_intersecting > 0);
+}
+
+U32 LASindex::get_number_cells() const
+{
+  return interval->get_number_cells();
+}
+
+U32 LASindex::get_cell_counts(F32* bounding_boxes, U32* counts)
+{
+  U32 number = 0;
+  interval->get_cells();
+  while (interval->has_cells())
+  {
+    if (bounding_boxes) spatial->get_cell_bounding_box(interval->index, &bounding_boxes[4*number], &bounding_boxes[4*number+2]);
+    if (counts) counts[number] = interval->full;
+    number++;
+  }
+  return number;
+}
+
 BOOL LASindex::intersect_rectangle(const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y)
 {
   have_interval = FALSE;
+  read_ahead_cell = 0;
   cells = spatial->intersect_rectangle(r_min_x, r_min_y, r_max_x, r_max_y);
 //  fprintf(stderr,"%d cells of %g/%g %g/%g intersect rect %g/%g %g/%g\n", num_cells, spatial->get_min_x(), spatial->get_min_y(), spatial->get_max_x(), spatial->get_max_y(), r_min_x, r_min_y, r_max_x, r_max_y);
   if (cells)
@@ -253,6 +339,7 @@ BOOL LASindex::intersect_rectangle(const F64 r_min_x, const F64 r_min_y, const F
 BOOL LASindex::intersect_tile(const F32 ll_x, const F32 ll_y, const F32 size)
 {
   have_interval = FALSE;
+  read_ahead_cell = 0;
   cells = spatial->intersect_tile(ll_x, ll_y, size);
 //  fprintf(stderr,"%d cells of %g/%g %g/%g intersect tile %g/%g/%g\n", num_cells, spatial->get_min_x(), spatial->get_min_y(), spatial->get_max_x(), spatial->get_max_y(), ll_x, ll_y, size);
   if (cells)
@@ -263,6 +350,7 @@ BOOL LASindex::intersect_tile(const F32 ll_x, const F32 ll_y, const F32 size)
 BOOL LASindex::intersect_circle(const F64 center_x, const F64 center_y, const F64 radius)
 {
   have_interval = FALSE;
+  read_ahead_cell = 0;
   cells = spatial->intersect_circle(center_x, center_y, radius);
 //  fprintf(stderr,"%d cells of %g/%g %g/%g intersect circle %g/%g/%g\n", num_cells, spatial->get_min_x(), spatial->get_min_y(), spatial->get_max_x(), spatial->get_max_y(), center_x, center_y, radius);
   if (cells)
@@ -270,10 +358,98 @@ BOOL LASindex::intersect_circle(const F64 center_x, const F64 center_y, const F6
   return FALSE;
 }
 
+BOOL LASindex::intersect_rectangles(const U32 number, const F64* rectangles, LASindexIntervals* intervals) const
+{
+  return intersect_queries(number, rectangles, FALSE, intervals);
+}
+
+BOOL LASindex::intersect_circles(const U32 number, const F64* circles, LASindexIntervals* intervals) const
+{
+  return intersect_queries(number, circles, TRUE, intervals);
+}
+
+BOOL LASindex::intersect_queries(const U32 number, const F64* queries, const BOOL circles, LASindexIntervals* intervals) const
+{
+  intervals->init(number);
+  U32 threshold = interval->get_threshold();
+  U32 q, r, c;
+  for (q = 0; q < number; q++)
+  {
+    intervals->firsts[q] = intervals->number_intervals;
+    U32 found;
+    if (circles)
+    {
+      found = spatial->intersect_circle(queries[3*q], queries[3*q+1], queries[3*q+2], intervals->cells);
+    }
+    else
+    {
+      found = spatial->intersect_rectangle(queries[4*q], queries[4*q+1], queries[4*q+2], queries[4*q+3], intervals->cells);
+    }
+    if (found == 0) continue;
+    // collect the intervals of the cells that have points
+    U32 used_cells = 0;
+    const LASintervalStartCell* used_cell = 0;
+    intervals->number_sorted = 0;
+    for (r = 0; r < intervals->cells->number_intervals; r++)
+    {
+      for (c = intervals->cells->intervals[2*r]; c <= intervals->cells->intervals[2*r+1]; c++)
+      {
+        const LASintervalStartCell* cell = interval->find_cell(c);
+        if (cell == 0) continue;
+        const LASintervalCell* cell_interval = cell;
+        while (cell_interval)
+        {
+          intervals->add_sorted(cell_interval->start, cell_interval->end);
+          cell_interval = cell_interval->next;
+        }
+        used_cell = cell;
+        used_cells++;
+      }
+    }
+    if (used_cells == 1)
+    {
+      // like LASinterval::merge() the intervals of a single cell are used as they are
+      intervals->number_sorted = 0;
+      const LASintervalCell* cell_interval = used_cell;
+      while (cell_interval)
+      {
+        if (intervals->number_intervals == intervals->intervals_alloc)
+        {
+          intervals->intervals_alloc = (intervals->intervals_alloc ? 2*intervals->intervals_alloc : 256);
+          intervals->intervals = (U32*)realloc(intervals->intervals, sizeof(U32)*2*intervals->intervals_alloc);
+        }
+        intervals->intervals[2*intervals->number_intervals] = cell_interval->start;
+        intervals->intervals[2*intervals->number_intervals+1] = cell_interval->end;
+        intervals->number_intervals++;
+        cell_interval = cell_interval->next;
+      }
+    }
+    else if (used_cells)
+    {
+      intervals->merge_sorted(threshold, &intervals->intervals, &intervals->number_intervals, &intervals->intervals_alloc);
+    }
+  }
+  intervals->firsts[number] = intervals->number_intervals;
+  // the union of the intervals of all queries
+  intervals->number_sorted = 0;
+  for (q = 0; q < intervals->number_intervals; q++)
+  {
+    intervals->add_sorted(intervals->intervals[2*q], intervals->intervals[2*q+1]);
+  }
+  intervals->merge_sorted(threshold, &intervals->merged, &intervals->number_merged, &intervals->merged_alloc);
+  return (intervals->number_merged != 0);
+}
+
 BOOL LASindex::get_intervals()
 {
   have_interval = FALSE;
-  return interval->get_merged_cell();
+  read_ahead_cell = 0;
+  if (interval->get_merged_cell())
+  {
+    start_read_ahead();
+    return TRUE;
+  }
+  return FALSE;
 }
 
 BOOL LASindex::has_intervals()
@@ -290,6 +466,102 @@ BOOL LASindex::has_intervals()
   return FALSE;
 }
 
+BOOL LASindexIntervals::contains(const U32 q, const U32 p_index) const
+{
+  const U32* query_intervals = get_intervals(q);
+  U32 lo = 0;
+  U32 hi = get_number_intervals(q);
+  // find the first interval that ends at or after the point
+  while (lo < hi)
+  {
+    U32 mid = (lo + hi) / 2;
+    if (query_intervals[2*mid+1] < p_index) lo = mid + 1;
+    else hi = mid;
+  }
+  return ((lo < get_number_intervals(q)) && (query_intervals[2*lo] <= p_index));
+}
+
+void LASindexIntervals::init(const U32 number_queries)
+{
+  this->number_queries = number_queries;
+  if (firsts_alloc < number_queries + 1)
+  {
+    firsts_alloc = number_queries + 1;
+    firsts = (U32*)realloc(firsts, sizeof(U32)*firsts_alloc);
+  }
+  firsts[0] = 0;
+  number_intervals = 0;
+  number_merged = 0;
+  number_sorted = 0;
+}
+
+void LASindexIntervals::add_sorted(const U32 start, const U32 end)
+{
+  if (number_sorted == sorted_alloc)
+  {
+    sorted_alloc = (sorted_alloc ? 2*sorted_alloc : 256);
+    sorted = (U64*)realloc(sorted, sizeof(U64)*sorted_alloc);
+  }
+  sorted[number_sorted] = (((U64)start) << 32) | end;
+  number_sorted++;
+}
+
+// sorts the collected intervals and appends them with the gaps of up to threshold points
+// closed the same way as LASinterval::merge()
+U32 LASindexIntervals::merge_sorted(const U32 threshold, U32** intervals, U32* number, U32* alloc)
+{
+  if (number_sorted == 0) return 0;
+  sort(sorted, sorted + number_sorted);
+  U32 first = *number;
+  U32 s;
+  for (s = 0; s < number_sorted; s++)
+  {
+    U32 start = (U32)(sorted[s] >> 32);
+    U32 end = (U32)(sorted[s] & 0xFFFFFFFF);
+    if ((*number > first) && ((I32)(start - (*intervals)[2*(*number)-1]) <= (I32)threshold))
+    {
+      if ((I32)(end - (*intervals)[2*(*number)-1]) > 0) (*intervals)[2*(*number)-1] = end;
+      continue;
+    }
+    if (*number == *alloc)
+    {
+      *alloc = (*alloc ? 2*(*alloc) : 256);
+      *intervals = (U32*)realloc(*intervals, sizeof(U32)*2*(*alloc));
+    }
+    (*intervals)[2*(*number)] = start;
+    (*intervals)[2*(*number)+1] = end;
+    (*number)++;
+  }
+  number_sorted = 0;
+  return *number - first;
+}
+
+LASindexIntervals::LASindexIntervals()
+{
+  number_queries = 0;
+  firsts = 0;
+  number_intervals = 0;
+  intervals = 0;
+  number_merged = 0;
+  merged = 0;
+  firsts_alloc = 0;
+  intervals_alloc = 0;
+  merged_alloc = 0;
+  number_sorted = 0;
+  sorted_alloc = 0;
+  sorted = 0;
+  cells = new LASquadtreeCells();
+}
+
+LASindexIntervals::~LASindexIntervals()
+{
+  if (firsts) free(firsts);
+  if (intervals) free(intervals);
+  if (merged) free(merged);
+  if (sorted) free(sorted);
+  delete cells;
+}
+
 BOOL LASindex::read(FILE* file)
 {
   if (file == 0) return FALSE;
@@ -618,6 +890,22 @@ BOOL LASindex::write(ByteStreamOut* stream) const
 
 // seek to next interval point
 
+void LASindex::start_read_ahead()
+{
+  read_ahead_cell = interval->peek_intervals();
+  read_ahead_points = 0;
+}
+
+BOOL LASindex::next_read_ahead(U32* first, U32* last)
+{
+  if ((read_ahead_cell == 0) || (read_ahead_points >= LAS_INDEX_READ_AHEAD_POINTS)) return FALSE;
+  *first = read_ahead_cell->start;
+  *last = read_ahead_cell->end;
+  read_ahead_points += (read_ahead_cell->end - read_ahead_cell->start + 1);
+  read_ahead_cell = read_ahead_cell->next;
+  return TRUE;
+}
+
 #ifdef LASZIPDLL_EXPORTS
 BOOL LASindex::seek_next(LASreadPoint* reader, I64 &p_count)
 {
@@ -626,6 +914,16 @@ BOOL LASindex::seek_next(LASreadPoint* reader, I64 &p_count)
     if (!has_intervals()) return FALSE;
     reader->seek((U32)p_count, start);
     p_count = start;
+    // refill the hints once half of them were read
+    if (read_ahead_points < LAS_INDEX_READ_AHEAD_POINTS/2)
+    {
+      U32 first, last;
+      while (next_read_ahead(&first, &last))
+      {
+        if (!reader->read_ahead(first, last)) read_ahead_cell = 0;
+      }
+    }
+    read_ahead_points = (read_ahead_points > (end-start+1) ? read_ahead_points-(end-start+1) : 0);
   }
   if (p_count == end)
   {
@@ -640,6 +938,16 @@ BOOL LASindex::seek_next(LASreader* lasreader)
   {
     if (!has_intervals()) return FALSE;
     lasreader->seek(start);
+    // refill the hints once half of them were read
+    if (read_ahead_points < LAS_INDEX_READ_AHEAD_POINTS/2)
+    {
+      U32 first, last;
+      while (next_read_ahead(&first, &last))
+      {
+        if (!lasreader->read_ahead(first, last)) read_ahead_cell = 0;
+      }
+    }
+    read_ahead_points = (read_ahead_points > (end-start+1) ? read_ahead_points-(end-start+1) : 0);
   }
   if (lasreader->p_count == end)
   {
@@ -670,6 +978,7 @@ BOOL LASindex::merge_intervals()
       full = interval->full;
       total = interval->total;
       interval->clear_merge_cell_set();
+      if (r) start_read_ahead();
       return r;
     }
   }
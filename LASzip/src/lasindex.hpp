@@ -27,6 +27,9 @@
 
   CHANGE HISTORY:
 
+    19 October 2026 -- seek_next() hints the chunks of the next intervals to the reader
+    19 October 2026 -- stateless batch queries of rectangles or circles with merged intervals
+    19 October 2026 -- counting points of a rectangle or of every cell from the index alone
      7 September 2018 -- replaced calls to _strdup with calls to the LASCopyString macro
      7 January 2017 -- add read(FILE* file) for Trimble LASzip DLL improvement
      2 April 2015 -- add seek_next(LASreadPoint* reader, I64 &p_count) for DLL
@@ -44,7 +47,9 @@
 #include "mydefs.hpp"
 
 class LASquadtree;
+class LASquadtreeCells;
 class LASinterval;
+class LASintervalCell;
 #ifdef LASZIPDLL_EXPORTS
 class LASreadPoint;
 #else
@@ -53,6 +58,41 @@ class LASreader;
 class ByteStreamIn;
 class ByteStreamOut;
 
+// the point intervals of a batch of queries. every thread that queries the same LASindex
+// needs its own. the memory is kept from one batch to the next.
+class LASindexIntervals
+{
+public:
+  U32 number_queries;
+  U32* firsts;             // the first interval of each query with one more entry at the end
+  U32 number_intervals;
+  U32* intervals;          // the start and the end (inclusive) of every interval
+  U32 number_merged;
+  U32* merged;             // the intervals of all queries sorted and merged
+
+  inline U32 get_number_intervals(const U32 q) const { return firsts[q+1] - firsts[q]; };
+  inline const U32* get_intervals(const U32 q) const { return &intervals[2*firsts[q]]; };
+
+  // whether the point is in one of the intervals of the query
+  BOOL contains(const U32 q, const U32 p_index) const;
+
+  LASindexIntervals();
+  ~LASindexIntervals();
+
+private:
+  friend class LASindex;
+  void init(const U32 number_queries);
+  void add_sorted(const U32 start, const U32 end);
+  U32 merge_sorted(const U32 threshold, U32** intervals, U32* number, U32* alloc);
+  U32 firsts_alloc;
+  U32 intervals_alloc;
+  U32 merged_alloc;
+  U32 number_sorted;
+  U32 sorted_alloc;
+  U64* sorted;
+  LASquadtreeCells* cells;
+};
+
 class LASindex
 {
 public:
@@ -78,6 +118,24 @@ public:
   BOOL intersect_tile(const F32 ll_x, const F32 ll_y, const F32 size);
   BOOL intersect_circle(const F64 center_x, const F64 center_y, const F64 radius);
 
+  // queries for a batch of rectangles (min_x, min_y, max_x, max_y) or circles (center_x,
+  // center_y, radius) that leave the index unchanged, so that several threads can query
+  // it at once. every query gets the same intervals as from intersect_*() above. where the
+  // intervals of different queries overlap they are merged into one, so that a reader can
+  // decode the points once and hand them to each query whose intervals contain them.
+  BOOL intersect_rectangles(const U32 number, const F64* rectangles, LASindexIntervals* intervals) const;
+  BOOL intersect_circles(const U32 number, const F64* circles, LASindexIntervals* intervals) const;
+
+  // point counts from the cells alone without touching the points. 'inside' counts the
+  // points of the cells completely inside the rectangle, 'intersecting' those of all cells
+  // overlapping it, and 'estimate' weighs every overlapping cell by the part of its area
+  // inside. the optional bounding box is that of the overlapping cells cut to the rectangle.
+  BOOL count_rectangle(const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y, I64* inside, I64* estimate, I64* intersecting, F64* bounding_box=0);
+
+  // the bounding box (min_x, min_y, max_x, max_y) and the number of points of every cell
+  U32 get_number_cells() const;
+  U32 get_cell_counts(F32* bounding_boxes, U32* counts);
+
   // access the intersected intervals
   BOOL get_intervals();
   BOOL has_intervals();
@@ -104,10 +162,16 @@ public:
 
 private:
   BOOL merge_intervals();
+  BOOL intersect_queries(const U32 number, const F64* queries, const BOOL circles, LASindexIntervals* intervals) const;
+  void start_read_ahead();
+  BOOL next_read_ahead(U32* first, U32* last);
 
   LASquadtree* spatial;
   LASinterval* interval;
   BOOL have_interval;
+  // the first interval the reader was not yet told about and the points told about ahead
+  const LASintervalCell* read_ahead_cell;
+  U32 read_ahead_points;
 };
 
 #endif
@@ -368,6 +368,16 @@ BOOL LASinterval::get_cell(const I32 c_index)
   return TRUE;
 }
 
+const LASintervalStartCell* LASinterval::find_cell(const I32 c_index) const
+{
+  my_cell_hash::const_iterator hash_element = ((const my_cell_hash*)cells)->find(c_index);
+  if (hash_element == ((const my_cell_hash*)cells)->end())
+  {
+    return 0;
+  }
+  return (*hash_element).second;
+}
+
 BOOL LASinterval::add_current_cell_to_merge_cell_set()
 {
   if (current_cell == 0)
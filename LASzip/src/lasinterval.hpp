@@ -25,6 +25,8 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- peek_intervals() shows the intervals that are still ahead
+    19 October 2026 -- find_cell() for looking up cells from several threads at once
     20 October 2018 -- fixed rare bug in merge_intervals() when verbose is TRUE
     29 April 2011 -- created after cable outage during the royal wedding (-:
   
@@ -92,6 +94,12 @@ public:
   // get a particular cell
   BOOL get_cell(const I32 c_index);
 
+  // find a particular cell without changing the iteration state
+  const LASintervalStartCell* find_cell(const I32 c_index) const;
+
+  // intervals of merged cells with gaps up to this many points are joined
+  inline U32 get_threshold() const { return threshold; };
+
   // add cell's intervals to those that will be merged 
   BOOL add_current_cell_to_merge_cell_set();
   BOOL add_cell_to_merge_cell_set(const I32 c_index, const BOOL erase=FALSE);
@@ -102,6 +110,9 @@ public:
   // iterate intervals of current cell (or over merged intervals)
   BOOL has_intervals();
 
+  // the interval that has_intervals() returns next, linked to those after it
+  inline const LASintervalCell* peek_intervals() const { return current_cell; };
+
   I32 index;
   U32 start;
   U32 end;
@@ -37,10 +37,65 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include <vector>
-using namespace std;
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
 
-typedef vector<I32> my_cell_vector;
+// up to this many levels the borders of the cells are kept in tables
+#define LAS_QUADTREE_BORDER_LEVELS 16
+
+// the level index has the bits of the column at even and those of the row at odd positions
+static inline U32 interleave(U32 col, U32 row)
+{
+#if defined(__BMI2__)
+  return _pdep_u32(col, 0x55555555) | _pdep_u32(row, 0xAAAAAAAA);
+#else
+  col &= 0x0000FFFF;
+  col = (col | (col << 8)) & 0x00FF00FF;
+  col = (col | (col << 4)) & 0x0F0F0F0F;
+  col = (col | (col << 2)) & 0x33333333;
+  col = (col | (col << 1)) & 0x55555555;
+  row &= 0x0000FFFF;
+  row = (row | (row << 8)) & 0x00FF00FF;
+  row = (row | (row << 4)) & 0x0F0F0F0F;
+  row = (row | (row << 2)) & 0x33333333;
+  row = (row | (row << 1)) & 0x55555555;
+  return col | (row << 1);
+#endif
+}
+
+// the column of a level index (or its row when shifted down by one)
+static inline U32 deinterleave(U32 level_index)
+{
+#if defined(__BMI2__)
+  return _pext_u32(level_index, 0x55555555);
+#else
+  level_index &= 0x55555555;
+  level_index = (level_index | (level_index >> 1)) & 0x33333333;
+  level_index = (level_index | (level_index >> 2)) & 0x0F0F0F0F;
+  level_index = (level_index | (level_index >> 4)) & 0x00FF00FF;
+  level_index = (level_index | (level_index >> 8)) & 0x0000FFFF;
+  return level_index;
+#endif
+}
+
+// the cell among the n that the coordinate falls into. the guess from the scale is off
+// by at most one unless rounding made cells collapse, which the comparisons correct.
+static inline U32 get_border_guess(const F32* borders, const U32 n, const F64 scale, const F64 coordinate)
+{
+  F64 guess = (coordinate - borders[0])*scale;
+  if (!(guess < n)) return n - 1; // also NaN, which is never strictly less
+  if (guess < 0) return 0;
+  return (U32)guess;
+}
+
+static inline U32 get_border_index(const F32* borders, const U32 n, const F64 scale, const F64 coordinate)
+{
+  U32 i = get_border_guess(borders, n, scale, coordinate);
+  while (i && (coordinate < borders[i])) i--;
+  while ((i < n - 1) && !(coordinate < borders[i+1])) i++;
+  return i;
+}
 
 /*
 
@@ -104,48 +159,7 @@ static bool intersect_point(LAScell* cell, const float* p_pos)
 // returns the bounding box of the cell that x & y fall into at the specified level
 void LASquadtree::get_cell_bounding_box(const F64 x, const F64 y, U32 level, F32* min, F32* max) const
 {
-  volatile float cell_mid_x;
-  volatile float cell_mid_y;
-  float cell_min_x, cell_max_x;
-  float cell_min_y, cell_max_y;
-  
-  cell_min_x = min_x;
-  cell_max_x = max_x;
-  cell_min_y = min_y;
-  cell_max_y = max_y;
-
-  while (level)
-  {
-    cell_mid_x = (cell_min_x + cell_max_x)/2;
-    cell_mid_y = (cell_min_y + cell_max_y)/2;
-    if (x < cell_mid_x)
-    {
-      cell_max_x = cell_mid_x;
-    }
-    else
-    {
-      cell_min_x = cell_mid_x;
-    }
-    if (y < cell_mid_y)
-    {
-      cell_max_y = cell_mid_y;
-    }
-    else
-    {
-      cell_min_y = cell_mid_y;
-    }
-    level--;
-  }
-  if (min)
-  {
-    min[0] = cell_min_x;
-    min[1] = cell_min_y;
-  }
-  if (max)
-  {
-    max[0] = cell_max_x;
-    max[1] = cell_max_y;
-  }
+  get_level_index(x, y, level, min, max);
 }
 
 // returns the bounding box of the cell that x & y fall into
@@ -157,6 +171,25 @@ void LASquadtree::get_cell_bounding_box(const F64 x, const F64 y, F32* min, F32*
 // returns the bounding box of the cell with the specified level_index at the specified level
 void LASquadtree::get_cell_bounding_box(U32 level_index, U32 level, F32* min, F32* max) const
 {
+  if (borders_x && (level <= levels))
+  {
+    U32 shift = levels - level;
+    if (level < 16) level_index &= ((1u << (2*level)) - 1);
+    U32 col = deinterleave(level_index);
+    U32 row = deinterleave(level_index >> 1);
+    if (min)
+    {
+      min[0] = borders_x[col << shift];
+      min[1] = borders_y[row << shift];
+    }
+    if (max)
+    {
+      max[0] = borders_x[(col+1) << shift];
+      max[1] = borders_y[(row+1) << shift];
+    }
+    return;
+  }
+
   volatile F32 cell_mid_x;
   volatile F32 cell_mid_y;
   F32 cell_min_x, cell_max_x;
@@ -275,6 +308,13 @@ void LASquadtree::get_cell_bounding_box(const I32 cell_index, F32* min, F32* max
 // returns the (sub-)level index of the cell that x & y fall into at the specified level
 U32 LASquadtree::get_level_index(const F64 x, const F64 y, U32 level) const
 {
+  if (borders_x && (level <= levels))
+  {
+    U32 n = (1 << levels);
+    U32 shift = levels - level;
+    return interleave(get_border_index(borders_x, n, borders_scale_x, x) >> shift, get_border_index(borders_y, n, borders_scale_y, y) >> shift);
+  }
+
   volatile float cell_mid_x;
   volatile float cell_mid_y;
   float cell_min_x, cell_max_x;
@@ -327,6 +367,25 @@ U32 LASquadtree::get_level_index(const F64 x, const F64 y) const
 // returns the (sub-)level index and the bounding box of the cell that x & y fall into at the specified level
 U32 LASquadtree::get_level_index(const F64 x, const F64 y, U32 level, F32* min, F32* max) const
 {
+  if (borders_x && (level <= levels))
+  {
+    U32 n = (1 << levels);
+    U32 shift = levels - level;
+    U32 col = get_border_index(borders_x, n, borders_scale_x, x) >> shift;
+    U32 row = get_border_index(borders_y, n, borders_scale_y, y) >> shift;
+    if (min)
+    {
+      min[0] = borders_x[col << shift];
+      min[1] = borders_y[row << shift];
+    }
+    if (max)
+    {
+      max[0] = borders_x[(col+1) << shift];
+      max[1] = borders_y[(row+1) << shift];
+    }
+    return interleave(col, row);
+  }
+
   volatile float cell_mid_x;
   volatile float cell_mid_y;
   float cell_min_x, cell_max_x;
@@ -665,6 +724,7 @@ BOOL LASquadtree::read(ByteStreamIn* stream)
     fprintf(stderr,"ERROR (LASquadtree): reading max_y\n");
     return FALSE;
   }
+  setup_borders();
   return TRUE;
 }
 
@@ -791,30 +851,29 @@ BOOL LASquadtree::inside(const F64 x, const F64 y) const
 
 U32 LASquadtree::intersect_rectangle(const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y, U32 level)
 {
-  if (current_cells == 0)
-  {
-    current_cells = (void*) new my_cell_vector;
-  }
-  else
-  {
-    ((my_cell_vector*)current_cells)->clear();
-  }
+  return intersect_rectangle(r_min_x, r_min_y, r_max_x, r_max_y, level, &current_cells);
+}
+
+U32 LASquadtree::intersect_rectangle(const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y, LASquadtreeCells* cells) const
+{
+  return intersect_rectangle(r_min_x, r_min_y, r_max_x, r_max_y, levels, cells);
+}
+
+U32 LASquadtree::intersect_rectangle(const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y, U32 level, LASquadtreeCells* cells) const
+{
+  cells->number_intervals = 0;
 
   if (r_max_x <= min_x || !(r_min_x <= max_x) || r_max_y <= min_y || !(r_min_y <= max_y))
   {
     return 0;
   }
 
-  if (adaptive)
-  {
-    intersect_rectangle_with_cells_adaptive(r_min_x, r_min_y, r_max_x, r_max_y, min_x, max_x, min_y, max_y, 0, 0);
-  }
-  else
-  {
-    intersect_rectangle_with_cells(r_min_x, r_min_y, r_max_x, r_max_y, min_x, max_x, min_y, max_y, level, 0);
-  }
+  if (adaptive) level = levels;
 
-  return (U32)(((my_cell_vector*)current_cells)->size());
+  U32 first_col, last_col, first_row, last_row;
+  get_intersected_range(r_min_x, r_max_x, min_x, max_x, borders_x, borders_scale_x, level, &first_col, &last_col);
+  get_intersected_range(r_min_y, r_max_y, min_y, max_y, borders_y, borders_scale_y, level, &first_row, &last_row);
+  return intersect_cells(first_col, last_col, first_row, last_row, level, 0, cells);
 }
 
 U32 LASquadtree::intersect_rectangle(const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y)
@@ -824,14 +883,17 @@ U32 LASquadtree::intersect_rectangle(const F64 r_min_x, const F64 r_min_y, const
 
 U32 LASquadtree::intersect_tile(const F32 ll_x, const F32 ll_y, const F32 size, U32 level)
 {
-  if (current_cells == 0)
-  {
-    current_cells = (void*) new my_cell_vector;
-  }
-  else
-  {
-    ((my_cell_vector*)current_cells)->clear();
-  }
+  return intersect_tile(ll_x, ll_y, size, level, &current_cells);
+}
+
+U32 LASquadtree::intersect_tile(const F32 ll_x, const F32 ll_y, const F32 size, LASquadtreeCells* cells) const
+{
+  return intersect_tile(ll_x, ll_y, size, levels, cells);
+}
+
+U32 LASquadtree::intersect_tile(const F32 ll_x, const F32 ll_y, const F32 size, U32 level, LASquadtreeCells* cells) const
+{
+  cells->number_intervals = 0;
 
   volatile F32 ur_x = ll_x + size;
   volatile F32 ur_y = ll_y + size;
@@ -841,16 +903,12 @@ U32 LASquadtree::intersect_tile(const F32 ll_x, const F32 ll_y, const F32 size,
     return 0;
   }
 
-  if (adaptive)
-  {
-    intersect_tile_with_cells_adaptive(ll_x, ll_y, ur_x, ur_y, min_x, max_x, min_y, max_y, 0, 0);
-  }
-  else
-  {
-    intersect_tile_with_cells(ll_x, ll_y, ur_x, ur_y, min_x, max_x, min_y, max_y, level, 0);
-  }
+  if (adaptive) level = levels;
 
-  return (U32)(((my_cell_vector*)current_cells)->size());
+  U32 first_col, last_col, first_row, last_row;
+  get_intersected_range(ll_x, ur_x, min_x, max_x, borders_x, borders_scale_x, level, &first_col, &last_col);
+  get_intersected_range(ll_y, ur_y, min_y, max_y, borders_y, borders_scale_y, level, &first_row, &last_row);
+  return intersect_cells(first_col, last_col, first_row, last_row, level, 0, cells);
 }
 
 U32 LASquadtree::intersect_tile(const F32 ll_x, const F32 ll_y, const F32 size)
@@ -860,14 +918,17 @@ U32 LASquadtree::intersect_tile(const F32 ll_x, const F32 ll_y, const F32 size)
 
 U32 LASquadtree::intersect_circle(const F64 center_x, const F64 center_y, const F64 radius, U32 level)
 {
-  if (current_cells == 0)
-  {
-    current_cells = (void*) new my_cell_vector;
-  }
-  else
-  {
-    ((my_cell_vector*)current_cells)->clear();
-  }
+  return intersect_circle(center_x, center_y, radius, level, &current_cells);
+}
+
+U32 LASquadtree::intersect_circle(const F64 center_x, const F64 center_y, const F64 radius, LASquadtreeCells* cells) const
+{
+  return intersect_circle(center_x, center_y, radius, levels, cells);
+}
+
+U32 LASquadtree::intersect_circle(const F64 center_x, const F64 center_y, const F64 radius, U32 level, LASquadtreeCells* cells) const
+{
+  cells->number_intervals = 0;
 
   F64 r_min_x = center_x - radius; 
   F64 r_min_y = center_y - radius; 
@@ -879,16 +940,16 @@ U32 LASquadtree::intersect_circle(const F64 center_x, const F64 center_y, const
     return 0;
   }
 
-  if (adaptive)
-  {
-    intersect_circle_with_cells_adaptive(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, min_x, max_x, min_y, max_y, 0, 0);
-  }
-  else
-  {
-    intersect_circle_with_cells(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, min_x, max_x, min_y, max_y, level, 0);
-  }
+  if (adaptive) level = levels;
 
-  return (U32)(((my_cell_vector*)current_cells)->size());
+  U32 first_col, last_col, first_row, last_row;
+  get_intersected_range(r_min_x, r_max_x, min_x, max_x, borders_x, borders_scale_x, level, &first_col, &last_col);
+  get_intersected_range(r_min_y, r_max_y, min_y, max_y, borders_y, borders_scale_y, level, &first_row, &last_row);
+  F64 circle[3];
+  circle[0] = center_x;
+  circle[1] = center_y;
+  circle[2] = radius;
+  return intersect_cells(first_col, last_col, first_row, last_row, level, circle, cells);
 }
 
 U32 LASquadtree::intersect_circle(const F64 center_x, const F64 center_y, const F64 radius)
@@ -896,520 +957,170 @@ U32 LASquadtree::intersect_circle(const F64 center_x, const F64 center_y, const
   return intersect_circle(center_x, center_y, radius, levels);
 }
 
-void LASquadtree::intersect_rectangle_with_cells(const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y, const F32 cell_min_x, const F32 cell_max_x, const F32 cell_min_y, const F32 cell_max_y, U32 level, U32 level_index)
+// the first and the last of the columns (or rows) at the specified level that halving the cells
+// would descend into. the cells that are left of the midpoint are visited unless r_min is not
+// strictly less (and r_max is larger) and those right of it only when r_max is larger. as the
+// midpoints increase all columns in between are visited.
+void LASquadtree::get_intersected_range(const F64 r_min, const F64 r_max, const F32 cell_min, const F32 cell_max, const F32* borders, const F64 scale, U32 level, U32* first, U32* last) const
 {
-  volatile float cell_mid_x;
-  volatile float cell_mid_y;
-  if (level)
+  if (borders && (level <= levels))
+  {
+    U32 n = (1 << levels);
+    U32 shift = levels - level;
+    U32 i = get_border_guess(borders, n, scale, r_max);
+    while (i && !(r_max > borders[i])) i--;
+    while ((i < n - 1) && (r_max > borders[i+1])) i++;
+    *last = (i >> shift);
+    i = get_border_guess(borders, n, scale, r_min);
+    while ((i < n - 1) && !((r_max <= borders[i+1]) || (r_min < borders[i+1]))) i++;
+    while (i && ((r_max <= borders[i]) || (r_min < borders[i]))) i--;
+    *first = (i >> shift);
+    return;
+  }
+
+  volatile F32 cell_mid;
+  F32 first_min = cell_min;
+  F32 first_max = cell_max;
+  F32 last_min = cell_min;
+  F32 last_max = cell_max;
+  *first = 0;
+  *last = 0;
+  while (level)
   {
-    level--;
-    level_index <<= 2;
-
-    cell_mid_x = (cell_min_x + cell_max_x)/2;
-    cell_mid_y = (cell_min_y + cell_max_y)/2;
-
-    if (r_max_x <= cell_mid_x)
-    {
-      // cell_max_x = cell_mid_x;
-      if (r_max_y <= cell_mid_y)
-      {
-        // cell_max_y = cell_mid_y;
-        intersect_rectangle_with_cells(r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-      }
-      else if (!(r_min_y < cell_mid_y))
-      {
-        // cell_min_y = cell_mid_y;
-        // level_index |= 1;
-        intersect_rectangle_with_cells(r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-      }
-      else
-      {
-        intersect_rectangle_with_cells(r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-        intersect_rectangle_with_cells(r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-      }
-    }
-    else if (!(r_min_x < cell_mid_x))
+    (*first) <<= 1;
+    cell_mid = (first_min + first_max)/2;
+    if ((r_max <= cell_mid) || (r_min < cell_mid))
     {
-      // cell_min_x = cell_mid_x;
-      // level_index |= 1;
-      if (r_max_y <= cell_mid_y)
-      {
-        // cell_max_y = cell_mid_y;
-        intersect_rectangle_with_cells(r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-      }
-      else if (!(r_min_y < cell_mid_y))
-      {
-        // cell_min_y = cell_mid_y;
-        // level_index |= 1;
-        intersect_rectangle_with_cells(r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
-      }
-      else
-      {
-        intersect_rectangle_with_cells(r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-        intersect_rectangle_with_cells(r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
-      }
+      first_max = cell_mid;
     }
     else
     {
-      if (r_max_y <= cell_mid_y)
-      {
-        // cell_max_y = cell_mid_y;
-        intersect_rectangle_with_cells(r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-        intersect_rectangle_with_cells(r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-      }
-      else if (!(r_min_y < cell_mid_y))
-      {
-        // cell_min_y = cell_mid_y;
-        // level_index |= 1;
-        intersect_rectangle_with_cells(r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-        intersect_rectangle_with_cells(r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
-      }
-      else
-      {
-        intersect_rectangle_with_cells(r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-        intersect_rectangle_with_cells(r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-        intersect_rectangle_with_cells(r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-        intersect_rectangle_with_cells(r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
-      }
-    }
-  }
-  else
-  {
-    ((my_cell_vector*)current_cells)->push_back(level_index);
-  }
-}
-
-void LASquadtree::intersect_rectangle_with_cells_adaptive(const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y, const F32 cell_min_x, const F32 cell_max_x, const F32 cell_min_y, const F32 cell_max_y, U32 level, U32 level_index)
-{
-  volatile float cell_mid_x;
-  volatile float cell_mid_y;
-  U32 cell_index = get_cell_index(level_index, level);
-  U32 adaptive_pos = cell_index/32;
-  U32 adaptive_bit = ((U32)1) << (cell_index%32);
-  if ((level < levels) && (adaptive[adaptive_pos] & adaptive_bit))
-  {
-    level++;
-    level_index <<= 2;
-
-    cell_mid_x = (cell_min_x + cell_max_x)/2;
-    cell_mid_y = (cell_min_y + cell_max_y)/2;
-
-    if (r_max_x <= cell_mid_x)
-    {
-      // cell_max_x = cell_mid_x;
-      if (r_max_y <= cell_mid_y)
-      {
-        // cell_max_y = cell_mid_y;
-        intersect_rectangle_with_cells_adaptive(r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-      }
-      else if (!(r_min_y < cell_mid_y))
-      {
-        // cell_min_y = cell_mid_y;
-        // level_index |= 1;
-        intersect_rectangle_with_cells_adaptive(r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-      }
-      else
-      {
-        intersect_rectangle_with_cells_adaptive(r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-        intersect_rectangle_with_cells_adaptive(r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-      }
+      first_min = cell_mid;
+      (*first) |= 1;
     }
-    else if (!(r_min_x < cell_mid_x))
+    (*last) <<= 1;
+    cell_mid = (last_min + last_max)/2;
+    if (r_max <= cell_mid)
     {
-      // cell_min_x = cell_mid_x;
-      // level_index |= 1;
-      if (r_max_y <= cell_mid_y)
-      {
-        // cell_max_y = cell_mid_y;
-        intersect_rectangle_with_cells_adaptive(r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-      }
-      else if (!(r_min_y < cell_mid_y))
-      {
-        // cell_min_y = cell_mid_y;
-        // level_index |= 1;
-        intersect_rectangle_with_cells_adaptive(r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
-      }
-      else
-      {
-        intersect_rectangle_with_cells_adaptive(r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-        intersect_rectangle_with_cells_adaptive(r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
-      }
+      last_max = cell_mid;
     }
     else
     {
-      if (r_max_y <= cell_mid_y)
-      {
-        // cell_max_y = cell_mid_y;
-        intersect_rectangle_with_cells_adaptive(r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-        intersect_rectangle_with_cells_adaptive(r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-      }
-      else if (!(r_min_y < cell_mid_y))
-      {
-        // cell_min_y = cell_mid_y;
-        // level_index |= 1;
-        intersect_rectangle_with_cells_adaptive(r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-        intersect_rectangle_with_cells_adaptive(r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
-      }
-      else
-      {
-        intersect_rectangle_with_cells_adaptive(r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-        intersect_rectangle_with_cells_adaptive(r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-        intersect_rectangle_with_cells_adaptive(r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-        intersect_rectangle_with_cells_adaptive(r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
-      }
+      last_min = cell_mid;
+      (*last) |= 1;
     }
-  }
-  else
-  {
-    ((my_cell_vector*)current_cells)->push_back(cell_index);
-  }
-}
-
-void LASquadtree::intersect_tile_with_cells(const F32 ll_x, const F32 ll_y, const F32 ur_x, const F32 ur_y, const F32 cell_min_x, const F32 cell_max_x, const F32 cell_min_y, const F32 cell_max_y, U32 level, U32 level_index)
-{
-  volatile float cell_mid_x;
-  volatile float cell_mid_y;
-  if (level)
-  {
     level--;
-    level_index <<= 2;
-
-    cell_mid_x = (cell_min_x + cell_max_x)/2;
-    cell_mid_y = (cell_min_y + cell_max_y)/2;
-
-    if (ur_x <= cell_mid_x)
-    {
-      // cell_max_x = cell_mid_x;
-      if (ur_y <= cell_mid_y)
-      {
-        // cell_max_y = cell_mid_y;
-        intersect_tile_with_cells(ll_x, ll_y, ur_x, ur_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-      }
-      else if (!(ll_y < cell_mid_y))
-      {
-        // cell_min_y = cell_mid_y;
-        // level_index |= 1;
-        intersect_tile_with_cells(ll_x, ll_y, ur_x, ur_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-      }
-      else
-      {
-        intersect_tile_with_cells(ll_x, ll_y, ur_x, ur_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-        intersect_tile_with_cells(ll_x, ll_y, ur_x, ur_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-      }
-    }
-    else if (!(ll_x < cell_mid_x))
-    {
-      // cell_min_x = cell_mid_x;
-      // level_index |= 1;
-      if (ur_y <= cell_mid_y)
-      {
-        // cell_max_y = cell_mid_y;
-        intersect_tile_with_cells(ll_x, ll_y, ur_x, ur_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-      }
-      else if (!(ll_y < cell_mid_y))
-      {
-        // cell_min_y = cell_mid_y;
-        // level_index |= 1;
-        intersect_tile_with_cells(ll_x, ll_y, ur_x, ur_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
-      }
-      else
-      {
-        intersect_tile_with_cells(ll_x, ll_y, ur_x, ur_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-        intersect_tile_with_cells(ll_x, ll_y, ur_x, ur_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
-      }
-    }
-    else
-    {
-      if (ur_y <= cell_mid_y)
-      {
-        // cell_max_y = cell_mid_y;
-        intersect_tile_with_cells(ll_x, ll_y, ur_x, ur_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-        intersect_tile_with_cells(ll_x, ll_y, ur_x, ur_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-      }
-      else if (!(ll_y < cell_mid_y))
-      {
-        // cell_min_y = cell_mid_y;
-        // level_index |= 1;
-        intersect_tile_with_cells(ll_x, ll_y, ur_x, ur_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-        intersect_tile_with_cells(ll_x, ll_y, ur_x, ur_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
-      }
-      else
-      {
-        intersect_tile_with_cells(ll_x, ll_y, ur_x, ur_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-        intersect_tile_with_cells(ll_x, ll_y, ur_x, ur_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-        intersect_tile_with_cells(ll_x, ll_y, ur_x, ur_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-        intersect_tile_with_cells(ll_x, ll_y, ur_x, ur_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
-      }
-    }
-  }
-  else
-  {
-    ((my_cell_vector*)current_cells)->push_back(level_index);
   }
 }
 
-void LASquadtree::intersect_tile_with_cells_adaptive(const F32 ll_x, const F32 ll_y, const F32 ur_x, const F32 ur_y, const F32 cell_min_x, const F32 cell_max_x, const F32 cell_min_y, const F32 cell_max_y, U32 level, U32 level_index)
+// visits the cells whose columns and rows overlap the ranges in the order of their level indices
+// with a stack instead of recursion. the cells at the specified level that are entirely inside
+// the ranges are added as one run. in the adaptive quadtree the cells that contain finer cells
+// are descended down to levels.
+U32 LASquadtree::intersect_cells(const U32 first_col, const U32 last_col, const U32 first_row, const U32 last_row, const U32 level, const F64* circle, LASquadtreeCells* cells) const
 {
-  volatile float cell_mid_x;
-  volatile float cell_mid_y;
-  U32 cell_index = get_cell_index(level_index, level);
-  U32 adaptive_pos = cell_index/32;
-  U32 adaptive_bit = ((U32)1) << (cell_index%32);
-  if ((level < levels) && (adaptive[adaptive_pos] & adaptive_bit))
-  {
-    level++;
-    level_index <<= 2;
-
-    cell_mid_x = (cell_min_x + cell_max_x)/2;
-    cell_mid_y = (cell_min_y + cell_max_y)/2;
-
-    if (ur_x <= cell_mid_x)
-    {
-      // cell_max_x = cell_mid_x;
-      if (ur_y <= cell_mid_y)
-      {
-        // cell_max_y = cell_mid_y;
-        intersect_tile_with_cells_adaptive(ll_x, ll_y, ur_x, ur_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-      }
-      else if (!(ll_y < cell_mid_y))
-      {
-        // cell_min_y = cell_mid_y;
-        // level_index |= 1;
-        intersect_tile_with_cells_adaptive(ll_x, ll_y, ur_x, ur_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-      }
-      else
-      {
-        intersect_tile_with_cells_adaptive(ll_x, ll_y, ur_x, ur_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-        intersect_tile_with_cells_adaptive(ll_x, ll_y, ur_x, ur_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-      }
-    }
-    else if (!(ll_x < cell_mid_x))
+  // the cells waiting to be visited as level, column, row, and level index. each one is replaced
+  // by at most four children so that no more than 3*23+1 are waiting at any time.
+  U32 stack[96][4];
+  U32 stack_size = 1;
+  stack[0][0] = 0;
+  stack[0][1] = 0;
+  stack[0][2] = 0;
+  stack[0][3] = 0;
+
+  U32 number = 0;
+  cells->number_intervals = 0;
+
+  while (stack_size)
+  {
+    stack_size--;
+    U32 cell_level = stack[stack_size][0];
+    U32 col = stack[stack_size][1];
+    U32 row = stack[stack_size][2];
+    U32 level_index = stack[stack_size][3];
+    BOOL leaf;
+    U32 cell_index = 0;
+    if (adaptive)
     {
-      // cell_min_x = cell_mid_x;
-      // level_index |= 1;
-      if (ur_y <= cell_mid_y)
-      {
-        // cell_max_y = cell_mid_y;
-        intersect_tile_with_cells_adaptive(ll_x, ll_y, ur_x, ur_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-      }
-      else if (!(ll_y < cell_mid_y))
-      {
-        // cell_min_y = cell_mid_y;
-        // level_index |= 1;
-        intersect_tile_with_cells_adaptive(ll_x, ll_y, ur_x, ur_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
-      }
-      else
-      {
-        intersect_tile_with_cells_adaptive(ll_x, ll_y, ur_x, ur_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-        intersect_tile_with_cells_adaptive(ll_x, ll_y, ur_x, ur_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
-      }
+      cell_index = get_cell_index(level_index, cell_level);
+      U32 adaptive_pos = cell_index/32;
+      U32 adaptive_bit = ((U32)1) << (cell_index%32);
+      leaf = !((cell_level < levels) && (adaptive_pos < adaptive_alloc) && (adaptive[adaptive_pos] & adaptive_bit));
     }
     else
     {
-      if (ur_y <= cell_mid_y)
-      {
-        // cell_max_y = cell_mid_y;
-        intersect_tile_with_cells_adaptive(ll_x, ll_y, ur_x, ur_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-        intersect_tile_with_cells_adaptive(ll_x, ll_y, ur_x, ur_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-      }
-      else if (!(ll_y < cell_mid_y))
-      {
-        // cell_min_y = cell_mid_y;
-        // level_index |= 1;
-        intersect_tile_with_cells_adaptive(ll_x, ll_y, ur_x, ur_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-        intersect_tile_with_cells_adaptive(ll_x, ll_y, ur_x, ur_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
-      }
-      else
-      {
-        intersect_tile_with_cells_adaptive(ll_x, ll_y, ur_x, ur_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-        intersect_tile_with_cells_adaptive(ll_x, ll_y, ur_x, ur_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-        intersect_tile_with_cells_adaptive(ll_x, ll_y, ur_x, ur_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-        intersect_tile_with_cells_adaptive(ll_x, ll_y, ur_x, ur_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
-      }
-    }
-  }
-  else
-  {
-    ((my_cell_vector*)current_cells)->push_back(cell_index);
-  }
-}
-
-void LASquadtree::intersect_circle_with_cells(const F64 center_x, const F64 center_y, const F64 radius, const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y, const F32 cell_min_x, const F32 cell_max_x, const F32 cell_min_y, const F32 cell_max_y, U32 level, U32 level_index)
-{
-  volatile float cell_mid_x;
-  volatile float cell_mid_y;
-  if (level)
-  {
-    level--;
-    level_index <<= 2;
-
-    cell_mid_x = (cell_min_x + cell_max_x)/2;
-    cell_mid_y = (cell_min_y + cell_max_y)/2;
-
-    if (r_max_x <= cell_mid_x)
-    {
-      // cell_max_x = cell_mid_x;
-      if (r_max_y <= cell_mid_y)
-      {
-        // cell_max_y = cell_mid_y;
-        intersect_circle_with_cells(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-      }
-      else if (!(r_min_y < cell_mid_y))
+      leaf = (cell_level == level);
+      if (!leaf && !circle)
       {
-        // cell_min_y = cell_mid_y;
-        // level_index |= 1;
-        intersect_circle_with_cells(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-      }
-      else
-      {
-        intersect_circle_with_cells(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-        intersect_circle_with_cells(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
+        U32 shift = level - cell_level;
+        if ((first_col <= (col << shift)) && (((col+1) << shift) - 1 <= last_col) && (first_row <= (row << shift)) && (((row+1) << shift) - 1 <= last_row))
+        {
+          U32 first = level_index << (2*shift);
+          U32 last = (U32)(((((U64)level_index)+1) << (2*shift)) - 1);
+          cells->add(level_offset[levels] + first, level_offset[levels] + last);
+          number += (last - first + 1);
+          continue;
+        }
       }
     }
-    else if (!(r_min_x < cell_mid_x))
+    if (leaf)
     {
-      // cell_min_x = cell_mid_x;
-      // level_index |= 1;
-      if (r_max_y <= cell_mid_y)
+      if (circle)
       {
-        // cell_max_y = cell_mid_y;
-        intersect_circle_with_cells(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
+        F32 min[2];
+        F32 max[2];
+        get_cell_bounding_box(level_index, cell_level, min, max);
+        if (!intersect_circle_with_rectangle(circle[0], circle[1], circle[2], min[0], max[0], min[1], max[1]))
+        {
+          continue;
+        }
       }
-      else if (!(r_min_y < cell_mid_y))
+      if (adaptive)
       {
-        // cell_min_y = cell_mid_y;
-        // level_index |= 1;
-        intersect_circle_with_cells(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
+        cells->add(cell_index, cell_index);
       }
       else
       {
-        intersect_circle_with_cells(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-        intersect_circle_with_cells(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
+        cells->add(level_offset[levels] + level_index, level_offset[levels] + level_index);
       }
+      number++;
     }
     else
     {
-      if (r_max_y <= cell_mid_y)
+      // push the children that overlap so that they are popped in the order of their level indices
+      cell_level++;
+      col = 2*col;
+      row = 2*row;
+      level_index = 4*level_index;
+      U32 shift = level - cell_level;
+      U32 mid_col = (col+1) << shift;
+      U32 mid_row = (row+1) << shift;
+      BOOL left = (first_col < mid_col);
+      BOOL right = (mid_col <= last_col);
+      BOOL lower = (first_row < mid_row);
+      BOOL upper = (mid_row <= last_row);
+      if (upper && right)
       {
-        // cell_max_y = cell_mid_y;
-        intersect_circle_with_cells(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-        intersect_circle_with_cells(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
+        stack[stack_size][0] = cell_level; stack[stack_size][1] = col+1; stack[stack_size][2] = row+1; stack[stack_size][3] = level_index + 3; stack_size++;
       }
-      else if (!(r_min_y < cell_mid_y))
+      if (upper && left)
       {
-        // cell_min_y = cell_mid_y;
-        // level_index |= 1;
-        intersect_circle_with_cells(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-        intersect_circle_with_cells(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
+        stack[stack_size][0] = cell_level; stack[stack_size][1] = col; stack[stack_size][2] = row+1; stack[stack_size][3] = level_index + 2; stack_size++;
       }
-      else
+      if (lower && right)
       {
-        intersect_circle_with_cells(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-        intersect_circle_with_cells(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-        intersect_circle_with_cells(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-        intersect_circle_with_cells(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
+        stack[stack_size][0] = cell_level; stack[stack_size][1] = col+1; stack[stack_size][2] = row; stack[stack_size][3] = level_index + 1; stack_size++;
       }
-    }
-  }
-  else
-  {
-    if (intersect_circle_with_rectangle(center_x, center_y, radius, cell_min_x, cell_max_x, cell_min_y, cell_max_y))
-    {
-      ((my_cell_vector*)current_cells)->push_back(level_index);
-    }
-  }
-}
-
-void LASquadtree::intersect_circle_with_cells_adaptive(const F64 center_x, const F64 center_y, const F64 radius, const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y, const F32 cell_min_x, const F32 cell_max_x, const F32 cell_min_y, const F32 cell_max_y, U32 level, U32 level_index)
-{
-  volatile float cell_mid_x;
-  volatile float cell_mid_y;
-  U32 cell_index = get_cell_index(level_index, level);
-  U32 adaptive_pos = cell_index/32;
-  U32 adaptive_bit = ((U32)1) << (cell_index%32);
-  if ((level < levels) && (adaptive[adaptive_pos] & adaptive_bit))
-  {
-    level++;
-    level_index <<= 2;
-
-    cell_mid_x = (cell_min_x + cell_max_x)/2;
-    cell_mid_y = (cell_min_y + cell_max_y)/2;
-
-    if (r_max_x <= cell_mid_x)
-    {
-      // cell_max_x = cell_mid_x;
-      if (r_max_y <= cell_mid_y)
-      {
-        // cell_max_y = cell_mid_y;
-        intersect_circle_with_cells_adaptive(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-      }
-      else if (!(r_min_y < cell_mid_y))
-      {
-        // cell_min_y = cell_mid_y;
-        // level_index |= 1;
-        intersect_circle_with_cells_adaptive(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-      }
-      else
-      {
-        intersect_circle_with_cells_adaptive(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-        intersect_circle_with_cells_adaptive(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-      }
-    }
-    else if (!(r_min_x < cell_mid_x))
-    {
-      // cell_min_x = cell_mid_x;
-      // level_index |= 1;
-      if (r_max_y <= cell_mid_y)
-      {
-        // cell_max_y = cell_mid_y;
-        intersect_circle_with_cells_adaptive(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-      }
-      else if (!(r_min_y < cell_mid_y))
-      {
-        // cell_min_y = cell_mid_y;
-        // level_index |= 1;
-        intersect_circle_with_cells_adaptive(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
-      }
-      else
+      if (lower && left)
       {
-        intersect_circle_with_cells_adaptive(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-        intersect_circle_with_cells_adaptive(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
+        stack[stack_size][0] = cell_level; stack[stack_size][1] = col; stack[stack_size][2] = row; stack[stack_size][3] = level_index + 0; stack_size++;
       }
     }
-    else
-    {
-      if (r_max_y <= cell_mid_y)
-      {
-        // cell_max_y = cell_mid_y;
-        intersect_circle_with_cells_adaptive(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-        intersect_circle_with_cells_adaptive(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-      }
-      else if (!(r_min_y < cell_mid_y))
-      {
-        // cell_min_y = cell_mid_y;
-        // level_index |= 1;
-        intersect_circle_with_cells_adaptive(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-        intersect_circle_with_cells_adaptive(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
-      }
-      else
-      {
-        intersect_circle_with_cells_adaptive(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_min_y, cell_mid_y, level, level_index);
-        intersect_circle_with_cells_adaptive(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_min_y, cell_mid_y, level, level_index | 1);
-        intersect_circle_with_cells_adaptive(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_min_x, cell_mid_x, cell_mid_y, cell_max_y, level, level_index | 2);
-        intersect_circle_with_cells_adaptive(center_x, center_y, radius, r_min_x, r_min_y, r_max_x, r_max_y, cell_mid_x, cell_max_x, cell_mid_y, cell_max_y, level, level_index | 3);
-      }
-    }
-  }
-  else
-  {
-    if (intersect_circle_with_rectangle(center_x, center_y, radius, cell_min_x, cell_max_x, cell_min_y, cell_max_y))
-    {
-      ((my_cell_vector*)current_cells)->push_back(cell_index);
-    }
   }
+  return number;
 }
 
-BOOL LASquadtree::intersect_circle_with_rectangle(const F64 center_x, const F64 center_y, const F64 radius, const F32 r_min_x, const F32 r_max_x, const F32 r_min_y, const F32 r_max_y)
+BOOL LASquadtree::intersect_circle_with_rectangle(const F64 center_x, const F64 center_y, const F64 radius, const F32 r_min_x, const F32 r_max_x, const F32 r_min_y, const F32 r_max_y) const
 {
   F64 r_diff_x, r_diff_y;
   F64 radius_squared = radius * radius;
@@ -1476,37 +1187,31 @@ BOOL LASquadtree::get_all_cells()
 
 BOOL LASquadtree::get_intersected_cells()
 {
-  next_cell_index = 0;
-  if (current_cells == 0)
-  {
-    return FALSE;
-  }
-  if (((my_cell_vector*)current_cells)->size() == 0)
+  next_cell_interval = 0;
+  if (current_cells.number_intervals == 0)
   {
     return FALSE;
   }
+  next_cell = current_cells.intervals[0];
   return TRUE;
 }
 
 BOOL LASquadtree::has_more_cells()
 {
-  if (current_cells == 0)
-  {
-    return FALSE;
-  }
-  if (next_cell_index >= ((my_cell_vector*)current_cells)->size())
+  if (next_cell_interval >= current_cells.number_intervals)
   {
     return FALSE;
   }
-  if (adaptive)
+  current_cell = next_cell;
+  if (next_cell == current_cells.intervals[2*next_cell_interval+1])
   {
-    current_cell = ((my_cell_vector*)current_cells)->at(next_cell_index);
+    next_cell_interval++;
+    if (next_cell_interval < current_cells.number_intervals) next_cell = current_cells.intervals[2*next_cell_interval];
   }
   else
   {
-    current_cell = level_offset[levels] + ((my_cell_vector*)current_cells)->at(next_cell_index);
+    next_cell++;
   }
-  next_cell_index++;
   return TRUE;
 }
 
@@ -1533,6 +1238,7 @@ BOOL LASquadtree::setup(F64 bb_min_x, F64 bb_max_x, F64 bb_min_y, F64 bb_max_y,
   if (cells_x == 0 || cells_y == 0)
   {
     fprintf(stderr, "ERROR: cells_x %d cells_y %d\n", cells_x, cells_y);
+    clean_borders();
     return FALSE;
   }
 
@@ -1558,6 +1264,7 @@ BOOL LASquadtree::setup(F64 bb_min_x, F64 bb_max_x, F64 bb_min_y, F64 bb_max_y,
   min_y -= (c2 * cell_size);
   max_y += (c1 * cell_size);
 
+  setup_borders();
   return TRUE;
 }
 
@@ -1584,6 +1291,7 @@ BOOL LASquadtree::setup(F64 bb_min_x, F64 bb_max_x, F64 bb_min_y, F64 bb_max_y,
   if (cells_x == 0 || cells_y == 0)
   {
     fprintf(stderr, "ERROR: cells_x %d cells_y %d\n", cells_x, cells_y);
+    clean_borders();
     return FALSE;
   }
 
@@ -1609,6 +1317,7 @@ BOOL LASquadtree::setup(F64 bb_min_x, F64 bb_max_x, F64 bb_min_y, F64 bb_max_y,
   min_y -= (c2 * cell_size);
   max_y += (c1 * cell_size);
 
+  setup_borders();
   return TRUE;
 }
 
@@ -1621,6 +1330,7 @@ BOOL LASquadtree::tiling_setup(F32 min_x, F32 max_x, F32 min_y, F32 max_y, U32 l
   this->levels = levels;
   this->sub_level = 0;
   this->sub_level_index = 0;
+  setup_borders();
   return TRUE;
 }
 
@@ -1630,6 +1340,7 @@ BOOL LASquadtree::subtiling_setup(F32 min_x, F32 max_x, F32 min_y, F32 max_y, U3
   this->max_x = max_x;
   this->min_y = min_y;
   this->max_y = max_y;
+  clean_borders();
   F32 min[2];
   F32 max[2];
   get_cell_bounding_box(sub_level_index, sub_level, min, max);
@@ -1640,9 +1351,50 @@ BOOL LASquadtree::subtiling_setup(F32 min_x, F32 max_x, F32 min_y, F32 max_y, U3
   this->sub_level = sub_level;
   this->sub_level_index = sub_level_index;
   this->levels = levels;
+  setup_borders();
   return TRUE;
 }
 
+// tabulates the borders of the cells at the deepest level. each one is the midpoint of its
+// neighbours at the next coarser level computed exactly as when halving the cells.
+void LASquadtree::setup_borders()
+{
+  clean_borders();
+  if (levels > LAS_QUADTREE_BORDER_LEVELS) return;
+  U32 n = (1 << levels);
+  borders_x = (F32*)malloc(sizeof(F32)*2*(n+1));
+  if (borders_x == 0) return;
+  borders_y = borders_x + (n+1);
+  borders_x[0] = min_x;
+  borders_x[n] = max_x;
+  borders_y[0] = min_y;
+  borders_y[n] = max_y;
+  volatile F32 cell_mid;
+  U32 i, step;
+  for (step = n/2; step; step = step/2)
+  {
+    for (i = step; i < n; i += 2*step)
+    {
+      cell_mid = (borders_x[i-step] + borders_x[i+step])/2;
+      borders_x[i] = cell_mid;
+      cell_mid = (borders_y[i-step] + borders_y[i+step])/2;
+      borders_y[i] = cell_mid;
+    }
+  }
+  borders_scale_x = (max_x > min_x ? n/((F64)max_x - (F64)min_x) : 0.0);
+  borders_scale_y = (max_y > min_y ? n/((F64)max_y - (F64)min_y) : 0.0);
+}
+
+void LASquadtree::clean_borders()
+{
+  if (borders_x)
+  {
+    free(borders_x);
+    borders_x = 0;
+    borders_y = 0;
+  }
+}
+
 LASquadtree::LASquadtree()
 {
   U32 l;
@@ -1661,13 +1413,57 @@ LASquadtree::LASquadtree()
   {
     level_offset[l+1] = level_offset[l] + ((1<<l)*(1<<l));
   }
-  current_cells = 0;
   adaptive_alloc = 0;
   adaptive = 0;
+  borders_x = 0;
+  borders_y = 0;
+  borders_scale_x = 0.0;
+  borders_scale_y = 0.0;
+  next_cell_interval = 0;
+  next_cell = 0;
 }
 
 LASquadtree::~LASquadtree()
 {
-  if (current_cells) delete ((my_cell_vector*)current_cells);
   if (adaptive) free(adaptive);
+  clean_borders();
+}
+
+U32 LASquadtreeCells::get_number_cells() const
+{
+  U32 number = 0;
+  for (U32 i = 0; i < number_intervals; i++)
+  {
+    number += (intervals[2*i+1] - intervals[2*i] + 1);
+  }
+  return number;
+}
+
+void LASquadtreeCells::add(const U32 first, const U32 last)
+{
+  if (number_intervals && (intervals[2*number_intervals-1] + 1 == first))
+  {
+    intervals[2*number_intervals-1] = last;
+    return;
+  }
+  if (number_intervals == intervals_alloc)
+  {
+    intervals_alloc = (intervals_alloc ? 2*intervals_alloc : 64);
+    intervals = (U32*)realloc(intervals, sizeof(U32)*2*intervals_alloc);
+  }
+  intervals[2*number_intervals] = first;
+  intervals[2*number_intervals+1] = last;
+  number_intervals++;
+}
+
+LASquadtreeCells::LASquadtreeCells()
+{
+  number_intervals = 0;
+  intervals_alloc = 0;
+  intervals = 0;
+}
+
+LASquadtreeCells::~LASquadtreeCells()
+{
+  if (intervals) free(intervals);
 }
@@ -26,6 +26,8 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- queries into caller-owned LASquadtreeCells that leave the quadtree unchanged
+    19 October 2026 -- O(1) cell lookup with border tables and Morton interleaving, queries without recursion
     31 March 2015 -- remove unused LASquadtree inheritance of abstract LASspatial 
     11 May 2011 -- moved into LASlib so that LASreader supports spatial indexing
     19 January 2011 -- created after mara met with silke to talk about africa
@@ -42,6 +44,21 @@ class ByteStreamOut;
 
 #define LAS_SPATIAL_QUAD_TREE 0
 
+// the cells of a query as sorted runs of consecutive cell indices. each caller with its own
+// can query the same quadtree at the same time.
+class LASquadtreeCells
+{
+public:
+  U32 number_intervals;
+  U32* intervals;          // the first and the last cell index of each run
+  U32 get_number_cells() const;
+  void add(const U32 first, const U32 last);
+  LASquadtreeCells();
+  ~LASquadtreeCells();
+private:
+  U32 intervals_alloc;
+};
+
 class LASquadtree
 {
 public:
@@ -77,6 +94,11 @@ public:
   U32 intersect_tile(const F32 ll_x, const F32 ll_y, const F32 size);
   U32 intersect_circle(const F64 center_x, const F64 center_y, const F64 radius);
 
+  // the same queries into cells of the caller. they leave the quadtree unchanged.
+  U32 intersect_rectangle(const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y, LASquadtreeCells* cells) const;
+  U32 intersect_tile(const F32 ll_x, const F32 ll_y, const F32 size, LASquadtreeCells* cells) const;
+  U32 intersect_circle(const F64 center_x, const F64 center_y, const F64 radius, LASquadtreeCells* cells) const;
+
   // iterate over cells
   BOOL get_all_cells();
   BOOL get_intersected_cells();
@@ -145,16 +167,22 @@ private:
   U32 adaptive_alloc;
   U32* adaptive;
 
-  void intersect_rectangle_with_cells(const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y, const F32 cell_min_x, const F32 cell_max_x, const F32 cell_min_y, const F32 cell_max_y, U32 level, U32 level_index);
-  void intersect_rectangle_with_cells_adaptive(const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y, const F32 cell_min_x, const F32 cell_max_x, const F32 cell_min_y, const F32 cell_max_y, U32 level, U32 level_index);
-  void intersect_tile_with_cells(const F32 ll_x, const F32 ll_y, const F32 ur_x, const F32 ur_y, const F32 cell_min_x, const F32 cell_max_x, const F32 cell_min_y, const F32 cell_max_y, U32 level, U32 level_index);
-  void intersect_tile_with_cells_adaptive(const F32 ll_x, const F32 ll_y, const F32 ur_x, const F32 ur_y, const F32 cell_min_x, const F32 cell_max_x, const F32 cell_min_y, const F32 cell_max_y, U32 level, U32 level_index);
-  void intersect_circle_with_cells(const F64 center_x, const F64 center_y, const F64 radius, const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y, const F32 cell_min_x, const F32 cell_max_x, const F32 cell_min_y, const F32 cell_max_y, U32 level, U32 level_index);
-  void intersect_circle_with_cells_adaptive(const F64 center_x, const F64 center_y, const F64 radius, const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y, const F32 cell_min_x, const F32 cell_max_x, const F32 cell_min_y, const F32 cell_max_y, U32 level, U32 level_index);
-  BOOL intersect_circle_with_rectangle(const F64 center_x, const F64 center_y, const F64 radius, const F32 r_min_x, const F32 r_max_x, const F32 r_min_y, const F32 r_max_y);
+  F32* borders_x;          // of the cells at the deepest level with the same floating-point
+  F32* borders_y;          // midpoints as when halving, so cell indices match existing *.lax
+  F64 borders_scale_x;
+  F64 borders_scale_y;
+  void setup_borders();
+  void clean_borders();
+  void get_intersected_range(const F64 r_min, const F64 r_max, const F32 cell_min, const F32 cell_max, const F32* borders, const F64 scale, U32 level, U32* first, U32* last) const;
+  U32 intersect_rectangle(const F64 r_min_x, const F64 r_min_y, const F64 r_max_x, const F64 r_max_y, U32 level, LASquadtreeCells* cells) const;
+  U32 intersect_tile(const F32 ll_x, const F32 ll_y, const F32 size, U32 level, LASquadtreeCells* cells) const;
+  U32 intersect_circle(const F64 center_x, const F64 center_y, const F64 radius, U32 level, LASquadtreeCells* cells) const;
+  U32 intersect_cells(const U32 first_col, const U32 last_col, const U32 first_row, const U32 last_row, const U32 level, const F64* circle, LASquadtreeCells* cells) const;
+  BOOL intersect_circle_with_rectangle(const F64 center_x, const F64 center_y, const F64 radius, const F32 r_min_x, const F32 r_max_x, const F32 r_min_y, const F32 r_max_y) const;
   void raster_occupancy(BOOL(*does_cell_exist)(I32), U32* data, U32 min_x, U32 min_y, U32 level_index, U32 level, U32 stop_level) const;
-  void* current_cells;
-  U32 next_cell_index;
+  LASquadtreeCells current_cells;
+  U32 next_cell_interval;
+  U32 next_cell;
 };
 
 #endif
@@ -42,6 +42,92 @@
 #include <stdlib.h>
 #include <string.h>
 
+// the item sequences of the common point types. with these the compiler sees the concrete
+// reader classes and can call (and for raw items inline) their read() without the vtable.
+
+#define LAS_READ_POINT_PIPELINE_GENERIC                0
+#define LAS_READ_POINT_PIPELINE_RAW_POINT10            1
+#define LAS_READ_POINT_PIPELINE_RAW_POINT10_GPS        2
+#define LAS_READ_POINT_PIPELINE_RAW_POINT10_GPS_RGB    3
+#define LAS_READ_POINT_PIPELINE_RAW_POINT14            4
+#define LAS_READ_POINT_PIPELINE_RAW_POINT14_RGB        5
+#define LAS_READ_POINT_PIPELINE_RAW_POINT14_RGBNIR     6
+#define LAS_READ_POINT_PIPELINE_V2_POINT10            11
+#define LAS_READ_POINT_PIPELINE_V2_POINT10_GPS        12
+#define LAS_READ_POINT_PIPELINE_V2_POINT10_GPS_RGB    13
+#define LAS_READ_POINT_PIPELINE_V3_POINT14            21
+#define LAS_READ_POINT_PIPELINE_V3_POINT14_RGB        22
+#define LAS_READ_POINT_PIPELINE_V3_POINT14_RGBNIR     23
+#define LAS_READ_POINT_PIPELINE_V4_POINT14            31
+#define LAS_READ_POINT_PIPELINE_V4_POINT14_RGB        32
+#define LAS_READ_POINT_PIPELINE_V4_POINT14_RGBNIR     33
+
+template<class Item>
+static inline void read_items(LASreadItem** readers, U8* const * point, U32& context)
+{
+  ((Item*)readers[0])->Item::read(point[0], context);
+}
+
+template<class Item, class Next, class... Rest>
+static inline void read_items(LASreadItem** readers, U8* const * point, U32& context)
+{
+  ((Item*)readers[0])->Item::read(point[0], context);
+  read_items<Next, Rest...>(readers + 1, point + 1, context);
+}
+
+static inline BOOL read_pipeline(const U32 pipeline, LASreadItem** readers, U8* const * point, U32& context)
+{
+  switch (pipeline)
+  {
+  case LAS_READ_POINT_PIPELINE_RAW_POINT10:
+    read_items<LASreadItemRaw_POINT10_LE>(readers, point, context);
+    return TRUE;
+  case LAS_READ_POINT_PIPELINE_RAW_POINT10_GPS:
+    read_items<LASreadItemRaw_POINT10_LE, LASreadItemRaw_GPSTIME11_LE>(readers, point, context);
+    return TRUE;
+  case LAS_READ_POINT_PIPELINE_RAW_POINT10_GPS_RGB:
+    read_items<LASreadItemRaw_POINT10_LE, LASreadItemRaw_GPSTIME11_LE, LASreadItemRaw_RGB12_LE>(readers, point, context);
+    return TRUE;
+  case LAS_READ_POINT_PIPELINE_RAW_POINT14:
+    read_items<LASreadItemRaw_POINT14_LE>(readers, point, context);
+    return TRUE;
+  case LAS_READ_POINT_PIPELINE_RAW_POINT14_RGB:
+    read_items<LASreadItemRaw_POINT14_LE, LASreadItemRaw_RGB12_LE>(readers, point, context);
+    return TRUE;
+  case LAS_READ_POINT_PIPELINE_RAW_POINT14_RGBNIR:
+    read_items<LASreadItemRaw_POINT14_LE, LASreadItemRaw_RGBNIR14_LE>(readers, point, context);
+    return TRUE;
+  case LAS_READ_POINT_PIPELINE_V2_POINT10:
+    read_items<LASreadItemCompressed_POINT10_v2>(readers, point, context);
+    return TRUE;
+  case LAS_READ_POINT_PIPELINE_V2_POINT10_GPS:
+    read_items<LASreadItemCompressed_POINT10_v2, LASreadItemCompressed_GPSTIME11_v2>(readers, point, context);
+    return TRUE;
+  case LAS_READ_POINT_PIPELINE_V2_POINT10_GPS_RGB:
+    read_items<LASreadItemCompressed_POINT10_v2, LASreadItemCompressed_GPSTIME11_v2, LASreadItemCompressed_RGB12_v2>(readers, point, context);
+    return TRUE;
+  case LAS_READ_POINT_PIPELINE_V3_POINT14:
+    read_items<LASreadItemCompressed_POINT14_v3>(readers, point, context);
+    return TRUE;
+  case LAS_READ_POINT_PIPELINE_V3_POINT14_RGB:
+    read_items<LASreadItemCompressed_POINT14_v3, LASreadItemCompressed_RGB14_v3>(readers, point, context);
+    return TRUE;
+  case LAS_READ_POINT_PIPELINE_V3_POINT14_RGBNIR:
+    read_items<LASreadItemCompressed_POINT14_v3, LASreadItemCompressed_RGBNIR14_v3>(readers, point, context);
+    return TRUE;
+  case LAS_READ_POINT_PIPELINE_V4_POINT14:
+    read_items<LASreadItemCompressed_POINT14_v4>(readers, point, context);
+    return TRUE;
+  case LAS_READ_POINT_PIPELINE_V4_POINT14_RGB:
+    read_items<LASreadItemCompressed_POINT14_v4, LASreadItemCompressed_RGB14_v4>(readers, point, context);
+    return TRUE;
+  case LAS_READ_POINT_PIPELINE_V4_POINT14_RGBNIR:
+    read_items<LASreadItemCompressed_POINT14_v4, LASreadItemCompressed_RGBNIR14_v4>(readers, point, context);
+    return TRUE;
+  }
+  return FALSE;
+}
+
 LASreadPoint::LASreadPoint(U32 decompress_selective)
 {
   point_size = 0;
@@ -52,6 +138,7 @@ LASreadPoint::LASreadPoint(U32 decompress_selective)
   readers_compressed = 0;
   dec = 0;
   layered_las14_compression = FALSE;
+  pipeline = LAS_READ_POINT_PIPELINE_GENERIC;
   // used for chunking
   chunk_size = U32_MAX;
   chunk_count = 0;
@@ -65,6 +152,8 @@ LASreadPoint::LASreadPoint(U32 decompress_selective)
   // used for seeking
   point_start = 0;
   seek_point = 0;
+  read_ahead_start = 0;
+  read_ahead_end = 0;
   // used for error and warning reporting
   last_error = 0;
   last_warning = 0;
@@ -296,9 +385,62 @@ BOOL LASreadPoint::setup(U32 num_items, const LASitem* items, const LASzip* lasz
       number_chunks = U32_MAX;
     }
   }
+  select_pipeline(num_items, items);
   return TRUE;
 }
 
+void LASreadPoint::select_pipeline(const U32 num_items, const LASitem* items)
+{
+  pipeline = LAS_READ_POINT_PIPELINE_GENERIC;
+
+  if ((num_items == 0) || (num_items > 3))
+  {
+    return;
+  }
+
+  // the type of every item and the version shared by all items (or zero if raw)
+
+  U32 i;
+  U32 types[3] = { 0, 0, 0 };
+  U32 version = (dec ? items[0].version : 0);
+  for (i = 0; i < num_items; i++)
+  {
+    if (dec && (items[i].version != version)) return;
+    types[i] = items[i].type;
+  }
+  if ((dec == 0) && !IS_LITTLE_ENDIAN())
+  {
+    return;
+  }
+  if (dec && (version == 2) && (types[0] == LASitem::POINT14))
+  {
+    // version 2 of POINT14 from lasproto is decoded like version 3
+    version = 3;
+  }
+
+  if ((types[0] == LASitem::POINT10) && ((version == 0) || (version == 2)))
+  {
+    if (num_items == 1)
+      pipeline = LAS_READ_POINT_PIPELINE_RAW_POINT10;
+    else if ((num_items == 2) && (types[1] == LASitem::GPSTIME11))
+      pipeline = LAS_READ_POINT_PIPELINE_RAW_POINT10_GPS;
+    else if ((num_items == 3) && (types[1] == LASitem::GPSTIME11) && (types[2] == LASitem::RGB12))
+      pipeline = LAS_READ_POINT_PIPELINE_RAW_POINT10_GPS_RGB;
+    if (pipeline && (version == 2)) pipeline += (LAS_READ_POINT_PIPELINE_V2_POINT10 - LAS_READ_POINT_PIPELINE_RAW_POINT10);
+  }
+  else if ((types[0] == LASitem::POINT14) && ((version == 0) || (version == 3) || (version == 4)))
+  {
+    if (num_items == 1)
+      pipeline = LAS_READ_POINT_PIPELINE_RAW_POINT14;
+    else if ((num_items == 2) && (types[1] == LASitem::RGB14))
+      pipeline = LAS_READ_POINT_PIPELINE_RAW_POINT14_RGB;
+    else if ((num_items == 2) && (types[1] == LASitem::RGBNIR14))
+      pipeline = LAS_READ_POINT_PIPELINE_RAW_POINT14_RGBNIR;
+    if (pipeline && (version == 3)) pipeline += (LAS_READ_POINT_PIPELINE_V3_POINT14 - LAS_READ_POINT_PIPELINE_RAW_POINT14);
+    else if (pipeline && (version == 4)) pipeline += (LAS_READ_POINT_PIPELINE_V4_POINT14 - LAS_READ_POINT_PIPELINE_RAW_POINT14);
+  }
+}
+
 BOOL LASreadPoint::init(ByteStreamIn* instream)
 {
   if (!instream) return FALSE;
@@ -321,6 +463,8 @@ BOOL LASreadPoint::init(ByteStreamIn* instream)
     point_start = instream->tell();
     readers = readers_raw;
   }
+  read_ahead_start = 0;
+  read_ahead_end = 0;
 
   return TRUE;
 }
@@ -402,6 +546,50 @@ BOOL LASreadPoint::seek(const U32 current, const U32 target)
   return TRUE;
 }
 
+BOOL LASreadPoint::read_ahead(const U32 first, const U32 last)
+{
+  if (!instream->isSeekable() || (first > last)) return FALSE;
+  I64 start, end;
+  if (dec)
+  {
+    // only chunks whose start and end are in the chunk table
+    if (chunk_starts == 0) return FALSE;
+    U32 first_chunk, last_chunk;
+    if (chunk_totals)
+    {
+      first_chunk = search_chunk_table(first, 0, number_chunks);
+      last_chunk = search_chunk_table(last, 0, number_chunks);
+    }
+    else
+    {
+      first_chunk = first/chunk_size;
+      last_chunk = last/chunk_size;
+    }
+    if ((first_chunk+1) >= tabled_chunks) return FALSE;
+    if ((last_chunk+1) >= tabled_chunks) last_chunk = tabled_chunks-2;
+    start = chunk_starts[first_chunk];
+    end = chunk_starts[last_chunk+1];
+  }
+  else
+  {
+    start = point_start+(I64)point_size*first;
+    end = point_start+(I64)point_size*last+point_size;
+  }
+  I64 hint = start;
+  if ((read_ahead_start <= start) && (start <= read_ahead_end))
+  {
+    // continues (or is in) the chunks hinted before
+    if (end <= read_ahead_end) return TRUE;
+    hint = read_ahead_end;
+  }
+  else
+  {
+    read_ahead_start = start;
+  }
+  read_ahead_end = end;
+  return instream->readAhead(hint, end-hint);
+}
+
 BOOL LASreadPoint::read(U8* const * point)
 {
   U32 i;
@@ -450,9 +638,12 @@ BOOL LASreadPoint::read(U8* const * point)
 
       if (readers)
       {
-        for (i = 0; i < num_readers; i++)
+        if (!read_pipeline(pipeline, readers, point, context))
         {
-          readers[i]->read(point[i], context);
+          for (i = 0; i < num_readers; i++)
+          {
+            readers[i]->read(point[i], context);
+          }
         }
       }
       else
@@ -492,9 +683,12 @@ BOOL LASreadPoint::read(U8* const * point)
     }
     else
     {
-      for (i = 0; i < num_readers; i++)
+      if (!read_pipeline(pipeline, readers, point, context))
       {
-        readers[i]->read(point[i], context);
+        for (i = 0; i < num_readers; i++)
+        {
+          readers[i]->read(point[i], context);
+        }
       }
     }
   }
@@ -743,6 +937,51 @@ BOOL LASreadPoint::read_chunk_table()
   return TRUE;
 }
 
+U32 LASreadPoint::get_number_chunks()
+{
+  if (dec == 0)
+  {
+    return 0;
+  }
+  if (point_start == 0)
+  {
+    // like seek() this leaves the stream at the start of the first chunk
+    if (!init_dec())
+    {
+      return 0;
+    }
+    chunk_count = 0;
+  }
+  // only a complete chunk table is of use
+  if ((chunk_starts == 0) || (number_chunks == U32_MAX) || (tabled_chunks != (number_chunks+1)))
+  {
+    return 0;
+  }
+  return number_chunks;
+}
+
+BOOL LASreadPoint::get_chunk(const U32 index, I64* start, U32* num_bytes, I64* first_point, U32* num_points)
+{
+  if (index >= get_number_chunks())
+  {
+    return FALSE;
+  }
+  if (start) *start = chunk_starts[index];
+  if (num_bytes) *num_bytes = (U32)(chunk_starts[index+1] - chunk_starts[index]);
+  if (chunk_totals)
+  {
+    if (first_point) *first_point = chunk_totals[index];
+    if (num_points) *num_points = chunk_totals[index+1] - chunk_totals[index];
+  }
+  else
+  {
+    // the last chunk of fixed size may be shorter, which only the caller knows
+    if (first_point) *first_point = (I64)index*chunk_size;
+    if (num_points) *num_points = chunk_size;
+  }
+  return TRUE;
+}
+
 U32 LASreadPoint::search_chunk_table(const U32 index, const U32 lower, const U32 upper)
 {
   if (lower + 1 == upper) return lower;
@@ -24,6 +24,9 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- read_ahead() hints the stream about the chunks of upcoming points
+    19 October 2026 -- chunk table can be queried for copying chunks without decoding
+    19 October 2026 -- common item sequences are read without virtual calls
     28 August 2017 -- moving 'context' from global development hack to interface  
     18 July 2017 -- bug fix for spatial-indexed reading of native compressed LAS 1.4 
     19 April 2017 -- support for selective decompression for new LAS 1.4 points 
@@ -63,10 +66,17 @@ public:
 
   BOOL init(ByteStreamIn* instream);
   BOOL seek(const U32 current, const U32 target);
+  // hints the stream about the bytes of the points first to last, which for LAZ are those of
+  // the whole chunks they are in. bytes hinted by the previous call are not hinted again.
+  BOOL read_ahead(const U32 first, const U32 last);
   BOOL read(U8* const * point);
   BOOL check_end();
   BOOL done();
 
+  // the chunks of chunked LAZ. the chunk table is read here if no point was read yet.
+  U32 get_number_chunks();
+  BOOL get_chunk(const U32 index, I64* start, U32* num_bytes, I64* first_point, U32* num_points);
+
   inline const CHAR* error() const { return last_error; };
   inline const CHAR* warning() const { return last_warning; };
 
@@ -78,6 +88,9 @@ private:
   LASreadItem** readers_compressed;
   ArithmeticDecoder* dec;
   BOOL layered_las14_compression;
+  // the item sequence of common point types is read without virtual calls
+  U32 pipeline;
+  void select_pipeline(const U32 num_items, const LASitem* items);
   // used for chunking
   U32 chunk_size;
   U32 chunk_count;
@@ -95,6 +108,8 @@ private:
   I64 point_start;
   U32 point_size;
   U8** seek_point;
+  I64 read_ahead_start;
+  I64 read_ahead_end;
   // used for error and warning reporting
   CHAR* last_error;
   CHAR* last_warning;
@@ -42,6 +42,92 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+// the item sequences of the common point types. with these the compiler sees the concrete
+// writer classes and can call (and for raw items inline) their write() without the vtable.
+
+#define LAS_WRITE_POINT_PIPELINE_GENERIC                0
+#define LAS_WRITE_POINT_PIPELINE_RAW_POINT10            1
+#define LAS_WRITE_POINT_PIPELINE_RAW_POINT10_GPS        2
+#define LAS_WRITE_POINT_PIPELINE_RAW_POINT10_GPS_RGB    3
+#define LAS_WRITE_POINT_PIPELINE_RAW_POINT14            4
+#define LAS_WRITE_POINT_PIPELINE_RAW_POINT14_RGB        5
+#define LAS_WRITE_POINT_PIPELINE_RAW_POINT14_RGBNIR     6
+#define LAS_WRITE_POINT_PIPELINE_V2_POINT10            11
+#define LAS_WRITE_POINT_PIPELINE_V2_POINT10_GPS        12
+#define LAS_WRITE_POINT_PIPELINE_V2_POINT10_GPS_RGB    13
+#define LAS_WRITE_POINT_PIPELINE_V3_POINT14            21
+#define LAS_WRITE_POINT_PIPELINE_V3_POINT14_RGB        22
+#define LAS_WRITE_POINT_PIPELINE_V3_POINT14_RGBNIR     23
+#define LAS_WRITE_POINT_PIPELINE_V4_POINT14            31
+#define LAS_WRITE_POINT_PIPELINE_V4_POINT14_RGB        32
+#define LAS_WRITE_POINT_PIPELINE_V4_POINT14_RGBNIR     33
+
+template<class Item>
+static inline void write_items(LASwriteItem** writers, const U8 * const * point, U32& context)
+{
+  ((Item*)writers[0])->Item::write(point[0], context);
+}
+
+template<class Item, class Next, class... Rest>
+static inline void write_items(LASwriteItem** writers, const U8 * const * point, U32& context)
+{
+  ((Item*)writers[0])->Item::write(point[0], context);
+  write_items<Next, Rest...>(writers + 1, point + 1, context);
+}
+
+static inline BOOL write_pipeline(const U32 pipeline, LASwriteItem** writers, const U8 * const * point, U32& context)
+{
+  switch (pipeline)
+  {
+  case LAS_WRITE_POINT_PIPELINE_RAW_POINT10:
+    write_items<LASwriteItemRaw_POINT10_LE>(writers, point, context);
+    return TRUE;
+  case LAS_WRITE_POINT_PIPELINE_RAW_POINT10_GPS:
+    write_items<LASwriteItemRaw_POINT10_LE, LASwriteItemRaw_GPSTIME11_LE>(writers, point, context);
+    return TRUE;
+  case LAS_WRITE_POINT_PIPELINE_RAW_POINT10_GPS_RGB:
+    write_items<LASwriteItemRaw_POINT10_LE, LASwriteItemRaw_GPSTIME11_LE, LASwriteItemRaw_RGB12_LE>(writers, point, context);
+    return TRUE;
+  case LAS_WRITE_POINT_PIPELINE_RAW_POINT14:
+    write_items<LASwriteItemRaw_POINT14_LE>(writers, point, context);
+    return TRUE;
+  case LAS_WRITE_POINT_PIPELINE_RAW_POINT14_RGB:
+    write_items<LASwriteItemRaw_POINT14_LE, LASwriteItemRaw_RGB12_LE>(writers, point, context);
+    return TRUE;
+  case LAS_WRITE_POINT_PIPELINE_RAW_POINT14_RGBNIR:
+    write_items<LASwriteItemRaw_POINT14_LE, LASwriteItemRaw_RGBNIR14_LE>(writers, point, context);
+    return TRUE;
+  case LAS_WRITE_POINT_PIPELINE_V2_POINT10:
+    write_items<LASwriteItemCompressed_POINT10_v2>(writers, point, context);
+    return TRUE;
+  case LAS_WRITE_POINT_PIPELINE_V2_POINT10_GPS:
+    write_items<LASwriteItemCompressed_POINT10_v2, LASwriteItemCompressed_GPSTIME11_v2>(writers, point, context);
+    return TRUE;
+  case LAS_WRITE_POINT_PIPELINE_V2_POINT10_GPS_RGB:
+    write_items<LASwriteItemCompressed_POINT10_v2, LASwriteItemCompressed_GPSTIME11_v2, LASwriteItemCompressed_RGB12_v2>(writers, point, context);
+    return TRUE;
+  case LAS_WRITE_POINT_PIPELINE_V3_POINT14:
+    write_items<LASwriteItemCompressed_POINT14_v3>(writers, point, context);
+    return TRUE;
+  case LAS_WRITE_POINT_PIPELINE_V3_POINT14_RGB:
+    write_items<LASwriteItemCompressed_POINT14_v3, LASwriteItemCompressed_RGB14_v3>(writers, point, context);
+    return TRUE;
+  case LAS_WRITE_POINT_PIPELINE_V3_POINT14_RGBNIR:
+    write_items<LASwriteItemCompressed_POINT14_v3, LASwriteItemCompressed_RGBNIR14_v3>(writers, point, context);
+    return TRUE;
+  case LAS_WRITE_POINT_PIPELINE_V4_POINT14:
+    write_items<LASwriteItemCompressed_POINT14_v4>(writers, point, context);
+    return TRUE;
+  case LAS_WRITE_POINT_PIPELINE_V4_POINT14_RGB:
+    write_items<LASwriteItemCompressed_POINT14_v4, LASwriteItemCompressed_RGB14_v4>(writers, point, context);
+    return TRUE;
+  case LAS_WRITE_POINT_PIPELINE_V4_POINT14_RGBNIR:
+    write_items<LASwriteItemCompressed_POINT14_v4, LASwriteItemCompressed_RGBNIR14_v4>(writers, point, context);
+    return TRUE;
+  }
+  return FALSE;
+}
+
 LASwritePoint::LASwritePoint()
 {
   outstream = 0;
@@ -51,6 +137,7 @@ LASwritePoint::LASwritePoint()
   writers_compressed = 0;
   enc = 0;
   layered_las14_compression = FALSE;
+  pipeline = LAS_WRITE_POINT_PIPELINE_GENERIC;
   // used for chunking
   chunk_size = U32_MAX;
   chunk_count = 0;
@@ -251,9 +338,57 @@ BOOL LASwritePoint::setup(const U32 num_items, const LASitem* items, const LASzi
       number_chunks = U32_MAX;
     }
   }
+  select_pipeline(num_items, items);
   return TRUE;
 }
 
+void LASwritePoint::select_pipeline(const U32 num_items, const LASitem* items)
+{
+  pipeline = LAS_WRITE_POINT_PIPELINE_GENERIC;
+
+  if ((num_items == 0) || (num_items > 3))
+  {
+    return;
+  }
+
+  // the type of every item and the version shared by all items (or zero if raw)
+
+  U32 i;
+  U32 types[3] = { 0, 0, 0 };
+  U32 version = (enc ? items[0].version : 0);
+  for (i = 0; i < num_items; i++)
+  {
+    if (enc && (items[i].version != version)) return;
+    types[i] = items[i].type;
+  }
+  if ((enc == 0) && !IS_LITTLE_ENDIAN())
+  {
+    return;
+  }
+
+  if ((types[0] == LASitem::POINT10) && ((version == 0) || (version == 2)))
+  {
+    if (num_items == 1)
+      pipeline = LAS_WRITE_POINT_PIPELINE_RAW_POINT10;
+    else if ((num_items == 2) && (types[1] == LASitem::GPSTIME11))
+      pipeline = LAS_WRITE_POINT_PIPELINE_RAW_POINT10_GPS;
+    else if ((num_items == 3) && (types[1] == LASitem::GPSTIME11) && (types[2] == LASitem::RGB12))
+      pipeline = LAS_WRITE_POINT_PIPELINE_RAW_POINT10_GPS_RGB;
+    if (pipeline && (version == 2)) pipeline += (LAS_WRITE_POINT_PIPELINE_V2_POINT10 - LAS_WRITE_POINT_PIPELINE_RAW_POINT10);
+  }
+  else if ((types[0] == LASitem::POINT14) && ((version == 0) || (version == 3) || (version == 4)))
+  {
+    if (num_items == 1)
+      pipeline = LAS_WRITE_POINT_PIPELINE_RAW_POINT14;
+    else if ((num_items == 2) && (types[1] == LASitem::RGB14))
+      pipeline = LAS_WRITE_POINT_PIPELINE_RAW_POINT14_RGB;
+    else if ((num_items == 2) && (types[1] == LASitem::RGBNIR14))
+      pipeline = LAS_WRITE_POINT_PIPELINE_RAW_POINT14_RGBNIR;
+    if (pipeline && (version == 3)) pipeline += (LAS_WRITE_POINT_PIPELINE_V3_POINT14 - LAS_WRITE_POINT_PIPELINE_RAW_POINT14);
+    else if (pipeline && (version == 4)) pipeline += (LAS_WRITE_POINT_PIPELINE_V4_POINT14 - LAS_WRITE_POINT_PIPELINE_RAW_POINT14);
+  }
+}
+
 BOOL LASwritePoint::init(ByteStreamOut* outstream)
 {
   if (!outstream) return FALSE;
@@ -334,9 +469,12 @@ BOOL LASwritePoint::write(const U8 * const * point)
 
   if (writers)
   {
-    for (i = 0; i < num_writers; i++)
+    if (!write_pipeline(pipeline, writers, point, context))
     {
-      writers[i]->write(point[i], context);
+      for (i = 0; i < num_writers; i++)
+      {
+        writers[i]->write(point[i], context);
+      }
     }
   }
   else
@@ -383,6 +521,33 @@ BOOL LASwritePoint::chunk()
   return TRUE;
 }
 
+BOOL LASwritePoint::write_chunk(const U8* bytes, const U32 num_bytes, const U32 num_points)
+{
+  if (chunk_start_position == 0 || chunk_size != U32_MAX)
+  {
+    return FALSE;
+  }
+  // first close the chunk of the points written so far
+  if (writers && chunk_count)
+  {
+    if (!chunk())
+    {
+      return FALSE;
+    }
+  }
+  if (!outstream->putBytes(bytes, num_bytes))
+  {
+    return FALSE;
+  }
+  chunk_count = num_points;
+  if (!add_chunk_to_table())
+  {
+    return FALSE;
+  }
+  chunk_count = 0;
+  return TRUE;
+}
+
 BOOL LASwritePoint::done()
 {
   if (writers == writers_compressed)
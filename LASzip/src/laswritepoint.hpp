@@ -24,6 +24,8 @@
 
   CHANGE HISTORY:
 
+    19 October 2026 -- chunks compressed elsewhere can be appended with write_chunk()
+    19 October 2026 -- common item sequences are written without virtual calls
     21 February 2019 -- fix for writing 4294967295+ points uncompressed to LAS
     28 August 2017 -- moving 'context' from global development hack to interface  
     23 August 2016 -- layering of items for selective decompression in LAS 1.4 
@@ -63,6 +65,9 @@ public:
   BOOL chunk();
   BOOL done();
 
+  // appends a chunk compressed elsewhere with the same items (only with variable chunking)
+  BOOL write_chunk(const U8* bytes, const U32 num_bytes, const U32 num_points);
+
 private:
   ByteStreamOut* outstream;
   U32 num_writers;
@@ -71,6 +76,9 @@ private:
   LASwriteItem** writers_compressed;
   ArithmeticEncoder* enc;
   BOOL layered_las14_compression;
+  // the item sequence of common point types is written without virtual calls
+  U32 pipeline;
+  void select_pipeline(const U32 num_items, const LASitem* items);
   // used for chunking
   U32 chunk_size;
   U32 chunk_count;
@@ -4,14 +4,57 @@
 #include <string>
 #include <iostream>
 #include <time.h>
+#include <vector>
 
 #include "lasreader.hpp"
 #include "laswriter.hpp"
+#include "lascatalog.hpp"
+#include "laspointtable.hpp"
+#include "lasmulticlip.hpp"
+#include "laschunkclip.hpp"
+#include "laspointcount.hpp"
+#include "lasthingrid.hpp"
+#include "laszip_decompress_selective_v3.hpp"
+
+// attributes decoded by the read functions below. for LAS 1.4 point types 6 to 10 with layered
+// compression everything else (intensity, RGB, NIR, GPS time, extra bytes, ...) is skipped
+const U32 DECOMPRESS_XYZ = LASZIP_DECOMPRESS_SELECTIVE_CHANNEL_RETURNS_XY | LASZIP_DECOMPRESS_SELECTIVE_Z;
+const U32 DECOMPRESS_XYZ_CLASSIFICATION = DECOMPRESS_XYZ | LASZIP_DECOMPRESS_SELECTIVE_CLASSIFICATION;
 
 LASreader* lasreader;
 LASwriter* laswriter;
 double start_time = 0.0;
 
+LAScatalog* catalog = NULL;
+char* catalogFileName = NULL;
+
+// the inventory of an output is updated for blocks of points rather than for every single one
+#define INVENTORY_BLOCK 1024
+
+struct InventoryBlock {
+	I32 X[INVENTORY_BLOCK];
+	I32 Y[INVENTORY_BLOCK];
+	I32 Z[INVENTORY_BLOCK];
+	U8 returnNumbers[INVENTORY_BLOCK];
+	U32 number;
+};
+
+InventoryBlock inventoryBlock;
+
+static void flushInventory(InventoryBlock* block, LASwriter* writer) {
+	writer->inventory.add(block->X, block->Y, block->Z, block->returnNumbers, block->number);
+	block->number = 0;
+}
+
+static void addToInventory(InventoryBlock* block, LASwriter* writer, const LASpoint* point) {
+	block->X[block->number] = point->get_X();
+	block->Y[block->number] = point->get_Y();
+	block->Z[block->number] = point->get_Z();
+	block->returnNumbers[block->number] = (point->extended_point_type ? point->extended_return_number : point->return_number);
+	block->number++;
+	if (block->number == INVENTORY_BLOCK) flushInventory(block, writer);
+}
+
 const char* init(const char* inputFileName, const char* outputFileName, int argc = NULL, char** argv = NULL) {
 	
 	LASreadOpener lasreadopener;
@@ -44,6 +87,7 @@ const char* init(const char* inputFileName, const char* outputFileName, int argc
 		{
 			return "ERROR: could not open laswriter\n";
 		}
+		inventoryBlock.number = 0;
 	}
 	//char returnValue[100];
 	//sprintf(returnValue, "reading %I64d points from '%s' and writing them modified to '%s'.\n", lasreader->npoints, lasreadopener.get_file_name(), laswriteopener.get_file_name());
@@ -52,6 +96,7 @@ const char* init(const char* inputFileName, const char* outputFileName, int argc
 
 const char* after() {
 	if (laswriter) {
+		flushInventory(&inventoryBlock, laswriter);
 		laswriter->update_header(&lasreader->header, TRUE);
 
 		I64 total_bytes = laswriter->close();
@@ -81,6 +126,55 @@ static char* doubleToChar(double d) {
 	return c;
 }
 
+static void freeArgv(int argc, char** argv) {
+	for (int i = 0; i < argc; i++) {
+		delete[] argv[i];
+	}
+	delete[] argv;
+}
+
+static bool isCatalog(const char* fileName) {
+	return strstr(fileName, ".lascat") != NULL;
+}
+
+static bool isLasOrLaz(const char* fileName) {
+	size_t length = strlen(fileName);
+	if (length < 4 || fileName[length - 4] != '.') return false;
+	const char* extension = fileName + length - 3;
+	return (extension[0] == 'l' || extension[0] == 'L') && (extension[1] == 'a' || extension[1] == 'A') && (extension[2] == 's' || extension[2] == 'S' || extension[2] == 'z' || extension[2] == 'Z');
+}
+
+// the last catalog is kept in memory so that repeated queries do not read it again
+static LAScatalog* getCatalog(const char* fileName) {
+	if (catalog != NULL && strcmp(catalogFileName, fileName) == 0) {
+		return catalog;
+	}
+	LAScatalog* newCatalog = new LAScatalog();
+	if (!newCatalog->read(fileName)) {
+		delete newCatalog;
+		return NULL;
+	}
+	delete catalog;
+	delete[] catalogFileName;
+	catalog = newCatalog;
+	catalogFileName = constToChar(fileName);
+	return catalog;
+}
+
+// input is either one LAS/LAZ file or a catalog, in which case all its tiles overlapping the area are read merged
+static bool setInput(LASreadOpener& lasreadopener, const char* inputFileName, double minX, double minY, double maxX, double maxY) {
+	if (!isCatalog(inputFileName)) {
+		lasreadopener.set_file_name(inputFileName);
+		return true;
+	}
+	LAScatalog* tiles = getCatalog(inputFileName);
+	if (tiles == NULL || tiles->add_file_names(&lasreadopener, minX, minY, maxX, maxY) == 0) {
+		return false;
+	}
+	lasreadopener.set_merged(TRUE);
+	return true;
+}
+
 static double distanceCalculate(double x1, double y1, double x2, double y2)
 {
 	double x = x1 - x2; //calculating number to square in next step
@@ -174,7 +268,7 @@ int write_point(const F64 x, const F64 y, const F64 z, U8 classification) {
 	// write the modified point
 	BOOL result = laswriter->write_point(&point);
 	// add it to the inventory
-	laswriter->update_inventory(&point);
+	addToInventory(&inventoryBlock, laswriter, &point);
 
 	return result;
 }
@@ -271,8 +365,12 @@ JNIEXPORT jdoubleArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLib
 	};
 	LASreadOpener lasreadopener;
 	if (!lasreadopener.parse(5, argv)) return NULL;
+	lasreadopener.set_decompress_selective(DECOMPRESS_XYZ);
 
-	lasreadopener.set_file_name(nativeStringInputFileName);
+	if (!setInput(lasreadopener, nativeStringInputFileName, x - radius, y - radius, x + radius, y + radius)) {
+		env->ReleaseStringUTFChars(inputFileName, nativeStringInputFileName);
+		return NULL;
+	}
 	LASreader* lasreader = lasreadopener.open();
 
 	double closestX = 0;
@@ -351,8 +449,12 @@ JNIEXPORT jdoubleArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLib
 	};
 	LASreadOpener lasreadopener;
 	if (!lasreadopener.parse(argc, argv)) return NULL;
+	lasreadopener.set_decompress_selective(DECOMPRESS_XYZ);
 
-	lasreadopener.set_file_name(nativeStringInputFileName);
+	if (!setInput(lasreadopener, nativeStringInputFileName, bbox1, bbox2, bbox3, bbox4)) {
+		env->ReleaseStringUTFChars(inputFileName, nativeStringInputFileName);
+		return NULL;
+	}
 	LASreader* lasreader = lasreadopener.open();
 
 	double closestX = 0;
@@ -414,21 +516,55 @@ JNIEXPORT jint JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelp
 		doubleToChar(maxY),
 	};
 
-	if (!lasreadopener.parse(6, argv)) return -1;
+	// returns the number of points written or -1 on any failure
+	if (!lasreadopener.parse(6, argv)) {
+		env->ReleaseStringUTFChars(tempFileName, nativeStringTempFileName);
+		env->ReleaseStringUTFChars(inputFileName, nativeStringInputFileName);
+		return -1;
+	}
 
-	lasreadopener.set_file_name(nativeStringInputFileName);
+	// a single LAS/LAZ file clipped to LAZ copies the chunks inside the rectangle without re-encoding
+	// them. if that fails (e.g. for a file LASreaderLAS cannot open) the general path below is taken.
+	size_t length = strlen(nativeStringTempFileName);
+	if (isLasOrLaz(nativeStringInputFileName) && length && (nativeStringTempFileName[length - 1] == 'z' || nativeStringTempFileName[length - 1] == 'Z')) {
+		LASchunkClip chunkClip;
+		I64 number = chunkClip.clip(nativeStringInputFileName, nativeStringTempFileName, minX, minY, maxX, maxY);
+		if (number >= 0) {
+			env->ReleaseStringUTFChars(tempFileName, nativeStringTempFileName);
+			env->ReleaseStringUTFChars(inputFileName, nativeStringInputFileName);
+			return (jint)number;
+		}
+	}
+
+	if (!setInput(lasreadopener, nativeStringInputFileName, minX, minY, maxX, maxY)) {
+		env->ReleaseStringUTFChars(tempFileName, nativeStringTempFileName);
+		env->ReleaseStringUTFChars(inputFileName, nativeStringInputFileName);
+		return -1;
+	}
 	laswriteopener.set_file_name(nativeStringTempFileName);
 
 	LASreader* lasreader = lasreadopener.open();
-	LASwriter* laswriter = laswriteopener.open(&lasreader->header);
+	LASwriter* laswriter = (lasreader ? laswriteopener.open(&lasreader->header) : 0);
+	if (laswriter == 0) {
+		if (lasreader) {
+			lasreader->close();
+			delete lasreader;
+		}
+		env->ReleaseStringUTFChars(tempFileName, nativeStringTempFileName);
+		env->ReleaseStringUTFChars(inputFileName, nativeStringInputFileName);
+		return -1;
+	}
 
+	InventoryBlock* block = new InventoryBlock();
 	int i = 0;
 	while (lasreader->read_point())
 	{
 		laswriter->write_point(&lasreader->point);
-		laswriter->update_inventory(&lasreader->point);
+		addToInventory(block, laswriter, &lasreader->point);
 		i++;
 	}
+	flushInventory(block, laswriter);
+	delete block;
 	laswriter->update_header(&lasreader->header, TRUE);
 
 	laswriter->close();
@@ -449,6 +585,7 @@ JNIEXPORT jobjectArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLib
 	LASreadOpener lasreadopener;
 
 	lasreadopener.set_file_name(nativeStringInputFileName);
+	lasreadopener.set_decompress_selective(DECOMPRESS_XYZ_CLASSIFICATION);
 	LASreader* lasreader = lasreadopener.open();
 		
 	long long numOfPoints = lasreader->npoints;
@@ -538,6 +675,7 @@ JNIEXPORT jobjectArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLib
 		doubleToChar(maxX),
 	};
 	if (!lasreadopener.parse(argc, argv)) return NULL;
+	lasreadopener.set_decompress_selective(DECOMPRESS_XYZ);
 	
 	lasreadopener.set_file_name(nativeStringInputFileName);
 	LASreader* lasreader = lasreadopener.open();
@@ -629,7 +767,7 @@ JNIEXPORT jint JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelp
 	return len;
 }
 
-JNIEXPORT jobjectArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_getJNIPointArrayParams(JNIEnv * env, jobject obj, jstring inputFileName, jobjectArray params)
+static jobjectArray getPointArray(JNIEnv * env, jstring inputFileName, jobjectArray params, U32 decompressSelective)
 {
 	const int argc = env->GetArrayLength(params);
 
@@ -645,6 +783,7 @@ JNIEXPORT jobjectArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLib
 	LASreadOpener lasreadopener;
 
 	if (!lasreadopener.parse(argc, argv)) return NULL;
+	lasreadopener.set_decompress_selective(decompressSelective);
 
 	lasreadopener.set_file_name(nativeStringInputFileName);
 	LASreader* lasreader = lasreadopener.open();
@@ -694,3 +833,346 @@ JNIEXPORT jobjectArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLib
 	}
 	return outer;
 }
+
+JNIEXPORT jobjectArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_getJNIPointArrayParams(JNIEnv * env, jobject obj, jstring inputFileName, jobjectArray params)
+{
+	return getPointArray(env, inputFileName, params, DECOMPRESS_XYZ_CLASSIFICATION);
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_getJNIPointArraySelective(JNIEnv * env, jobject obj, jstring inputFileName, jobjectArray params, jint decompressSelective)
+{
+	return getPointArray(env, inputFileName, params, (U32)decompressSelective);
+}
+
+JNIEXPORT jint JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_buildJNICatalog(JNIEnv * env, jobject obj, jstring directory, jstring catalogFile)
+{
+	const char *nativeStringDirectory = env->GetStringUTFChars(directory, 0);
+	const char *nativeStringCatalogFile = env->GetStringUTFChars(catalogFile, 0);
+
+	// an existing catalog is only updated with the tiles that are new or changed since
+	LAScatalog* tiles = new LAScatalog();
+	BOOL built;
+	if (tiles->read(nativeStringCatalogFile)) {
+		built = tiles->update(nativeStringDirectory);
+	}
+	else {
+		built = tiles->build(nativeStringDirectory);
+	}
+	int number = -1;
+	if (built && tiles->write(nativeStringCatalogFile)) {
+		number = tiles->get_number_entries();
+	}
+	delete tiles;
+
+	// make sure the next query reads the new catalog
+	if (catalog != NULL && strcmp(catalogFileName, nativeStringCatalogFile) == 0) {
+		delete catalog;
+		delete[] catalogFileName;
+		catalog = NULL;
+		catalogFileName = NULL;
+	}
+
+	env->ReleaseStringUTFChars(directory, nativeStringDirectory);
+	env->ReleaseStringUTFChars(catalogFile, nativeStringCatalogFile);
+	return number;
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_queryJNICatalog(JNIEnv * env, jobject obj, jstring catalogFile, jdouble minX, jdouble minY, jdouble maxX, jdouble maxY)
+{
+	const char *nativeStringCatalogFile = env->GetStringUTFChars(catalogFile, 0);
+	LAScatalog* tiles = getCatalog(nativeStringCatalogFile);
+	env->ReleaseStringUTFChars(catalogFile, nativeStringCatalogFile);
+	if (tiles == NULL) return NULL;
+
+	U32* indices = NULL;
+	U32 allocated = 0;
+	U32 number = tiles->intersect_rectangle(minX, minY, maxX, maxY, &indices, &allocated);
+
+	jclass cls = env->FindClass("java/lang/String");
+	jobjectArray result = env->NewObjectArray(number, cls, NULL);
+	for (U32 i = 0; i < number; i++)
+	{
+		jstring name = env->NewStringUTF(tiles->get_file_name(indices[i]));
+		env->SetObjectArrayElement(result, i, name);
+		env->DeleteLocalRef(name);
+	}
+	free(indices);
+	return result;
+}
+
+JNIEXPORT jlong JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_loadJNIPointTable(JNIEnv * env, jobject obj, jstring inputFileName, jint attributes)
+{
+	const char *nativeStringInputFileName = env->GetStringUTFChars(inputFileName, 0);
+	LASreadOpener lasreadopener;
+	lasreadopener.set_file_name(nativeStringInputFileName);
+
+	// LAS and LAZ files are decoded with several threads, everything else goes through a reader
+	LASpointTable* table = new LASpointTable();
+	BOOL loaded = FALSE;
+	I32 format = lasreadopener.get_file_format(0);
+	if (format == LAS_TOOLS_FORMAT_LAS || format == LAS_TOOLS_FORMAT_LAZ) {
+		loaded = table->read(nativeStringInputFileName, (U32)attributes);
+	}
+	else {
+		LASreader* lasreader = lasreadopener.open();
+		if (lasreader != NULL) {
+			loaded = table->read(lasreader, (U32)attributes);
+			lasreader->close();
+			delete lasreader;
+		}
+	}
+	env->ReleaseStringUTFChars(inputFileName, nativeStringInputFileName);
+
+	if (!loaded) {
+		delete table;
+		return 0;
+	}
+	return (jlong)table;
+}
+
+JNIEXPORT jlong JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_getJNIPointTableSize(JNIEnv * env, jobject obj, jlong table)
+{
+	if (table == 0) return 0;
+	return ((LASpointTable*)table)->get_number_of_points();
+}
+
+JNIEXPORT jobject JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_getJNIPointTableColumn(JNIEnv * env, jobject obj, jlong table, jint column)
+{
+	if (table == 0) return NULL;
+
+	// the buffer points into the table and is only valid until freeJNIPointTable(). the values are
+	// in native byte order so the Java side has to call order(ByteOrder.nativeOrder()) on it
+	I64 bytes;
+	void* values = ((LASpointTable*)table)->get_column((U32)column, &bytes);
+	if (values == NULL) return NULL;
+	return env->NewDirectByteBuffer(values, bytes);
+}
+
+JNIEXPORT jdoubleArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_getJNIPointTableQuantizer(JNIEnv * env, jobject obj, jlong table)
+{
+	if (table == 0) return NULL;
+	const LASquantizer* quantizer = &((LASpointTable*)table)->quantizer;
+
+	// x = X * values[0] + values[3] and likewise for y and z
+	jdouble values[6];
+	values[0] = quantizer->x_scale_factor;
+	values[1] = quantizer->y_scale_factor;
+	values[2] = quantizer->z_scale_factor;
+	values[3] = quantizer->x_offset;
+	values[4] = quantizer->y_offset;
+	values[5] = quantizer->z_offset;
+
+	jdoubleArray result = env->NewDoubleArray(6);
+	env->SetDoubleArrayRegion(result, 0, 6, values);
+	return result;
+}
+
+JNIEXPORT void JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_freeJNIPointTable(JNIEnv * env, jobject obj, jlong table)
+{
+	delete (LASpointTable*)table;
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_multiClipJNI(JNIEnv * env, jobject obj, jstring inputFileName, jobjectArray regions, jobjectArray outputFileNames)
+{
+	// every region is either a rectangle {minX, minY, maxX, maxY} or a polygon {x0, y0, x1, y1, ...}
+	jsize number = env->GetArrayLength(regions);
+	if (number == 0 || number != env->GetArrayLength(outputFileNames)) return NULL;
+
+	LASmultiClip multiClip;
+	for (jsize i = 0; i < number; i++)
+	{
+		jdoubleArray region = (jdoubleArray)env->GetObjectArrayElement(regions, i);
+		jstring outputFileName = (jstring)env->GetObjectArrayElement(outputFileNames, i);
+		jsize length = env->GetArrayLength(region);
+		// a polygon needs at least three vertices and an x and a y for each of them
+		if (length != 4 && (length < 6 || length % 2)) {
+			env->DeleteLocalRef(region);
+			env->DeleteLocalRef(outputFileName);
+			return NULL;
+		}
+		jdouble* values = env->GetDoubleArrayElements(region, 0);
+		const char *nativeStringOutputFileName = env->GetStringUTFChars(outputFileName, 0);
+		if (length == 4) {
+			multiClip.add_rectangle(values[0], values[1], values[2], values[3], nativeStringOutputFileName);
+		}
+		else {
+			multiClip.add_polygon(values, length / 2, nativeStringOutputFileName);
+		}
+		env->ReleaseStringUTFChars(outputFileName, nativeStringOutputFileName);
+		env->ReleaseDoubleArrayElements(region, values, JNI_ABORT);
+		env->DeleteLocalRef(region);
+		env->DeleteLocalRef(outputFileName);
+	}
+
+	// with a catalog only the tiles overlapping one of the regions are read
+	const LASclipRegion* first = multiClip.get_region(0);
+	double minX = first->min_x, minY = first->min_y, maxX = first->max_x, maxY = first->max_y;
+	for (jsize i = 1; i < number; i++)
+	{
+		const LASclipRegion* region = multiClip.get_region(i);
+		if (region->min_x < minX) minX = region->min_x;
+		if (region->min_y < minY) minY = region->min_y;
+		if (region->max_x > maxX) maxX = region->max_x;
+		if (region->max_y > maxY) maxY = region->max_y;
+	}
+
+	const char *nativeStringInputFileName = env->GetStringUTFChars(inputFileName, 0);
+	LASreadOpener lasreadopener;
+	bool found = setInput(lasreadopener, nativeStringInputFileName, minX, minY, maxX, maxY);
+	env->ReleaseStringUTFChars(inputFileName, nativeStringInputFileName);
+	if (!found) return NULL;
+
+	LASreader* lasreader = lasreadopener.open();
+	if (lasreader == NULL) return NULL;
+	I64 read = multiClip.clip(lasreader);
+	lasreader->close();
+	delete lasreader;
+	if (read < 0) return NULL;
+
+	jlong* counts = new jlong[number];
+	for (jsize i = 0; i < number; i++)
+	{
+		counts[i] = multiClip.get_count(i);
+	}
+	jlongArray result = env->NewLongArray(number);
+	env->SetLongArrayRegion(result, 0, number, counts);
+	delete[] counts;
+	return result;
+}
+
+JNIEXPORT jdoubleArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_getJNIPointCount(JNIEnv * env, jobject obj, jstring inputFileName, jdouble minX, jdouble minY, jdouble maxX, jdouble maxY, jboolean exact)
+{
+	const char *nativeStringInputFileName = env->GetStringUTFChars(inputFileName, 0);
+	LASpointCount pointCount;
+	bool opened = pointCount.open(nativeStringInputFileName);
+	env->ReleaseStringUTFChars(inputFileName, nativeStringInputFileName);
+	if (!opened) return NULL;
+
+	// {inside, estimate, intersecting, minX, minY, maxX, maxY, bytes, exact} where the exact count is -1 unless requested
+	I64 inside, estimate, intersecting, bytes;
+	F64 bbox[4];
+	if (!pointCount.count_approximate(minX, minY, maxX, maxY, &inside, &estimate, &intersecting, bbox, &bytes)) return NULL;
+	jdouble values[9];
+	values[0] = (jdouble)inside;
+	values[1] = (jdouble)estimate;
+	values[2] = (jdouble)intersecting;
+	values[3] = bbox[0];
+	values[4] = bbox[1];
+	values[5] = bbox[2];
+	values[6] = bbox[3];
+	values[7] = (jdouble)bytes;
+	values[8] = (exact ? (jdouble)pointCount.count_exact(minX, minY, maxX, maxY) : -1.0);
+
+	jdoubleArray result = env->NewDoubleArray(9);
+	env->SetDoubleArrayRegion(result, 0, 9, values);
+	return result;
+}
+
+JNIEXPORT jdoubleArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_getJNICellCounts(JNIEnv * env, jobject obj, jstring inputFileName)
+{
+	const char *nativeStringInputFileName = env->GetStringUTFChars(inputFileName, 0);
+	LASpointCount pointCount;
+	bool opened = pointCount.open(nativeStringInputFileName);
+	env->ReleaseStringUTFChars(inputFileName, nativeStringInputFileName);
+	if (!opened || !pointCount.has_index()) return NULL;
+
+	// {minX, minY, maxX, maxY, count} for every cell
+	U32 number = pointCount.get_number_cells();
+	F32* bboxes = new F32[4 * number];
+	U32* counts = new U32[number];
+	pointCount.get_cell_counts(bboxes, counts);
+	jdouble* values = new jdouble[5 * number];
+	for (U32 i = 0; i < number; i++)
+	{
+		values[5 * i] = bboxes[4 * i];
+		values[5 * i + 1] = bboxes[4 * i + 1];
+		values[5 * i + 2] = bboxes[4 * i + 2];
+		values[5 * i + 3] = bboxes[4 * i + 3];
+		values[5 * i + 4] = counts[i];
+	}
+	jdoubleArray result = env->NewDoubleArray(5 * number);
+	env->SetDoubleArrayRegion(result, 0, 5 * number, values);
+	delete[] bboxes;
+	delete[] counts;
+	delete[] values;
+	return result;
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_getJNIThinnedPointArray(JNIEnv * env, jobject obj, jstring inputFileName, jobjectArray params, jdouble gridSpacing, jint mode)
+{
+	const int argc = env->GetArrayLength(params);
+	char** argv = new char*[argc];
+	for (int i = 0; i < argc; i++) {
+		jstring string = (jstring)(env->GetObjectArrayElement(params, i));
+		const char *rawString = env->GetStringUTFChars(string, 0);
+		argv[i] = constToChar(rawString);
+		env->ReleaseStringUTFChars(string, rawString);
+	}
+
+	LASthinGrid grid;
+	LASreadOpener lasreadopener;
+	if (!grid.init(gridSpacing, (U32)mode) || !lasreadopener.parse(argc, argv)) {
+		freeArgv(argc, argv);
+		return NULL;
+	}
+	lasreadopener.set_decompress_selective(DECOMPRESS_XYZ_CLASSIFICATION);
+
+	const char *nativeStringInputFileName = env->GetStringUTFChars(inputFileName, 0);
+	lasreadopener.set_file_name(nativeStringInputFileName);
+	LASreader* lasreader = lasreadopener.open();
+	env->ReleaseStringUTFChars(inputFileName, nativeStringInputFileName);
+	freeArgv(argc, argv);
+	if (lasreader == 0) return NULL;
+
+	// {x, y, z, classification} of the point kept in every occupied cell. keeping the first point
+	// needs one pass, keeping the lowest, the highest, or the most central one needs two.
+	std::vector<jdouble> kept;
+	I64 index = 0;
+	if (mode == LAS_THIN_FIRST) {
+		while (lasreader->read_point()) {
+			if (grid.add(&lasreader->point)) {
+				kept.push_back(lasreader->point.get_x());
+				kept.push_back(lasreader->point.get_y());
+				kept.push_back(lasreader->point.get_z());
+				kept.push_back(lasreader->point.get_classification());
+			}
+		}
+	}
+	else {
+		while (lasreader->read_point()) {
+			grid.add(&lasreader->point, index++);
+		}
+		if (!lasreadopener.reopen(lasreader)) {
+			delete lasreader;
+			return NULL;
+		}
+		kept.reserve(4 * (size_t)grid.get_number_cells());
+		index = 0;
+		while (lasreader->read_point()) {
+			if (grid.is_kept(&lasreader->point, index++)) {
+				kept.push_back(lasreader->point.get_x());
+				kept.push_back(lasreader->point.get_y());
+				kept.push_back(lasreader->point.get_z());
+				kept.push_back(lasreader->point.get_classification());
+			}
+		}
+	}
+	lasreader->close();
+	delete lasreader;
+
+	// a grid that could not grow has dropped points, so the result would be incomplete
+	if (grid.has_failed()) return NULL;
+
+	const int arraySize = 4;
+	const jsize number = (jsize)(kept.size() / arraySize);
+	jclass cls = env->FindClass("[D");
+	jobjectArray outer = env->NewObjectArray(number, cls, NULL);
+	for (jsize i = 0; i < number; i++)
+	{
+		jdoubleArray inner = env->NewDoubleArray(arraySize);
+		env->SetDoubleArrayRegion(inner, 0, arraySize, &kept[arraySize * i]);
+		env->SetObjectArrayElement(outer, i, inner);
+		env->DeleteLocalRef(inner);
+	}
+	return outer;
+}
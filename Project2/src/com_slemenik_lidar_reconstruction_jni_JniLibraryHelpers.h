@@ -87,6 +87,102 @@ extern "C" {
 	JNIEXPORT jobjectArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_getJNIPointArrayParams
 	(JNIEnv *env, jobject obj, jstring inputFileName, jobjectArray params);
 
+	/*
+	 * Class:     com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers
+	 * Method:    getJNIPointArraySelective
+	 * Signature: (Ljava/lang/String;[Ljava/lang/String;I)[[D
+	 */
+	JNIEXPORT jobjectArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_getJNIPointArraySelective
+	(JNIEnv *env, jobject obj, jstring inputFileName, jobjectArray params, jint decompressSelective);
+
+	/*
+	 * Class:     com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers
+	 * Method:    buildJNICatalog
+	 * Signature: (Ljava/lang/String;Ljava/lang/String;)I
+	 */
+	JNIEXPORT jint JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_buildJNICatalog
+	(JNIEnv *env, jobject obj, jstring directory, jstring catalogFile);
+
+	/*
+	 * Class:     com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers
+	 * Method:    queryJNICatalog
+	 * Signature: (Ljava/lang/String;DDDD)[Ljava/lang/String;
+	 */
+	JNIEXPORT jobjectArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_queryJNICatalog
+	(JNIEnv *env, jobject obj, jstring catalogFile, jdouble minX, jdouble minY, jdouble maxX, jdouble maxY);
+
+	/*
+	 * Class:     com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers
+	 * Method:    loadJNIPointTable
+	 * Signature: (Ljava/lang/String;I)J
+	 */
+	JNIEXPORT jlong JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_loadJNIPointTable
+	(JNIEnv *env, jobject obj, jstring inputFileName, jint attributes);
+
+	/*
+	 * Class:     com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers
+	 * Method:    getJNIPointTableSize
+	 * Signature: (J)J
+	 */
+	JNIEXPORT jlong JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_getJNIPointTableSize
+	(JNIEnv *env, jobject obj, jlong table);
+
+	/*
+	 * Class:     com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers
+	 * Method:    getJNIPointTableColumn
+	 * Signature: (JI)Ljava/nio/ByteBuffer;
+	 */
+	JNIEXPORT jobject JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_getJNIPointTableColumn
+	(JNIEnv *env, jobject obj, jlong table, jint column);
+
+	/*
+	 * Class:     com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers
+	 * Method:    getJNIPointTableQuantizer
+	 * Signature: (J)[D
+	 */
+	JNIEXPORT jdoubleArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_getJNIPointTableQuantizer
+	(JNIEnv *env, jobject obj, jlong table);
+
+	/*
+	 * Class:     com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers
+	 * Method:    freeJNIPointTable
+	 * Signature: (J)V
+	 */
+	JNIEXPORT void JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_freeJNIPointTable
+	(JNIEnv *env, jobject obj, jlong table);
+
+	/*
+	 * Class:     com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers
+	 * Method:    multiClipJNI
+	 * Signature: (Ljava/lang/String;[[D[Ljava/lang/String;)[J
+	 */
+	JNIEXPORT jlongArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_multiClipJNI
+	(JNIEnv *env, jobject obj, jstring inputFileName, jobjectArray regions, jobjectArray outputFileNames);
+
+	/*
+	 * Class:     com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers
+	 * Method:    getJNIPointCount
+	 * Signature: (Ljava/lang/String;DDDDZ)[D
+	 */
+	JNIEXPORT jdoubleArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_getJNIPointCount
+	(JNIEnv *env, jobject obj, jstring inputFileName, jdouble minX, jdouble minY, jdouble maxX, jdouble maxY, jboolean exact);
+
+	/*
+	 * Class:     com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers
+	 * Method:    getJNICellCounts
+	 * Signature: (Ljava/lang/String;)[D
+	 */
+	JNIEXPORT jdoubleArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_getJNICellCounts
+	(JNIEnv *env, jobject obj, jstring inputFileName);
+
+	/*
+	 * Class:     com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers
+	 * Method:    getJNIThinnedPointArray
+	 * Signature: (Ljava/lang/String;[Ljava/lang/String;DI)[[D
+	 */
+	JNIEXPORT jobjectArray JNICALL Java_com_slemenik_lidar_reconstruction_jni_JniLibraryHelpers_getJNIThinnedPointArray
+	(JNIEnv *env, jobject obj, jstring inputFileName, jobjectArray params, jdouble gridSpacing, jint mode);
+
 #ifdef __cplusplus
 }
 #endif